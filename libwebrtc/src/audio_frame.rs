@@ -33,3 +33,34 @@ impl AudioFrame<'_> {
         }
     }
 }
+
+/// Float counterpart of [`AudioFrame`], with samples in [-1, 1]. Planar data
+/// holds every sample of the first channel, then of the second one, and so on.
+/// The conversion to and from the int16 WebRTC works with happens once, in
+/// native code.
+#[derive(Debug, Clone)]
+pub struct AudioFrameF32<'a> {
+    pub data: Cow<'a, [f32]>,
+    pub sample_rate: u32,
+    pub num_channels: u32,
+    pub samples_per_channel: u32,
+    pub planar: bool,
+}
+
+impl AudioFrameF32<'_> {
+    // Owned
+    pub fn new(
+        sample_rate: u32,
+        num_channels: u32,
+        samples_per_channel: u32,
+        planar: bool,
+    ) -> Self {
+        Self {
+            data: vec![0.0; (num_channels * samples_per_channel) as usize].into(),
+            sample_rate,
+            num_channels,
+            samples_per_channel,
+            planar,
+        }
+    }
+}
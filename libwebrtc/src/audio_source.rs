@@ -23,6 +23,29 @@ pub struct AudioSourceOptions {
     pub auto_gain_control: bool,
 }
 
+/// Capture queue counters of a [`native::NativeAudioSource`].
+#[derive(Default, Debug, Clone, Copy)]
+pub struct AudioSourceBufferStats {
+    /// Interleaved samples currently queued.
+    pub queued_samples: u64,
+    /// Capacity of the queue, in interleaved samples.
+    pub capacity_samples: u64,
+    /// Number of times the queue ran out of audio while it was being sent,
+    /// idle periods are not counted.
+    pub underruns: u64,
+}
+
+/// Timing of the process-wide 10ms tick that paces every buffered
+/// [`native::NativeAudioSource`].
+#[derive(Default, Debug, Clone, Copy)]
+pub struct AudioPacerStats {
+    pub ticks: u64,
+    /// Delay of the last tick relative to its schedule, in microseconds.
+    pub last_jitter_us: i64,
+    pub max_jitter_us: i64,
+    pub avg_jitter_us: f64,
+}
+
 #[non_exhaustive]
 #[derive(Debug, Clone)]
 pub enum RtcAudioSource {
@@ -45,7 +68,10 @@ pub mod native {
     use std::fmt::{Debug, Formatter};
 
     use super::*;
-    use crate::{audio_frame::AudioFrame, RtcError};
+    use crate::{
+        audio_frame::{AudioFrame, AudioFrameF32},
+        RtcError,
+    };
 
     #[derive(Clone)]
     pub struct NativeAudioSource {
@@ -75,14 +101,57 @@ pub mod native {
             }
         }
 
+        /// Source publishing Opus packets encoded by the application, see
+        /// [`NativeAudioSource::capture_encoded_frame`]. The track must be
+        /// negotiated with Opus at `sample_rate` and `num_channels`, without DTX.
+        pub fn new_encoded(
+            sample_rate: u32,
+            num_channels: u32,
+            queue_size_ms: u32,
+        ) -> NativeAudioSource {
+            Self {
+                handle: imp_as::NativeAudioSource::new_encoded(
+                    sample_rate,
+                    num_channels,
+                    queue_size_ms,
+                ),
+            }
+        }
+
+        /// Publishes one Opus packet lasting `samples_per_channel`, which must be a
+        /// multiple of 10ms and match the negotiated ptime (20ms by default).
+        /// Packets are paced by the source queue like raw frames; without a queue,
+        /// the caller paces them in real time.
+        pub fn capture_encoded_frame(
+            &self,
+            data: &[u8],
+            samples_per_channel: u32,
+        ) -> Result<(), RtcError> {
+            self.handle.capture_encoded_frame(data, samples_per_channel)
+        }
+
         pub fn clear_buffer(&self) {
             self.handle.clear_buffer()
         }
 
+        pub fn buffer_stats(&self) -> AudioSourceBufferStats {
+            self.handle.buffer_stats()
+        }
+
+        pub fn pacer_stats() -> AudioPacerStats {
+            imp_as::NativeAudioSource::pacer_stats()
+        }
+
         pub async fn capture_frame(&self, frame: &AudioFrame<'_>) -> Result<(), RtcError> {
             self.handle.capture_frame(frame).await
         }
 
+        /// Same as [`NativeAudioSource::capture_frame`] with float samples,
+        /// interleaved or planar.
+        pub async fn capture_frame_f32(&self, frame: &AudioFrameF32<'_>) -> Result<(), RtcError> {
+            self.handle.capture_frame_f32(frame).await
+        }
+
         pub fn set_audio_options(&self, options: AudioSourceOptions) {
             self.handle.set_audio_options(options)
         }
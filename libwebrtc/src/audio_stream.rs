@@ -25,7 +25,10 @@ pub mod native {
     use livekit_runtime::Stream;
 
     use super::stream_imp;
-    use crate::{audio_frame::AudioFrame, audio_track::RtcAudioTrack};
+    use crate::{
+        audio_frame::{AudioFrame, AudioFrameF32},
+        audio_track::RtcAudioTrack,
+    };
 
     pub struct NativeAudioStream {
         pub(crate) handle: stream_imp::NativeAudioStream,
@@ -60,4 +63,49 @@ pub mod native {
             Pin::new(&mut self.get_mut().handle).poll_next(cx)
         }
     }
+
+    /// Same as [`NativeAudioStream`] with float frames, interleaved or planar.
+    pub struct NativeAudioStreamF32 {
+        pub(crate) handle: stream_imp::NativeAudioStreamF32,
+    }
+
+    impl Debug for NativeAudioStreamF32 {
+        fn fmt(&self, f: &mut Formatter) -> std::fmt::Result {
+            f.debug_struct("NativeAudioStreamF32").field("track", &self.track()).finish()
+        }
+    }
+
+    impl NativeAudioStreamF32 {
+        pub fn new(
+            audio_track: RtcAudioTrack,
+            sample_rate: i32,
+            num_channels: i32,
+            planar: bool,
+        ) -> Self {
+            Self {
+                handle: stream_imp::NativeAudioStreamF32::new(
+                    audio_track,
+                    sample_rate,
+                    num_channels,
+                    planar,
+                ),
+            }
+        }
+
+        pub fn track(&self) -> RtcAudioTrack {
+            self.handle.track()
+        }
+
+        pub fn close(&mut self) {
+            self.handle.close()
+        }
+    }
+
+    impl Stream for NativeAudioStreamF32 {
+        type Item = AudioFrameF32<'static>;
+
+        fn poll_next(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
+            Pin::new(&mut self.get_mut().handle).poll_next(cx)
+        }
+    }
 }
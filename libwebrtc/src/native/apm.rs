@@ -40,72 +40,153 @@ impl AudioProcessingModule {
         }
     }
 
+    /// Processes `data` in place, a multiple of 10ms of interleaved samples.
     pub fn process_stream(
         &mut self,
         data: &mut [i16],
         sample_rate: i32,
         num_channels: i32,
     ) -> Result<(), RtcError> {
-        let samples_per_10ms = (sample_rate as usize / 100) * num_channels as usize;
+        check_10ms_multiple(data.len(), sample_rate, num_channels);
+        let data_ptr = data.as_mut_ptr();
+        let res = unsafe {
+            self.sys_handle.pin_mut().process_stream_batch(
+                data_ptr,
+                data.len(),
+                data_ptr,
+                std::ptr::null(),
+                0,
+                std::ptr::null_mut(),
+                sample_rate,
+                num_channels,
+            )
+        };
+        check_result(res, "Failed to process stream")
+    }
+
+    /// Processes the far-end audio `data` in place, a multiple of 10ms of
+    /// interleaved samples.
+    pub fn process_reverse_stream(
+        &mut self,
+        data: &mut [i16],
+        sample_rate: i32,
+        num_channels: i32,
+    ) -> Result<(), RtcError> {
+        check_10ms_multiple(data.len(), sample_rate, num_channels);
+        let data_ptr = data.as_mut_ptr();
+        let res = unsafe {
+            self.sys_handle.pin_mut().process_stream_batch(
+                std::ptr::null(),
+                0,
+                std::ptr::null_mut(),
+                data_ptr,
+                data.len(),
+                data_ptr,
+                sample_rate,
+                num_channels,
+            )
+        };
+        check_result(res, "Failed to process reverse stream")
+    }
+
+    /// Processes `data` and the far-end audio played out meanwhile, `reverse`,
+    /// in place and in a single call into the native module. Both hold the
+    /// same multiple of 10ms of interleaved samples, the reverse stream of
+    /// each 10ms is processed first.
+    pub fn process_stream_batch(
+        &mut self,
+        data: &mut [i16],
+        reverse: Option<&mut [i16]>,
+        sample_rate: i32,
+        num_channels: i32,
+    ) -> Result<(), RtcError> {
+        check_10ms_multiple(data.len(), sample_rate, num_channels);
+        let reverse = reverse.unwrap_or_default();
         assert!(
-            data.len() % samples_per_10ms == 0 && data.len() >= samples_per_10ms,
-            "slice must have a multiple of 10ms worth of samples"
+            reverse.is_empty() || reverse.len() == data.len(),
+            "reverse stream must be as long as the stream"
         );
 
-        for chunk in data.chunks_mut(samples_per_10ms) {
-            if unsafe {
-                self.sys_handle.pin_mut().process_stream(
-                    chunk.as_mut_ptr(),
-                    chunk.len(),
-                    chunk.as_mut_ptr(),
-                    chunk.len(),
-                    sample_rate,
-                    num_channels,
-                )
-            } != 0
-            {
-                return Err(RtcError {
-                    error_type: RtcErrorType::Internal,
-                    message: "Failed to process stream".to_string(),
-                });
-            }
-        }
-
-        Ok(())
+        let data_ptr = data.as_mut_ptr();
+        let reverse_ptr = reverse.as_mut_ptr();
+        let res = unsafe {
+            self.sys_handle.pin_mut().process_stream_batch(
+                data_ptr,
+                data.len(),
+                data_ptr,
+                reverse_ptr,
+                reverse.len(),
+                reverse_ptr,
+                sample_rate,
+                num_channels,
+            )
+        };
+        check_result(res, "Failed to process stream")
     }
 
-    pub fn process_reverse_stream(
+    /// Same as [`Self::process_stream_batch`] with samples in [-1, 1].
+    pub fn process_stream_batch_f32(
         &mut self,
-        data: &mut [i16],
+        data: &mut [f32],
+        reverse: Option<&mut [f32]>,
         sample_rate: i32,
         num_channels: i32,
     ) -> Result<(), RtcError> {
-        let samples_per_10ms = (sample_rate as usize / 100) * num_channels as usize;
+        check_10ms_multiple(data.len(), sample_rate, num_channels);
+        let reverse = reverse.unwrap_or_default();
         assert!(
-            data.len() % samples_per_10ms == 0 && data.len() >= samples_per_10ms,
-            "slice must have a multiple of 10ms worth of samples"
+            reverse.is_empty() || reverse.len() == data.len(),
+            "reverse stream must be as long as the stream"
         );
 
-        for chunk in data.chunks_mut(samples_per_10ms) {
-            if unsafe {
-                self.sys_handle.pin_mut().process_reverse_stream(
-                    chunk.as_mut_ptr(),
-                    chunk.len(),
-                    chunk.as_mut_ptr(),
-                    chunk.len(),
-                    sample_rate,
-                    num_channels,
-                )
-            } != 0
-            {
-                return Err(RtcError {
-                    error_type: RtcErrorType::Internal,
-                    message: "Failed to process reverse stream".to_string(),
-                });
-            }
-        }
+        let data_ptr = data.as_mut_ptr();
+        let reverse_ptr = reverse.as_mut_ptr();
+        let res = unsafe {
+            self.sys_handle.pin_mut().process_stream_batch_f32(
+                data_ptr,
+                data.len(),
+                data_ptr,
+                reverse_ptr,
+                reverse.len(),
+                reverse_ptr,
+                sample_rate,
+                num_channels,
+            )
+        };
+        check_result(res, "Failed to process stream")
+    }
 
-        Ok(())
+    /// Same as [`Self::process_stream_batch_f32`] with planar buffers, each
+    /// channel holding `len / num_channels` samples.
+    pub fn process_stream_batch_f32_planar(
+        &mut self,
+        data: &mut [f32],
+        reverse: Option<&mut [f32]>,
+        sample_rate: i32,
+        num_channels: i32,
+    ) -> Result<(), RtcError> {
+        check_10ms_multiple(data.len(), sample_rate, num_channels);
+        let reverse = reverse.unwrap_or_default();
+        assert!(
+            reverse.is_empty() || reverse.len() == data.len(),
+            "reverse stream must be as long as the stream"
+        );
+
+        let data_ptr = data.as_mut_ptr();
+        let reverse_ptr = reverse.as_mut_ptr();
+        let res = unsafe {
+            self.sys_handle.pin_mut().process_stream_batch_f32_planar(
+                data_ptr,
+                data.len(),
+                data_ptr,
+                reverse_ptr,
+                reverse.len(),
+                reverse_ptr,
+                sample_rate,
+                num_channels,
+            )
+        };
+        check_result(res, "Failed to process stream")
     }
 
     pub fn set_stream_delay_ms(&mut self, delay_ms: i32) -> Result<(), RtcError> {
@@ -119,3 +200,19 @@ impl AudioProcessingModule {
         }
     }
 }
+
+fn check_10ms_multiple(len: usize, sample_rate: i32, num_channels: i32) {
+    let samples_per_10ms = (sample_rate as usize / 100) * num_channels as usize;
+    assert!(
+        samples_per_10ms > 0 && len % samples_per_10ms == 0 && len >= samples_per_10ms,
+        "slice must have a multiple of 10ms worth of samples"
+    );
+}
+
+fn check_result(res: i32, message: &str) -> Result<(), RtcError> {
+    if res == 0 {
+        Ok(())
+    } else {
+        Err(RtcError { error_type: RtcErrorType::Internal, message: message.to_string() })
+    }
+}
@@ -26,6 +26,9 @@ impl Default for AudioResampler {
 }
 
 impl AudioResampler {
+    /// `src` can hold any number of samples, they are resampled by 10ms chunks
+    /// and the remainder is carried over to the next call with the same
+    /// format. The output may therefore be empty, or longer than 10ms.
     pub fn remix_and_resample<'a>(
         &'a mut self,
         src: &[i16],
@@ -47,7 +50,46 @@ impl AudioResampler {
                 dst_sample_rate as i32,
             );
 
+            if len == 0 {
+                return &[];
+            }
+
             std::slice::from_raw_parts(self.sys_handle.data(), len / 2)
         }
     }
+
+    /// Float version of [`Self::remix_and_resample`], with samples in [-1, 1].
+    /// `src` and the output are planar when `planar` is set. It has its own
+    /// carry-over, so the output may also be empty or longer than 10ms.
+    #[allow(clippy::too_many_arguments)]
+    pub fn remix_and_resample_f32<'a>(
+        &'a mut self,
+        src: &[f32],
+        samples_per_channel: u32,
+        num_channels: u32,
+        sample_rate: u32,
+        planar: bool,
+        dst_num_channels: u32,
+        dst_sample_rate: u32,
+    ) -> &'a [f32] {
+        assert!(src.len() >= (samples_per_channel * num_channels) as usize, "src buffer too small");
+
+        unsafe {
+            let len = self.sys_handle.pin_mut().remix_and_resample_f32(
+                src.as_ptr(),
+                samples_per_channel as usize,
+                num_channels as usize,
+                sample_rate as i32,
+                planar,
+                dst_num_channels as usize,
+                dst_sample_rate as i32,
+            );
+
+            if len == 0 {
+                return &[];
+            }
+
+            std::slice::from_raw_parts(self.sys_handle.data_f32(), len / 4)
+        }
+    }
 }
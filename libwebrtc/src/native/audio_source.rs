@@ -16,7 +16,11 @@ use cxx::SharedPtr;
 use tokio::sync::oneshot;
 use webrtc_sys::audio_track as sys_at;
 
-use crate::{audio_frame::AudioFrame, audio_source::AudioSourceOptions, RtcError, RtcErrorType};
+use crate::{
+    audio_frame::{AudioFrame, AudioFrameF32},
+    audio_source::{AudioPacerStats, AudioSourceBufferStats, AudioSourceOptions},
+    RtcError, RtcErrorType,
+};
 
 #[derive(Clone)]
 pub struct NativeAudioSource {
@@ -65,6 +69,28 @@ impl NativeAudioSource {
         Self { sys_handle, sample_rate, num_channels, queue_size_samples }
     }
 
+    /// Creates a source publishing Opus packets instead of PCM, the encoder runs
+    /// on silence and its output is replaced by the packets.
+    ///
+    /// # Panics
+    /// assert if `queue_size_ms` is not a multiple of 10.
+    pub fn new_encoded(
+        sample_rate: u32,
+        num_channels: u32,
+        queue_size_ms: u32,
+    ) -> NativeAudioSource {
+        assert!(queue_size_ms % 10 == 0, "queue_size_ms must be a multiple of 10");
+
+        let sys_handle = sys_at::ffi::new_encoded_audio_track_source(
+            sample_rate.try_into().unwrap(),
+            num_channels.try_into().unwrap(),
+            queue_size_ms.try_into().unwrap(),
+        );
+
+        let queue_size_samples = (queue_size_ms * sample_rate * num_channels) / 1000;
+        Self { sys_handle, sample_rate, num_channels, queue_size_samples }
+    }
+
     pub fn sys_handle(&self) -> SharedPtr<sys_at::ffi::AudioTrackSource> {
         self.sys_handle.clone()
     }
@@ -89,25 +115,110 @@ impl NativeAudioSource {
         self.sys_handle.clear_buffer();
     }
 
+    pub fn buffer_stats(&self) -> AudioSourceBufferStats {
+        self.sys_handle.buffer_stats().into()
+    }
+
+    pub fn pacer_stats() -> AudioPacerStats {
+        sys_at::ffi::audio_pacer_stats().into()
+    }
+
+    pub fn capture_encoded_frame(
+        &self,
+        data: &[u8],
+        samples_per_channel: u32,
+    ) -> Result<(), RtcError> {
+        if samples_per_channel == 0 || samples_per_channel % (self.sample_rate / 100) != 0 {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "encoded frames must last a multiple of 10ms".to_owned(),
+            });
+        }
+
+        if !self.sys_handle.capture_encoded_frame(data, samples_per_channel as usize) {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "failed to capture encoded frame".to_owned(),
+            });
+        }
+        Ok(())
+    }
+
     pub async fn capture_frame(&self, frame: &AudioFrame<'_>) -> Result<(), RtcError> {
-        if self.sample_rate != frame.sample_rate || self.num_channels != frame.num_channels {
+        self.check_frame(frame.sample_rate, frame.num_channels, frame.data.len())?;
+
+        let data: &[i16] = frame.data.as_ref();
+        let num_channels = self.num_channels as usize;
+        self.capture(data.len() / num_channels, |start, nb_frames, ctx, on_complete| unsafe {
+            self.sys_handle.capture_frame(
+                &data[start * num_channels..(start + nb_frames) * num_channels],
+                self.sample_rate,
+                self.num_channels,
+                nb_frames,
+                ctx,
+                on_complete,
+            )
+        })
+        .await
+    }
+
+    /// Same as [`Self::capture_frame`] with float samples, converted to int16 in native
+    /// code.
+    pub async fn capture_frame_f32(&self, frame: &AudioFrameF32<'_>) -> Result<(), RtcError> {
+        self.check_frame(frame.sample_rate, frame.num_channels, frame.data.len())?;
+
+        let data: &[f32] = frame.data.as_ref();
+        let num_channels = self.num_channels as usize;
+        let total_frames = data.len() / num_channels;
+        self.capture(total_frames, |start, nb_frames, ctx, on_complete| unsafe {
+            // Planar chunks start at their first frame in the first channel, the
+            // other channels follow every `total_frames` samples.
+            let (chunk, planar_stride) = if frame.planar {
+                (&data[start..], total_frames)
+            } else {
+                (&data[start * num_channels..(start + nb_frames) * num_channels], 0)
+            };
+            self.sys_handle.capture_frame_f32(
+                chunk,
+                self.sample_rate,
+                self.num_channels,
+                nb_frames,
+                planar_stride,
+                ctx,
+                on_complete,
+            )
+        })
+        .await
+    }
+
+    fn check_frame(&self, sample_rate: u32, num_channels: u32, len: usize) -> Result<(), RtcError> {
+        if self.sample_rate != sample_rate || self.num_channels != num_channels {
             return Err(RtcError {
                 error_type: RtcErrorType::InvalidState,
                 message: "sample_rate and num_channels don't match".to_owned(),
             });
         }
+        if len % (self.num_channels as usize) != 0 {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "frame.data length not divisible by channel count".to_owned(),
+            });
+        }
+        Ok(())
+    }
 
+    /// Hands `nb_frames` frames to `capture(start, nb_frames, ctx, on_complete)`,
+    /// at once without a queue, otherwise in chunks of at most the queue size, each
+    /// one once the previous one has been consumed.
+    async fn capture(
+        &self,
+        nb_frames: usize,
+        capture: impl Fn(usize, usize, *const sys_at::SourceContext, sys_at::CompleteCallback) -> bool,
+    ) -> Result<(), RtcError> {
         // Fast path: no buffering
         if self.queue_size_samples == 0 {
             // frame size must be 10ms for fast path
             let expected_frames_per_ch = (self.sample_rate / 100) as usize;
-            if frame.data.len() % (self.num_channels as usize) != 0 {
-                return Err(RtcError {
-                    error_type: RtcErrorType::InvalidState,
-                    message: "frame.data length not divisible by channel count".to_owned(),
-                });
-            }
-            let nb_frames = frame.data.len() / (self.num_channels as usize);
             if nb_frames != expected_frames_per_ch {
                 return Err(RtcError {
                     error_type: RtcErrorType::InvalidState,
@@ -124,25 +235,15 @@ impl NativeAudioSource {
                 // No-op: fast path completes synchronously, no callback needed
             }
 
-            unsafe {
-                let data: &[i16] = frame.data.as_ref();
-                // Use a valid no-op callback instead of null for safety
-                // In release mode, transmuting null pointers can cause UB
-                let noop_callback = sys_at::CompleteCallback(noop_complete_callback);
-                let ok = self.sys_handle.capture_frame(
-                    data,
-                    self.sample_rate,
-                    self.num_channels,
-                    nb_frames,
-                    std::ptr::null(), // Context is still null - callback won't use it
-                    noop_callback,
-                );
-                if !ok {
-                    return Err(RtcError {
-                        error_type: RtcErrorType::InvalidState,
-                        message: "failed to capture frame without buffering".to_owned(),
-                    });
-                }
+            // Use a valid no-op callback instead of null for safety
+            // In release mode, transmuting null pointers can cause UB
+            let noop_callback = sys_at::CompleteCallback(noop_complete_callback);
+            // Context is still null - callback won't use it
+            if !capture(0, nb_frames, std::ptr::null(), noop_callback) {
+                return Err(RtcError {
+                    error_type: RtcErrorType::InvalidState,
+                    message: "failed to capture frame without buffering".to_owned(),
+                });
             }
             return Ok(());
         }
@@ -154,30 +255,29 @@ impl NativeAudioSource {
         }
 
         // iterate over chunks of self._queue_size_samples
-        for chunk in frame.data.chunks(self.queue_size_samples as usize) {
-            let nb_frames = chunk.len() / self.num_channels as usize;
+        let chunk_frames = (self.queue_size_samples / self.num_channels) as usize;
+        let mut start = 0;
+        while start < nb_frames {
+            let chunk_len = chunk_frames.min(nb_frames - start);
             let (tx, rx) = oneshot::channel::<()>();
             let ctx = Box::new(tx);
             let ctx_ptr = Box::into_raw(ctx) as *const sys_at::SourceContext;
 
-            unsafe {
-                // In the fast path, C++ never store / invoke on_complete / ctx.
-                if !self.sys_handle.capture_frame(
-                    chunk,
-                    self.sample_rate,
-                    self.num_channels,
-                    nb_frames,
-                    ctx_ptr,
-                    sys_at::CompleteCallback(lk_audio_source_complete),
-                ) {
-                    return Err(RtcError {
-                        error_type: RtcErrorType::InvalidState,
-                        message: "failed to capture frame".to_owned(),
-                    });
-                }
+            // In the fast path, C++ never store / invoke on_complete / ctx.
+            if !capture(
+                start,
+                chunk_len,
+                ctx_ptr,
+                sys_at::CompleteCallback(lk_audio_source_complete),
+            ) {
+                return Err(RtcError {
+                    error_type: RtcErrorType::InvalidState,
+                    message: "failed to capture frame".to_owned(),
+                });
             }
 
             let _ = rx.await;
+            start += chunk_len;
         }
 
         Ok(())
@@ -203,3 +303,24 @@ impl From<AudioSourceOptions> for sys_at::ffi::AudioSourceOptions {
         }
     }
 }
+
+impl From<sys_at::ffi::AudioSourceBufferStats> for AudioSourceBufferStats {
+    fn from(stats: sys_at::ffi::AudioSourceBufferStats) -> Self {
+        Self {
+            queued_samples: stats.queued_samples,
+            capacity_samples: stats.capacity_samples,
+            underruns: stats.underruns,
+        }
+    }
+}
+
+impl From<sys_at::ffi::AudioPacerStats> for AudioPacerStats {
+    fn from(stats: sys_at::ffi::AudioPacerStats) -> Self {
+        Self {
+            ticks: stats.ticks,
+            last_jitter_us: stats.last_jitter_us,
+            max_jitter_us: stats.max_jitter_us,
+            avg_jitter_us: stats.avg_jitter_us,
+        }
+    }
+}
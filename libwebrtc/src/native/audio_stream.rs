@@ -23,7 +23,10 @@ use livekit_runtime::Stream;
 use tokio::sync::mpsc;
 use webrtc_sys::audio_track as sys_at;
 
-use crate::{audio_frame::AudioFrame, audio_track::RtcAudioTrack};
+use crate::{
+    audio_frame::{AudioFrame, AudioFrameF32},
+    audio_track::RtcAudioTrack,
+};
 
 pub struct NativeAudioStream {
     native_sink: SharedPtr<sys_at::ffi::NativeAudioSink>,
@@ -73,6 +76,62 @@ impl Stream for NativeAudioStream {
     }
 }
 
+/// Same as [`NativeAudioStream`] with float frames, converted from int16 in native
+/// code.
+pub struct NativeAudioStreamF32 {
+    native_sink: SharedPtr<sys_at::ffi::NativeAudioSink>,
+    audio_track: RtcAudioTrack,
+    frame_rx: mpsc::UnboundedReceiver<AudioFrameF32<'static>>,
+}
+
+impl NativeAudioStreamF32 {
+    pub fn new(
+        audio_track: RtcAudioTrack,
+        sample_rate: i32,
+        num_channels: i32,
+        planar: bool,
+    ) -> Self {
+        let (frame_tx, frame_rx) = mpsc::unbounded_channel();
+        let observer = Arc::new(AudioTrackObserverF32 { frame_tx });
+        let native_sink = sys_at::ffi::new_native_audio_sink_f32(
+            Box::new(sys_at::AudioSinkWrapper::new(observer.clone())),
+            sample_rate,
+            num_channels,
+            planar,
+        );
+
+        let audio = unsafe { sys_at::ffi::media_to_audio(audio_track.sys_handle()) };
+        audio.add_sink(&native_sink);
+
+        Self { native_sink, audio_track, frame_rx }
+    }
+
+    pub fn track(&self) -> RtcAudioTrack {
+        self.audio_track.clone()
+    }
+
+    pub fn close(&mut self) {
+        let audio = unsafe { sys_at::ffi::media_to_audio(self.audio_track.sys_handle()) };
+        audio.remove_sink(&self.native_sink);
+
+        self.frame_rx.close();
+    }
+}
+
+impl Drop for NativeAudioStreamF32 {
+    fn drop(&mut self) {
+        self.close();
+    }
+}
+
+impl Stream for NativeAudioStreamF32 {
+    type Item = AudioFrameF32<'static>;
+
+    fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
+        self.frame_rx.poll_recv(cx)
+    }
+}
+
 pub struct AudioTrackObserver {
     frame_tx: mpsc::UnboundedSender<AudioFrame<'static>>,
 }
@@ -87,3 +146,29 @@ impl sys_at::AudioSink for AudioTrackObserver {
         });
     }
 }
+
+pub struct AudioTrackObserverF32 {
+    frame_tx: mpsc::UnboundedSender<AudioFrameF32<'static>>,
+}
+
+impl sys_at::AudioSink for AudioTrackObserverF32 {
+    // The sink is a float one, only on_data_f32 is called.
+    fn on_data(&self, _data: &[i16], _sample_rate: i32, _nb_channels: usize, _nb_frames: usize) {}
+
+    fn on_data_f32(
+        &self,
+        data: &[f32],
+        sample_rate: i32,
+        nb_channels: usize,
+        nb_frames: usize,
+        planar: bool,
+    ) {
+        let _ = self.frame_tx.send(AudioFrameF32 {
+            data: data.to_owned().into(),
+            sample_rate: sample_rate as u32,
+            num_channels: nb_channels as u32,
+            samples_per_channel: nb_frames as u32,
+            planar,
+        });
+    }
+}
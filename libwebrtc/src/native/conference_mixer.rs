@@ -0,0 +1,97 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use cxx::UniquePtr;
+use webrtc_sys::conference_mixer::ffi;
+
+/// Mixer for many participants pushing their own 10ms frames, e.g. to record
+/// a room. Frames without voice activity or below -90dBov are skipped, and
+/// only the `max_speakers` loudest participants are mixed. A mix-minus (the
+/// mix without their own voice) can be produced for each of them.
+///
+/// Up to 4 frames are queued per participant, each [`Self::mix`] takes the
+/// oldest one.
+pub struct ConferenceMixer {
+    sys_handle: UniquePtr<ffi::ConferenceMixer>,
+    samples_per_frame: usize,
+}
+
+impl ConferenceMixer {
+    pub fn new(sample_rate: u32, num_channels: u32, max_speakers: usize) -> Self {
+        Self {
+            sys_handle: ffi::create_conference_mixer(
+                sample_rate as i32,
+                num_channels as usize,
+                max_speakers,
+            ),
+            samples_per_frame: (sample_rate / 100 * num_channels) as usize,
+        }
+    }
+
+    pub fn add_participant(&mut self, id: u32) {
+        self.sys_handle.pin_mut().add_participant(id);
+    }
+
+    pub fn remove_participant(&mut self, id: u32) {
+        self.sys_handle.pin_mut().remove_participant(id);
+    }
+
+    /// Queues a frame of `id` for the next [`Self::mix`] calls, 10ms of
+    /// interleaved samples at the mixer format. `audio_level` is in -dBov like
+    /// RFC 6464 (0 is the loudest, 127 silence), computed from `data` when
+    /// `None`. Returns false for an unknown participant.
+    pub fn push_frame(
+        &mut self,
+        id: u32,
+        data: &[i16],
+        voice_activity: bool,
+        audio_level: Option<u8>,
+    ) -> bool {
+        assert_eq!(data.len(), self.samples_per_frame, "frame must contain 10ms of samples");
+
+        unsafe {
+            self.sys_handle.pin_mut().push_frame(
+                id,
+                data.as_ptr(),
+                data.len(),
+                voice_activity,
+                audio_level.map_or(-1, i32::from),
+            )
+        }
+    }
+
+    /// Mixes the oldest queued frame of every participant. With `mix_minus`, the
+    /// mix-minus of every participant is available from
+    /// [`Self::mix_minus`] until the next call.
+    pub fn mix(&mut self, mix_minus: bool) -> &[i16] {
+        let len = self.sys_handle.pin_mut().mix(mix_minus);
+        unsafe { std::slice::from_raw_parts(self.sys_handle.data(), len) }
+    }
+
+    /// Last mix without the audio of `id`, the full mix when `id` wasn't
+    /// mixed.
+    pub fn mix_minus(&self, id: u32) -> Option<&[i16]> {
+        let data = self.sys_handle.mix_minus(id);
+        if data.is_null() {
+            return None;
+        }
+
+        unsafe { Some(std::slice::from_raw_parts(data, self.samples_per_frame)) }
+    }
+
+    /// Participants mixed by the last [`Self::mix`], loudest first.
+    pub fn speakers(&self) -> Vec<u32> {
+        self.sys_handle.speakers().iter().copied().collect()
+    }
+}
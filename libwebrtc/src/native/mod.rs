@@ -20,6 +20,7 @@ pub mod audio_resampler;
 pub mod audio_source;
 pub mod audio_stream;
 pub mod audio_track;
+pub mod conference_mixer;
 pub mod data_channel;
 #[cfg(any(target_os = "macos", target_os = "windows", target_os = "linux"))]
 pub mod desktop_capturer;
@@ -34,6 +35,8 @@ pub mod rtp_receiver;
 pub mod rtp_sender;
 pub mod rtp_transceiver;
 pub mod session_description;
+pub mod stats;
+pub mod video_encoder;
 pub mod video_frame;
 pub mod video_source;
 pub mod video_stream;
@@ -28,7 +28,7 @@ use crate::{
     imp::{
         data_channel as imp_dc, ice_candidate as imp_ic, media_stream as imp_ms,
         media_stream_track as imp_mst, rtp_receiver as imp_rr, rtp_sender as imp_rs,
-        rtp_transceiver as imp_rt, session_description as imp_sdp,
+        rtp_transceiver as imp_rt, session_description as imp_sdp, stats as imp_stats,
     },
     media_stream::MediaStream,
     media_stream_track::MediaStreamTrack,
@@ -45,7 +45,7 @@ use crate::{
     rtp_sender::RtpSender,
     rtp_transceiver::{RtpTransceiver, RtpTransceiverInit},
     session_description::SessionDescription,
-    stats::RtcStats,
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
     MediaType, RtcError, RtcErrorType,
 };
 
@@ -408,26 +408,22 @@ impl PeerConnection {
     }
 
     pub async fn get_stats(&self) -> Result<Vec<RtcStats>, RtcError> {
-        let (tx, rx) = oneshot::channel::<Result<Vec<RtcStats>, RtcError>>();
-        let ctx = Box::new(sys_pc::PeerContext(Box::new(tx)));
-
-        self.sys_handle.get_stats(ctx, |ctx, stats| {
-            let tx = ctx.0.downcast::<oneshot::Sender<Result<Vec<RtcStats>, RtcError>>>().unwrap();
+        imp_stats::to_stats(self.get_stats_records(StatsMode::Full).await?)
+    }
 
-            if stats.is_empty() {
-                let _ = tx.send(Ok(vec![]));
-                return;
-            }
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        let (tx, rx) = oneshot::channel::<Vec<RtcStatsRecord>>();
+        let ctx = Box::new(sys_pc::PeerContext(Box::new(tx)));
 
-            // Unwrap because it should not happens
-            let vec = serde_json::from_str(&stats).unwrap();
-            let _ = tx.send(Ok(vec));
+        self.sys_handle.get_stats(ctx, mode == StatsMode::Delta, |ctx, stats| {
+            let tx = ctx.0.downcast::<imp_stats::StatsSender>().unwrap();
+            let _ = tx.send(stats.into_iter().map(Into::into).collect());
         });
 
-        rx.await.map_err(|_| RtcError {
-            error_type: RtcErrorType::Internal,
-            message: "get_stats cancelled".to_owned(),
-        })?
+        rx.await.map_err(|_| imp_stats::get_stats_cancelled())
     }
 
     pub fn senders(&self) -> Vec<RtpSender> {
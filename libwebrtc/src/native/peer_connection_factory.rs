@@ -24,7 +24,7 @@ use crate::{
     audio_track::RtcAudioTrack,
     imp::{audio_track as imp_at, peer_connection as imp_pc, video_track as imp_vt},
     peer_connection::PeerConnection,
-    peer_connection_factory::RtcConfiguration,
+    peer_connection_factory::{native::VideoDecoderThreading, RtcConfiguration},
     rtp_parameters::RtpCapabilities,
     video_source::native::NativeVideoSource,
     video_track::RtcVideoTrack,
@@ -101,6 +101,13 @@ impl PeerConnectionFactory {
     pub fn get_rtp_receiver_capabilities(&self, media_type: MediaType) -> RtpCapabilities {
         self.sys_handle.rtp_receiver_capabilities(media_type.into()).into()
     }
+
+    pub fn set_video_decoder_threading(&self, threading: VideoDecoderThreading) {
+        self.sys_handle.set_video_decoder_threading(sys_pcf::ffi::VideoDecoderThreading {
+            threads_per_decoder: threading.threads_per_decoder,
+            max_total_threads: threading.max_total_threads,
+        });
+    }
 }
 
 #[cfg(test)]
@@ -12,13 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+use std::sync::Arc;
+
 use cxx::SharedPtr;
 use tokio::sync::oneshot;
 use webrtc_sys::rtp_receiver as sys_rr;
 
 use crate::{
-    imp::media_stream_track::new_media_stream_track, media_stream_track::MediaStreamTrack,
-    rtp_parameters::RtpParameters, stats::RtcStats, RtcError, RtcErrorType,
+    imp::{media_stream_track::new_media_stream_track, stats as imp_stats},
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::RtpParameters,
+    rtp_receiver::{EncodedFrame, OnEncodedFrame},
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
+    RtcError,
 };
 
 #[derive(Clone)]
@@ -37,29 +43,58 @@ impl RtpReceiver {
     }
 
     pub async fn get_stats(&self) -> Result<Vec<RtcStats>, RtcError> {
-        let (tx, rx) = oneshot::channel::<Result<Vec<RtcStats>, RtcError>>();
-        let ctx = Box::new(sys_rr::ReceiverContext(Box::new(tx)));
-
-        self.sys_handle.get_stats(ctx, |ctx, stats| {
-            let tx = ctx.0.downcast::<oneshot::Sender<Result<Vec<RtcStats>, RtcError>>>().unwrap();
+        imp_stats::to_stats(self.get_stats_records(StatsMode::Full).await?)
+    }
 
-            if stats.is_empty() {
-                let _ = tx.send(Ok(vec![]));
-                return;
-            }
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        let (tx, rx) = oneshot::channel::<Vec<RtcStatsRecord>>();
+        let ctx = Box::new(sys_rr::ReceiverContext(Box::new(tx)));
 
-            // Unwrap because it should not happens
-            let vec = serde_json::from_str(&stats).unwrap();
-            let _ = tx.send(Ok(vec));
+        self.sys_handle.get_stats(ctx, mode == StatsMode::Delta, |ctx, stats| {
+            let tx = ctx.0.downcast::<imp_stats::StatsSender>().unwrap();
+            let _ = tx.send(stats.into_iter().map(Into::into).collect());
         });
 
-        rx.await.map_err(|_| RtcError {
-            error_type: RtcErrorType::Internal,
-            message: "get_stats cancelled".to_owned(),
-        })?
+        rx.await.map_err(|_| imp_stats::get_stats_cancelled())
     }
 
     pub fn parameters(&self) -> RtpParameters {
         self.sys_handle.get_parameters().into()
     }
+
+    pub fn add_encoded_frame_tap(&self, decode: bool, on_frame: OnEncodedFrame) -> EncodedFrameTap {
+        let observer = Arc::new(EncodedFrameObserver { on_frame });
+        let sys_handle = self.sys_handle.add_encoded_frame_tap(
+            Box::new(sys_rr::EncodedFrameSinkWrapper::new(observer)),
+            decode,
+        );
+        EncodedFrameTap { _sys_handle: sys_handle }
+    }
+}
+
+pub struct EncodedFrameTap {
+    _sys_handle: SharedPtr<sys_rr::ffi::EncodedFrameTap>,
+}
+
+struct EncodedFrameObserver {
+    on_frame: OnEncodedFrame,
+}
+
+impl sys_rr::EncodedFrameSink for EncodedFrameObserver {
+    fn on_encoded_frame(&self, info: &sys_rr::ffi::EncodedFrameInfo, data: &[u8]) {
+        (self.on_frame)(&EncodedFrame {
+            data,
+            keyframe: info.keyframe,
+            rtp_timestamp: info.rtp_timestamp,
+            ssrc: info.ssrc,
+            payload_type: info.payload_type,
+            mime_type: &info.mime_type,
+            width: info.width,
+            height: info.height,
+            receive_time_us: info.receive_time_us,
+        });
+    }
 }
@@ -16,10 +16,12 @@ use cxx::SharedPtr;
 use tokio::sync::oneshot;
 use webrtc_sys::{rtc_error as sys_err, rtp_sender as sys_rs};
 
-use super::media_stream_track::new_media_stream_track;
+use super::{media_stream_track::new_media_stream_track, stats as imp_stats};
 use crate::{
-    media_stream_track::MediaStreamTrack, rtp_parameters::RtpParameters, stats::RtcStats, RtcError,
-    RtcErrorType,
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::RtpParameters,
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
+    RtcError, RtcErrorType,
 };
 
 #[derive(Clone)]
@@ -38,26 +40,22 @@ impl RtpSender {
     }
 
     pub async fn get_stats(&self) -> Result<Vec<RtcStats>, RtcError> {
-        let (tx, rx) = oneshot::channel::<Result<Vec<RtcStats>, RtcError>>();
-        let ctx = Box::new(sys_rs::SenderContext(Box::new(tx)));
-
-        self.sys_handle.get_stats(ctx, |ctx, stats| {
-            let tx = ctx.0.downcast::<oneshot::Sender<Result<Vec<RtcStats>, RtcError>>>().unwrap();
+        imp_stats::to_stats(self.get_stats_records(StatsMode::Full).await?)
+    }
 
-            if stats.is_empty() {
-                let _ = tx.send(Ok(vec![]));
-                return;
-            }
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        let (tx, rx) = oneshot::channel::<Vec<RtcStatsRecord>>();
+        let ctx = Box::new(sys_rs::SenderContext(Box::new(tx)));
 
-            // Unwrap because it should not happens
-            let vec = serde_json::from_str(&stats).unwrap();
-            let _ = tx.send(Ok(vec));
+        self.sys_handle.get_stats(ctx, mode == StatsMode::Delta, |ctx, stats| {
+            let tx = ctx.0.downcast::<imp_stats::StatsSender>().unwrap();
+            let _ = tx.send(stats.into_iter().map(Into::into).collect());
         });
 
-        rx.await.map_err(|_| RtcError {
-            error_type: RtcErrorType::Internal,
-            message: "get_stats cancelled".to_owned(),
-        })?
+        rx.await.map_err(|_| imp_stats::get_stats_cancelled())
     }
 
     pub fn set_track(&self, track: Option<MediaStreamTrack>) -> Result<(), RtcError> {
@@ -0,0 +1,70 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use webrtc_sys::stats::ffi as sys_stats;
+
+use crate::{
+    stats::{RtcStats, RtcStatsRecord, RtcStatsValue},
+    RtcError, RtcErrorType,
+};
+
+pub type StatsSender = tokio::sync::oneshot::Sender<Vec<RtcStatsRecord>>;
+
+pub fn get_stats_cancelled() -> RtcError {
+    RtcError { error_type: RtcErrorType::Internal, message: "get_stats cancelled".to_owned() }
+}
+
+pub fn to_stats(records: Vec<RtcStatsRecord>) -> Result<Vec<RtcStats>, RtcError> {
+    records.iter().map(RtcStats::from_record).collect()
+}
+
+impl From<sys_stats::RtcStatsMember> for RtcStatsValue {
+    fn from(member: sys_stats::RtcStatsMember) -> Self {
+        use sys_stats::RtcStatsMemberKind as Kind;
+        match member.kind {
+            Kind::Bool => Self::Bool(member.bool_value),
+            Kind::Int => Self::Int(member.int_value),
+            Kind::Uint => Self::Uint(member.uint_value),
+            Kind::Double => Self::Double(member.double_value),
+            Kind::String => Self::String(member.string_value),
+            Kind::BoolSequence => Self::BoolSequence(member.bool_values),
+            Kind::IntSequence => Self::IntSequence(member.int_values),
+            Kind::UintSequence => Self::UintSequence(member.uint_values),
+            Kind::DoubleSequence => Self::DoubleSequence(member.double_values),
+            Kind::StringSequence => Self::StringSequence(member.string_values),
+            Kind::UintMap => {
+                Self::UintMap(member.string_values.into_iter().zip(member.uint_values).collect())
+            }
+            Kind::DoubleMap => Self::DoubleMap(
+                member.string_values.into_iter().zip(member.double_values).collect(),
+            ),
+            _ => unreachable!("unknown stats member kind"),
+        }
+    }
+}
+
+impl From<sys_stats::RtcStatsRecord> for RtcStatsRecord {
+    fn from(record: sys_stats::RtcStatsRecord) -> Self {
+        Self {
+            id: record.id,
+            stats_type: record.stats_type,
+            timestamp_us: record.timestamp_us,
+            members: record
+                .members
+                .into_iter()
+                .map(|mut member| (std::mem::take(&mut member.name), member.into()))
+                .collect(),
+        }
+    }
+}
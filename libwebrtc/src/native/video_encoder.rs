@@ -0,0 +1,139 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use webrtc_sys::video_encoder_factory as sys_vef;
+
+#[derive(Default, Debug, Clone, Copy)]
+pub struct EncodeTimingStats {
+    pub count: u64,
+    /// Wall-clock time of the last encode, in microseconds.
+    pub last_us: i64,
+    pub max_us: i64,
+    pub avg_us: f64,
+}
+
+/// Encode times of the simulcast video encoder of one track.
+#[derive(Default, Debug, Clone)]
+pub struct SimulcastEncodeStats {
+    /// From the input frame to all of its layers being encoded.
+    pub frame: EncodeTimingStats,
+    /// Indexed by simulcast layer, lowest resolution first. Empty when a
+    /// single encoder encodes every layer in one call (libvpx VP8 without
+    /// parallel encoding), its time can't be split between them.
+    pub layers: Vec<EncodeTimingStats>,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum VideoEncoderPreference {
+    Hardware,
+    Software,
+}
+
+/// How the encoder of a track is picked among the implementations available
+/// for its codec.
+#[derive(Debug, Clone)]
+pub struct VideoEncoderPolicy {
+    pub preference: VideoEncoderPreference,
+    /// (codec, implementation) pairs, the implementation is used for the codec
+    /// whenever it is available. Implementations are "software", "nvidia",
+    /// "vaapi", "videotoolbox" and "mediacodec".
+    pub pins: Vec<(String, String)>,
+    /// Try the next implementation when one fails to initialize.
+    pub fallback_on_init_failure: bool,
+    /// Replace a hardware encoder by a software one, starting with a keyframe,
+    /// when an encode fails, or when it keeps taking longer than
+    /// `max_encode_time_ms` if set.
+    pub fallback_on_encode_failure: bool,
+    /// Opt-in latency fallback: 30 consecutive encodes slower than this
+    /// switch to software for the rest of the track. 0 (the default) only
+    /// falls back on encode errors.
+    pub max_encode_time_ms: u32,
+}
+
+impl Default for VideoEncoderPolicy {
+    fn default() -> Self {
+        Self {
+            preference: VideoEncoderPreference::Hardware,
+            pins: Vec::new(),
+            fallback_on_init_failure: true,
+            fallback_on_encode_failure: true,
+            max_encode_time_ms: 0,
+        }
+    }
+}
+
+/// Only applies to the encoders created afterwards, i.e. to the tracks
+/// published after the call.
+pub fn set_video_encoder_policy(policy: VideoEncoderPolicy) {
+    sys_vef::ffi::set_video_encoder_policy(policy.into());
+}
+
+/// Number of hardware encoders replaced by a software one while encoding.
+pub fn video_encoder_fallbacks() -> u64 {
+    sys_vef::ffi::video_encoder_fallbacks()
+}
+
+/// Encode the simulcast layers of a track concurrently on a shared worker
+/// pool instead of one after the other. Only applies to the encoders created
+/// afterwards, i.e. to the tracks published after the call.
+pub fn set_parallel_simulcast_encode(enabled: bool) {
+    sys_vef::ffi::set_parallel_simulcast_encode(enabled);
+}
+
+/// One entry per published simulcast track, in publication order.
+pub fn simulcast_encode_stats() -> Vec<SimulcastEncodeStats> {
+    sys_vef::ffi::simulcast_encode_stats().into_iter().map(Into::into).collect()
+}
+
+impl From<sys_vef::ffi::EncodeTimingStats> for EncodeTimingStats {
+    fn from(stats: sys_vef::ffi::EncodeTimingStats) -> Self {
+        Self {
+            count: stats.count,
+            last_us: stats.last_us,
+            max_us: stats.max_us,
+            avg_us: stats.avg_us,
+        }
+    }
+}
+
+impl From<sys_vef::ffi::SimulcastEncodeStats> for SimulcastEncodeStats {
+    fn from(stats: sys_vef::ffi::SimulcastEncodeStats) -> Self {
+        Self {
+            frame: stats.frame.into(),
+            layers: stats.layers.into_iter().map(Into::into).collect(),
+        }
+    }
+}
+
+impl From<VideoEncoderPolicy> for sys_vef::ffi::VideoEncoderPolicy {
+    fn from(policy: VideoEncoderPolicy) -> Self {
+        Self {
+            preference: match policy.preference {
+                VideoEncoderPreference::Hardware => sys_vef::ffi::VideoEncoderPreference::Hardware,
+                VideoEncoderPreference::Software => sys_vef::ffi::VideoEncoderPreference::Software,
+            },
+            pins: policy
+                .pins
+                .into_iter()
+                .map(|(codec, implementation)| sys_vef::ffi::VideoEncoderPin {
+                    codec,
+                    implementation,
+                })
+                .collect(),
+            fallback_on_init_failure: policy.fallback_on_init_failure,
+            fallback_on_encode_failure: policy.fallback_on_encode_failure,
+            max_encode_time_ms: policy.max_encode_time_ms.min(i32::MAX as u32) as i32,
+        }
+    }
+}
@@ -24,7 +24,7 @@ use webrtc_sys::{video_frame as vf_sys, video_frame::ffi::VideoRotation, video_t
 
 use crate::{
     video_frame::{I420Buffer, VideoBuffer, VideoFrame},
-    video_source::VideoResolution,
+    video_source::{EncodedVideoCodec, EncodedVideoFrame, VideoResolution},
 };
 
 impl From<vt_sys::ffi::VideoResolution> for VideoResolution {
@@ -39,6 +39,15 @@ impl From<VideoResolution> for vt_sys::ffi::VideoResolution {
     }
 }
 
+impl From<EncodedVideoCodec> for vt_sys::ffi::EncodedVideoCodec {
+    fn from(codec: EncodedVideoCodec) -> Self {
+        match codec {
+            EncodedVideoCodec::H264 => Self::H264,
+            EncodedVideoCodec::Vp8 => Self::VP8,
+        }
+    }
+}
+
 #[derive(Clone)]
 pub struct NativeVideoSource {
     sys_handle: SharedPtr<vt_sys::ffi::VideoTrackSource>,
@@ -110,6 +119,30 @@ impl NativeVideoSource {
         self.sys_handle.on_captured_frame(&builder.pin_mut().build());
     }
 
+    pub fn capture_encoded_frame(&self, frame: &EncodedVideoFrame) -> bool {
+        let mut inner = self.inner.lock();
+        inner.captured_frames += 1;
+
+        let timestamp_us = if frame.timestamp_us == 0 {
+            SystemTime::now().duration_since(UNIX_EPOCH).unwrap().as_micros() as i64
+        } else {
+            frame.timestamp_us
+        };
+
+        let info = vt_sys::ffi::EncodedVideoFrameInfo {
+            codec: frame.codec.into(),
+            keyframe: frame.keyframe,
+            width: frame.width,
+            height: frame.height,
+            timestamp_us,
+        };
+        self.sys_handle.on_captured_encoded_frame(&info, frame.data)
+    }
+
+    pub fn take_keyframe_request(&self) -> bool {
+        self.sys_handle.take_keyframe_request()
+    }
+
     pub fn video_resolution(&self) -> VideoResolution {
         self.sys_handle.video_resolution().into()
     }
@@ -13,51 +13,73 @@
 // limitations under the License.
 
 use std::{
+    collections::VecDeque,
     pin::Pin,
-    sync::Arc,
-    task::{Context, Poll},
+    sync::{
+        atomic::{AtomicI64, AtomicU64, Ordering},
+        Arc,
+    },
+    task::{Context, Poll, Waker},
 };
 
-use cxx::{SharedPtr, UniquePtr};
+use cxx::SharedPtr;
 use livekit_runtime::Stream;
-use tokio::sync::mpsc;
-use webrtc_sys::video_track as sys_vt;
+use parking_lot::Mutex;
+use webrtc_sys::{video_track as sys_vt, webrtc as sys_rtc};
 
 use super::video_frame::new_video_frame_buffer;
 use crate::{
     video_frame::{BoxVideoFrame, VideoFrame},
+    video_stream::{VideoSinkWants, VideoStreamOptions, VideoStreamStats},
     video_track::RtcVideoTrack,
 };
 
 pub struct NativeVideoStream {
     native_sink: SharedPtr<sys_vt::ffi::NativeVideoSink>,
     video_track: RtcVideoTrack,
-    frame_rx: mpsc::UnboundedReceiver<BoxVideoFrame>,
+    queue: Arc<FrameQueue>,
 }
 
 impl NativeVideoStream {
     pub fn new(video_track: RtcVideoTrack) -> Self {
-        let (frame_tx, frame_rx) = mpsc::unbounded_channel();
-        let observer = Arc::new(VideoTrackObserver { frame_tx });
+        Self::with_options(video_track, VideoStreamOptions::default())
+    }
+
+    pub fn with_options(video_track: RtcVideoTrack, options: VideoStreamOptions) -> Self {
+        assert!(options.queue_size != Some(0), "queue_size must be greater than 0");
+
+        let queue = Arc::new(FrameQueue::new(options.queue_size));
+        let observer = Arc::new(VideoTrackObserver { queue: queue.clone() });
         let native_sink = sys_vt::ffi::new_native_video_sink(Box::new(
             sys_vt::VideoSinkWrapper::new(observer.clone()),
         ));
 
         let video = unsafe { sys_vt::ffi::media_to_video(video_track.sys_handle()) };
+        // Not added yet, this only sets the wants used by add_sink
+        video.set_sink_wants(&native_sink, &options.sink_wants.into());
         video.add_sink(&native_sink);
 
-        Self { native_sink, video_track, frame_rx }
+        Self { native_sink, video_track, queue }
     }
 
     pub fn track(&self) -> RtcVideoTrack {
         self.video_track.clone()
     }
 
+    pub fn stats(&self) -> VideoStreamStats {
+        self.queue.stats()
+    }
+
+    pub fn set_sink_wants(&self, wants: VideoSinkWants) {
+        let video = unsafe { sys_vt::ffi::media_to_video(self.video_track.sys_handle()) };
+        video.set_sink_wants(&self.native_sink, &wants.into());
+    }
+
     pub fn close(&mut self) {
         let video = unsafe { sys_vt::ffi::media_to_video(self.video_track.sys_handle()) };
         video.remove_sink(&self.native_sink);
 
-        self.frame_rx.close();
+        self.queue.close();
     }
 }
 
@@ -70,25 +92,145 @@ impl Drop for NativeVideoStream {
 impl Stream for NativeVideoStream {
     type Item = BoxVideoFrame;
 
-    fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
-        self.frame_rx.poll_recv(cx)
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
+        self.queue.poll_recv(cx)
+    }
+}
+
+struct QueueInner {
+    /// Frames along with the time they were enqueued, in microseconds.
+    frames: VecDeque<(i64, BoxVideoFrame)>,
+    waker: Option<Waker>,
+    closed: bool,
+}
+
+/// Frames waiting to be polled. When bounded, only the newest `capacity`
+/// frames are kept.
+struct FrameQueue {
+    capacity: Option<usize>,
+    inner: Mutex<QueueInner>,
+    received_frames: AtomicU64,
+    dropped_frames: AtomicU64,
+    last_frame_age_us: AtomicI64,
+    max_frame_age_us: AtomicI64,
+}
+
+impl FrameQueue {
+    fn new(capacity: Option<usize>) -> Self {
+        Self {
+            capacity,
+            inner: Mutex::new(QueueInner {
+                frames: VecDeque::with_capacity(capacity.unwrap_or_default()),
+                waker: None,
+                closed: false,
+            }),
+            received_frames: AtomicU64::new(0),
+            dropped_frames: AtomicU64::new(0),
+            last_frame_age_us: AtomicI64::new(0),
+            max_frame_age_us: AtomicI64::new(0),
+        }
+    }
+
+    /// Returns the oldest frame if it had to be evicted to make room.
+    fn push(&self, frame: BoxVideoFrame) -> Option<BoxVideoFrame> {
+        let mut inner = self.inner.lock();
+        if inner.closed {
+            return None;
+        }
+
+        self.received_frames.fetch_add(1, Ordering::Relaxed);
+
+        let evicted = match self.capacity {
+            Some(capacity) if inner.frames.len() >= capacity => {
+                inner.frames.pop_front().map(|(_, frame)| frame)
+            }
+            _ => None,
+        };
+
+        inner.frames.push_back((sys_rtc::ffi::time_micros(), frame));
+        let waker = inner.waker.take();
+        drop(inner);
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+
+        evicted
+    }
+
+    fn poll_recv(&self, cx: &mut Context) -> Poll<Option<BoxVideoFrame>> {
+        let mut inner = self.inner.lock();
+        if let Some((enqueued_us, frame)) = inner.frames.pop_front() {
+            drop(inner);
+
+            // Remote frames carry their render time, which is usually in the
+            // future, so the age only covers the time spent in the queue.
+            let age_us = sys_rtc::ffi::time_micros() - enqueued_us;
+            self.last_frame_age_us.store(age_us, Ordering::Relaxed);
+            self.max_frame_age_us.fetch_max(age_us, Ordering::Relaxed);
+            return Poll::Ready(Some(frame));
+        }
+
+        if inner.closed {
+            return Poll::Ready(None);
+        }
+
+        inner.waker = Some(cx.waker().clone());
+        Poll::Pending
+    }
+
+    fn close(&self) {
+        let mut inner = self.inner.lock();
+        inner.closed = true;
+        if let Some(waker) = inner.waker.take() {
+            waker.wake();
+        }
+    }
+
+    fn stats(&self) -> VideoStreamStats {
+        VideoStreamStats {
+            queue_depth: self.inner.lock().frames.len(),
+            received_frames: self.received_frames.load(Ordering::Relaxed),
+            dropped_frames: self.dropped_frames.load(Ordering::Relaxed),
+            last_frame_age_ms: self.last_frame_age_us.load(Ordering::Relaxed) as f64 / 1000.0,
+            max_frame_age_ms: self.max_frame_age_us.load(Ordering::Relaxed) as f64 / 1000.0,
+        }
     }
 }
 
 struct VideoTrackObserver {
-    frame_tx: mpsc::UnboundedSender<BoxVideoFrame>,
+    queue: Arc<FrameQueue>,
 }
 
 impl sys_vt::VideoSink for VideoTrackObserver {
-    fn on_frame(&self, frame: UniquePtr<webrtc_sys::video_frame::ffi::VideoFrame>) {
-        let _ = self.frame_tx.send(VideoFrame {
+    fn on_frame(&self, frame: &webrtc_sys::video_frame::ffi::VideoFrame) {
+        // Queued frames outlive the callback, so this still allocates the
+        // owned C++ buffer wrappers and the boxed VideoBuffer for each frame.
+        let evicted = self.queue.push(VideoFrame {
             rotation: frame.rotation().into(),
             timestamp_us: frame.timestamp_us(),
             buffer: new_video_frame_buffer(unsafe { frame.video_frame_buffer() }),
         });
+
+        if evicted.is_some() {
+            self.on_discarded_frame();
+        }
     }
 
-    fn on_discarded_frame(&self) {}
+    fn on_discarded_frame(&self) {
+        self.queue.dropped_frames.fetch_add(1, Ordering::Relaxed);
+    }
 
     fn on_constraints_changed(&self, _constraints: sys_vt::ffi::VideoTrackSourceConstraints) {}
 }
+
+impl From<VideoSinkWants> for sys_vt::ffi::VideoSinkWants {
+    fn from(wants: VideoSinkWants) -> Self {
+        Self {
+            max_pixel_count: wants.max_pixel_count,
+            target_pixel_count: wants.target_pixel_count,
+            max_framerate_fps: wants.max_framerate_fps,
+            resolution_alignment: wants.resolution_alignment,
+        }
+    }
+}
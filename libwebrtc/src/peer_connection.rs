@@ -25,7 +25,7 @@ use crate::{
     rtp_sender::RtpSender,
     rtp_transceiver::{RtpTransceiver, RtpTransceiverInit},
     session_description::SessionDescription,
-    stats::RtcStats,
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
     MediaType, RtcError,
 };
 
@@ -165,6 +165,15 @@ impl PeerConnection {
         self.handle.get_stats().await
     }
 
+    /// Stats as flat typed records, skips mapping them to [`RtcStats`].
+    /// With [`StatsMode::Delta`], only what changed since the previous delta poll of this handle.
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        self.handle.get_stats_records(mode).await
+    }
+
     pub fn add_transceiver(
         &self,
         track: MediaStreamTrack,
@@ -342,4 +351,304 @@ mod tests {
         alice.close();
         bob.close();
     }
+
+    fn local_config() -> RtcConfiguration {
+        RtcConfiguration {
+            ice_servers: vec![],
+            continual_gathering_policy: ContinualGatheringPolicy::GatherOnce,
+            ice_transport_type: IceTransportsType::All,
+        }
+    }
+
+    /// Negotiates bob's tracks to alice and waits for their first candidates.
+    async fn connect(bob: &PeerConnection, alice: &PeerConnection) {
+        let (bob_ice_tx, mut bob_ice_rx) = mpsc::unbounded_channel::<IceCandidate>();
+        let (alice_ice_tx, mut alice_ice_rx) = mpsc::unbounded_channel::<IceCandidate>();
+        bob.on_ice_candidate(Some(Box::new(move |candidate| {
+            let _ = bob_ice_tx.send(candidate);
+        })));
+        alice.on_ice_candidate(Some(Box::new(move |candidate| {
+            let _ = alice_ice_tx.send(candidate);
+        })));
+
+        let offer = bob.create_offer(OfferOptions::default()).await.unwrap();
+        bob.set_local_description(offer.clone()).await.unwrap();
+        alice.set_remote_description(offer).await.unwrap();
+        let answer = alice.create_answer(AnswerOptions::default()).await.unwrap();
+        alice.set_local_description(answer.clone()).await.unwrap();
+        bob.set_remote_description(answer).await.unwrap();
+
+        bob.add_ice_candidate(alice_ice_rx.recv().await.unwrap()).await.unwrap();
+        alice.add_ice_candidate(bob_ice_rx.recv().await.unwrap()).await.unwrap();
+    }
+
+    /// VP8 keyframe header of a 64x64 frame, then filler. Only the transport is
+    /// checked, the receiver doesn't need to decode it.
+    fn vp8_keyframe() -> Vec<u8> {
+        let mut keyframe = vec![0x10, 0x00, 0x00, 0x9d, 0x01, 0x2a, 64, 0, 64, 0];
+        keyframe.resize(1200, 0xaa);
+        keyframe
+    }
+
+    #[tokio::test]
+    async fn encoded_passthrough_loopback() {
+        use std::{
+            sync::{
+                atomic::{AtomicUsize, Ordering},
+                Arc,
+            },
+            time::Duration,
+        };
+
+        use crate::{
+            audio_source::native::NativeAudioSource,
+            peer_connection_factory::native::PeerConnectionFactoryExt,
+            rtp_receiver::EncodedFrameTap,
+            video_source::{native::NativeVideoSource, *},
+        };
+
+        let _ = env_logger::builder().is_test(true).try_init();
+
+        let factory = PeerConnectionFactory::default();
+        let bob = factory.create_peer_connection(local_config()).unwrap();
+        let alice = factory.create_peer_connection(local_config()).unwrap();
+
+        let video_source = NativeVideoSource::new(VideoResolution { width: 64, height: 64 });
+        let audio_source = NativeAudioSource::new_encoded(48000, 1, 100);
+        let video_track = factory.create_video_track("video", video_source.clone());
+        let audio_track = factory.create_audio_track("audio", audio_source.clone());
+        bob.add_track(video_track.into(), &["stream"]).unwrap();
+        bob.add_track(audio_track.into(), &["stream"]).unwrap();
+
+        let keyframe = vp8_keyframe();
+        // Opus TOC of a 20ms mono CELT frame, then filler. The encoder only
+        // produces silence, receiving these bytes means they replaced it.
+        let mut packet = vec![0xf8];
+        packet.resize(80, 0x55);
+
+        // Counts the received payloads identical to the ones pushed.
+        let video_frames = Arc::new(AtomicUsize::new(0));
+        let audio_frames = Arc::new(AtomicUsize::new(0));
+        let (tap_tx, mut tap_rx) = mpsc::unbounded_channel::<EncodedFrameTap>();
+        alice.on_track(Some(Box::new({
+            let (video_frames, audio_frames) = (video_frames.clone(), audio_frames.clone());
+            let (keyframe, packet) = (keyframe.clone(), packet.clone());
+            move |event| {
+                let (video_frames, audio_frames) = (video_frames.clone(), audio_frames.clone());
+                let (keyframe, packet) = (keyframe.clone(), packet.clone());
+                let tap = event.receiver.add_encoded_frame_tap(
+                    true,
+                    Box::new(move |frame| {
+                        // Called from a WebRTC thread, don't panic here.
+                        if frame.mime_type == "video/VP8" && frame.data == keyframe.as_slice() {
+                            video_frames.fetch_add(1, Ordering::Relaxed);
+                        }
+                        if frame.mime_type == "audio/opus" && frame.data == packet.as_slice() {
+                            audio_frames.fetch_add(1, Ordering::Relaxed);
+                        }
+                    }),
+                );
+                let _ = tap_tx.send(tap);
+            }
+        })));
+
+        connect(&bob, &alice).await;
+        let _taps = [tap_rx.recv().await.unwrap(), tap_rx.recv().await.unwrap()];
+
+        for _ in 0..150 {
+            video_source.capture_encoded_frame(&EncodedVideoFrame {
+                codec: EncodedVideoCodec::Vp8,
+                data: &keyframe,
+                keyframe: true,
+                width: 64,
+                height: 64,
+                timestamp_us: 0,
+            });
+            let _ = audio_source.capture_encoded_frame(&packet, 960);
+            tokio::time::sleep(Duration::from_millis(20)).await;
+
+            if video_frames.load(Ordering::Relaxed) >= 5
+                && audio_frames.load(Ordering::Relaxed) >= 5
+            {
+                break;
+            }
+        }
+
+        assert!(video_frames.load(Ordering::Relaxed) >= 5, "encoded video didn't arrive intact");
+        assert!(audio_frames.load(Ordering::Relaxed) >= 5, "encoded audio didn't arrive intact");
+
+        alice.close();
+        bob.close();
+    }
+
+    #[tokio::test]
+    async fn sink_wants_on_remote_track() {
+        use std::{future::poll_fn, pin::Pin, time::Duration};
+
+        use livekit_runtime::Stream;
+
+        use crate::{
+            media_stream_track::MediaStreamTrack,
+            peer_connection_factory::native::PeerConnectionFactoryExt,
+            video_frame::{I420Buffer, VideoBuffer, VideoFrame, VideoRotation},
+            video_source::{native::NativeVideoSource, *},
+            video_stream::{native::NativeVideoStream, VideoSinkWants, VideoStreamOptions},
+        };
+
+        let _ = env_logger::builder().is_test(true).try_init();
+
+        let factory = PeerConnectionFactory::default();
+        let bob = factory.create_peer_connection(local_config()).unwrap();
+        let alice = factory.create_peer_connection(local_config()).unwrap();
+
+        let source = NativeVideoSource::new(VideoResolution { width: 320, height: 240 });
+        let track = factory.create_video_track("video", source.clone());
+        bob.add_track(track.into(), &["stream"]).unwrap();
+
+        let (track_tx, mut track_rx) = mpsc::unbounded_channel();
+        alice.on_track(Some(Box::new(move |event| {
+            if let MediaStreamTrack::Video(track) = event.track {
+                let _ = track_tx.send(track);
+            }
+        })));
+
+        connect(&bob, &alice).await;
+        let remote = track_rx.recv().await.unwrap();
+
+        const MAX_PIXELS: u32 = 80 * 60;
+        let mut small = NativeVideoStream::with_options(
+            remote.clone(),
+            VideoStreamOptions {
+                queue_size: Some(1),
+                sink_wants: VideoSinkWants {
+                    max_pixel_count: MAX_PIXELS as i32,
+                    ..Default::default()
+                },
+            },
+        );
+        let mut full = NativeVideoStream::with_options(
+            remote,
+            VideoStreamOptions { queue_size: Some(1), ..Default::default() },
+        );
+
+        let frame = VideoFrame {
+            rotation: VideoRotation::VideoRotation0,
+            timestamp_us: 0,
+            buffer: I420Buffer::new(320, 240),
+        };
+        let (mut small_pixels, mut full_pixels) = (0, 0);
+        for _ in 0..150 {
+            source.capture_frame(&frame);
+            tokio::time::sleep(Duration::from_millis(20)).await;
+
+            for (stream, pixels) in [(&mut small, &mut small_pixels), (&mut full, &mut full_pixels)]
+            {
+                let next = poll_fn(|cx| Pin::new(&mut *stream).poll_next(cx));
+                if let Ok(Some(frame)) = tokio::time::timeout(Duration::ZERO, next).await {
+                    *pixels = frame.buffer.width() * frame.buffer.height();
+                }
+            }
+            if small_pixels > 0 && full_pixels > 0 {
+                break;
+            }
+        }
+
+        assert!(small_pixels > 0 && small_pixels <= MAX_PIXELS, "got {} pixels", small_pixels);
+        assert!(full_pixels > MAX_PIXELS, "the unconstrained stream was downscaled");
+
+        alice.close();
+        bob.close();
+    }
+
+    /// Sends real VP8 frames to a receiver with an encoded frame tap and
+    /// returns the number of tapped frames and of frames decoded.
+    async fn run_encoded_frame_tap(decode: bool) -> (usize, u32) {
+        use std::{
+            sync::{
+                atomic::{AtomicUsize, Ordering},
+                Arc,
+            },
+            time::Duration,
+        };
+
+        use crate::{
+            peer_connection_factory::native::PeerConnectionFactoryExt,
+            rtp_receiver::EncodedFrameTap,
+            stats::RtcStats,
+            video_frame::{I420Buffer, VideoFrame, VideoRotation},
+            video_source::{native::NativeVideoSource, *},
+        };
+
+        let factory = PeerConnectionFactory::default();
+        let bob = factory.create_peer_connection(local_config()).unwrap();
+        let alice = factory.create_peer_connection(local_config()).unwrap();
+
+        let source = NativeVideoSource::new(VideoResolution { width: 160, height: 120 });
+        let track = factory.create_video_track("video", source.clone());
+        bob.add_track(track.into(), &["stream"]).unwrap();
+
+        let frames = Arc::new(AtomicUsize::new(0));
+        let (tap_tx, mut tap_rx) = mpsc::unbounded_channel::<EncodedFrameTap>();
+        alice.on_track(Some(Box::new({
+            let frames = frames.clone();
+            move |event| {
+                let frames = frames.clone();
+                let tap = event.receiver.add_encoded_frame_tap(
+                    decode,
+                    Box::new(move |frame| {
+                        // Called from a WebRTC thread, don't panic here.
+                        if frame.mime_type == "video/VP8" && !frame.data.is_empty() {
+                            frames.fetch_add(1, Ordering::Relaxed);
+                        }
+                    }),
+                );
+                let _ = tap_tx.send(tap);
+            }
+        })));
+
+        connect(&bob, &alice).await;
+        let _tap = tap_rx.recv().await.unwrap();
+
+        let frame = VideoFrame {
+            rotation: VideoRotation::VideoRotation0,
+            timestamp_us: 0,
+            buffer: I420Buffer::new(160, 120),
+        };
+        for _ in 0..150 {
+            source.capture_frame(&frame);
+            tokio::time::sleep(Duration::from_millis(20)).await;
+            if frames.load(Ordering::Relaxed) >= 20 {
+                break;
+            }
+        }
+        // Let the last frames reach the decoder.
+        tokio::time::sleep(Duration::from_millis(200)).await;
+
+        let mut decoded = 0;
+        for stats in alice.get_stats().await.unwrap() {
+            if let RtcStats::InboundRtp(inbound) = stats {
+                if inbound.stream.kind == "video" {
+                    decoded = inbound.inbound.frames_decoded;
+                }
+            }
+        }
+
+        alice.close();
+        bob.close();
+        (frames.load(Ordering::Relaxed), decoded)
+    }
+
+    #[tokio::test]
+    async fn encoded_frame_tap_without_decoding() {
+        let _ = env_logger::builder().is_test(true).try_init();
+
+        let (tapped, decoded) = run_encoded_frame_tap(false).await;
+        assert!(tapped >= 20, "the tap got {} frames", tapped);
+        assert_eq!(decoded, 0, "frames were decoded");
+
+        // The same frames are decodable when the tap lets them through.
+        let (tapped, decoded) = run_encoded_frame_tap(true).await;
+        assert!(tapped >= 20, "the tap got {} frames", tapped);
+        assert!(decoded > 0, "no frame was decoded");
+    }
 }
@@ -91,9 +91,25 @@ pub mod native {
         video_source::native::NativeVideoSource, video_track::RtcVideoTrack,
     };
 
+    /// Threads of the video decoders of the process, 0 for no limit.
+    ///
+    /// VP9 and AV1 decoders split tiles and rows over their threads, VP8 and
+    /// H264 decoders use a single thread whatever the limits.
+    #[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+    pub struct VideoDecoderThreading {
+        /// By default a decoder may use as many threads as there are cores.
+        pub threads_per_decoder: u32,
+        /// Shared by all the decoders, each of them still gets one thread
+        /// once the budget is used up.
+        pub max_total_threads: u32,
+    }
+
     pub trait PeerConnectionFactoryExt {
         fn create_video_track(&self, label: &str, source: NativeVideoSource) -> RtcVideoTrack;
         fn create_audio_track(&self, label: &str, source: NativeAudioSource) -> RtcAudioTrack;
+        /// Process-wide, applies to the decoders configured afterwards, i.e. to
+        /// the video tracks subscribed after the call.
+        fn set_video_decoder_threading(&self, threading: VideoDecoderThreading);
     }
 
     impl PeerConnectionFactoryExt for PeerConnectionFactory {
@@ -104,5 +120,9 @@ pub mod native {
         fn create_audio_track(&self, label: &str, source: NativeAudioSource) -> RtcAudioTrack {
             self.handle.create_audio_track(label, source)
         }
+
+        fn set_video_decoder_threading(&self, threading: VideoDecoderThreading) {
+            self.handle.set_video_decoder_threading(threading)
+        }
     }
 }
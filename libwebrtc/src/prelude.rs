@@ -13,7 +13,7 @@
 // limitations under the License.
 
 pub use crate::{
-    audio_frame::AudioFrame,
+    audio_frame::{AudioFrame, AudioFrameF32},
     audio_source::{AudioSourceOptions, RtcAudioSource},
     audio_track::RtcAudioTrack,
     data_channel::{DataBuffer, DataChannel, DataChannelError, DataChannelInit, DataChannelState},
@@ -37,7 +37,7 @@ pub use crate::{
         BoxVideoBuffer, BoxVideoFrame, I010Buffer, I420ABuffer, I420Buffer, I422Buffer, I444Buffer,
         NV12Buffer, VideoBuffer, VideoBufferType, VideoFormatType, VideoFrame, VideoRotation,
     },
-    video_source::{RtcVideoSource, VideoResolution},
+    video_source::{EncodedVideoCodec, EncodedVideoFrame, RtcVideoSource, VideoResolution},
     video_track::RtcVideoTrack,
     MediaType, RtcError, RtcErrorType,
 };
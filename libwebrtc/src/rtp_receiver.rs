@@ -15,10 +15,37 @@
 use std::fmt::Debug;
 
 use crate::{
-    imp::rtp_receiver as imp_rr, media_stream_track::MediaStreamTrack,
-    rtp_parameters::RtpParameters, stats::RtcStats, RtcError,
+    imp::rtp_receiver as imp_rr,
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::RtpParameters,
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
+    RtcError,
 };
 
+/// Encoded frame seen by an [`EncodedFrameTap`], before decoding.
+#[derive(Debug)]
+pub struct EncodedFrame<'a> {
+    pub data: &'a [u8],
+    /// Always true for audio.
+    pub keyframe: bool,
+    pub rtp_timestamp: u32,
+    pub ssrc: u32,
+    pub payload_type: u8,
+    /// e.g. "video/VP8" or "audio/opus".
+    pub mime_type: &'a str,
+    /// 0 for audio.
+    pub width: u32,
+    pub height: u32,
+    pub receive_time_us: i64,
+}
+
+pub type OnEncodedFrame = Box<dyn Fn(&EncodedFrame) + Send + Sync>;
+
+/// Delivers the encoded frames of a receiver until it is dropped.
+pub struct EncodedFrameTap {
+    pub(crate) _handle: imp_rr::EncodedFrameTap,
+}
+
 #[derive(Clone)]
 pub struct RtpReceiver {
     pub(crate) handle: imp_rr::RtpReceiver,
@@ -33,9 +60,28 @@ impl RtpReceiver {
         self.handle.get_stats().await
     }
 
+    /// Stats as flat typed records, skips mapping them to [`RtcStats`].
+    /// With [`StatsMode::Delta`], only what changed since the previous delta poll of this handle.
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        self.handle.get_stats_records(mode).await
+    }
+
     pub fn parameters(&self) -> RtpParameters {
         self.handle.parameters()
     }
+
+    /// Calls `on_frame` with every frame received, before decoding. With
+    /// `decode` false the track isn't decoded at all and its sinks get no frame,
+    /// for recorders only keeping the bitstream.
+    ///
+    /// Uses the frame transformer of the receiver, it can't be combined with a
+    /// `FrameCryptor`.
+    pub fn add_encoded_frame_tap(&self, decode: bool, on_frame: OnEncodedFrame) -> EncodedFrameTap {
+        EncodedFrameTap { _handle: self.handle.add_encoded_frame_tap(decode, on_frame) }
+    }
 }
 
 impl Debug for RtpReceiver {
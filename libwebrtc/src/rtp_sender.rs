@@ -15,8 +15,11 @@
 use std::fmt::Debug;
 
 use crate::{
-    imp::rtp_sender as imp_rs, media_stream_track::MediaStreamTrack, rtp_parameters::RtpParameters,
-    stats::RtcStats, RtcError,
+    imp::rtp_sender as imp_rs,
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::RtpParameters,
+    stats::{RtcStats, RtcStatsRecord, StatsMode},
+    RtcError,
 };
 
 #[derive(Clone)]
@@ -33,6 +36,15 @@ impl RtpSender {
         self.handle.get_stats().await
     }
 
+    /// Stats as flat typed records, skips mapping them to [`RtcStats`].
+    /// With [`StatsMode::Delta`], only what changed since the previous delta poll of this handle.
+    pub async fn get_stats_records(
+        &self,
+        mode: StatsMode,
+    ) -> Result<Vec<RtcStatsRecord>, RtcError> {
+        self.handle.get_stats_records(mode).await
+    }
+
     pub fn set_track(&self, track: Option<MediaStreamTrack>) -> Result<(), RtcError> {
         self.handle.set_track(track)
     }
@@ -622,3 +622,224 @@ pub mod dictionaries {
         // pub timestamp: i64,
     }
 }
+
+/// Value of a stats member, with the type libwebrtc reported it with.
+#[derive(Debug, Clone, PartialEq)]
+pub enum RtcStatsValue {
+    Bool(bool),
+    Int(i64),
+    Uint(u64),
+    Double(f64),
+    String(String),
+    BoolSequence(Vec<bool>),
+    IntSequence(Vec<i64>),
+    UintSequence(Vec<u64>),
+    DoubleSequence(Vec<f64>),
+    StringSequence(Vec<String>),
+    UintMap(Vec<(String, u64)>),
+    DoubleMap(Vec<(String, f64)>),
+}
+
+/// One RTCStats object as delivered by libwebrtc, before being mapped to [`RtcStats`].
+///
+/// Members use the camelCase names of the spec. Attributes without a value are not listed.
+#[derive(Debug, Clone, Default)]
+pub struct RtcStatsRecord {
+    pub id: String,
+    /// RTCStatsType, e.g. "outbound-rtp"
+    pub stats_type: String,
+    pub timestamp_us: i64,
+    pub members: Vec<(String, RtcStatsValue)>,
+}
+
+impl RtcStatsRecord {
+    pub fn get(&self, name: &str) -> Option<&RtcStatsValue> {
+        self.members.iter().find(|(n, _)| n == name).map(|(_, v)| v)
+    }
+}
+
+#[derive(Debug, Default, Copy, Clone, PartialEq, Eq)]
+pub enum StatsMode {
+    /// Every stats object with all its members.
+    #[default]
+    Full,
+    /// Only the members that changed since the previous `Delta` poll of the same object
+    /// (PeerConnection, RtpSender or RtpReceiver handle). Stats objects without any change
+    /// are omitted, the first poll returns everything.
+    Delta,
+}
+
+impl RtcStats {
+    /// Maps a full record to its typed struct, as the JSON report used to be.
+    /// Members missing from the record (e.g. in delta mode) are left to their default.
+    pub fn from_record(record: &RtcStatsRecord) -> Result<Self, crate::RtcError> {
+        Self::deserialize(record_de::RecordDeserializer(record)).map_err(|e| crate::RtcError {
+            error_type: crate::RtcErrorType::Internal,
+            message: format!("failed to map {} stats: {}", record.stats_type, e),
+        })
+    }
+}
+
+/// Presents a record to serde as the map RTCStatsReport::ToJson produced for the same object.
+mod record_de {
+    use serde::{
+        de::{
+            value::{Error, MapDeserializer, SeqDeserializer},
+            IntoDeserializer, Visitor,
+        },
+        forward_to_deserialize_any, Deserializer,
+    };
+
+    use super::{RtcStatsRecord, RtcStatsValue};
+
+    pub struct RecordDeserializer<'a>(pub &'a RtcStatsRecord);
+
+    impl<'de> Deserializer<'de> for RecordDeserializer<'de> {
+        type Error = Error;
+
+        fn deserialize_any<V: Visitor<'de>>(self, visitor: V) -> Result<V::Value, Error> {
+            let record = self.0;
+            let header = [
+                ("type", ValueRef::Str(&record.stats_type)),
+                ("id", ValueRef::Str(&record.id)),
+                ("timestamp", ValueRef::Int(record.timestamp_us)),
+            ];
+            let members =
+                record.members.iter().map(|(name, value)| (name.as_str(), ValueRef::Value(value)));
+            visitor.visit_map(MapDeserializer::new(header.into_iter().chain(members)))
+        }
+
+        forward_to_deserialize_any! {
+            bool i8 i16 i32 i64 i128 u8 u16 u32 u64 u128 f32 f64 char str string
+            bytes byte_buf option unit unit_struct newtype_struct seq tuple
+            tuple_struct map struct enum identifier ignored_any
+        }
+    }
+
+    #[derive(Clone, Copy)]
+    enum ValueRef<'a> {
+        Str(&'a str),
+        Int(i64),
+        Value(&'a RtcStatsValue),
+    }
+
+    impl<'de> IntoDeserializer<'de, Error> for ValueRef<'de> {
+        type Deserializer = Self;
+
+        fn into_deserializer(self) -> Self {
+            self
+        }
+    }
+
+    impl<'de> Deserializer<'de> for ValueRef<'de> {
+        type Error = Error;
+
+        fn deserialize_any<V: Visitor<'de>>(self, visitor: V) -> Result<V::Value, Error> {
+            let value = match self {
+                ValueRef::Str(s) => return visitor.visit_borrowed_str(s),
+                ValueRef::Int(v) => return visitor.visit_i64(v),
+                ValueRef::Value(value) => value,
+            };
+
+            match value {
+                RtcStatsValue::Bool(v) => visitor.visit_bool(*v),
+                RtcStatsValue::Int(v) => visitor.visit_i64(*v),
+                RtcStatsValue::Uint(v) => visitor.visit_u64(*v),
+                RtcStatsValue::Double(v) => visitor.visit_f64(*v),
+                RtcStatsValue::String(v) => visitor.visit_borrowed_str(v),
+                RtcStatsValue::BoolSequence(v) => {
+                    visitor.visit_seq(SeqDeserializer::new(v.iter().copied()))
+                }
+                RtcStatsValue::IntSequence(v) => {
+                    visitor.visit_seq(SeqDeserializer::new(v.iter().copied()))
+                }
+                RtcStatsValue::UintSequence(v) => {
+                    visitor.visit_seq(SeqDeserializer::new(v.iter().copied()))
+                }
+                RtcStatsValue::DoubleSequence(v) => {
+                    visitor.visit_seq(SeqDeserializer::new(v.iter().copied()))
+                }
+                RtcStatsValue::StringSequence(v) => {
+                    visitor.visit_seq(SeqDeserializer::new(v.iter().map(String::as_str)))
+                }
+                RtcStatsValue::UintMap(v) => {
+                    visitor.visit_map(MapDeserializer::new(v.iter().map(|(k, v)| (k.as_str(), *v))))
+                }
+                RtcStatsValue::DoubleMap(v) => {
+                    visitor.visit_map(MapDeserializer::new(v.iter().map(|(k, v)| (k.as_str(), *v))))
+                }
+            }
+        }
+
+        fn deserialize_option<V: Visitor<'de>>(self, visitor: V) -> Result<V::Value, Error> {
+            // Attributes without a value are never part of a record.
+            visitor.visit_some(self)
+        }
+
+        fn deserialize_enum<V: Visitor<'de>>(
+            self,
+            name: &'static str,
+            variants: &'static [&'static str],
+            visitor: V,
+        ) -> Result<V::Value, Error> {
+            let s = match self {
+                ValueRef::Str(s) => s,
+                ValueRef::Value(RtcStatsValue::String(s)) => s.as_str(),
+                _ => return self.deserialize_any(visitor),
+            };
+            IntoDeserializer::<Error>::into_deserializer(s)
+                .deserialize_enum(name, variants, visitor)
+        }
+
+        forward_to_deserialize_any! {
+            bool i8 i16 i32 i64 i128 u8 u16 u32 u64 u128 f32 f64 char str string
+            bytes byte_buf unit unit_struct newtype_struct seq tuple
+            tuple_struct map struct identifier ignored_any
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn record_to_stats() {
+        let record = RtcStatsRecord {
+            id: "OT01V42".to_owned(),
+            stats_type: "outbound-rtp".to_owned(),
+            timestamp_us: 1234,
+            members: vec![
+                ("ssrc".to_owned(), RtcStatsValue::Uint(42)),
+                ("kind".to_owned(), RtcStatsValue::String("video".to_owned())),
+                ("bytesSent".to_owned(), RtcStatsValue::Uint(1000)),
+                ("framesPerSecond".to_owned(), RtcStatsValue::Double(30.0)),
+                (
+                    "qualityLimitationReason".to_owned(),
+                    RtcStatsValue::String("bandwidth".to_owned()),
+                ),
+                (
+                    "qualityLimitationDurations".to_owned(),
+                    RtcStatsValue::DoubleMap(vec![("cpu".to_owned(), 0.5)]),
+                ),
+                ("active".to_owned(), RtcStatsValue::Bool(true)),
+            ],
+        };
+
+        let RtcStats::OutboundRtp(stats) = RtcStats::from_record(&record).unwrap() else {
+            panic!("expected outbound-rtp stats");
+        };
+        assert_eq!(stats.rtc.id, "OT01V42");
+        assert_eq!(stats.rtc.timestamp, 1234);
+        assert_eq!(stats.stream.ssrc, 42);
+        assert_eq!(stats.stream.kind, "video");
+        assert_eq!(stats.sent.bytes_sent, 1000);
+        assert_eq!(stats.outbound.frames_per_second, 30.0);
+        assert_eq!(stats.outbound.quality_limitation_reason, QualityLimitationReason::Bandwidth);
+        assert_eq!(stats.outbound.quality_limitation_durations.get("cpu"), Some(&0.5));
+        assert!(stats.outbound.active);
+
+        let unknown = RtcStatsRecord { stats_type: "unknown".to_owned(), ..Default::default() };
+        assert!(RtcStats::from_record(&unknown).is_err());
+    }
+}
@@ -29,6 +29,27 @@ impl Default for VideoResolution {
     }
 }
 
+/// Codecs that can be published from already encoded frames.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EncodedVideoCodec {
+    /// Annex B byte stream, with SPS/PPS in front of every keyframe.
+    H264,
+    /// Without temporal layers.
+    Vp8,
+}
+
+/// A frame encoded by the application, sent as is without being decoded.
+#[derive(Debug, Clone)]
+pub struct EncodedVideoFrame<'a> {
+    pub codec: EncodedVideoCodec,
+    pub data: &'a [u8],
+    pub keyframe: bool,
+    pub width: u32,
+    pub height: u32,
+    /// Capture time, the RTP timestamp is derived from it. 0 means now.
+    pub timestamp_us: i64,
+}
+
 #[non_exhaustive]
 #[derive(Debug, Clone)]
 pub enum RtcVideoSource {
@@ -78,6 +99,19 @@ pub mod native {
             self.handle.capture_frame(frame)
         }
 
+        /// Publishes a frame encoded by the application, bypassing the encoder.
+        /// The codec must be the one negotiated for the track, and the track
+        /// published without simulcast. Returns false when the frame is rejected.
+        pub fn capture_encoded_frame(&self, frame: &EncodedVideoFrame) -> bool {
+            self.handle.capture_encoded_frame(frame)
+        }
+
+        /// Whether a receiver asked for a keyframe since the last call, the next
+        /// encoded frame should then be one.
+        pub fn take_keyframe_request(&self) -> bool {
+            self.handle.take_keyframe_request()
+        }
+
         pub fn video_resolution(&self) -> VideoResolution {
             self.handle.video_resolution()
         }
@@ -14,6 +14,43 @@
 
 use crate::imp::video_stream as stream_imp;
 
+#[derive(Default, Debug, Clone)]
+pub struct VideoStreamOptions {
+    /// Maximum number of frames waiting to be polled. When the consumer falls
+    /// behind, the oldest frames are dropped so that only the newest ones are
+    /// delivered. `None` keeps every frame (unbounded).
+    pub queue_size: Option<usize>,
+    /// Initial constraints on the delivered frames, see [`VideoSinkWants`].
+    pub sink_wants: VideoSinkWants,
+}
+
+/// Lets WebRTC adapt the frames before they reach the stream, e.g. a small
+/// thumbnail doesn't need full resolution frames. Only this stream is
+/// affected, the published video and other streams of the track keep their
+/// resolution and framerate. Zero means no constraint.
+#[derive(Default, Debug, Clone, Copy, PartialEq, Eq)]
+pub struct VideoSinkWants {
+    /// Frames larger than this many pixels are scaled down.
+    pub max_pixel_count: i32,
+    /// Preferred number of pixels per frame.
+    pub target_pixel_count: i32,
+    pub max_framerate_fps: i32,
+    /// Width and height of the delivered frames are multiples of this value.
+    pub resolution_alignment: i32,
+}
+
+#[derive(Default, Debug, Clone, Copy)]
+pub struct VideoStreamStats {
+    /// Frames currently waiting to be polled.
+    pub queue_depth: usize,
+    pub received_frames: u64,
+    /// Frames dropped because the queue was full or discarded by WebRTC.
+    pub dropped_frames: u64,
+    /// Time the last polled frame spent waiting in the queue, in ms.
+    pub last_frame_age_ms: f64,
+    pub max_frame_age_ms: f64,
+}
+
 // There is no shared sink between native and web platforms.
 // Each platform requires different configuration (e.g: WebGlContext, ..)
 
@@ -25,7 +62,7 @@ pub mod native {
         task::{Context, Poll},
     };
 
-    use super::stream_imp;
+    use super::{stream_imp, VideoSinkWants, VideoStreamOptions, VideoStreamStats};
     use crate::{video_frame::BoxVideoFrame, video_track::RtcVideoTrack};
     use livekit_runtime::Stream;
 
@@ -44,6 +81,18 @@ pub mod native {
             Self { handle: stream_imp::NativeVideoStream::new(video_track) }
         }
 
+        pub fn with_options(video_track: RtcVideoTrack, options: VideoStreamOptions) -> Self {
+            Self { handle: stream_imp::NativeVideoStream::with_options(video_track, options) }
+        }
+
+        pub fn stats(&self) -> VideoStreamStats {
+            self.handle.stats()
+        }
+
+        pub fn set_sink_wants(&self, wants: VideoSinkWants) {
+            self.handle.set_sink_wants(wants)
+        }
+
         pub fn track(&self) -> RtcVideoTrack {
             self.handle.track()
         }
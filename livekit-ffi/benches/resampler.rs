@@ -0,0 +1,127 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Stereo int16 resampling to 48kHz with the WebRTC AudioResampler versus the
+//! FFI SoxResampler (medium quality), for 10ms frames and for odd-sized
+//! buffers carried over between calls. The alternating case pushes one frame
+//! of every input rate per iteration: a single AudioResampler keeps a state
+//! per format, soxr needs one resampler per rate.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use livekit::webrtc::native::audio_resampler::AudioResampler;
+use livekit_ffi::{
+    proto,
+    server::resampler::{IOSpec, QualitySpec, RuntimeSpec, SoxResampler},
+};
+
+const INPUT_RATES: [u32; 3] = [16000, 24000, 44100];
+const OUTPUT_RATE: u32 = 48000;
+const NUM_CHANNELS: u32 = 2;
+// Samples per channel of the odd-sized buffers, not a multiple of 10ms at
+// any of the rates.
+const ODD_FRAMES: u32 = 333;
+
+fn create_input(sample_rate: u32, frames: u32) -> Vec<i16> {
+    (0..frames)
+        .flat_map(|i| {
+            let t = i as f64 / sample_rate as f64;
+            let sample = ((t * 440.0 * 2.0 * std::f64::consts::PI).sin() * 8000.0) as i16;
+            [sample; NUM_CHANNELS as usize]
+        })
+        .collect()
+}
+
+fn create_sox(input_rate: u32) -> SoxResampler {
+    SoxResampler::new(
+        input_rate as f64,
+        OUTPUT_RATE as f64,
+        NUM_CHANNELS,
+        IOSpec {
+            input_type: proto::SoxResamplerDataType::SoxrDatatypeInt16i,
+            output_type: proto::SoxResamplerDataType::SoxrDatatypeInt16i,
+        },
+        QualitySpec { quality: proto::SoxQualityRecipe::SoxrQualityMedium, flags: 0 },
+        RuntimeSpec { num_threads: 1 },
+    )
+    .expect("failed to create SoxResampler")
+}
+
+fn resample_bench(c: &mut Criterion) {
+    for input_rate in INPUT_RATES {
+        let mut group = c.benchmark_group(format!("resample/{}-{}", input_rate, OUTPUT_RATE));
+
+        for (name, frames) in [("10ms", input_rate / 100), ("odd", ODD_FRAMES)] {
+            let input = create_input(input_rate, frames);
+            group.throughput(Throughput::Elements(frames as u64));
+
+            let mut resampler = AudioResampler::default();
+            group.bench_function(BenchmarkId::new("webrtc", name), |b| {
+                b.iter(|| {
+                    resampler
+                        .remix_and_resample(
+                            &input,
+                            frames,
+                            NUM_CHANNELS,
+                            input_rate,
+                            NUM_CHANNELS,
+                            OUTPUT_RATE,
+                        )
+                        .len()
+                })
+            });
+
+            let mut sox = create_sox(input_rate);
+            group.bench_function(BenchmarkId::new("soxr", name), |b| {
+                b.iter(|| sox.push(&input).unwrap().len())
+            });
+        }
+
+        group.finish();
+    }
+
+    let mut group = c.benchmark_group("resample/alternating");
+    let inputs: Vec<(u32, Vec<i16>)> =
+        INPUT_RATES.iter().map(|&rate| (rate, create_input(rate, rate / 100))).collect();
+    group.throughput(Throughput::Elements(inputs.len() as u64));
+
+    let mut resampler = AudioResampler::default();
+    group.bench_function("webrtc", |b| {
+        b.iter(|| {
+            for (rate, input) in &inputs {
+                resampler.remix_and_resample(
+                    input,
+                    rate / 100,
+                    NUM_CHANNELS,
+                    *rate,
+                    NUM_CHANNELS,
+                    OUTPUT_RATE,
+                );
+            }
+        })
+    });
+
+    let mut sox: Vec<SoxResampler> = INPUT_RATES.iter().map(|&rate| create_sox(rate)).collect();
+    group.bench_function("soxr", |b| {
+        b.iter(|| {
+            for ((_, input), sox) in inputs.iter().zip(&mut sox) {
+                sox.push(input).unwrap();
+            }
+        })
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, resample_bench);
+criterion_main!(benches);
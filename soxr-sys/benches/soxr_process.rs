@@ -0,0 +1,97 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Throughput of soxr_process for 10ms mono int16 frames, the shape used by the
+//! FFI SoxResampler. Run with `SOXR_USE_SIMD=0` to compare against the scalar
+//! cores.
+
+use std::ffi::CStr;
+use std::ptr;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use soxr_sys::*;
+
+const QUALITIES: [(&str, u32); 5] = [
+    ("quick", SOXR_QQ),
+    ("low", SOXR_LQ),
+    ("medium", SOXR_MQ),
+    ("high", SOXR_20_BITQ),
+    ("very_high", SOXR_28_BITQ),
+];
+
+const RATES: [(f64, f64); 3] = [(48000.0, 16000.0), (44100.0, 48000.0), (24000.0, 48000.0)];
+
+fn soxr_process_bench(c: &mut Criterion) {
+    for (input_rate, output_rate) in RATES {
+        let mut group = c.benchmark_group(format!("soxr_process/{}-{}", input_rate, output_rate));
+
+        let input_len = (input_rate / 100.0) as usize;
+        let output_len = (output_rate / 100.0) as usize * 2;
+        let input: Vec<i16> = (0..input_len)
+            .map(|i| {
+                let t = i as f64 / input_rate;
+                ((t * 440.0 * 2.0 * std::f64::consts::PI).sin() * i16::MAX as f64 * 0.5) as i16
+            })
+            .collect();
+        let mut output = vec![0i16; output_len];
+
+        group.throughput(Throughput::Elements(input_len as u64));
+
+        for (name, quality) in QUALITIES {
+            unsafe {
+                let io_spec =
+                    soxr_io_spec(soxr_datatype_t_SOXR_INT16_I, soxr_datatype_t_SOXR_INT16_I);
+                let quality_spec = soxr_quality_spec(quality as _, 0);
+                let runtime_spec = soxr_runtime_spec(1);
+                let mut error: soxr_error_t = ptr::null();
+                let soxr = soxr_create(
+                    input_rate,
+                    output_rate,
+                    1,
+                    &mut error,
+                    &io_spec,
+                    &quality_spec,
+                    &runtime_spec,
+                );
+                assert!(error.is_null(), "soxr_create failed");
+
+                let engine = CStr::from_ptr(soxr_engine(soxr)).to_string_lossy().into_owned();
+                let id = BenchmarkId::new(name, engine);
+
+                group.bench_function(id, |b| {
+                    b.iter(|| {
+                        let mut odone = 0;
+                        soxr_process(
+                            soxr,
+                            input.as_ptr() as _,
+                            input_len,
+                            ptr::null_mut(),
+                            output.as_mut_ptr() as _,
+                            output_len,
+                            &mut odone,
+                        );
+                        odone
+                    })
+                });
+
+                soxr_delete(soxr);
+            }
+        }
+
+        group.finish();
+    }
+}
+
+criterion_group!(benches, soxr_process_bench);
+criterion_main!(benches);
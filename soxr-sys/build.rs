@@ -14,9 +14,7 @@
 
 use std::env;
 
-fn main() {
-    let mut build = cc::Build::new();
-
+fn configure(build: &mut cc::Build) {
     build.include("src");
     build.define("SOXR_LIB", "0");
 
@@ -32,9 +30,21 @@ fn main() {
         .flag_if_supported("-Wundef")
         .flag_if_supported("-Wpointer-arith")
         .flag_if_supported("-Wno-long-long");
+}
 
-    // TODO(theomonnom): Add SIMD support
-    let sources = [
+fn main() {
+    let target_arch = env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+    let target_os = env::var("CARGO_CFG_TARGET_OS").unwrap();
+
+    // SSE is part of the x86_64/i686 baselines and NEON of the aarch64 one, so the
+    // 32-bit SIMD core can always be built. soxr still checks the CPU at runtime
+    // before picking it (see should_use_simd32 in soxr.c).
+    let simd32 = matches!(target_arch.as_str(), "x86_64" | "x86" | "aarch64");
+    // The 64-bit SIMD core needs AVX, it is compiled separately with AVX enabled
+    // and only selected at runtime when the CPU supports it (should_use_simd64).
+    let simd64 = target_arch == "x86_64";
+
+    let mut sources = vec![
         "src/soxr.c",
         "src/data-io.c",
         "src/dbesi0.c",
@@ -47,13 +57,52 @@ fn main() {
         "src/vr32.c",
     ];
 
+    let mut defines = Vec::new();
+    if simd32 || simd64 {
+        defines.push(("WITH_PFFFT", "1"));
+    }
+
+    if simd32 {
+        defines.push(("WITH_CR32S", "1"));
+        sources.extend(["src/cr32s.c", "src/pffft32s.c", "src/util32s.c"]);
+    }
+
+    if simd64 {
+        // The scalar 64-bit core is the fallback for CPUs without AVX.
+        defines.push(("WITH_CR64", "1"));
+        defines.push(("WITH_CR64S", "1"));
+        sources.push("src/cr64.c");
+    }
+
+    let mut build = cc::Build::new();
+    configure(&mut build);
+    for (key, value) in &defines {
+        build.define(key, *value);
+    }
+
     for source in &sources {
         build.file(source);
     }
 
+    if simd64 {
+        let mut avx = cc::Build::new();
+        configure(&mut avx);
+        for (key, value) in &defines {
+            avx.define(key, *value);
+        }
+
+        if avx.get_compiler().is_like_msvc() {
+            avx.flag("/arch:AVX");
+        } else {
+            avx.flag("-mavx");
+        }
+
+        avx.files(["src/cr64s.c", "src/pffft64s.c", "src/util64s.c"]);
+        avx.compile("soxr-avx");
+    }
+
     build.compile("libsoxr.a");
 
-    let target_os = env::var("CARGO_CFG_TARGET_OS").unwrap();
     if target_os.as_str() != "windows" {
         println!("cargo:rustc-link-lib=m");
     }
@@ -7,7 +7,11 @@
 
 #define AVCODEC_FOUND 0
 #define AVUTIL_FOUND 0
+
+/* The SIMD switches below are set by build.rs depending on the target. */
+#if !defined WITH_PFFFT
 #define WITH_PFFFT 0
+#endif
 
 #define HAVE_FENV_H 1
 #define HAVE_STDBOOL_H 1
@@ -16,9 +20,15 @@
 #define HAVE_BIGENDIAN 0
 
 #define WITH_CR32 1
+#if !defined WITH_CR32S
 #define WITH_CR32S 0
+#endif
+#if !defined WITH_CR64
 #define WITH_CR64 0
+#endif
+#if !defined WITH_CR64S
 #define WITH_CR64S 0
+#endif
 #define WITH_VR32 1
 
 #define WITH_HI_PREC_CLOCK 0
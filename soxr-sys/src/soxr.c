@@ -245,7 +245,7 @@ soxr_io_spec_t soxr_io_spec(
 #if WITH_CR32S && WITH_CR32
   static bool cpu_has_simd32(void)
   {
-  #if defined __x86_64__ || defined _M_X64
+  #if defined __x86_64__ || defined _M_X64 || defined __aarch64__
     return true;
   #elif defined __i386__ || defined _M_IX86
     enum {SSE = 1 << 25, SSE2 = 1 << 26};
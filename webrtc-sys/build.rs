@@ -54,6 +54,9 @@ fn main() {
         "src/prohibit_libsrtp_initialization.rs",
         "src/apm.rs",
         "src/audio_mixer.rs",
+        "src/conference_mixer.rs",
+        "src/stats.rs",
+        "src/video_encoder_factory.rs",
     ];
 
     if is_desktop {
@@ -68,6 +71,8 @@ fn main() {
         "src/media_stream.cpp",
         "src/media_stream_track.cpp",
         "src/audio_track.cpp",
+        "src/audio_sink_fanout.cpp",
+        "src/audio_pacer.cpp",
         "src/video_track.cpp",
         "src/data_channel.cpp",
         "src/jsep.cpp",
@@ -81,14 +86,21 @@ fn main() {
         "src/video_frame.cpp",
         "src/video_frame_buffer.cpp",
         "src/video_encoder_factory.cpp",
+        "src/fallback_video_encoder.cpp",
+        "src/encoded_passthrough.cpp",
+        "src/simulcast_pyramid.cpp",
+        "src/parallel_simulcast_encoder.cpp",
         "src/video_decoder_factory.cpp",
         "src/audio_device.cpp",
         "src/audio_resampler.cpp",
+        "src/audio_format.cpp",
         "src/frame_cryptor.cpp",
         "src/global_task_queue.cpp",
         "src/prohibit_libsrtp_initialization.cpp",
         "src/apm.cpp",
         "src/audio_mixer.cpp",
+        "src/conference_mixer.cpp",
+        "src/stats.cpp",
     ]);
 
     if is_desktop {
@@ -153,6 +165,10 @@ fn main() {
                 //.file("vaapi-windows/DirectX-Headers-1.0/src/dxguids.cpp")
                 //.file("src/vaapi/vaapi_display_win32.cpp")
                 //.file("src/vaapi/vaapi_h264_encoder_wrapper.cpp")
+                //.file("src/vaapi/vaapi_surface_upload.cpp")
+                //.file("src/vaapi/encoded_image_buffer_pool.cpp")
+                //.file("src/vaapi/h264_bitstream_writer.cpp")
+                //.file("src/vaapi/h264_packed_headers.cpp")
                 //.file("src/vaapi/vaapi_encoder_factory.cpp")
                 //.file("src/vaapi/h264_encoder_impl.cpp")
                 .flag("/std:c++20")
@@ -193,6 +209,10 @@ fn main() {
                     .include(libva_include)
                     .file("src/vaapi/vaapi_display_drm.cpp")
                     .file("src/vaapi/vaapi_h264_encoder_wrapper.cpp")
+                    .file("src/vaapi/vaapi_surface_upload.cpp")
+                    .file("src/vaapi/encoded_image_buffer_pool.cpp")
+                    .file("src/vaapi/h264_bitstream_writer.cpp")
+                    .file("src/vaapi/h264_packed_headers.cpp")
                     .file("src/vaapi/vaapi_encoder_factory.cpp")
                     .file("src/vaapi/h264_encoder_impl.cpp")
                     .flag("-DUSE_VAAPI_VIDEO_CODEC=1");
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "api/scoped_refptr.h"
 #include "api/video_codecs/video_decoder_factory.h"
@@ -60,10 +61,81 @@ class AudioProcessingModule {
                              int sample_rate,
                              int num_channels);
 
+  // Processes every 10 ms block of the interleaved near-end audio |src| into
+  // |dst|, and of the far-end audio |reverse_src| played out meanwhile into
+  // |reverse_dst|, in a single call. The reverse block of each 10 ms goes
+  // first, as during a call. Either stream may be empty, otherwise both hold
+  // the same multiple of 10 ms, and the outputs are as long as their inputs
+  // (in place is fine). Returns the first error, later blocks are left as is.
+  int process_stream_batch(const int16_t* src,
+                           size_t src_len,
+                           int16_t* dst,
+                           const int16_t* reverse_src,
+                           size_t reverse_len,
+                           int16_t* reverse_dst,
+                           int sample_rate,
+                           int num_channels);
+
+  // Same with float samples in [-1, 1].
+  int process_stream_batch_f32(const float* src,
+                               size_t src_len,
+                               float* dst,
+                               const float* reverse_src,
+                               size_t reverse_len,
+                               float* reverse_dst,
+                               int sample_rate,
+                               int num_channels);
+
+  // Same with planar buffers, each channel holding |src_len| / |num_channels|
+  // samples. The channels are handed to AudioProcessing where they are, without
+  // copies.
+  int process_stream_batch_f32_planar(const float* src,
+                                      size_t src_len,
+                                      float* dst,
+                                      const float* reverse_src,
+                                      size_t reverse_len,
+                                      float* reverse_dst,
+                                      int sample_rate,
+                                      int num_channels);
+
   int set_stream_delay_ms(int delay_ms);
 
  private:
+  template <typename T>
+  int process_batch(const T* src,
+                    size_t src_len,
+                    T* dst,
+                    const T* reverse_src,
+                    size_t reverse_len,
+                    T* reverse_dst,
+                    int sample_rate,
+                    int num_channels);
+
+  // Checks the lengths given to the batch functions.
+  static bool valid_batch(const webrtc::StreamConfig& config,
+                          size_t src_len,
+                          size_t reverse_len);
+
+  int process_block(const int16_t* src,
+                    const webrtc::StreamConfig& config,
+                    int16_t* dst);
+  int process_block(const float* src,
+                    const webrtc::StreamConfig& config,
+                    float* dst);
+  int process_reverse_block(const int16_t* src,
+                            const webrtc::StreamConfig& config,
+                            int16_t* dst);
+  int process_reverse_block(const float* src,
+                            const webrtc::StreamConfig& config,
+                            float* dst);
+
+  // The float API of AudioProcessing takes one buffer per channel.
+  void deinterleave(const float* src, const webrtc::StreamConfig& config);
+  void interleave(const webrtc::StreamConfig& config, float* dst) const;
+
   webrtc::scoped_refptr<webrtc::AudioProcessing> apm_;
+  std::vector<float> deinterleaved_;
+  std::vector<float*> channels_;
 };
 
 std::unique_ptr<AudioProcessingModule> create_apm(
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace livekit_ffi {
+
+// Float audio exchanged with Rust holds samples in [-1, 1], interleaved or
+// planar. A planar buffer holds each channel contiguously, |planar_stride|
+// samples after the previous one; a stride of 0 means interleaved. WebRTC
+// carries interleaved int16, these convert once at that boundary.
+
+// Converts |frames| frames of |num_channels| float channels to interleaved
+// int16, rounding and saturating.
+void FloatToS16Interleaved(const float* src,
+                           size_t frames,
+                           size_t num_channels,
+                           size_t planar_stride,
+                           int16_t* dst);
+
+// Converts interleaved int16 to float, planar with a stride of |frames| when
+// |planar|.
+void S16ToFloat(const int16_t* src,
+                size_t frames,
+                size_t num_channels,
+                bool planar,
+                float* dst);
+
+// Copies float samples to interleaved |dst|.
+void InterleaveFloat(const float* src,
+                     size_t frames,
+                     size_t num_channels,
+                     size_t planar_stride,
+                     float* dst);
+
+// Copies interleaved float samples to planar |dst|, with a stride of |frames|.
+void DeinterleaveFloat(const float* src,
+                       size_t frames,
+                       size_t num_channels,
+                       float* dst);
+
+}  // namespace livekit_ffi
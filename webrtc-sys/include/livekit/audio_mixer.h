@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 
 #include "api/audio/audio_mixer.h"
 #include "api/scoped_refptr.h"
@@ -79,7 +80,8 @@ class AudioMixer {
  private:
   mutable webrtc::Mutex sources_mutex_;
   webrtc::AudioFrame frame_;
-  std::vector<std::shared_ptr<AudioMixerSource>> sources_;
+  // By SSRC.
+  std::unordered_map<int, std::shared_ptr<AudioMixerSource>> sources_;
   rtc::scoped_refptr<webrtc::AudioMixer> audio_mixer_;
 };
 
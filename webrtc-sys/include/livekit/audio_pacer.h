@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_utils/repeating_task.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit_ffi {
+
+// Drives every queued AudioTrackSource from a small fixed pool of task queues
+// on a common 10ms tick, instead of one task queue (and thread) per source.
+// A source is pinned to a single worker for its whole lifetime, so its
+// on_tick() is never called concurrently.
+class AudioPacer {
+ public:
+  class Source {
+   public:
+    virtual void on_tick() = 0;
+
+   protected:
+    virtual ~Source() = default;
+  };
+
+  struct Stats {
+    uint64_t ticks = 0;
+    int64_t last_jitter_us = 0;
+    int64_t max_jitter_us = 0;
+    int64_t total_jitter_us = 0;
+  };
+
+  static constexpr int64_t kTickIntervalMs = 10;
+
+  AudioPacer(webrtc::TaskQueueFactory* task_queue_factory, int num_workers);
+
+  void add_source(Source* source);
+
+  // Blocks until |source| isn't ticking anymore, after this returns it is
+  // safe to destroy it.
+  void remove_source(Source* source);
+
+  Stats stats() const;
+
+ private:
+  struct Worker {
+    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> queue;
+    webrtc::RepeatingTaskHandle task;
+    webrtc::Mutex mutex;
+    std::vector<Source*> sources RTC_GUARDED_BY(mutex);
+    int64_t next_tick_us = 0;  // only accessed on |queue|
+  };
+
+  webrtc::TimeDelta tick(Worker* worker);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_worker_{0};
+
+  mutable webrtc::Mutex stats_mutex_;
+  Stats stats_ RTC_GUARDED_BY(stats_mutex_);
+};
+
+}  // namespace livekit_ffi
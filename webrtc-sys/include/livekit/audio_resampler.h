@@ -16,7 +16,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 #include "api/audio/audio_frame.h"
 #include "api/data_channel_interface.h"
@@ -26,8 +30,19 @@
 
 namespace livekit_ffi {
 
+// Keeps one resampler per (source rate, source channels, destination rate,
+// destination channels), so callers alternating between formats don't
+// reinitialize it on every switch.
 class AudioResampler {
  public:
+  // Up to this many formats are cached, the least recently used one is
+  // dropped with whatever it carried over.
+  static constexpr size_t kMaxCachedFormats = 8;
+
+  // |src| can hold any number of samples. They are processed by 10 ms
+  // chunks, what is left of the last one is carried over to the next call
+  // with the same format, so the output can be shorter or longer than
+  // |src| (or empty). Returns the output size in bytes.
   size_t remix_and_resample(const int16_t* src,
                             size_t samples_per_channel,
                             size_t num_channels,
@@ -37,9 +52,61 @@ class AudioResampler {
 
   const int16_t* data() const;
 
+  // Float version, with samples in [-1, 1]. |src| and the output are planar
+  // when |planar|, interleaved otherwise. Remixing and resampling both run on
+  // floats, without going through int16. The 10 ms chunking and the carry
+  // over work as above, separately from the int16 ones.
+  size_t remix_and_resample_f32(const float* src,
+                                size_t samples_per_channel,
+                                size_t num_channels,
+                                int sample_rate_hz,
+                                bool planar,
+                                size_t dest_num_channels,
+                                int dest_sample_rate_hz);
+
+  const float* data_f32() const;
+
  private:
+  using Format = std::tuple<int, size_t, int, size_t>;
+
+  struct State {
+    webrtc::PushResampler<int16_t> resampler;
+    // Interleaved source samples short of 10 ms.
+    std::vector<int16_t> carry;
+    webrtc::PushResampler<float> resampler_f32;
+    // Interleaved samples short of 10 ms, already remixed.
+    std::vector<float> carry_f32;
+    uint64_t last_use = 0;
+  };
+
+  State& state(const Format& format);
+
+  // Resamples 10 ms of |src| into |frame_|.
+  void resample_chunk(State& state,
+                      const int16_t* src,
+                      size_t num_channels,
+                      int sample_rate);
+
+  // Resamples 10 ms of remixed |src| to the end of |resampled_|.
+  void resample_chunk_f32(State& state,
+                          const float* src,
+                          size_t num_channels,
+                          int sample_rate,
+                          int dest_sample_rate);
+
   webrtc::AudioFrame frame_;
-  webrtc::PushResampler<int16_t> resampler_;
+  std::map<Format, std::unique_ptr<State>> states_;
+  uint64_t uses_ = 0;
+  // Output spanning several chunks, |data_| points either to it or to
+  // |frame_|.
+  std::vector<int16_t> output_;
+  const int16_t* data_ = nullptr;
+
+  // Interleaved, at the source rate then at the destination rate.
+  std::vector<float> remixed_;
+  std::vector<float> resampled_;
+  std::vector<float> planar_;
+  const float* data_f32_ = nullptr;
 };
 
 std::unique_ptr<AudioResampler> create_audio_resampler();
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace livekit_ffi {
+
+// Fixed-capacity single-producer/single-consumer ring buffer.
+//
+// write() must only be called from one thread at a time (the producer) and
+// read()/discard() from one other thread at a time (the consumer). Neither
+// side takes a lock, the read/write positions are monotonically increasing
+// 64-bit counters so the occupancy is always |write - read|.
+template <typename T>
+class AudioRingBuffer {
+ public:
+  explicit AudioRingBuffer(size_t capacity) : buffer_(capacity) {}
+
+  size_t capacity() const { return buffer_.size(); }
+
+  size_t size() const {
+    uint64_t write = write_pos_.load(std::memory_order_acquire);
+    uint64_t read = read_pos_.load(std::memory_order_acquire);
+    return static_cast<size_t>(write - read);
+  }
+
+  // Producer side. Writes all of |data| or nothing.
+  bool write(const T* data, size_t len) {
+    uint64_t write = write_pos_.load(std::memory_order_relaxed);
+    uint64_t read = read_pos_.load(std::memory_order_acquire);
+    if (buffer_.size() - static_cast<size_t>(write - read) < len)
+      return false;
+
+    size_t offset = static_cast<size_t>(write % buffer_.size());
+    size_t first = std::min(len, buffer_.size() - offset);
+    std::memcpy(buffer_.data() + offset, data, first * sizeof(T));
+    std::memcpy(buffer_.data(), data + first, (len - first) * sizeof(T));
+
+    write_pos_.store(write + len, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Reads exactly |len| elements into |dst| or nothing.
+  bool read(T* dst, size_t len) {
+    uint64_t read = read_pos_.load(std::memory_order_relaxed);
+    uint64_t write = write_pos_.load(std::memory_order_acquire);
+    if (static_cast<size_t>(write - read) < len)
+      return false;
+
+    size_t offset = static_cast<size_t>(read % buffer_.size());
+    size_t first = std::min(len, buffer_.size() - offset);
+    std::memcpy(dst, buffer_.data() + offset, first * sizeof(T));
+    std::memcpy(dst + first, buffer_.data(), (len - first) * sizeof(T));
+
+    read_pos_.store(read + len, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Drops everything that was written before |until|.
+  void discard_until(uint64_t until) {
+    uint64_t read = read_pos_.load(std::memory_order_relaxed);
+    if (until > read)
+      read_pos_.store(until, std::memory_order_release);
+  }
+
+  uint64_t write_position() const {
+    return write_pos_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<T> buffer_;
+  alignas(64) std::atomic<uint64_t> write_pos_{0};
+  alignas(64) std::atomic<uint64_t> read_pos_{0};
+};
+
+}  // namespace livekit_ffi
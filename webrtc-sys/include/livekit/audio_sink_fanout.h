@@ -0,0 +1,77 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "api/media_stream_interface.h"
+#include "common_audio/resampler/include/push_resampler.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit_ffi {
+
+// Single sink of a track, fanning its audio out to any number of consumers.
+// Consumers asking for the same format are grouped, so the audio is remixed
+// and resampled once per format and callback rather than once per consumer.
+class AudioSinkFanout : public webrtc::AudioTrackSinkInterface {
+ public:
+  class Sink {
+   public:
+    virtual ~Sink() = default;
+
+    virtual int sample_rate() const = 0;
+    virtual int num_channels() const = 0;
+
+    // |data| is interleaved, at sample_rate() and num_channels().
+    virtual void deliver(const int16_t* data,
+                         int sample_rate,
+                         size_t number_of_channels,
+                         size_t number_of_frames) = 0;
+  };
+
+  // Nothing is delivered to |sink| once RemoveSink() returns.
+  void AddSink(Sink* sink);
+  void RemoveSink(Sink* sink);
+
+  void OnData(const void* audio_data,
+              int bits_per_sample,
+              int sample_rate,
+              size_t number_of_channels,
+              size_t number_of_frames) override;
+
+  // Number of RemixAndResample() calls so far.
+  int64_t resamples() const;
+
+ private:
+  struct Group {
+    int sample_rate;
+    int num_channels;
+    std::vector<Sink*> sinks;
+    webrtc::PushResampler<int16_t> resampler;
+    webrtc::AudioFrame frame;
+  };
+
+  mutable webrtc::Mutex mutex_;
+  std::vector<std::unique_ptr<Group>> groups_ RTC_GUARDED_BY(mutex_);
+  int64_t resamples_ RTC_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace livekit_ffi
@@ -16,20 +16,21 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "api/audio/audio_frame.h"
 #include "api/audio_options.h"
-#include "api/task_queue/task_queue_factory.h"
-#include "common_audio/resampler/include/push_resampler.h"
+#include "livekit/audio_pacer.h"
+#include "livekit/audio_ring_buffer.h"
+#include "livekit/audio_sink_fanout.h"
+#include "livekit/encoded_passthrough.h"
 #include "livekit/helper.h"
 #include "livekit/media_stream_track.h"
 #include "livekit/webrtc.h"
 #include "pc/local_audio_source.h"
 #include "rtc_base/synchronization/mutex.h"
-#include "api/task_queue/task_queue_base.h"
-#include "rtc_base/task_utils/repeating_task.h"
 #include "rtc_base/thread_annotations.h"
 #include "rust/cxx.h"
 
@@ -68,27 +69,41 @@ class AudioTrack : public MediaStreamTrack {
   // Keep a strong reference to the added sinks, so we don't need to
   // manage the lifetime safety on the Rust side
   mutable std::vector<std::shared_ptr<NativeAudioSink>> sinks_;
+
+  // Added to the track while there are sinks, resamples once per format
+  // for all of them.
+  mutable AudioSinkFanout fanout_;
 };
 
-class NativeAudioSink : public webrtc::AudioTrackSinkInterface {
+class NativeAudioSink : public AudioSinkFanout::Sink {
  public:
   explicit NativeAudioSink(rust::Box<AudioSinkWrapper> observer,
                            int sample_rate,
                            int num_channels);
-  void OnData(const void* audio_data,
-              int bits_per_sample,
-              int sample_rate,
-              size_t number_of_channels,
-              size_t number_of_frames) override;
+  // Sink delivering float samples to AudioSinkWrapper::on_data_f32,
+  // interleaved or planar.
+  NativeAudioSink(rust::Box<AudioSinkWrapper> observer,
+                  int sample_rate,
+                  int num_channels,
+                  bool planar);
+
+  int sample_rate() const override { return sample_rate_; }
+  int num_channels() const override { return num_channels_; }
+
+  void deliver(const int16_t* data,
+               int sample_rate,
+               size_t number_of_channels,
+               size_t number_of_frames) override;
 
  private:
   rust::Box<AudioSinkWrapper> observer_;
 
   int sample_rate_;
   int num_channels_;
+  const bool float_ = false;
+  const bool planar_ = false;
 
-  webrtc::AudioFrame frame_;
-  webrtc::PushResampler<int16_t> resampler_;
+  std::vector<float> float_buffer_;
 };
 
 std::shared_ptr<NativeAudioSink> new_native_audio_sink(
@@ -96,14 +111,22 @@ std::shared_ptr<NativeAudioSink> new_native_audio_sink(
     int sample_rate,
     int num_channels);
 
+std::shared_ptr<NativeAudioSink> new_native_audio_sink_f32(
+    rust::Box<AudioSinkWrapper> observer,
+    int sample_rate,
+    int num_channels,
+    bool planar);
+
 class AudioTrackSource {
-  class InternalSource : public webrtc::LocalAudioSource {
+  class InternalSource : public webrtc::LocalAudioSource,
+                         public AudioPacer::Source {
    public:
     InternalSource(const cricket::AudioOptions& options,
                    int sample_rate,
                    int num_channels,
                    int buffer_size_ms,
-                   webrtc::TaskQueueFactory* task_queue_factory);
+                   AudioPacer* pacer,
+                   bool encoded);
 
     ~InternalSource() override;
 
@@ -124,24 +147,63 @@ class AudioTrackSource {
                        const SourceContext* ctx,
                        void (*on_complete)(const SourceContext*));
 
+    // Converts to int16 then captures like capture_frame().
+    bool capture_frame_f32(rust::Slice<const float> audio_data,
+                           uint32_t sample_rate,
+                           uint32_t number_of_channels,
+                           size_t number_of_frames,
+                           size_t planar_stride,
+                           const SourceContext* ctx,
+                           void (*on_complete)(const SourceContext*));
+
+    // Queues an encoded packet and feeds the encoder the same duration of
+    // silence, see EncodedAudioTransformer.
+    bool capture_encoded_frame(rust::Slice<const uint8_t> data,
+                               size_t samples_per_channel);
+
     void clear_buffer();
 
+    AudioSourceBufferStats buffer_stats() const;
+
+    // AudioPacer::Source, called every 10ms when the queue is enabled.
+    void on_tick() override;
+
    private:
     mutable webrtc::Mutex mutex_;
-    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> audio_queue_;
-    webrtc::RepeatingTaskHandle audio_task_;
+    AudioPacer* pacer_ = nullptr;
 
     std::vector<webrtc::AudioTrackSinkInterface*> sinks_ RTC_GUARDED_BY(mutex_);
-    std::vector<int16_t> buffer_ RTC_GUARDED_BY(mutex_);
 
-    const SourceContext* capture_userdata_ RTC_GUARDED_BY(mutex_);
-    void (*on_complete_)(const SourceContext*) RTC_GUARDED_BY(mutex_);
+    // The queue is a SPSC ring buffer: capture_frame() is the producer and the
+    // pacer tick is the consumer, so they never contend on |mutex_|.
+    // |capture_mutex_| only serializes concurrent producers.
+    webrtc::Mutex capture_mutex_;
+    std::unique_ptr<AudioRingBuffer<int16_t>> buffer_;
+    std::atomic<uint64_t> clear_until_{0};
 
-    int missed_frames_ RTC_GUARDED_BY(mutex_) = 0;
+    // Written by the producer before publishing |on_complete_|, read by the
+    // consumer after observing it.
+    const SourceContext* capture_userdata_;
+    std::atomic<CompleteCallback> on_complete_;
+
+    std::atomic<uint64_t> underruns_{0};
+
+    // Conversion output of capture_frame_f32().
+    webrtc::Mutex convert_mutex_;
+    std::vector<int16_t> convert_buffer_ RTC_GUARDED_BY(convert_mutex_);
+
+    int missed_frames_ = 0;  // only accessed by on_tick()
+    bool playing_ = false;   // same
+    std::vector<int16_t> frame_buffer_;
     std::vector<int16_t> silence_buffer_;
 
+    // Set for encoded sources only.
+    webrtc::scoped_refptr<EncodedAudioTransformer> encoded_transformer_;
+    std::vector<int16_t> encoded_silence_;  // guarded by |capture_mutex_|
+
     int sample_rate_ = 0;
     int num_channels_ = 0;
+    int samples10ms_ = 0;
     int queue_size_samples_ = 0;
     int notify_threshold_samples_ = 0;
 
@@ -153,7 +215,8 @@ class AudioTrackSource {
                    int sample_rate,
                    int num_channels,
                    int queue_size_ms,
-                   webrtc::TaskQueueFactory* task_queue_factory);
+                   AudioPacer* pacer,
+                   bool encoded = false);
 
   AudioSourceOptions audio_options() const;
 
@@ -166,8 +229,28 @@ class AudioTrackSource {
                      const SourceContext* ctx,
                      CompleteCallback on_complete) const;
 
+  // |audio_data| holds float samples in [-1, 1], interleaved when
+  // |planar_stride| is 0, otherwise planar with channels |planar_stride|
+  // samples apart (see audio_format.h). They are converted to int16 here,
+  // once, before entering WebRTC.
+  bool capture_frame_f32(rust::Slice<const float> audio_data,
+                         uint32_t sample_rate,
+                         uint32_t number_of_channels,
+                         size_t number_of_frames,
+                         size_t planar_stride,
+                         const SourceContext* ctx,
+                         CompleteCallback on_complete) const;
+
+  // Only for sources created by new_encoded_audio_track_source(). |data| is
+  // one Opus packet lasting |samples_per_channel|, a multiple of 10ms
+  // matching the negotiated ptime (20ms by default).
+  bool capture_encoded_frame(rust::Slice<const uint8_t> data,
+                             size_t samples_per_channel) const;
+
   void clear_buffer() const;
 
+  AudioSourceBufferStats buffer_stats() const;
+
   webrtc::scoped_refptr<InternalSource> get() const;
 
  private:
@@ -180,6 +263,15 @@ std::shared_ptr<AudioTrackSource> new_audio_track_source(
     int num_channels,
     int queue_size_ms);
 
+// Source publishing Opus packets of the application, the track must be
+// negotiated with Opus at |sample_rate| and |num_channels|, without DTX.
+std::shared_ptr<AudioTrackSource> new_encoded_audio_track_source(
+    int sample_rate,
+    int num_channels,
+    int queue_size_ms);
+
+AudioPacerStats audio_pacer_stats();
+
 static std::shared_ptr<MediaStreamTrack> audio_to_media(
     std::shared_ptr<AudioTrack> track) {
   return track;
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit_ffi {
+
+// Mixer for many participants, e.g. to record a whole room. Unlike
+// AudioMixer, which pulls every source on each mix, participants push their
+// 10 ms frames along with their voice activity and, when the application
+// knows it, their level. Otherwise the level is computed from the samples.
+// Frames without voice, or quieter than kSilentLevel, are never copied, and
+// only the |max_speakers| loudest of the others are mixed. Accumulation runs
+// on floats with SSE2/NEON.
+//
+// Each participant has a short queue, so a participant pushing twice between
+// two mixes (jitter between the pushing threads and the mixing one) doesn't
+// lose a frame. Every mix() takes one frame from each queue.
+//
+// A mix-minus, the mix without a participant's own voice, can be produced
+// for every mixed participant in the same pass. The others hear the full
+// mix.
+class ConferenceMixer {
+ public:
+  // RFC 6464 level, in -dBov, of frames left out of the mix: quieter than
+  // one LSB of int16.
+  static constexpr int kSilentLevel = 90;
+  // |audio_level| of push_frame() to compute the level from the samples.
+  static constexpr int kUnknownLevel = -1;
+  // Frames queued per participant, the oldest is dropped past this.
+  static constexpr size_t kMaxQueuedFrames = 4;
+
+  ConferenceMixer(int sample_rate, size_t num_channels, size_t max_speakers);
+
+  void add_participant(uint32_t id);
+  void remove_participant(uint32_t id);
+
+  // Queues a frame of |id| for the next mix() calls, 10 ms of interleaved
+  // samples at the mixer format. |audio_level| is in -dBov like RFC 6464 (0
+  // is the loudest, 127 silence), or kUnknownLevel. Returns false for an
+  // unknown participant or a wrong length.
+  bool push_frame(uint32_t id,
+                  const int16_t* data,
+                  size_t len,
+                  bool voice_activity,
+                  int audio_level);
+
+  // Mixes the oldest queued frame of every participant and returns the
+  // number of samples, read with data(). Participants with an empty queue
+  // are left out.
+  size_t mix(bool mix_minus);
+
+  // data() and mix_minus() point into the mixer, they are only valid until
+  // the next mix() and, for mix_minus(), the removal of |id|. Read them on
+  // the mixing thread, push_frame() can still run on any other.
+  const int16_t* data() const;
+
+  // Mix of the last mix(true) without the audio of |id|, data() when |id|
+  // wasn't mixed. nullptr for an unknown participant or after mix(false).
+  const int16_t* mix_minus(uint32_t id) const;
+
+  // Copy of the participants mixed by the last mix(), loudest first.
+  std::unique_ptr<std::vector<uint32_t>> speakers() const;
+
+  size_t samples_per_frame() const { return samples_per_frame_; }
+
+ private:
+  struct QueuedFrame {
+    // Unset for frames not worth mixing, their samples aren't copied.
+    bool voiced = false;
+    int level = 127;
+  };
+
+  struct Participant {
+    uint32_t id;
+    // Ring of kMaxQueuedFrames frames, |samples| holds their audio.
+    std::array<QueuedFrame, kMaxQueuedFrames> queue;
+    std::vector<int16_t> samples;
+    size_t head = 0;
+    size_t queued = 0;
+    // Frame taken by the current mix(), nullptr when there is none.
+    const int16_t* frame = nullptr;
+    int level = 127;
+    std::vector<int16_t> mix_minus;
+  };
+
+  const size_t samples_per_frame_;
+  const size_t max_speakers_;
+
+  mutable webrtc::Mutex mutex_;
+  std::vector<Participant> participants_ RTC_GUARDED_BY(mutex_);
+  // Index in |participants_| by id.
+  std::unordered_map<uint32_t, size_t> index_ RTC_GUARDED_BY(mutex_);
+
+  std::vector<size_t> selected_ RTC_GUARDED_BY(mutex_);
+  std::vector<uint32_t> speakers_ RTC_GUARDED_BY(mutex_);
+  std::vector<float> mix_ RTC_GUARDED_BY(mutex_);
+  std::vector<int16_t> output_ RTC_GUARDED_BY(mutex_);
+  bool mix_minus_ RTC_GUARDED_BY(mutex_) = false;
+};
+
+std::unique_ptr<ConferenceMixer> create_conference_mixer(
+    int sample_rate,
+    size_t num_channels,
+    size_t max_speakers);
+
+}  // namespace livekit_ffi
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/frame_transformer_interface.h"
+#include "api/media_stream_interface.h"
+#include "api/rtp_sender_interface.h"
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_codec.h"
+#include "api/video_codecs/video_encoder.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit_ffi {
+
+// Already encoded video frame travelling through the video pipeline in place
+// of raw pixels, from VideoTrackSource to the PassthroughVideoEncoder.
+class EncodedVideoFrameBuffer : public webrtc::VideoFrameBuffer {
+ public:
+  EncodedVideoFrameBuffer(
+      webrtc::VideoCodecType codec,
+      webrtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+      bool keyframe,
+      int width,
+      int height,
+      uint64_t sequence,
+      std::shared_ptr<std::atomic<bool>> keyframe_request);
+  ~EncodedVideoFrameBuffer() override;
+
+  // Returns |buffer| as an EncodedVideoFrameBuffer, nullptr when it holds
+  // pixels.
+  static const EncodedVideoFrameBuffer* From(
+      const webrtc::VideoFrameBuffer* buffer);
+
+  Type type() const override { return Type::kNative; }
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+
+  // There are no pixels to convert, returns nullptr. NativeVideoSink doesn't
+  // deliver these buffers, only encoders see them.
+  webrtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override;
+
+  // An encoded frame can't be scaled, it is sent at its own resolution.
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override;
+
+  webrtc::VideoCodecType codec() const { return codec_; }
+  webrtc::scoped_refptr<webrtc::EncodedImageBuffer> data() const {
+    return data_;
+  }
+  bool keyframe() const { return keyframe_; }
+  // Consecutive frames of a source differ by one, a larger step means frames
+  // were dropped on the way to the encoder.
+  uint64_t sequence() const { return sequence_; }
+
+  // Asks the source for a keyframe, on PLI/FIR or a new receiver.
+  void RequestKeyframe() const;
+
+ private:
+  const webrtc::VideoCodecType codec_;
+  const webrtc::scoped_refptr<webrtc::EncodedImageBuffer> data_;
+  const bool keyframe_;
+  const int width_;
+  const int height_;
+  const uint64_t sequence_;
+  const std::shared_ptr<std::atomic<bool>> keyframe_request_;
+};
+
+// Outermost encoder of every video track. Frames carrying an
+// EncodedVideoFrameBuffer are sent as they are with their keyframe flag, the
+// RTP timestamp comes from the frame timestamp like for encoded pixels.
+// Anything else goes to |encoder|.
+//
+// A keyframe is requested from the source when the pipeline asks for one,
+// and when a delta frame doesn't follow the last frame sent: the frames in
+// between were dropped (by the source adaptation or the VideoStreamEncoder)
+// and the receiver can't decode past them.
+//
+// Only H264 (Annex B) and VP8 without temporal layers are passed through, to
+// a single stream: encoded tracks are meant to be published without
+// simulcast.
+class PassthroughVideoEncoder : public webrtc::VideoEncoder {
+ public:
+  explicit PassthroughVideoEncoder(
+      std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const webrtc::VideoEncoder::Settings& settings) override;
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+
+  int32_t Release() override;
+
+  int32_t Encode(const webrtc::VideoFrame& frame,
+                 const std::vector<webrtc::VideoFrameType>* frame_types) override;
+
+  void SetRates(const RateControlParameters& parameters) override;
+
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+
+  void OnRttUpdate(int64_t rtt_ms) override;
+
+  void OnLossNotification(const LossNotification& loss_notification) override;
+
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  int32_t Send(const webrtc::VideoFrame& frame,
+               const EncodedVideoFrameBuffer& encoded);
+
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+  webrtc::VideoCodecType codec_type_ = webrtc::kVideoCodecGeneric;
+  int num_streams_ = 1;
+  // Set once an encoded frame went through, the source is an encoded one.
+  bool passthrough_ = false;
+  bool reported_mismatch_ = false;
+  // Sequence of the last encoded frame sent since InitEncode.
+  bool sent_ = false;
+  uint64_t last_sequence_ = 0;
+};
+
+// Sender frame transformer of encoded audio tracks. The audio encoder runs on
+// silence to keep the RTP timing, every frame it produces gets its payload
+// replaced by the next packet queued by the application, or is dropped when
+// there is none.
+class EncodedAudioTransformer : public webrtc::FrameTransformerInterface {
+ public:
+  // 2s of 20ms packets.
+  static constexpr size_t kMaxQueuedPackets = 100;
+
+  // Drops the oldest packet when the queue is full.
+  void Push(const uint8_t* data, size_t size);
+
+  void Transform(
+      std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+
+  void RegisterTransformedFrameCallback(
+      webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback)
+      override;
+  void RegisterTransformedFrameSinkCallback(
+      webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+      uint32_t ssrc) override;
+  void UnregisterTransformedFrameCallback() override;
+  void UnregisterTransformedFrameSinkCallback(uint32_t ssrc) override;
+
+ private:
+  webrtc::Mutex mutex_;
+  std::deque<std::vector<uint8_t>> packets_ RTC_GUARDED_BY(mutex_);
+  webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback_
+      RTC_GUARDED_BY(mutex_);
+  std::map<uint32_t, webrtc::scoped_refptr<webrtc::TransformedFrameCallback>>
+      sink_callbacks_ RTC_GUARDED_BY(mutex_);
+};
+
+// Encoded audio sources register their transformer for the lifetime of the
+// source, it is installed on the senders of their tracks.
+void RegisterEncodedAudioSource(
+    const webrtc::AudioSourceInterface* source,
+    webrtc::scoped_refptr<EncodedAudioTransformer> transformer);
+void UnregisterEncodedAudioSource(const webrtc::AudioSourceInterface* source);
+
+// Installs the transformer of the encoded source of the sender's track, if
+// any. Encoded tracks can't be end-to-end encrypted.
+void AttachEncodedAudioSource(webrtc::RtpSenderInterface* sender);
+
+}  // namespace livekit_ffi
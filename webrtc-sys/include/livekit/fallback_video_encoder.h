@@ -0,0 +1,128 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "api/video_codecs/video_codec.h"
+#include "api/video_codecs/video_encoder.h"
+
+namespace livekit_ffi {
+
+// Goes through a list of encoder implementations in order, moving to the
+// next one when the current one fails to initialize.
+//
+// A hardware encoder is also replaced by the next software candidate while
+// the stream runs, when an encode fails or, if a limit is set, when it
+// keeps taking longer than allowed. The new encoder is initialized with the
+// same settings and rates and starts with a keyframe.
+class FallbackVideoEncoder : public webrtc::VideoEncoder {
+ public:
+  struct Candidate {
+    std::string name;
+    bool hardware;
+    // Returns nullptr when the implementation can't be created.
+    std::function<std::unique_ptr<webrtc::VideoEncoder>()> create;
+  };
+
+  struct Options {
+    bool on_init_failure = true;
+    bool on_encode_failure = true;
+    // Longest acceptable encode time, 0 to only fall back on encode errors.
+    int max_encode_time_ms = 0;
+  };
+
+  // Consecutive frames over |max_encode_time_ms| before falling back.
+  static constexpr int kSlowFramesBeforeFallback = 30;
+
+  // Returns nullptr when none of the candidates could be created.
+  static std::unique_ptr<FallbackVideoEncoder> Create(
+      std::vector<Candidate> candidates,
+      Options options);
+
+  // Number of runtime fallbacks of every encoder of the process.
+  static uint64_t total_fallbacks();
+
+  // Runtime fallbacks of this encoder.
+  int fallbacks() const { return fallbacks_; }
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const webrtc::VideoEncoder::Settings& settings) override;
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+
+  int32_t Release() override;
+
+  int32_t Encode(const webrtc::VideoFrame& frame,
+                 const std::vector<webrtc::VideoFrameType>* frame_types) override;
+
+  void SetRates(const RateControlParameters& parameters) override;
+
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+
+  void OnRttUpdate(int64_t rtt_ms) override;
+
+  void OnLossNotification(const LossNotification& loss_notification) override;
+
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  FallbackVideoEncoder(std::vector<Candidate> candidates, Options options);
+
+  // Replaces |encoder_| by the next candidate that can be created.
+  bool Advance();
+
+  // Initializes |encoder_| with the last settings, moving on to the next
+  // candidates while it fails if allowed.
+  int32_t InitCurrent();
+
+  // Switches from the current hardware encoder to the next software one.
+  bool FallBack();
+
+  bool CanFallBack() const;
+
+  std::vector<Candidate> candidates_;
+  const Options options_;
+  size_t current_candidate_ = 0;
+  size_t next_candidate_ = 0;
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+  webrtc::FecControllerOverride* fec_controller_override_ = nullptr;
+
+  // Replayed on the encoder taking over after a fallback.
+  std::optional<webrtc::VideoCodec> codec_settings_;
+  std::optional<webrtc::VideoEncoder::Settings> settings_;
+  std::optional<RateControlParameters> rates_;
+  std::optional<float> packet_loss_rate_;
+  std::optional<int64_t> rtt_ms_;
+
+  int slow_frames_ = 0;
+  bool force_keyframe_ = false;
+  int fallbacks_ = 0;
+};
+
+}  // namespace livekit_ffi
@@ -17,9 +17,17 @@
 #pragma once
 
 #include "api/task_queue/task_queue_factory.h"
+#include "livekit/audio_pacer.h"
+#include "livekit/parallel_simulcast_encoder.h"
 
 namespace livekit_ffi {
 
 webrtc::TaskQueueFactory* GetGlobalTaskQueueFactory();
 
+// Process-wide pacer shared by all the queued AudioTrackSources.
+AudioPacer* GetGlobalAudioPacer();
+
+// Process-wide workers running the simulcast layer encodes.
+SimulcastEncodePool* GetGlobalSimulcastEncodePool();
+
 } // namespace livekit_ffi
@@ -24,6 +24,7 @@
 #include "api/set_remote_description_observer_interface.h"
 #include "api/stats/rtc_stats_collector_callback.h"
 #include "livekit/rtc_error.h"
+#include "livekit/stats.h"
 #include "rtc_base/ref_count.h"
 #include "rust/cxx.h"
 
@@ -134,18 +135,23 @@ class NativeSetRemoteSdpObserver
 template <class T>  // Context type
 class NativeRtcStatsCollector : public webrtc::RTCStatsCollectorCallback {
  public:
-  NativeRtcStatsCollector(rust::Box<T> ctx,
-                          rust::Fn<void(rust::Box<T>, rust::String)> on_stats)
-      : ctx_(std::move(ctx)), on_stats_(on_stats) {}
+  // `delta` is null for full reports.
+  NativeRtcStatsCollector(
+      rust::Box<T> ctx,
+      std::shared_ptr<RtcStatsDelta> delta,
+      rust::Fn<void(rust::Box<T>, rust::Vec<RtcStatsRecord>)> on_stats)
+      : ctx_(std::move(ctx)), delta_(std::move(delta)), on_stats_(on_stats) {}
 
   void OnStatsDelivered(
       const webrtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override {
-    on_stats_(std::move(ctx_), report->ToJson());
+    on_stats_(std::move(ctx_),
+              delta_ ? delta_->Diff(*report) : to_rust_stats(*report));
   }
 
  private:
   rust::Box<T> ctx_;
-  rust::Fn<void(rust::Box<T>, rust::String)> on_stats_;
+  std::shared_ptr<RtcStatsDelta> delta_;
+  rust::Fn<void(rust::Box<T>, rust::Vec<RtcStatsRecord>)> on_stats_;
 };
 
 }  // namespace livekit_ffi
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "api/environment/environment.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_encoder.h"
+#include "api/video_codecs/video_encoder_factory.h"
+
+namespace livekit_ffi {
+
+// Bounded set of task queues running the layer encodes of simulcast tracks,
+// shared by every encoder of the process.
+class SimulcastEncodePool {
+ public:
+  SimulcastEncodePool(webrtc::TaskQueueFactory* task_queue_factory,
+                      int num_workers);
+
+  void Post(absl::AnyInvocable<void() &&> task);
+
+ private:
+  std::vector<std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>>
+      queues_;
+  std::atomic<size_t> next_queue_{0};
+};
+
+struct SimulcastEncodeTiming {
+  uint64_t count = 0;
+  int64_t last_us = 0;
+  int64_t max_us = 0;
+  int64_t total_us = 0;
+};
+
+// Wall-clock encode times of one simulcast encoder.
+struct SimulcastEncodeTimings {
+  // From the input frame to all of its layers being encoded.
+  SimulcastEncodeTiming frame;
+  // Indexed by simulcast stream, lowest resolution first. Timed around each
+  // stream's encode as the SimulcastEncoderAdapter dispatches it; left empty
+  // when a single encoder encodes every stream in one call.
+  std::vector<SimulcastEncodeTiming> layers;
+};
+
+// One entry per live ParallelSimulcastEncoder encoding more than one stream,
+// i.e. per published simulcast track, in creation order.
+std::vector<SimulcastEncodeTimings> GetSimulcastEncodeTimings();
+
+class SimulcastLayerGroup;
+
+// SimulcastEncoderAdapter encoding its layers concurrently on the
+// SimulcastEncodePool. Encode() returns once every layer of the frame is
+// encoded, the encoded images are then delivered in layer order from the
+// calling thread, as the adapter does when it encodes them one by one.
+//
+// With `parallel` false the layers are encoded in order on the calling
+// thread, only the encode times are recorded.
+class ParallelSimulcastEncoder : public webrtc::VideoEncoder {
+ public:
+  ParallelSimulcastEncoder(const webrtc::Environment& env,
+                           webrtc::VideoEncoderFactory* factory,
+                           const webrtc::SdpVideoFormat& format,
+                           bool parallel);
+  ~ParallelSimulcastEncoder() override;
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const webrtc::VideoEncoder::Settings& settings) override;
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+
+  int32_t Release() override;
+
+  int32_t Encode(const webrtc::VideoFrame& frame,
+                 const std::vector<webrtc::VideoFrameType>* frame_types) override;
+
+  void SetRates(const RateControlParameters& parameters) override;
+
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+
+  void OnRttUpdate(int64_t rtt_ms) override;
+
+  void OnLossNotification(const LossNotification& loss_notification) override;
+
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  class LayerFactory;
+
+  std::shared_ptr<SimulcastLayerGroup> group_;
+  std::unique_ptr<LayerFactory> layer_factory_;
+  // Destroyed before |layer_factory_|, it creates its encoders from it.
+  std::unique_ptr<webrtc::VideoEncoder> adapter_;
+};
+
+}  // namespace livekit_ffi
@@ -28,6 +28,7 @@
 #include "livekit/rtp_receiver.h"
 #include "livekit/rtp_sender.h"
 #include "livekit/rtp_transceiver.h"
+#include "livekit/stats.h"
 #include "livekit/webrtc.h"
 #include "rust/cxx.h"
 #include "webrtc-sys/src/data_channel.rs.h"
@@ -95,9 +96,13 @@ class PeerConnection : webrtc::PeerConnectionObserver {
 
   void remove_track(std::shared_ptr<RtpSender> sender) const;
 
+  // With `delta`, only the stats that changed since the previous delta
+  // report of this object are returned.
   void get_stats(
       rust::Box<PeerContext> ctx,
-      rust::Fn<void(rust::Box<PeerContext>, rust::String)> on_stats) const;
+      bool delta,
+      rust::Fn<void(rust::Box<PeerContext>, rust::Vec<RtcStatsRecord>)>
+          on_stats) const;
 
   void restart_ice() const;
 
@@ -199,6 +204,8 @@ class PeerConnection : webrtc::PeerConnectionObserver {
   webrtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pc_factory_;
   rust::Box<PeerConnectionObserverWrapper> observer_;
   webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
+  std::shared_ptr<RtcStatsDelta> stats_delta_ =
+      std::make_shared<RtcStatsDelta>();
 };
 
 static std::shared_ptr<PeerConnection> _shared_peer_connection() {
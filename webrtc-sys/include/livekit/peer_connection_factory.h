@@ -60,6 +60,9 @@ class PeerConnectionFactory {
 
   RtpCapabilities rtp_receiver_capabilities(MediaType type) const;
 
+  // The threading is process-wide, shared by the decoders of every factory.
+  void set_video_decoder_threading(VideoDecoderThreading threading) const;
+
   std::shared_ptr<RtcRuntime> rtc_runtime() const { return rtc_runtime_; }
 
  private:
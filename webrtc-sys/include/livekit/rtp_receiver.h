@@ -16,26 +16,86 @@
 
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 
+#include "api/frame_transformer_interface.h"
 #include "api/peer_connection_interface.h"
 #include "api/rtp_receiver_interface.h"
 #include "api/scoped_refptr.h"
 #include "livekit/helper.h"
 #include "livekit/media_stream.h"
 #include "livekit/rtp_parameters.h"
+#include "livekit/stats.h"
 #include "livekit/webrtc.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
 #include "rust/cxx.h"
 
 namespace livekit_ffi {
 class RtpReceiver;
+class EncodedFrameTap;
 }
 #include "webrtc-sys/src/rtp_receiver.rs.h"
 namespace livekit_ffi {
 
+// Depacketizer to decoder frame transformer handing the received encoded
+// frames to Rust. Without |decode|, video frames still go through the
+// receive pipeline, so it doesn't ask for keyframes, but with an empty
+// payload that the decoder of this receiver skips (see IsSkippedVideoFrame);
+// audio frames are dropped before NetEq. Decoding resumes once detached.
+class EncodedFrameTapTransformer : public webrtc::FrameTransformerInterface {
+ public:
+  EncodedFrameTapTransformer(rust::Box<EncodedFrameSinkWrapper> observer,
+                             bool video,
+                             bool decode);
+  ~EncodedFrameTapTransformer() override;
+
+  // Stops the callbacks and restores decoding, waits for a running callback.
+  void Detach();
+
+  void Transform(
+      std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+
+  void RegisterTransformedFrameCallback(
+      webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback)
+      override;
+  void RegisterTransformedFrameSinkCallback(
+      webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+      uint32_t ssrc) override;
+  void UnregisterTransformedFrameCallback() override;
+  void UnregisterTransformedFrameSinkCallback(uint32_t ssrc) override;
+
+ private:
+  const bool video_;
+  const bool decode_;
+
+  webrtc::Mutex mutex_;
+  std::optional<rust::Box<EncodedFrameSinkWrapper>> observer_
+      RTC_GUARDED_BY(mutex_);
+  webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback_
+      RTC_GUARDED_BY(mutex_);
+  std::map<uint32_t, webrtc::scoped_refptr<webrtc::TransformedFrameCallback>>
+      sink_callbacks_ RTC_GUARDED_BY(mutex_);
+};
+
+// Owned by Rust, the tap stops when it is dropped. The transformer itself
+// stays installed on the receiver and passes the frames through.
+class EncodedFrameTap {
+ public:
+  explicit EncodedFrameTap(
+      webrtc::scoped_refptr<EncodedFrameTapTransformer> transformer);
+  ~EncodedFrameTap();
+
+ private:
+  webrtc::scoped_refptr<EncodedFrameTapTransformer> transformer_;
+};
+
 // TODO(theomonnom): Implement RtpReceiverObserverInterface?
 // TODO(theomonnom): RtpSource
-// TODO(theomonnom): FrameTransformer & FrameDecryptor interface
+// TODO(theomonnom): FrameDecryptor interface
 class RtpReceiver {
  public:
   RtpReceiver(
@@ -45,9 +105,13 @@ class RtpReceiver {
 
   std::shared_ptr<MediaStreamTrack> track() const;
 
+  // With `delta`, only the stats that changed since the previous delta
+  // report of this object are returned.
   void get_stats(
       rust::Box<ReceiverContext> ctx,
-      rust::Fn<void(rust::Box<ReceiverContext>, rust::String)> on_stats) const;
+      bool delta,
+      rust::Fn<void(rust::Box<ReceiverContext>, rust::Vec<RtcStatsRecord>)>
+          on_stats) const;
 
   rust::Vec<rust::String> stream_ids() const;
   rust::Vec<MediaStreamPtr> streams() const;
@@ -62,6 +126,13 @@ class RtpReceiver {
   void set_jitter_buffer_minimum_delay(bool is_some,
                                        double delay_seconds) const;
 
+  // Delivers the encoded frames of this receiver to |observer|, before
+  // decoding. Takes the frame transformer slot of the receiver, so it can't
+  // be combined with a FrameCryptor.
+  std::shared_ptr<EncodedFrameTap> add_encoded_frame_tap(
+      rust::Box<EncodedFrameSinkWrapper> observer,
+      bool decode) const;
+
   webrtc::scoped_refptr<webrtc::RtpReceiverInterface> rtc_receiver() const {
     return receiver_;
   }
@@ -70,6 +141,8 @@ class RtpReceiver {
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   webrtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver_;
   webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
+  std::shared_ptr<RtcStatsDelta> stats_delta_ =
+      std::make_shared<RtcStatsDelta>();
 };
 
 static std::shared_ptr<RtpReceiver> _shared_rtp_receiver() {
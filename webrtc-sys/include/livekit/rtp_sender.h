@@ -24,6 +24,7 @@
 #include "livekit/media_stream.h"
 #include "livekit/rtc_error.h"
 #include "livekit/rtp_parameters.h"
+#include "livekit/stats.h"
 #include "rust/cxx.h"
 
 namespace livekit_ffi {
@@ -47,9 +48,13 @@ class RtpSender {
 
   uint32_t ssrc() const;
 
+  // With `delta`, only the stats that changed since the previous delta
+  // report of this object are returned.
   void get_stats(
       rust::Box<SenderContext> ctx,
-      rust::Fn<void(rust::Box<SenderContext>, rust::String)> on_stats) const;
+      bool delta,
+      rust::Fn<void(rust::Box<SenderContext>, rust::Vec<RtcStatsRecord>)>
+          on_stats) const;
 
   MediaType media_type() const;
 
@@ -73,6 +78,8 @@ class RtpSender {
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   webrtc::scoped_refptr<webrtc::RtpSenderInterface> sender_;
   webrtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
+  std::shared_ptr<RtcStatsDelta> stats_delta_ =
+      std::make_shared<RtcStatsDelta>();
 };
 
 static std::shared_ptr<RtpSender> _shared_rtp_sender() {
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/video/video_frame.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_encoder.h"
+#include "common_video/include/video_frame_buffer_pool.h"
+
+namespace livekit_ffi {
+
+// Builds every simulcast resolution of a frame in one pass, largest first,
+// each level being scaled from the previous one instead of from the full
+// resolution input.
+//
+// The returned buffer has the type and content of the source, but its
+// Scale()/CropAndScale() hand out the prebuilt levels when asked for one of
+// their sizes. This is what SimulcastEncoderAdapter calls for every layer
+// that doesn't match the input resolution.
+class FramePyramid {
+ public:
+  struct Size {
+    int width;
+    int height;
+  };
+
+  FramePyramid();
+  ~FramePyramid();
+
+  // Only I420 and NV12 sources are handled, other buffers are returned as is.
+  // Sizes that are not smaller than the source are ignored.
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> Build(
+      webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source,
+      std::vector<Size> sizes);
+
+ private:
+  // One pool per level, VideoFrameBufferPool drops its buffers whenever it is
+  // asked for another resolution.
+  std::vector<std::unique_ptr<webrtc::VideoFrameBufferPool>> pools_;
+};
+
+// Sits in front of SimulcastEncoderAdapter and hands it frames carrying the
+// downscaled layers from a FramePyramid.
+class SimulcastPyramidEncoder : public webrtc::VideoEncoder {
+ public:
+  explicit SimulcastPyramidEncoder(
+      std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const webrtc::VideoEncoder::Settings& settings) override;
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+
+  int32_t Release() override;
+
+  int32_t Encode(const webrtc::VideoFrame& frame,
+                 const std::vector<webrtc::VideoFrameType>* frame_types) override;
+
+  void SetRates(const RateControlParameters& parameters) override;
+
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+
+  void OnRttUpdate(int64_t rtt_ms) override;
+
+  void OnLossNotification(const LossNotification& loss_notification) override;
+
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  struct Layer {
+    int width;
+    int height;
+    bool active;
+  };
+
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  FramePyramid pyramid_;
+  std::vector<Layer> layers_;
+};
+
+}  // namespace livekit_ffi
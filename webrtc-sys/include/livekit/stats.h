@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "api/stats/rtc_stats_report.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rust/cxx.h"
+#include "webrtc-sys/src/stats.rs.h"
+
+namespace livekit_ffi {
+
+// Converts the whole report to flat records.
+rust::Vec<RtcStatsRecord> to_rust_stats(const webrtc::RTCStatsReport& report);
+
+// Remembers the attribute values of the previous report so the next one can
+// be reduced to what changed. One instance per stats consumer (PeerConnection,
+// RtpSender, RtpReceiver).
+class RtcStatsDelta {
+ public:
+  // Only the attributes that changed since the previous call are kept, records
+  // left without any member are dropped. The first call returns everything.
+  rust::Vec<RtcStatsRecord> Diff(const webrtc::RTCStatsReport& report);
+
+ private:
+  struct Value {
+    bool has_value = false;
+    uint64_t bits = 0;  // bool, integers and double
+    std::string text;   // strings, sequences and maps
+  };
+
+  struct Entry {
+    std::string type;
+    std::vector<Value> values;
+    bool seen = false;
+  };
+
+  webrtc::Mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace livekit_ffi
@@ -16,11 +16,33 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "api/video_codecs/video_decoder.h"
 #include "api/video_codecs/video_decoder_factory.h"
 #include "absl/strings/match.h"
 
 namespace livekit_ffi {
+
+// Receivers only consuming the encoded stream empty the payload of their
+// frames before the decoder (see EncodedFrameTapTransformer). The decoders
+// of this factory return such frames as decoded without producing a picture.
+// Unlike dropping them earlier, the receive stream doesn't see missing frames
+// and doesn't keep requesting keyframes.
+bool IsSkippedVideoFrame(const webrtc::EncodedImage& image);
+
+// Limits the threads each video decoder may use and the threads of all the
+// decoders of the process, 0 for no limit. Without limits a decoder gets as
+// many threads as the receive stream offers, the number of cores. Applies to
+// the decoders configured afterwards.
+void SetVideoDecoderThreads(int per_decoder, int max_total);
+
+// Threads held by the decoders currently configured.
+int VideoDecoderThreadsInUse();
+
 class VideoDecoderFactory : public webrtc::VideoDecoderFactory {
  public:
   VideoDecoderFactory();
@@ -33,7 +55,33 @@ class VideoDecoderFactory : public webrtc::VideoDecoderFactory {
   std::unique_ptr<webrtc::VideoDecoder> Create(
       const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) override;
 
+  // Names of the implementations able to decode |format|, in the order
+  // Create tries them: "videotoolbox", "mediacodec", "nvidia", "software".
+  std::vector<std::string> GetImplementations(
+      const webrtc::SdpVideoFormat& format) const;
+
+  // Decoder of the implementation called |name|, nullptr when it doesn't
+  // support |format|.
+  std::unique_ptr<webrtc::VideoDecoder> Create(
+      const webrtc::Environment& env,
+      const webrtc::SdpVideoFormat& format,
+      const std::string& name);
+
  private:
-  std::vector<std::unique_ptr<webrtc::VideoDecoderFactory>> factories_;
+  struct Implementation {
+    std::string name;
+    std::unique_ptr<webrtc::VideoDecoderFactory> factory;
+  };
+
+  static std::unique_ptr<webrtc::VideoDecoder> Wrap(
+      std::unique_ptr<webrtc::VideoDecoder> decoder);
+
+  static bool IsSoftwareCodec(const webrtc::SdpVideoFormat& format);
+
+  static std::unique_ptr<webrtc::VideoDecoder> CreateSoftware(
+      const webrtc::Environment& env,
+      const webrtc::SdpVideoFormat& format);
+
+  std::vector<Implementation> implementations_;
 };
 }  // namespace livekit_ffi
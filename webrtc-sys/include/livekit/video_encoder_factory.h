@@ -16,8 +16,13 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
+#include "rust/cxx.h"
+#include "webrtc-sys/src/video_encoder_factory.rs.h"
 
 namespace livekit_ffi {
 class VideoEncoderFactory : public webrtc::VideoEncoderFactory {
@@ -34,8 +39,28 @@ class VideoEncoderFactory : public webrtc::VideoEncoderFactory {
     std::unique_ptr<webrtc::VideoEncoder> Create(
         const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) override;
 
+    bool IsSupported(const webrtc::SdpVideoFormat& format) const;
+
    private:
-    std::vector<std::unique_ptr<webrtc::VideoEncoderFactory>> factories_;
+    struct Implementation {
+      std::string name;
+      bool hardware;
+      std::unique_ptr<webrtc::VideoEncoderFactory> factory;
+      // Queried once, the supported formats don't change at runtime.
+      std::vector<webrtc::SdpVideoFormat> formats;
+    };
+
+    void AddImplementation(std::string name,
+                           bool hardware,
+                           std::unique_ptr<webrtc::VideoEncoderFactory> factory);
+
+    // Format of |implementation| matching |format|, if any.
+    std::optional<webrtc::SdpVideoFormat> Match(
+        const Implementation& implementation,
+        const webrtc::SdpVideoFormat& format) const;
+
+    std::vector<Implementation> implementations_;
+    std::vector<webrtc::SdpVideoFormat> formats_;
   };
 
  public:
@@ -53,4 +78,17 @@ class VideoEncoderFactory : public webrtc::VideoEncoderFactory {
  private:
   std::unique_ptr<InternalFactory> internal_factory_;
 };
+
+// Encode the layers of simulcast tracks concurrently on a worker pool instead
+// of one after the other on the encoder thread.
+void set_parallel_simulcast_encode(bool enabled);
+
+// One entry per live simulcast encoder.
+rust::Vec<SimulcastEncodeStats> simulcast_encode_stats();
+
+// Only applies to the encoders created afterwards.
+void set_video_encoder_policy(VideoEncoderPolicy policy);
+
+// Hardware encoders replaced by a software one while encoding.
+uint64_t video_encoder_fallbacks();
 }  // namespace livekit_ffi
@@ -16,15 +16,18 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "api/media_stream_interface.h"
 #include "api/video/video_frame.h"
+#include "livekit/encoded_passthrough.h"
 #include "livekit/helper.h"
 #include "livekit/media_stream_track.h"
 #include "livekit/video_frame.h"
 #include "livekit/webrtc.h"
 #include "media/base/adapted_video_track_source.h"
+#include "media/base/video_adapter.h"
 #include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/timestamp_aligner.h"
 #include "rust/cxx.h"
@@ -49,6 +52,8 @@ class VideoTrack : public MediaStreamTrack {
 
   void add_sink(const std::shared_ptr<NativeVideoSink>& sink) const;
   void remove_sink(const std::shared_ptr<NativeVideoSink>& sink) const;
+  void set_sink_wants(const std::shared_ptr<NativeVideoSink>& sink,
+                      const VideoSinkWants& wants) const;
 
   void set_should_receive(bool should_receive) const;
   bool should_receive() const;
@@ -77,8 +82,17 @@ class NativeVideoSink : public webrtc::VideoSinkInterface<webrtc::VideoFrame> {
   void OnConstraintsChanged(
       const webrtc::VideoTrackSourceConstraints& constraints) override;
 
+  // The wants are applied to this sink only. Forwarding them to the track
+  // would downscale the published video of local tracks, and remote tracks
+  // ignore the resolution and framerate limits.
+  void set_wants(const VideoSinkWants& wants);
+
  private:
   rust::Box<VideoSinkWrapper> observer_;
+
+  mutable webrtc::Mutex mutex_;
+  webrtc::VideoAdapter adapter_ RTC_GUARDED_BY(mutex_);
+  bool adapt_ RTC_GUARDED_BY(mutex_) = false;
 };
 
 std::shared_ptr<NativeVideoSink> new_native_video_sink(
@@ -99,6 +113,10 @@ class VideoTrackSource {
     bool remote() const override;
     VideoResolution video_resolution() const;
     bool on_captured_frame(const webrtc::VideoFrame& frame);
+    // Encoded frames skip the adaptation, they can't be scaled or dropped.
+    bool on_captured_encoded_frame(
+        webrtc::scoped_refptr<EncodedVideoFrameBuffer> buffer,
+        int64_t timestamp_us);
 
    private:
     mutable webrtc::Mutex mutex_;
@@ -114,10 +132,20 @@ class VideoTrackSource {
   bool on_captured_frame(const std::unique_ptr<VideoFrame>& frame)
       const;  // frames pushed from Rust (+interior mutability)
 
+  // Publishes an already encoded frame, see PassthroughVideoEncoder.
+  bool on_captured_encoded_frame(const EncodedVideoFrameInfo& info,
+                                 rust::Slice<const uint8_t> data) const;
+
+  // Whether a receiver asked for a keyframe since the last call. Encoded
+  // sources must then send one as soon as possible.
+  bool take_keyframe_request() const;
+
   webrtc::scoped_refptr<InternalSource> get() const;
 
  private:
   webrtc::scoped_refptr<InternalSource> source_;
+  std::shared_ptr<std::atomic<bool>> keyframe_request_;
+  mutable std::atomic<uint64_t> encoded_sequence_{0};
 };
 
 std::shared_ptr<VideoTrackSource> new_video_track_source(
@@ -115,4 +115,7 @@ std::unique_ptr<LogSink> new_log_sink(
 
 rust::String create_random_uuid();
 
+// Monotonic clock used by WebRTC for the frame timestamps.
+int64_t time_micros();
+
 }  // namespace livekit_ffi
@@ -19,6 +19,7 @@
 #include "api/audio/builtin_audio_processing_builder.h"
 #include "api/environment/environment_factory.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
@@ -53,6 +54,185 @@ int AudioProcessingModule::process_reverse_stream(const int16_t* src,
   return apm_->ProcessReverseStream(src, stream_cfg, stream_cfg, dst);
 }
 
+int AudioProcessingModule::process_stream_batch(const int16_t* src,
+                                                size_t src_len,
+                                                int16_t* dst,
+                                                const int16_t* reverse_src,
+                                                size_t reverse_len,
+                                                int16_t* reverse_dst,
+                                                int sample_rate,
+                                                int num_channels) {
+  return process_batch(src, src_len, dst, reverse_src, reverse_len,
+                       reverse_dst, sample_rate, num_channels);
+}
+
+int AudioProcessingModule::process_stream_batch_f32(const float* src,
+                                                    size_t src_len,
+                                                    float* dst,
+                                                    const float* reverse_src,
+                                                    size_t reverse_len,
+                                                    float* reverse_dst,
+                                                    int sample_rate,
+                                                    int num_channels) {
+  return process_batch(src, src_len, dst, reverse_src, reverse_len,
+                       reverse_dst, sample_rate, num_channels);
+}
+
+int AudioProcessingModule::process_stream_batch_f32_planar(
+    const float* src,
+    size_t src_len,
+    float* dst,
+    const float* reverse_src,
+    size_t reverse_len,
+    float* reverse_dst,
+    int sample_rate,
+    int num_channels) {
+  webrtc::StreamConfig config(sample_rate, num_channels);
+  if (!valid_batch(config, src_len, reverse_len)) {
+    return webrtc::AudioProcessing::kBadDataLengthError;
+  }
+
+  // Channel |ch| of the block at |offset| starts at ch * frames + offset.
+  const size_t frames = std::max(src_len, reverse_len) / num_channels;
+  std::vector<const float*> input(num_channels);
+  std::vector<float*> output(num_channels);
+  auto channels = [&](const float* in, float* out, size_t offset) {
+    for (int ch = 0; ch < num_channels; ch++) {
+      input[ch] = in + ch * frames + offset;
+      output[ch] = out + ch * frames + offset;
+    }
+  };
+
+  for (size_t offset = 0; offset < frames; offset += config.num_frames()) {
+    if (reverse_len != 0) {
+      channels(reverse_src, reverse_dst, offset);
+      int error = apm_->ProcessReverseStream(input.data(), config, config,
+                                             output.data());
+      if (error != webrtc::AudioProcessing::kNoError) {
+        return error;
+      }
+    }
+    if (src_len != 0) {
+      channels(src, dst, offset);
+      int error =
+          apm_->ProcessStream(input.data(), config, config, output.data());
+      if (error != webrtc::AudioProcessing::kNoError) {
+        return error;
+      }
+    }
+  }
+  return webrtc::AudioProcessing::kNoError;
+}
+
+bool AudioProcessingModule::valid_batch(const webrtc::StreamConfig& config,
+                                        size_t src_len,
+                                        size_t reverse_len) {
+  const size_t block = config.num_samples();
+  return block != 0 && src_len % block == 0 && reverse_len % block == 0 &&
+         (src_len == 0 || reverse_len == 0 || src_len == reverse_len);
+}
+
+template <typename T>
+int AudioProcessingModule::process_batch(const T* src,
+                                         size_t src_len,
+                                         T* dst,
+                                         const T* reverse_src,
+                                         size_t reverse_len,
+                                         T* reverse_dst,
+                                         int sample_rate,
+                                         int num_channels) {
+  webrtc::StreamConfig config(sample_rate, num_channels);
+  if (!valid_batch(config, src_len, reverse_len)) {
+    return webrtc::AudioProcessing::kBadDataLengthError;
+  }
+
+  const size_t block = config.num_samples();
+  const size_t len = std::max(src_len, reverse_len);
+  for (size_t offset = 0; offset < len; offset += block) {
+    if (reverse_len != 0) {
+      int error = process_reverse_block(reverse_src + offset, config,
+                                        reverse_dst + offset);
+      if (error != webrtc::AudioProcessing::kNoError) {
+        return error;
+      }
+    }
+    if (src_len != 0) {
+      int error = process_block(src + offset, config, dst + offset);
+      if (error != webrtc::AudioProcessing::kNoError) {
+        return error;
+      }
+    }
+  }
+  return webrtc::AudioProcessing::kNoError;
+}
+
+int AudioProcessingModule::process_block(const int16_t* src,
+                                         const webrtc::StreamConfig& config,
+                                         int16_t* dst) {
+  return apm_->ProcessStream(src, config, config, dst);
+}
+
+int AudioProcessingModule::process_block(const float* src,
+                                         const webrtc::StreamConfig& config,
+                                         float* dst) {
+  deinterleave(src, config);
+  int error = apm_->ProcessStream(channels_.data(), config, config,
+                                  channels_.data());
+  interleave(config, dst);
+  return error;
+}
+
+int AudioProcessingModule::process_reverse_block(
+    const int16_t* src,
+    const webrtc::StreamConfig& config,
+    int16_t* dst) {
+  return apm_->ProcessReverseStream(src, config, config, dst);
+}
+
+int AudioProcessingModule::process_reverse_block(
+    const float* src,
+    const webrtc::StreamConfig& config,
+    float* dst) {
+  deinterleave(src, config);
+  int error = apm_->ProcessReverseStream(channels_.data(), config, config,
+                                         channels_.data());
+  interleave(config, dst);
+  return error;
+}
+
+void AudioProcessingModule::deinterleave(const float* src,
+                                         const webrtc::StreamConfig& config) {
+  const size_t frames = config.num_frames();
+  const size_t num_channels = config.num_channels();
+  if (deinterleaved_.size() != frames * num_channels ||
+      channels_.size() != num_channels) {
+    deinterleaved_.resize(frames * num_channels);
+    channels_.resize(num_channels);
+    for (size_t ch = 0; ch < num_channels; ch++) {
+      channels_[ch] = deinterleaved_.data() + ch * frames;
+    }
+  }
+
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    float* channel = channels_[ch];
+    for (size_t i = 0; i < frames; i++) {
+      channel[i] = src[i * num_channels + ch];
+    }
+  }
+}
+
+void AudioProcessingModule::interleave(const webrtc::StreamConfig& config,
+                                       float* dst) const {
+  const size_t frames = config.num_frames();
+  const size_t num_channels = config.num_channels();
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    const float* channel = channels_[ch];
+    for (size_t i = 0; i < frames; i++) {
+      dst[i * num_channels + ch] = channel[i];
+    }
+  }
+}
+
 int AudioProcessingModule::set_stream_delay_ms(int delay_ms) {
   return apm_->set_stream_delay_ms(delay_ms);
 }
@@ -41,6 +41,42 @@ pub mod ffi {
             num_channels: i32,
         ) -> i32;
 
+        unsafe fn process_stream_batch(
+            self: Pin<&mut AudioProcessingModule>,
+            src: *const i16,
+            src_len: usize,
+            dst: *mut i16,
+            reverse_src: *const i16,
+            reverse_len: usize,
+            reverse_dst: *mut i16,
+            sample_rate: i32,
+            num_channels: i32,
+        ) -> i32;
+
+        unsafe fn process_stream_batch_f32(
+            self: Pin<&mut AudioProcessingModule>,
+            src: *const f32,
+            src_len: usize,
+            dst: *mut f32,
+            reverse_src: *const f32,
+            reverse_len: usize,
+            reverse_dst: *mut f32,
+            sample_rate: i32,
+            num_channels: i32,
+        ) -> i32;
+
+        unsafe fn process_stream_batch_f32_planar(
+            self: Pin<&mut AudioProcessingModule>,
+            src: *const f32,
+            src_len: usize,
+            dst: *mut f32,
+            reverse_src: *const f32,
+            reverse_len: usize,
+            reverse_dst: *mut f32,
+            sample_rate: i32,
+            num_channels: i32,
+        ) -> i32;
+
         fn set_stream_delay_ms(self: Pin<&mut AudioProcessingModule>, delay: i32) -> i32;
 
         fn create_apm(
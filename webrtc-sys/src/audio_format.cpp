@@ -0,0 +1,90 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/audio_format.h"
+
+#include <algorithm>
+
+#include "common_audio/include/audio_util.h"
+
+namespace livekit_ffi {
+
+// The interleaved cases are single loops over contiguous memory, left to the
+// compiler to vectorize. Planar ones walk one channel at a time.
+
+void FloatToS16Interleaved(const float* src,
+                           size_t frames,
+                           size_t num_channels,
+                           size_t planar_stride,
+                           int16_t* dst) {
+  if (planar_stride == 0 || num_channels == 1) {
+    webrtc::FloatToS16(src, frames * num_channels, dst);
+    return;
+  }
+
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    const float* channel = src + ch * planar_stride;
+    for (size_t i = 0; i < frames; i++)
+      dst[i * num_channels + ch] = webrtc::FloatToS16(channel[i]);
+  }
+}
+
+void S16ToFloat(const int16_t* src,
+                size_t frames,
+                size_t num_channels,
+                bool planar,
+                float* dst) {
+  if (!planar || num_channels == 1) {
+    webrtc::S16ToFloat(src, frames * num_channels, dst);
+    return;
+  }
+
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    float* channel = dst + ch * frames;
+    for (size_t i = 0; i < frames; i++)
+      channel[i] = webrtc::S16ToFloat(src[i * num_channels + ch]);
+  }
+}
+
+void InterleaveFloat(const float* src,
+                     size_t frames,
+                     size_t num_channels,
+                     size_t planar_stride,
+                     float* dst) {
+  if (planar_stride == 0 || num_channels == 1) {
+    std::copy(src, src + frames * num_channels, dst);
+    return;
+  }
+
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    const float* channel = src + ch * planar_stride;
+    for (size_t i = 0; i < frames; i++)
+      dst[i * num_channels + ch] = channel[i];
+  }
+}
+
+void DeinterleaveFloat(const float* src,
+                       size_t frames,
+                       size_t num_channels,
+                       float* dst) {
+  for (size_t ch = 0; ch < num_channels; ch++) {
+    float* channel = dst + ch * frames;
+    for (size_t i = 0; i < frames; i++)
+      channel[i] = src[i * num_channels + ch];
+  }
+}
+
+}  // namespace livekit_ffi
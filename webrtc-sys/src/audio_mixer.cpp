@@ -34,18 +34,19 @@ void AudioMixer::add_source(rust::Box<AudioMixerSourceWrapper> source) {
   auto native_source = std::make_shared<AudioMixerSource>(std::move(source));
 
   webrtc::MutexLock lock(&sources_mutex_);
+  std::shared_ptr<AudioMixerSource>& slot = sources_[native_source->Ssrc()];
+  if (slot) {
+    audio_mixer_->RemoveSource(slot.get());
+  }
   audio_mixer_->AddSource(native_source.get());
-  sources_.push_back(native_source);
+  slot = std::move(native_source);
 }
 
 void AudioMixer::remove_source(int source_ssrc) {
   webrtc::MutexLock lock(&sources_mutex_);
-  auto it = std::find_if(
-      sources_.begin(), sources_.end(),
-      [source_ssrc](const auto& s) { return s->Ssrc() == source_ssrc; });
-
+  auto it = sources_.find(source_ssrc);
   if (it != sources_.end()) {
-    audio_mixer_->RemoveSource(it->get());
+    audio_mixer_->RemoveSource(it->second.get());
     sources_.erase(it);
   }
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/audio_pacer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/time_utils.h"
+
+namespace livekit_ffi {
+
+AudioPacer::AudioPacer(webrtc::TaskQueueFactory* task_queue_factory,
+                       int num_workers) {
+  RTC_CHECK_GT(num_workers, 0);
+
+  for (int i = 0; i < num_workers; ++i) {
+    auto worker = std::make_unique<Worker>();
+    worker->queue = task_queue_factory->CreateTaskQueue(
+        "AudioPacer" + std::to_string(i),
+        webrtc::TaskQueueFactory::Priority::HIGH);
+
+    Worker* w = worker.get();
+    w->next_tick_us = webrtc::TimeMicros();
+    w->task = webrtc::RepeatingTaskHandle::Start(
+        w->queue.get(), [this, w]() { return tick(w); },
+        webrtc::TaskQueueBase::DelayPrecision::kHigh);
+
+    workers_.push_back(std::move(worker));
+  }
+}
+
+void AudioPacer::add_source(Source* source) {
+  size_t index =
+      next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  Worker* w = workers_[index].get();
+
+  webrtc::MutexLock lock(&w->mutex);
+  w->sources.push_back(source);
+}
+
+void AudioPacer::remove_source(Source* source) {
+  // The worker holds its mutex for the whole tick, so once we own it
+  // |source| can't be running anymore.
+  for (auto& worker : workers_) {
+    webrtc::MutexLock lock(&worker->mutex);
+    auto it =
+        std::find(worker->sources.begin(), worker->sources.end(), source);
+    if (it != worker->sources.end()) {
+      worker->sources.erase(it);
+      return;
+    }
+  }
+}
+
+AudioPacer::Stats AudioPacer::stats() const {
+  webrtc::MutexLock lock(&stats_mutex_);
+  return stats_;
+}
+
+webrtc::TimeDelta AudioPacer::tick(Worker* worker) {
+  constexpr int64_t kTickIntervalUs = kTickIntervalMs * 1000;
+
+  int64_t now_us = webrtc::TimeMicros();
+  int64_t jitter_us = now_us - worker->next_tick_us;
+
+  {
+    webrtc::MutexLock lock(&worker->mutex);
+    for (Source* source : worker->sources)
+      source->on_tick();
+  }
+
+  {
+    webrtc::MutexLock lock(&stats_mutex_);
+    stats_.ticks++;
+    stats_.last_jitter_us = jitter_us;
+    stats_.max_jitter_us = std::max(stats_.max_jitter_us, jitter_us);
+    stats_.total_jitter_us += std::abs(jitter_us);
+  }
+
+  // Schedule against an absolute clock so that the delays don't accumulate,
+  // if we fell behind by more than a tick, start over from now.
+  worker->next_tick_us += kTickIntervalUs;
+  now_us = webrtc::TimeMicros();
+  if (worker->next_tick_us < now_us - kTickIntervalUs)
+    worker->next_tick_us = now_us;
+
+  return webrtc::TimeDelta::Micros(
+      std::max<int64_t>(0, worker->next_tick_us - now_us));
+}
+
+}  // namespace livekit_ffi
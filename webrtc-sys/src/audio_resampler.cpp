@@ -16,11 +16,13 @@
 
 #include "livekit/audio_resampler.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "audio/remix_resample.h"
 #include "api/audio/audio_view.h"
 #include "api/audio/audio_frame.h"
+#include "livekit/audio_format.h"
 
 namespace livekit_ffi {
 
@@ -30,19 +32,169 @@ size_t AudioResampler::remix_and_resample(const int16_t* src,
                                           int sample_rate,
                                           size_t dest_num_channels,
                                           int dest_sample_rate) {
+  State& format_state = state(
+      Format(sample_rate, num_channels, dest_sample_rate, dest_num_channels));
   frame_.num_channels_ = dest_num_channels;
   frame_.sample_rate_hz_ = dest_sample_rate;
-  frame_.samples_per_channel_ = webrtc::SampleRateToDefaultChannelSize(dest_sample_rate);
-  webrtc::InterleavedView<const int16_t> source(static_cast<const int16_t*>(src),
-                                         samples_per_channel,
-                                         num_channels);
-  webrtc::voe::RemixAndResample(source, sample_rate, &resampler_, &frame_);
+  frame_.samples_per_channel_ =
+      webrtc::SampleRateToDefaultChannelSize(dest_sample_rate);
 
-  return frame_.num_channels() * frame_.samples_per_channel() * sizeof(int16_t);
+  const size_t chunk =
+      webrtc::SampleRateToDefaultChannelSize(sample_rate) * num_channels;
+  const size_t len = samples_per_channel * num_channels;
+  const size_t dest_chunk = frame_.samples_per_channel() * dest_num_channels;
+
+  // 10 ms and nothing carried over, the output stays in |frame_|.
+  if (len == chunk && format_state.carry.empty()) {
+    resample_chunk(format_state, src, num_channels, sample_rate);
+    data_ = frame_.data();
+    return dest_chunk * sizeof(int16_t);
+  }
+
+  output_.clear();
+  size_t offset = 0;
+  if (!format_state.carry.empty()) {
+    offset = std::min(chunk - format_state.carry.size(), len);
+    format_state.carry.insert(format_state.carry.end(), src, src + offset);
+    if (format_state.carry.size() == chunk) {
+      resample_chunk(format_state, format_state.carry.data(), num_channels,
+                     sample_rate);
+      output_.insert(output_.end(), frame_.data(),
+                     frame_.data() + dest_chunk);
+      format_state.carry.clear();
+    }
+  }
+  for (; offset + chunk <= len; offset += chunk) {
+    resample_chunk(format_state, src + offset, num_channels, sample_rate);
+    output_.insert(output_.end(), frame_.data(), frame_.data() + dest_chunk);
+  }
+  format_state.carry.insert(format_state.carry.end(), src + offset, src + len);
+
+  data_ = output_.data();
+  return output_.size() * sizeof(int16_t);
 }
 
 const int16_t* AudioResampler::data() const {
-  return frame_.data();
+  return data_;
+}
+
+AudioResampler::State& AudioResampler::state(const Format& format) {
+  std::unique_ptr<State>& format_state = states_[format];
+  if (!format_state) {
+    if (states_.size() > kMaxCachedFormats) {
+      auto oldest = states_.end();
+      for (auto it = states_.begin(); it != states_.end(); ++it) {
+        if (it->second && (oldest == states_.end() ||
+                           it->second->last_use < oldest->second->last_use))
+          oldest = it;
+      }
+      states_.erase(oldest);
+    }
+    format_state = std::make_unique<State>();
+  }
+  format_state->last_use = ++uses_;
+  return *format_state;
+}
+
+void AudioResampler::resample_chunk(State& state,
+                                    const int16_t* src,
+                                    size_t num_channels,
+                                    int sample_rate) {
+  webrtc::InterleavedView<const int16_t> source(
+      src, webrtc::SampleRateToDefaultChannelSize(sample_rate), num_channels);
+  webrtc::voe::RemixAndResample(source, sample_rate, &state.resampler,
+                                &frame_);
+}
+
+size_t AudioResampler::remix_and_resample_f32(const float* src,
+                                              size_t samples_per_channel,
+                                              size_t num_channels,
+                                              int sample_rate,
+                                              bool planar,
+                                              size_t dest_num_channels,
+                                              int dest_sample_rate) {
+  // Remix to interleaved |remixed_|, like RemixAndResample(): downmixing
+  // averages the channels, upmixing repeats the last one.
+  remixed_.resize(samples_per_channel * dest_num_channels);
+  if (num_channels == dest_num_channels) {
+    InterleaveFloat(src, samples_per_channel, num_channels,
+                    planar ? samples_per_channel : 0, remixed_.data());
+  } else {
+    auto sample = [&](size_t i, size_t ch) {
+      return planar ? src[ch * samples_per_channel + i]
+                    : src[i * num_channels + ch];
+    };
+    for (size_t i = 0; i < samples_per_channel; i++) {
+      if (dest_num_channels == 1) {
+        float sum = 0;
+        for (size_t ch = 0; ch < num_channels; ch++)
+          sum += sample(i, ch);
+        remixed_[i] = sum / num_channels;
+      } else {
+        for (size_t ch = 0; ch < dest_num_channels; ch++)
+          remixed_[i * dest_num_channels + ch] =
+              sample(i, std::min(ch, num_channels - 1));
+      }
+    }
+  }
+
+  State& format_state = state(
+      Format(sample_rate, num_channels, dest_sample_rate, dest_num_channels));
+  const size_t chunk =
+      webrtc::SampleRateToDefaultChannelSize(sample_rate) * dest_num_channels;
+  const size_t len = remixed_.size();
+
+  resampled_.clear();
+  size_t offset = 0;
+  if (!format_state.carry_f32.empty()) {
+    std::vector<float>& carry = format_state.carry_f32;
+    offset = std::min(chunk - carry.size(), len);
+    carry.insert(carry.end(), remixed_.data(), remixed_.data() + offset);
+    if (carry.size() == chunk) {
+      resample_chunk_f32(format_state, carry.data(), dest_num_channels,
+                         sample_rate, dest_sample_rate);
+      carry.clear();
+    }
+  }
+  for (; offset + chunk <= len; offset += chunk) {
+    resample_chunk_f32(format_state, remixed_.data() + offset,
+                       dest_num_channels, sample_rate, dest_sample_rate);
+  }
+  format_state.carry_f32.insert(format_state.carry_f32.end(),
+                                remixed_.data() + offset,
+                                remixed_.data() + len);
+
+  data_f32_ = resampled_.data();
+  if (planar) {
+    planar_.resize(resampled_.size());
+    DeinterleaveFloat(resampled_.data(),
+                      resampled_.size() / dest_num_channels,
+                      dest_num_channels, planar_.data());
+    data_f32_ = planar_.data();
+  }
+  return resampled_.size() * sizeof(float);
+}
+
+void AudioResampler::resample_chunk_f32(State& state,
+                                        const float* src,
+                                        size_t num_channels,
+                                        int sample_rate,
+                                        int dest_sample_rate) {
+  const size_t dest_samples_per_channel =
+      webrtc::SampleRateToDefaultChannelSize(dest_sample_rate);
+  const size_t offset = resampled_.size();
+  resampled_.resize(offset + dest_samples_per_channel * num_channels);
+  state.resampler_f32.Resample(
+      webrtc::InterleavedView<const float>(
+          src, webrtc::SampleRateToDefaultChannelSize(sample_rate),
+          num_channels),
+      webrtc::InterleavedView<float>(resampled_.data() + offset,
+                                     dest_samples_per_channel,
+                                     num_channels));
+}
+
+const float* AudioResampler::data_f32() const {
+  return data_f32_;
 }
 
 std::unique_ptr<AudioResampler> create_audio_resampler() {
@@ -33,6 +33,19 @@ pub mod ffi {
 
         unsafe fn data(self: &AudioResampler) -> *const i16;
 
+        unsafe fn remix_and_resample_f32(
+            self: Pin<&mut AudioResampler>,
+            src: *const f32,
+            samples_per_channel: usize,
+            num_channels: usize,
+            sample_rate: i32,
+            planar: bool,
+            dst_num_channels: usize,
+            dst_sample_rate: i32,
+        ) -> usize;
+
+        unsafe fn data_f32(self: &AudioResampler) -> *const f32;
+
         fn create_audio_resampler() -> UniquePtr<AudioResampler>;
     }
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/audio_sink_fanout.h"
+
+#include <algorithm>
+
+#include "api/audio/audio_view.h"
+#include "audio/remix_resample.h"
+#include "rtc_base/checks.h"
+
+namespace livekit_ffi {
+
+void AudioSinkFanout::AddSink(Sink* sink) {
+  webrtc::MutexLock lock(&mutex_);
+  auto group = std::find_if(
+      groups_.begin(), groups_.end(), [sink](const auto& group) {
+        return group->sample_rate == sink->sample_rate() &&
+               group->num_channels == sink->num_channels();
+      });
+  if (group == groups_.end()) {
+    auto new_group = std::make_unique<Group>();
+    new_group->sample_rate = sink->sample_rate();
+    new_group->num_channels = sink->num_channels();
+    new_group->frame.sample_rate_hz_ = sink->sample_rate();
+    new_group->frame.num_channels_ = sink->num_channels();
+    new_group->frame.samples_per_channel_ =
+        webrtc::SampleRateToDefaultChannelSize(sink->sample_rate());
+    group = groups_.insert(groups_.end(), std::move(new_group));
+  }
+  (*group)->sinks.push_back(sink);
+}
+
+void AudioSinkFanout::RemoveSink(Sink* sink) {
+  webrtc::MutexLock lock(&mutex_);
+  for (auto& group : groups_) {
+    group->sinks.erase(
+        std::remove(group->sinks.begin(), group->sinks.end(), sink),
+        group->sinks.end());
+  }
+  groups_.erase(std::remove_if(groups_.begin(), groups_.end(),
+                               [](const auto& group) {
+                                 return group->sinks.empty();
+                               }),
+                groups_.end());
+}
+
+void AudioSinkFanout::OnData(const void* audio_data,
+                             int bits_per_sample,
+                             int sample_rate,
+                             size_t number_of_channels,
+                             size_t number_of_frames) {
+  RTC_CHECK_EQ(16, bits_per_sample);
+
+  const int16_t* data = static_cast<const int16_t*>(audio_data);
+  webrtc::MutexLock lock(&mutex_);
+  for (auto& group : groups_) {
+    if (group->sample_rate == sample_rate &&
+        static_cast<size_t>(group->num_channels) == number_of_channels) {
+      for (Sink* sink : group->sinks)
+        sink->deliver(data, sample_rate, number_of_channels, number_of_frames);
+      continue;
+    }
+
+    webrtc::InterleavedView<const int16_t> source(data, number_of_frames,
+                                                  number_of_channels);
+    webrtc::voe::RemixAndResample(source, sample_rate, &group->resampler,
+                                  &group->frame);
+    resamples_++;
+
+    const webrtc::AudioFrame& frame = group->frame;
+    for (Sink* sink : group->sinks) {
+      sink->deliver(frame.data(), frame.sample_rate_hz(), frame.num_channels(),
+                    frame.samples_per_channel());
+    }
+  }
+}
+
+int64_t AudioSinkFanout::resamples() const {
+  webrtc::MutexLock lock(&mutex_);
+  return resamples_;
+}
+
+}  // namespace livekit_ffi
@@ -24,9 +24,8 @@
 #include "api/audio_options.h"
 #include "api/audio/audio_frame.h"
 #include "api/media_stream_interface.h"
-#include "api/task_queue/task_queue_base.h"
-#include "audio/remix_resample.h"
 #include "common_audio/include/audio_util.h"
+#include "livekit/audio_format.h"
 #include "livekit/global_task_queue.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -62,22 +61,33 @@ AudioTrack::AudioTrack(std::shared_ptr<RtcRuntime> rtc_runtime,
 
 AudioTrack::~AudioTrack() {
   webrtc::MutexLock lock(&mutex_);
-  for (auto& sink : sinks_) {
-    track()->RemoveSink(sink.get());
+  if (!sinks_.empty()) {
+    track()->RemoveSink(&fanout_);
   }
 }
 
 void AudioTrack::add_sink(const std::shared_ptr<NativeAudioSink>& sink) const {
   webrtc::MutexLock lock(&mutex_);
-  track()->AddSink(sink.get());
+  if (sinks_.empty()) {
+    track()->AddSink(&fanout_);
+  }
+  fanout_.AddSink(sink.get());
   sinks_.push_back(sink);
 }
 
 void AudioTrack::remove_sink(
     const std::shared_ptr<NativeAudioSink>& sink) const {
   webrtc::MutexLock lock(&mutex_);
-  track()->RemoveSink(sink.get());
-  sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), sink), sinks_.end());
+  auto it = std::remove(sinks_.begin(), sinks_.end(), sink);
+  if (it == sinks_.end()) {
+    return;
+  }
+
+  fanout_.RemoveSink(sink.get());
+  sinks_.erase(it, sinks_.end());
+  if (sinks_.empty()) {
+    track()->RemoveSink(&fanout_);
+  }
 }
 
 NativeAudioSink::NativeAudioSink(rust::Box<AudioSinkWrapper> observer,
@@ -85,41 +95,36 @@ NativeAudioSink::NativeAudioSink(rust::Box<AudioSinkWrapper> observer,
                                  int num_channels)
     : observer_(std::move(observer)),
       sample_rate_(sample_rate),
-      num_channels_(num_channels) {
-  frame_.sample_rate_hz_ = sample_rate;
-  frame_.num_channels_ = num_channels;
-  frame_.samples_per_channel_ = webrtc::SampleRateToDefaultChannelSize(sample_rate);
-}
-
-void NativeAudioSink::OnData(const void* audio_data,
-                             int bits_per_sample,
-                             int sample_rate,
-                             size_t number_of_channels,
-                             size_t number_of_frames) {
-  RTC_CHECK_EQ(16, bits_per_sample);
-
-  const int16_t* data = static_cast<const int16_t*>(audio_data);
-
-  if (sample_rate_ != sample_rate || num_channels_ != number_of_channels) {
-    webrtc::InterleavedView<const int16_t> source(data,
-                                         number_of_frames,
-                                         number_of_channels);
-    // resample/remix before capturing
-    webrtc::voe::RemixAndResample(source, sample_rate, &resampler_, &frame_);
-
-    rust::Slice<const int16_t> rust_slice(
-        frame_.data(), frame_.num_channels() * frame_.samples_per_channel());
+      num_channels_(num_channels) {}
 
-    observer_->on_data(rust_slice, frame_.sample_rate_hz(),
-                       frame_.num_channels(), frame_.samples_per_channel());
-
-  } else {
-    rust::Slice<const int16_t> rust_slice(
-        data, number_of_channels * number_of_frames);
-
-    observer_->on_data(rust_slice, sample_rate, number_of_channels,
-                       number_of_frames);
+NativeAudioSink::NativeAudioSink(rust::Box<AudioSinkWrapper> observer,
+                                 int sample_rate,
+                                 int num_channels,
+                                 bool planar)
+    : observer_(std::move(observer)),
+      sample_rate_(sample_rate),
+      num_channels_(num_channels),
+      float_(true),
+      planar_(planar) {}
+
+void NativeAudioSink::deliver(const int16_t* data,
+                              int sample_rate,
+                              size_t number_of_channels,
+                              size_t number_of_frames) {
+  const size_t samples = number_of_channels * number_of_frames;
+  if (!float_) {
+    observer_->on_data(rust::Slice<const int16_t>(data, samples), sample_rate,
+                       number_of_channels, number_of_frames);
+    return;
   }
+
+  // Only called from the audio thread of the track.
+  float_buffer_.resize(samples);
+  S16ToFloat(data, number_of_frames, number_of_channels, planar_,
+             float_buffer_.data());
+  observer_->on_data_f32(
+      rust::Slice<const float>(float_buffer_.data(), samples), sample_rate,
+      number_of_channels, number_of_frames, planar_);
 }
 
 std::shared_ptr<NativeAudioSink> new_native_audio_sink(
@@ -130,75 +135,101 @@ std::shared_ptr<NativeAudioSink> new_native_audio_sink(
                                            num_channels);
 }
 
+std::shared_ptr<NativeAudioSink> new_native_audio_sink_f32(
+    rust::Box<AudioSinkWrapper> observer,
+    int sample_rate,
+    int num_channels,
+    bool planar) {
+  return std::make_shared<NativeAudioSink>(std::move(observer), sample_rate,
+                                           num_channels, planar);
+}
+
+// start sending silence when there is nothing on the queue for 10 frames
+// (100ms)
+constexpr int kSilenceFramesThreshold = 10;
+
 AudioTrackSource::InternalSource::InternalSource(
     const cricket::AudioOptions& options,
     int sample_rate,
     int num_channels,
     int queue_size_ms,  // must be a multiple of 10ms
-    webrtc::TaskQueueFactory* task_queue_factory)
+    AudioPacer* pacer,
+    bool encoded)
     : options_(options),
       sample_rate_(sample_rate),
       num_channels_(num_channels),
       capture_userdata_(nullptr),
       on_complete_(nullptr) {
+  if (encoded) {
+    encoded_transformer_ = webrtc::make_ref_counted<EncodedAudioTransformer>();
+    RegisterEncodedAudioSource(this, encoded_transformer_);
+  }
+
   if (!queue_size_ms) {
     // Set queue_size_samples_ to 0 so that capture_frame() will get to the fast path.
     queue_size_samples_ = 0;
     return;  // no audio queue
   }
 
-  // start sending silence when there is nothing on the queue for 10 frames
-  // (100ms)
-  const int silence_frames_threshold = 10;
-  missed_frames_ = silence_frames_threshold;
+  missed_frames_ = kSilenceFramesThreshold;
 
-  int samples10ms = sample_rate / 100 * num_channels;
+  samples10ms_ = sample_rate / 100 * num_channels;
 
-  silence_buffer_.assign(samples10ms, 0);
-  queue_size_samples_ = queue_size_ms / 10 * samples10ms;
+  silence_buffer_.assign(samples10ms_, 0);
+  frame_buffer_.assign(samples10ms_, 0);
+  queue_size_samples_ = queue_size_ms / 10 * samples10ms_;
   notify_threshold_samples_ = queue_size_samples_;  // TODO: this is currently
                                                     // using x2 the queue size
-  buffer_.reserve(queue_size_samples_ + notify_threshold_samples_);
-
-  audio_queue_ =
-      task_queue_factory->CreateTaskQueue(
-          "AudioSourceCapture", webrtc::TaskQueueFactory::Priority::NORMAL);
-
-  audio_task_ = webrtc::RepeatingTaskHandle::Start(
-      audio_queue_.get(),
-      [this, samples10ms]() {
-        webrtc::MutexLock lock(&mutex_);
-        constexpr int kBitsPerSample = sizeof(int16_t) * 8;
-
-        if (buffer_.size() >= samples10ms) {
-          // Reset |missed_frames_| to 0 so that it won't keep sending silence to webrtc due to audio callback timing drifts.
-          missed_frames_ = 0;
-          for (auto sink : sinks_)
-            sink->OnData(buffer_.data(), kBitsPerSample, sample_rate_,
-                         num_channels_, samples10ms / num_channels_);
-
-          buffer_.erase(buffer_.begin(), buffer_.begin() + samples10ms);
-        } else {
-          missed_frames_++;
-          if (missed_frames_ >= silence_frames_threshold) {
-            for (auto sink : sinks_)
-              sink->OnData(silence_buffer_.data(), kBitsPerSample, sample_rate_,
-                           num_channels_, samples10ms / num_channels_);
-          }
-        }
-
-        if (on_complete_ && buffer_.size() <= notify_threshold_samples_) {
-          on_complete_(capture_userdata_);
-          on_complete_ = nullptr;
-          capture_userdata_ = nullptr;
-        }
-
-        return webrtc::TimeDelta::Millis(10);
-      },
-      webrtc::TaskQueueBase::DelayPrecision::kHigh);
+  buffer_ = std::make_unique<AudioRingBuffer<int16_t>>(
+      queue_size_samples_ + notify_threshold_samples_);
+
+  pacer_ = pacer;
+  pacer_->add_source(this);
 }
 
 AudioTrackSource::InternalSource::~InternalSource() {
+  if (pacer_)
+    pacer_->remove_source(this);
+  if (encoded_transformer_)
+    UnregisterEncodedAudioSource(this);
+}
+
+void AudioTrackSource::InternalSource::on_tick() {
+  constexpr int kBitsPerSample = sizeof(int16_t) * 8;
+
+  buffer_->discard_until(clear_until_.load(std::memory_order_acquire));
+
+  const int16_t* data = nullptr;
+  if (buffer_->read(frame_buffer_.data(), samples10ms_)) {
+    // Reset |missed_frames_| to 0 so that it won't keep sending silence to webrtc due to audio callback timing drifts.
+    missed_frames_ = 0;
+    playing_ = true;
+    data = frame_buffer_.data();
+  } else {
+    // Only the first empty tick after some audio, an idle source isn't
+    // underrunning.
+    if (playing_)
+      underruns_.fetch_add(1, std::memory_order_relaxed);
+    playing_ = false;
+    missed_frames_++;
+    if (missed_frames_ >= kSilenceFramesThreshold)
+      data = silence_buffer_.data();
+  }
+
+  if (data) {
+    webrtc::MutexLock lock(&mutex_);
+    for (auto sink : sinks_)
+      sink->OnData(data, kBitsPerSample, sample_rate_, num_channels_,
+                   samples10ms_ / num_channels_);
+  }
+
+  CompleteCallback on_complete = on_complete_.load(std::memory_order_acquire);
+  if (on_complete && buffer_->size() <= notify_threshold_samples_) {
+    const SourceContext* ctx = capture_userdata_;
+    capture_userdata_ = nullptr;
+    on_complete_.store(nullptr, std::memory_order_release);
+    on_complete(ctx);
+  }
 }
 
 bool AudioTrackSource::InternalSource::capture_frame(
@@ -208,28 +239,26 @@ bool AudioTrackSource::InternalSource::capture_frame(
     size_t number_of_frames,
     const SourceContext* ctx,
     void (*on_complete)(const SourceContext*)) {
-  webrtc::MutexLock lock(&mutex_);
-
   if (queue_size_samples_) {
-    int available =
-        (queue_size_samples_ + notify_threshold_samples_) - buffer_.size();
-    if (available < data.size())
-      return false;
+    webrtc::MutexLock lock(&capture_mutex_);
 
-    if (on_complete_ || capture_userdata_)
+    // A previous capture is still waiting for the queue to drain.
+    if (on_complete_.load(std::memory_order_acquire))
       return false;
 
-    buffer_.insert(buffer_.end(), data.begin(), data.end());
+    if (!buffer_->write(data.data(), data.size()))
+      return false;
 
-    if (buffer_.size() <= notify_threshold_samples_) {
+    if (buffer_->size() <= notify_threshold_samples_) {
       on_complete(ctx);  // complete directly
     } else {
-      on_complete_ = on_complete;
       capture_userdata_ = ctx;
+      on_complete_.store(on_complete, std::memory_order_release);
     }
 
   } else {
     // capture directly when the queue buffer is 0 (frame size must be 10ms)
+    webrtc::MutexLock lock(&mutex_);
     for (auto sink : sinks_)
       sink->OnData(data.data(), sizeof(int16_t) * 8, sample_rate,
                    number_of_channels, number_of_frames);
@@ -238,9 +267,81 @@ bool AudioTrackSource::InternalSource::capture_frame(
   return true;
 }
 
+bool AudioTrackSource::InternalSource::capture_frame_f32(
+    rust::Slice<const float> data,
+    uint32_t sample_rate,
+    uint32_t number_of_channels,
+    size_t number_of_frames,
+    size_t planar_stride,
+    const SourceContext* ctx,
+    void (*on_complete)(const SourceContext*)) {
+  const size_t samples = number_of_channels * number_of_frames;
+  const size_t needed =
+      planar_stride == 0
+          ? samples
+          : (number_of_channels - 1) * planar_stride + number_of_frames;
+  if (number_of_channels == 0 || data.size() < needed ||
+      (planar_stride != 0 && planar_stride < number_of_frames))
+    return false;
+
+  webrtc::MutexLock lock(&convert_mutex_);
+  convert_buffer_.resize(samples);
+  FloatToS16Interleaved(data.data(), number_of_frames, number_of_channels,
+                        planar_stride, convert_buffer_.data());
+  return capture_frame(
+      rust::Slice<const int16_t>(convert_buffer_.data(), samples), sample_rate,
+      number_of_channels, number_of_frames, ctx, on_complete);
+}
+
+bool AudioTrackSource::InternalSource::capture_encoded_frame(
+    rust::Slice<const uint8_t> data,
+    size_t samples_per_channel) {
+  const size_t frames10ms = sample_rate_ / 100;
+  if (!encoded_transformer_ || data.empty() || samples_per_channel == 0 ||
+      samples_per_channel % frames10ms)
+    return false;
+
+  webrtc::MutexLock lock(&capture_mutex_);
+  encoded_silence_.resize(frames10ms * num_channels_);
+  const size_t chunks = samples_per_channel / frames10ms;
+  if (buffer_ &&
+      buffer_->capacity() - buffer_->size() < chunks * encoded_silence_.size())
+    return false;
+
+  // Queued first, the encoder output of the silence below takes it.
+  encoded_transformer_->Push(data.data(), data.size());
+
+  for (size_t i = 0; i < chunks; i++) {
+    if (buffer_) {
+      buffer_->write(encoded_silence_.data(), encoded_silence_.size());
+    } else {
+      webrtc::MutexLock sinks_lock(&mutex_);
+      for (auto sink : sinks_)
+        sink->OnData(encoded_silence_.data(), sizeof(int16_t) * 8,
+                     sample_rate_, num_channels_, frames10ms);
+    }
+  }
+  return true;
+}
+
 void AudioTrackSource::InternalSource::clear_buffer() {
-  webrtc::MutexLock lock(&mutex_);
-  buffer_.clear();
+  if (!buffer_)
+    return;
+
+  // The ring buffer can only be advanced by its consumer, on_tick() drops
+  // everything queued before this point.
+  webrtc::MutexLock lock(&capture_mutex_);
+  clear_until_.store(buffer_->write_position(), std::memory_order_release);
+}
+
+AudioSourceBufferStats AudioTrackSource::InternalSource::buffer_stats() const {
+  AudioSourceBufferStats stats{};
+  if (buffer_) {
+    stats.queued_samples = buffer_->size();
+    stats.capacity_samples = buffer_->capacity();
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+  }
+  return stats;
 }
 
 webrtc::MediaSourceInterface::SourceState
@@ -279,13 +380,15 @@ AudioTrackSource::AudioTrackSource(AudioSourceOptions options,
                                    int sample_rate,
                                    int num_channels,
                                    int queue_size_ms,
-                                   webrtc::TaskQueueFactory* task_queue_factory)
+                                   AudioPacer* pacer,
+                                   bool encoded)
     : source_(webrtc::make_ref_counted<InternalSource>(
           to_native_audio_options(options),
           sample_rate,
           num_channels,
           queue_size_ms,
-          task_queue_factory)) {}
+          pacer,
+          encoded)) {}
 
 AudioSourceOptions AudioTrackSource::audio_options() const {
   return to_rust_audio_options(source_->options());
@@ -307,10 +410,33 @@ bool AudioTrackSource::capture_frame(
                                 number_of_frames, ctx, on_complete);
 }
 
+bool AudioTrackSource::capture_frame_f32(
+    rust::Slice<const float> audio_data,
+    uint32_t sample_rate,
+    uint32_t number_of_channels,
+    size_t number_of_frames,
+    size_t planar_stride,
+    const SourceContext* ctx,
+    void (*on_complete)(const SourceContext*)) const {
+  return source_->capture_frame_f32(audio_data, sample_rate,
+                                    number_of_channels, number_of_frames,
+                                    planar_stride, ctx, on_complete);
+}
+
+bool AudioTrackSource::capture_encoded_frame(
+    rust::Slice<const uint8_t> data,
+    size_t samples_per_channel) const {
+  return source_->capture_encoded_frame(data, samples_per_channel);
+}
+
 void AudioTrackSource::clear_buffer() const {
   source_->clear_buffer();
 }
 
+AudioSourceBufferStats AudioTrackSource::buffer_stats() const {
+  return source_->buffer_stats();
+}
+
 std::shared_ptr<AudioTrackSource> new_audio_track_source(
     AudioSourceOptions options,
     int sample_rate,
@@ -318,7 +444,29 @@ std::shared_ptr<AudioTrackSource> new_audio_track_source(
     int queue_size_ms) {
   return std::make_shared<AudioTrackSource>(options, sample_rate, num_channels,
                                             queue_size_ms,
-                                            GetGlobalTaskQueueFactory());
+                                            GetGlobalAudioPacer());
+}
+
+std::shared_ptr<AudioTrackSource> new_encoded_audio_track_source(
+    int sample_rate,
+    int num_channels,
+    int queue_size_ms) {
+  return std::make_shared<AudioTrackSource>(
+      AudioSourceOptions{}, sample_rate, num_channels, queue_size_ms,
+      GetGlobalAudioPacer(), true);
+}
+
+AudioPacerStats audio_pacer_stats() {
+  AudioPacer::Stats stats = GetGlobalAudioPacer()->stats();
+
+  AudioPacerStats rust_stats{};
+  rust_stats.ticks = stats.ticks;
+  rust_stats.last_jitter_us = stats.last_jitter_us;
+  rust_stats.max_jitter_us = stats.max_jitter_us;
+  rust_stats.avg_jitter_us =
+      stats.ticks ? static_cast<double>(stats.total_jitter_us) / stats.ticks
+                  : 0.0;
+  return rust_stats;
 }
 
 webrtc::scoped_refptr<AudioTrackSource::InternalSource> AudioTrackSource::get()
@@ -28,6 +28,28 @@ pub mod ffi {
         pub auto_gain_control: bool,
     }
 
+    /// Occupancy counters of the capture queue of an AudioTrackSource.
+    /// All values are zero when the source was created without a queue.
+    #[derive(Debug, Default, Clone, Copy)]
+    pub struct AudioSourceBufferStats {
+        /// Interleaved samples currently waiting to be sent.
+        pub queued_samples: u64,
+        /// Size of the queue, in interleaved samples.
+        pub capacity_samples: u64,
+        /// Number of times the queue ran dry after delivering audio.
+        pub underruns: u64,
+    }
+
+    /// Timing of the shared 10ms tick driving all the queued AudioTrackSources.
+    #[derive(Debug, Default, Clone, Copy)]
+    pub struct AudioPacerStats {
+        pub ticks: u64,
+        /// Delay of the last tick relative to its schedule, in microseconds.
+        pub last_jitter_us: i64,
+        pub max_jitter_us: i64,
+        pub avg_jitter_us: f64,
+    }
+
     extern "C++" {
         include!("livekit/media_stream_track.h");
 
@@ -49,6 +71,12 @@ pub mod ffi {
             sample_rate: i32,
             num_channels: i32,
         ) -> SharedPtr<NativeAudioSink>;
+        fn new_native_audio_sink_f32(
+            observer: Box<AudioSinkWrapper>,
+            sample_rate: i32,
+            num_channels: i32,
+            planar: bool,
+        ) -> SharedPtr<NativeAudioSink>;
 
         unsafe fn capture_frame(
             self: &AudioTrackSource,
@@ -59,7 +87,23 @@ pub mod ffi {
             userdata: *const SourceContext,
             on_complete: CompleteCallback,
         ) -> bool;
+        unsafe fn capture_frame_f32(
+            self: &AudioTrackSource,
+            data: &[f32],
+            sample_rate: u32,
+            nb_channels: u32,
+            nb_frames: usize,
+            planar_stride: usize,
+            userdata: *const SourceContext,
+            on_complete: CompleteCallback,
+        ) -> bool;
+        fn capture_encoded_frame(
+            self: &AudioTrackSource,
+            data: &[u8],
+            samples_per_channel: usize,
+        ) -> bool;
         fn clear_buffer(self: &AudioTrackSource);
+        fn buffer_stats(self: &AudioTrackSource) -> AudioSourceBufferStats;
         fn audio_options(self: &AudioTrackSource) -> AudioSourceOptions;
         fn set_audio_options(self: &AudioTrackSource, options: &AudioSourceOptions);
 
@@ -70,6 +114,14 @@ pub mod ffi {
             queue_size_ms: i32,
         ) -> SharedPtr<AudioTrackSource>;
 
+        fn new_encoded_audio_track_source(
+            sample_rate: i32,
+            num_channels: i32,
+            queue_size_ms: i32,
+        ) -> SharedPtr<AudioTrackSource>;
+
+        fn audio_pacer_stats() -> AudioPacerStats;
+
         fn audio_to_media(track: SharedPtr<AudioTrack>) -> SharedPtr<MediaStreamTrack>;
         unsafe fn media_to_audio(track: SharedPtr<MediaStreamTrack>) -> SharedPtr<AudioTrack>;
         fn _shared_audio_track() -> SharedPtr<AudioTrack>;
@@ -87,6 +139,15 @@ pub mod ffi {
             nb_channels: usize,
             nb_frames: usize,
         );
+
+        fn on_data_f32(
+            self: &AudioSinkWrapper,
+            data: &[f32],
+            sample_rate: i32,
+            nb_channels: usize,
+            nb_frames: usize,
+            planar: bool,
+        );
     }
 }
 
@@ -107,6 +168,18 @@ unsafe impl ExternType for CompleteCallback {
 
 pub trait AudioSink: Send {
     fn on_data(&self, data: &[i16], sample_rate: i32, nb_channels: usize, nb_frames: usize);
+
+    /// Called instead of `on_data` by sinks created with
+    /// `new_native_audio_sink_f32`, samples are in [-1, 1].
+    fn on_data_f32(
+        &self,
+        _data: &[f32],
+        _sample_rate: i32,
+        _nb_channels: usize,
+        _nb_frames: usize,
+        _planar: bool,
+    ) {
+    }
 }
 
 pub struct AudioSinkWrapper {
@@ -121,4 +194,15 @@ impl AudioSinkWrapper {
     fn on_data(&self, data: &[i16], sample_rate: i32, nb_channels: usize, nb_frames: usize) {
         self.observer.on_data(data, sample_rate, nb_channels, nb_frames);
     }
+
+    fn on_data_f32(
+        &self,
+        data: &[f32],
+        sample_rate: i32,
+        nb_channels: usize,
+        nb_frames: usize,
+        planar: bool,
+    ) {
+        self.observer.on_data_f32(data, sample_rate, nb_channels, nb_frames, planar);
+    }
 }
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/conference_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace livekit_ffi {
+
+namespace {
+
+// |acc| += |src|, int16 samples accumulated as float.
+void AccumulateS16(const int16_t* src, size_t size, float* acc) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), lo));
+    _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), hi));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 8 <= size; i += 8) {
+    int16x8_t s = vld1q_s16(src + i);
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+    vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), lo));
+    vst1q_f32(acc + i + 4, vaddq_f32(vld1q_f32(acc + i + 4), hi));
+  }
+#endif
+  for (; i < size; i++)
+    acc[i] += src[i];
+}
+
+// |dst| = |mix| - |src| (|mix| alone when |src| is null), rounded to the
+// nearest and saturated to int16.
+void SubtractToS16(const float* mix,
+                   const int16_t* src,
+                   size_t size,
+                   int16_t* dst) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    __m128 lo = _mm_loadu_ps(mix + i);
+    __m128 hi = _mm_loadu_ps(mix + i + 4);
+    if (src) {
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      lo = _mm_sub_ps(
+          lo, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)));
+      hi = _mm_sub_ps(
+          hi, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)));
+    }
+    __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 8 <= size; i += 8) {
+    float32x4_t lo = vld1q_f32(mix + i);
+    float32x4_t hi = vld1q_f32(mix + i + 4);
+    if (src) {
+      int16x8_t s = vld1q_s16(src + i);
+      lo = vsubq_f32(lo, vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))));
+      hi = vsubq_f32(hi, vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))));
+    }
+    vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(lo)),
+                                    vqmovn_s32(vcvtnq_s32_f32(hi))));
+  }
+#endif
+  for (; i < size; i++) {
+    float value = src ? mix[i] - src[i] : mix[i];
+    dst[i] = static_cast<int16_t>(
+        std::lrint(std::min(std::max(value, -32768.f), 32767.f)));
+  }
+}
+
+float SumOfSquares(const int16_t* src, size_t size) {
+  size_t i = 0;
+  float sum = 0;
+#if defined(__SSE2__)
+  __m128 acc = _mm_setzero_ps();
+  for (; i + 8 <= size; i += 8) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+    acc = _mm_add_ps(acc, _mm_add_ps(_mm_mul_ps(lo, lo), _mm_mul_ps(hi, hi)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, acc);
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  float32x4_t acc = vdupq_n_f32(0);
+  for (; i + 8 <= size; i += 8) {
+    int16x8_t s = vld1q_s16(src + i);
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+    acc = vmlaq_f32(vmlaq_f32(acc, lo, lo), hi, hi);
+  }
+  sum = vaddvq_f32(acc);
+#endif
+  for (; i < size; i++)
+    sum += static_cast<float>(src[i]) * src[i];
+  return sum;
+}
+
+// RFC 6464 level of |src| in -dBov.
+int AudioLevel(const int16_t* src, size_t size) {
+  const float mean_square = SumOfSquares(src, size) / size;
+  if (mean_square <= 0)
+    return 127;
+  const float dbov = 10 * std::log10(mean_square / (32768.f * 32768.f));
+  return std::clamp(static_cast<int>(std::lround(-dbov)), 0, 127);
+}
+
+}  // namespace
+
+ConferenceMixer::ConferenceMixer(int sample_rate,
+                                 size_t num_channels,
+                                 size_t max_speakers)
+    : samples_per_frame_(static_cast<size_t>(sample_rate / 100) *
+                         num_channels),
+      max_speakers_(max_speakers),
+      mix_(samples_per_frame_),
+      output_(samples_per_frame_) {}
+
+void ConferenceMixer::add_participant(uint32_t id) {
+  webrtc::MutexLock lock(&mutex_);
+  if (index_.count(id))
+    return;
+
+  index_[id] = participants_.size();
+  Participant participant;
+  participant.id = id;
+  participant.samples.resize(kMaxQueuedFrames * samples_per_frame_);
+  participants_.push_back(std::move(participant));
+}
+
+void ConferenceMixer::remove_participant(uint32_t id) {
+  webrtc::MutexLock lock(&mutex_);
+  auto it = index_.find(id);
+  if (it == index_.end())
+    return;
+
+  // Moves the last participant in the slot of the removed one.
+  const size_t index = it->second;
+  index_.erase(it);
+  if (index != participants_.size() - 1) {
+    participants_[index] = std::move(participants_.back());
+    index_[participants_[index].id] = index;
+  }
+  participants_.pop_back();
+  speakers_.erase(std::remove(speakers_.begin(), speakers_.end(), id),
+                  speakers_.end());
+}
+
+bool ConferenceMixer::push_frame(uint32_t id,
+                                 const int16_t* data,
+                                 size_t len,
+                                 bool voice_activity,
+                                 int audio_level) {
+  if (len != samples_per_frame_)
+    return false;
+
+  webrtc::MutexLock lock(&mutex_);
+  auto it = index_.find(id);
+  if (it == index_.end())
+    return false;
+
+  // Silent frames are queued too, each push stands for 10 ms.
+  Participant& participant = participants_[it->second];
+  if (participant.queued == kMaxQueuedFrames) {
+    participant.head = (participant.head + 1) % kMaxQueuedFrames;
+    participant.queued--;
+  }
+  const size_t slot =
+      (participant.head + participant.queued) % kMaxQueuedFrames;
+  participant.queued++;
+
+  QueuedFrame& frame = participant.queue[slot];
+  frame.voiced = false;
+  if (!voice_activity || audio_level >= kSilentLevel)
+    return true;
+
+  if (audio_level == kUnknownLevel) {
+    audio_level = AudioLevel(data, len);
+    if (audio_level >= kSilentLevel)
+      return true;
+  }
+
+  std::copy(data, data + len,
+            participant.samples.begin() + slot * samples_per_frame_);
+  frame.voiced = true;
+  frame.level = audio_level;
+  return true;
+}
+
+size_t ConferenceMixer::mix(bool mix_minus) {
+  webrtc::MutexLock lock(&mutex_);
+  selected_.clear();
+  for (size_t i = 0; i < participants_.size(); i++) {
+    Participant& participant = participants_[i];
+    participant.frame = nullptr;
+    if (participant.queued == 0)
+      continue;
+
+    // The slot isn't reused before the next push, after this mix.
+    const size_t slot = participant.head;
+    participant.head = (participant.head + 1) % kMaxQueuedFrames;
+    participant.queued--;
+    if (!participant.queue[slot].voiced)
+      continue;
+
+    participant.frame = participant.samples.data() + slot * samples_per_frame_;
+    participant.level = participant.queue[slot].level;
+    selected_.push_back(i);
+  }
+
+  // Loudest first, the lowest level in -dBov.
+  auto louder = [this](size_t a, size_t b) {
+    return participants_[a].level < participants_[b].level;
+  };
+  if (selected_.size() > max_speakers_) {
+    std::nth_element(selected_.begin(), selected_.begin() + max_speakers_,
+                     selected_.end(), louder);
+    selected_.resize(max_speakers_);
+  }
+  std::sort(selected_.begin(), selected_.end(), louder);
+
+  std::fill(mix_.begin(), mix_.end(), 0.f);
+  speakers_.clear();
+  for (size_t index : selected_) {
+    AccumulateS16(participants_[index].frame, samples_per_frame_, mix_.data());
+    speakers_.push_back(participants_[index].id);
+  }
+  SubtractToS16(mix_.data(), nullptr, samples_per_frame_, output_.data());
+
+  mix_minus_ = mix_minus;
+  if (mix_minus) {
+    for (size_t index : selected_) {
+      Participant& participant = participants_[index];
+      participant.mix_minus.resize(samples_per_frame_);
+      SubtractToS16(mix_.data(), participant.frame, samples_per_frame_,
+                    participant.mix_minus.data());
+    }
+  }
+
+  return samples_per_frame_;
+}
+
+const int16_t* ConferenceMixer::data() const {
+  webrtc::MutexLock lock(&mutex_);
+  return output_.data();
+}
+
+const int16_t* ConferenceMixer::mix_minus(uint32_t id) const {
+  webrtc::MutexLock lock(&mutex_);
+  auto it = index_.find(id);
+  if (!mix_minus_ || it == index_.end())
+    return nullptr;
+
+  if (std::find(speakers_.begin(), speakers_.end(), id) == speakers_.end())
+    return output_.data();
+  return participants_[it->second].mix_minus.data();
+}
+
+std::unique_ptr<std::vector<uint32_t>> ConferenceMixer::speakers() const {
+  webrtc::MutexLock lock(&mutex_);
+  return std::make_unique<std::vector<uint32_t>>(speakers_);
+}
+
+std::unique_ptr<ConferenceMixer> create_conference_mixer(
+    int sample_rate,
+    size_t num_channels,
+    size_t max_speakers) {
+  return std::make_unique<ConferenceMixer>(sample_rate, num_channels,
+                                           max_speakers);
+}
+
+}  // namespace livekit_ffi
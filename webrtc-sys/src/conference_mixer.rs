@@ -0,0 +1,49 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use crate::impl_thread_safety;
+
+#[cxx::bridge(namespace = "livekit_ffi")]
+pub mod ffi {
+    unsafe extern "C++" {
+        include!("livekit/conference_mixer.h");
+
+        type ConferenceMixer;
+
+        fn add_participant(self: Pin<&mut ConferenceMixer>, id: u32);
+        fn remove_participant(self: Pin<&mut ConferenceMixer>, id: u32);
+
+        unsafe fn push_frame(
+            self: Pin<&mut ConferenceMixer>,
+            id: u32,
+            data: *const i16,
+            len: usize,
+            voice_activity: bool,
+            audio_level: i32,
+        ) -> bool;
+
+        fn mix(self: Pin<&mut ConferenceMixer>, mix_minus: bool) -> usize;
+        fn data(self: &ConferenceMixer) -> *const i16;
+        fn mix_minus(self: &ConferenceMixer, id: u32) -> *const i16;
+        fn speakers(self: &ConferenceMixer) -> UniquePtr<CxxVector<u32>>;
+
+        fn create_conference_mixer(
+            sample_rate: i32,
+            num_channels: usize,
+            max_speakers: usize,
+        ) -> UniquePtr<ConferenceMixer>;
+    }
+}
+
+impl_thread_safety!(ffi::ConferenceMixer, Send + Sync);
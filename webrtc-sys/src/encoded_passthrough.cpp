@@ -0,0 +1,346 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/encoded_passthrough.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/logging.h"
+
+namespace livekit_ffi {
+
+namespace {
+
+// Native buffers can come from elsewhere (platform capturers), the live
+// EncodedVideoFrameBuffers are tracked to tell them apart without RTTI.
+std::mutex encoded_buffers_mutex;
+std::unordered_set<const webrtc::VideoFrameBuffer*> encoded_buffers;
+
+std::mutex encoded_audio_mutex;
+std::unordered_map<const webrtc::AudioSourceInterface*,
+                   webrtc::scoped_refptr<EncodedAudioTransformer>>
+    encoded_audio_sources;
+
+}  // namespace
+
+EncodedVideoFrameBuffer::EncodedVideoFrameBuffer(
+    webrtc::VideoCodecType codec,
+    webrtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+    bool keyframe,
+    int width,
+    int height,
+    uint64_t sequence,
+    std::shared_ptr<std::atomic<bool>> keyframe_request)
+    : codec_(codec),
+      data_(std::move(data)),
+      keyframe_(keyframe),
+      width_(width),
+      height_(height),
+      sequence_(sequence),
+      keyframe_request_(std::move(keyframe_request)) {
+  std::lock_guard<std::mutex> lock(encoded_buffers_mutex);
+  encoded_buffers.insert(this);
+}
+
+EncodedVideoFrameBuffer::~EncodedVideoFrameBuffer() {
+  std::lock_guard<std::mutex> lock(encoded_buffers_mutex);
+  encoded_buffers.erase(this);
+}
+
+const EncodedVideoFrameBuffer* EncodedVideoFrameBuffer::From(
+    const webrtc::VideoFrameBuffer* buffer) {
+  if (!buffer || buffer->type() != Type::kNative)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(encoded_buffers_mutex);
+  if (!encoded_buffers.count(buffer))
+    return nullptr;
+  return static_cast<const EncodedVideoFrameBuffer*>(buffer);
+}
+
+webrtc::scoped_refptr<webrtc::I420BufferInterface>
+EncodedVideoFrameBuffer::ToI420() {
+  return nullptr;
+}
+
+webrtc::scoped_refptr<webrtc::VideoFrameBuffer>
+EncodedVideoFrameBuffer::CropAndScale(int offset_x,
+                                      int offset_y,
+                                      int crop_width,
+                                      int crop_height,
+                                      int scaled_width,
+                                      int scaled_height) {
+  return webrtc::scoped_refptr<webrtc::VideoFrameBuffer>(this);
+}
+
+void EncodedVideoFrameBuffer::RequestKeyframe() const {
+  if (keyframe_request_)
+    keyframe_request_->store(true, std::memory_order_relaxed);
+}
+
+PassthroughVideoEncoder::PassthroughVideoEncoder(
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : encoder_(std::move(encoder)) {}
+
+void PassthroughVideoEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int32_t PassthroughVideoEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  if (codec_settings) {
+    codec_type_ = codec_settings->codecType;
+    num_streams_ = std::max<int>(codec_settings->numberOfSimulcastStreams, 1);
+  }
+  sent_ = false;
+  return encoder_->InitEncode(codec_settings, settings);
+}
+
+int32_t PassthroughVideoEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  callback_ = callback;
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t PassthroughVideoEncoder::Release() {
+  return encoder_->Release();
+}
+
+int32_t PassthroughVideoEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  const EncodedVideoFrameBuffer* encoded =
+      EncodedVideoFrameBuffer::From(frame.video_frame_buffer().get());
+  if (!encoded) {
+    if (frame.video_frame_buffer()->type() !=
+            webrtc::VideoFrameBuffer::Type::kNative ||
+        encoder_->GetEncoderInfo().supports_native_handle)
+      return encoder_->Encode(frame, frame_types);
+
+    // Converted here as the pipeline would have, had this encoder not
+    // claimed native support.
+    webrtc::scoped_refptr<webrtc::I420BufferInterface> i420 =
+        frame.video_frame_buffer()->ToI420();
+    if (!i420)
+      return WEBRTC_VIDEO_CODEC_ERROR;
+    webrtc::VideoFrame i420_frame(frame);
+    i420_frame.set_video_frame_buffer(i420);
+    return encoder_->Encode(i420_frame, frame_types);
+  }
+
+  passthrough_ = true;
+  if (!encoded->keyframe()) {
+    bool requested =
+        frame_types &&
+        std::find(frame_types->begin(), frame_types->end(),
+                  webrtc::VideoFrameType::kVideoFrameKey) != frame_types->end();
+    bool gap = !sent_ || encoded->sequence() != last_sequence_ + 1;
+    if (requested || gap)
+      encoded->RequestKeyframe();
+  }
+
+  int32_t result = Send(frame, *encoded);
+  if (result == WEBRTC_VIDEO_CODEC_OK) {
+    sent_ = true;
+    last_sequence_ = encoded->sequence();
+  }
+  return result;
+}
+
+int32_t PassthroughVideoEncoder::Send(const webrtc::VideoFrame& frame,
+                                      const EncodedVideoFrameBuffer& encoded) {
+  if (!callback_)
+    return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+
+  if (encoded.codec() != codec_type_) {
+    if (!reported_mismatch_) {
+      RTC_LOG(LS_ERROR) << "Encoded frames are "
+                        << webrtc::CodecTypeToPayloadString(encoded.codec())
+                        << " but the track was negotiated with "
+                        << webrtc::CodecTypeToPayloadString(codec_type_);
+      reported_mismatch_ = true;
+    }
+    return WEBRTC_VIDEO_CODEC_ERROR;
+  }
+
+  webrtc::EncodedImage image;
+  image.SetEncodedData(encoded.data());
+  image.SetRtpTimestamp(frame.rtp_timestamp());
+  image.capture_time_ms_ = frame.render_time_ms();
+  image.ntp_time_ms_ = frame.ntp_time_ms();
+  image.rotation_ = frame.rotation();
+  image._encodedWidth = encoded.width();
+  image._encodedHeight = encoded.height();
+  image._frameType = encoded.keyframe()
+                         ? webrtc::VideoFrameType::kVideoFrameKey
+                         : webrtc::VideoFrameType::kVideoFrameDelta;
+  if (num_streams_ > 1)
+    image.SetSimulcastIndex(0);
+
+  webrtc::CodecSpecificInfo info;
+  info.codecType = codec_type_;
+  if (codec_type_ == webrtc::kVideoCodecH264) {
+    info.codecSpecific.H264.packetization_mode =
+        webrtc::H264PacketizationMode::NonInterleaved;
+    info.codecSpecific.H264.temporal_idx = webrtc::kNoTemporalIdx;
+    info.codecSpecific.H264.idr_frame = encoded.keyframe();
+    info.codecSpecific.H264.base_layer_sync = false;
+  } else if (codec_type_ == webrtc::kVideoCodecVP8) {
+    info.codecSpecific.VP8.nonReference = false;
+    info.codecSpecific.VP8.temporalIdx = webrtc::kNoTemporalIdx;
+    info.codecSpecific.VP8.layerSync = false;
+    info.codecSpecific.VP8.keyIdx = webrtc::kNoKeyIdx;
+  } else {
+    RTC_LOG(LS_ERROR) << "Can't pass "
+                      << webrtc::CodecTypeToPayloadString(codec_type_)
+                      << " frames through";
+    return WEBRTC_VIDEO_CODEC_ERROR;
+  }
+
+  webrtc::EncodedImageCallback::Result result =
+      callback_->OnEncodedImage(image, &info);
+  if (result.error != webrtc::EncodedImageCallback::Result::OK)
+    return WEBRTC_VIDEO_CODEC_ERROR;
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
+void PassthroughVideoEncoder::SetRates(
+    const RateControlParameters& parameters) {
+  encoder_->SetRates(parameters);
+}
+
+void PassthroughVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void PassthroughVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void PassthroughVideoEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo PassthroughVideoEncoder::GetEncoderInfo()
+    const {
+  EncoderInfo info = encoder_->GetEncoderInfo();
+  // Keeps the frames native, they would be converted to I420 otherwise.
+  info.supports_native_handle = true;
+  if (passthrough_) {
+    // The bitrate is the application's, don't let the pipeline drop or
+    // downscale frames to fit the estimate.
+    info.implementation_name = "passthrough";
+    info.is_hardware_accelerated = false;
+    info.has_trusted_rate_controller = true;
+    info.scaling_settings = VideoEncoder::ScalingSettings::kOff;
+  }
+  return info;
+}
+
+void EncodedAudioTransformer::Push(const uint8_t* data, size_t size) {
+  webrtc::MutexLock lock(&mutex_);
+  if (packets_.size() >= kMaxQueuedPackets)
+    packets_.pop_front();
+  packets_.emplace_back(data, data + size);
+}
+
+void EncodedAudioTransformer::Transform(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  std::vector<uint8_t> packet;
+  webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (packets_.empty())
+      return;  // Nothing to send in place of this frame.
+    packet = std::move(packets_.front());
+    packets_.pop_front();
+
+    auto it = sink_callbacks_.find(frame->GetSsrc());
+    callback = it != sink_callbacks_.end() ? it->second : callback_;
+  }
+
+  if (!callback)
+    return;
+  frame->SetData(packet);
+  callback->OnTransformedFrame(std::move(frame));
+}
+
+void EncodedAudioTransformer::RegisterTransformedFrameCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = std::move(callback);
+}
+
+void EncodedAudioTransformer::RegisterTransformedFrameSinkCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+    uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_[ssrc] = std::move(callback);
+}
+
+void EncodedAudioTransformer::UnregisterTransformedFrameCallback() {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = nullptr;
+}
+
+void EncodedAudioTransformer::UnregisterTransformedFrameSinkCallback(
+    uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_.erase(ssrc);
+}
+
+void RegisterEncodedAudioSource(
+    const webrtc::AudioSourceInterface* source,
+    webrtc::scoped_refptr<EncodedAudioTransformer> transformer) {
+  std::lock_guard<std::mutex> lock(encoded_audio_mutex);
+  encoded_audio_sources[source] = std::move(transformer);
+}
+
+void UnregisterEncodedAudioSource(const webrtc::AudioSourceInterface* source) {
+  std::lock_guard<std::mutex> lock(encoded_audio_mutex);
+  encoded_audio_sources.erase(source);
+}
+
+void AttachEncodedAudioSource(webrtc::RtpSenderInterface* sender) {
+  webrtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track =
+      sender->track();
+  if (!track || track->kind() != webrtc::MediaStreamTrackInterface::kAudioKind)
+    return;
+
+  const webrtc::AudioSourceInterface* source =
+      static_cast<webrtc::AudioTrackInterface*>(track.get())->GetSource();
+
+  webrtc::scoped_refptr<EncodedAudioTransformer> transformer;
+  {
+    std::lock_guard<std::mutex> lock(encoded_audio_mutex);
+    auto it = encoded_audio_sources.find(source);
+    if (it == encoded_audio_sources.end())
+      return;
+    transformer = it->second;
+  }
+  sender->SetEncoderToPacketizerFrameTransformer(transformer);
+}
+
+}  // namespace livekit_ffi
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/fallback_video_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+
+namespace livekit_ffi {
+
+namespace {
+
+std::atomic<uint64_t> total_fallback_count{0};
+
+}  // namespace
+
+std::unique_ptr<FallbackVideoEncoder> FallbackVideoEncoder::Create(
+    std::vector<Candidate> candidates,
+    Options options) {
+  std::unique_ptr<FallbackVideoEncoder> encoder(
+      new FallbackVideoEncoder(std::move(candidates), options));
+  if (!encoder->Advance())
+    return nullptr;
+  return encoder;
+}
+
+uint64_t FallbackVideoEncoder::total_fallbacks() {
+  return total_fallback_count.load(std::memory_order_relaxed);
+}
+
+FallbackVideoEncoder::FallbackVideoEncoder(std::vector<Candidate> candidates,
+                                           Options options)
+    : candidates_(std::move(candidates)), options_(options) {}
+
+bool FallbackVideoEncoder::Advance() {
+  while (next_candidate_ < candidates_.size()) {
+    size_t index = next_candidate_++;
+    const Candidate& candidate = candidates_[index];
+    std::unique_ptr<webrtc::VideoEncoder> encoder = candidate.create();
+    if (!encoder) {
+      RTC_LOG(LS_WARNING) << "Failed to create the " << candidate.name
+                          << " encoder";
+      continue;
+    }
+
+    if (encoder_)
+      encoder_->Release();
+    encoder_ = std::move(encoder);
+    current_candidate_ = index;
+    if (fec_controller_override_)
+      encoder_->SetFecControllerOverride(fec_controller_override_);
+    if (callback_)
+      encoder_->RegisterEncodeCompleteCallback(callback_);
+    return true;
+  }
+  return false;
+}
+
+int32_t FallbackVideoEncoder::InitCurrent() {
+  while (true) {
+    int32_t result = encoder_->InitEncode(&*codec_settings_, *settings_);
+    if (result >= WEBRTC_VIDEO_CODEC_OK)
+      return result;
+
+    RTC_LOG(LS_WARNING) << "Failed to initialize the "
+                        << candidates_[current_candidate_].name
+                        << " encoder (" << result << ")";
+    if (!options_.on_init_failure || !Advance())
+      return result;
+  }
+}
+
+bool FallbackVideoEncoder::CanFallBack() const {
+  if (!options_.on_encode_failure || !candidates_[current_candidate_].hardware)
+    return false;
+  return std::any_of(
+      candidates_.begin() + next_candidate_, candidates_.end(),
+      [](const Candidate& candidate) { return !candidate.hardware; });
+}
+
+bool FallbackVideoEncoder::FallBack() {
+  while (next_candidate_ < candidates_.size() &&
+         candidates_[next_candidate_].hardware)
+    next_candidate_++;
+
+  const std::string& from = candidates_[current_candidate_].name;
+  RTC_LOG(LS_WARNING) << "Falling back from the " << from << " encoder";
+  if (!Advance())
+    return false;
+
+  slow_frames_ = 0;
+  if (codec_settings_ && InitCurrent() < WEBRTC_VIDEO_CODEC_OK)
+    return false;
+
+  // Only counted once the software encoder is ready to take over.
+  fallbacks_++;
+  total_fallback_count.fetch_add(1, std::memory_order_relaxed);
+  if (!codec_settings_)
+    return true;
+
+  if (rates_)
+    encoder_->SetRates(*rates_);
+  if (packet_loss_rate_)
+    encoder_->OnPacketLossRateUpdate(*packet_loss_rate_);
+  if (rtt_ms_)
+    encoder_->OnRttUpdate(*rtt_ms_);
+
+  // The receiver can't decode the new encoder's delta frames.
+  force_keyframe_ = true;
+  return true;
+}
+
+void FallbackVideoEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  fec_controller_override_ = fec_controller_override;
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int32_t FallbackVideoEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  if (!codec_settings)
+    return encoder_->InitEncode(codec_settings, settings);
+
+  codec_settings_ = *codec_settings;
+  settings_ = settings;
+  slow_frames_ = 0;
+  return InitCurrent();
+}
+
+int32_t FallbackVideoEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  callback_ = callback;
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t FallbackVideoEncoder::Release() {
+  codec_settings_.reset();
+  settings_.reset();
+  return encoder_->Release();
+}
+
+int32_t FallbackVideoEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  std::vector<webrtc::VideoFrameType> keyframe_types;
+  if (force_keyframe_) {
+    size_t streams = frame_types ? frame_types->size() : 1;
+    keyframe_types.assign(std::max<size_t>(streams, 1),
+                          webrtc::VideoFrameType::kVideoFrameKey);
+    frame_types = &keyframe_types;
+    force_keyframe_ = false;
+  }
+
+  int64_t start_us = webrtc::TimeMicros();
+  int32_t result = encoder_->Encode(frame, frame_types);
+  if (!CanFallBack())
+    return result;
+
+  if (result < WEBRTC_VIDEO_CODEC_OK) {
+    RTC_LOG(LS_WARNING) << "Encode failed on the "
+                        << candidates_[current_candidate_].name
+                        << " encoder (" << result << ")";
+    if (!FallBack())
+      return result;
+    // Don't lose the frame, the new encoder starts with it.
+    return Encode(frame, frame_types);
+  }
+
+  // Falling back on latency is opt-in, a hardware encoder can be slow for a
+  // while (e.g. on a busy GPU) and still be the better choice.
+  if (options_.max_encode_time_ms <= 0)
+    return result;
+
+  int64_t max_encode_time_us = options_.max_encode_time_ms * int64_t{1000};
+  if (webrtc::TimeMicros() - start_us > max_encode_time_us)
+    slow_frames_++;
+  else
+    slow_frames_ = 0;
+
+  if (slow_frames_ >= kSlowFramesBeforeFallback) {
+    RTC_LOG(LS_WARNING) << "The " << candidates_[current_candidate_].name
+                        << " encoder can't keep up";
+    FallBack();
+  }
+  return result;
+}
+
+void FallbackVideoEncoder::SetRates(const RateControlParameters& parameters) {
+  rates_ = parameters;
+  encoder_->SetRates(parameters);
+}
+
+void FallbackVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  packet_loss_rate_ = packet_loss_rate;
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void FallbackVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  rtt_ms_ = rtt_ms;
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void FallbackVideoEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo FallbackVideoEncoder::GetEncoderInfo()
+    const {
+  return encoder_->GetEncoderInfo();
+}
+
+}  // namespace livekit_ffi
@@ -16,6 +16,9 @@
 
 #include "livekit/global_task_queue.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "api/task_queue/default_task_queue_factory.h"
 #include "api/task_queue/task_queue_factory.h"
 
@@ -27,4 +30,22 @@ webrtc::TaskQueueFactory* GetGlobalTaskQueueFactory() {
   return global_task_queue_factory.get();
 }
 
+AudioPacer* GetGlobalAudioPacer() {
+  // A handful of threads is enough to pace hundreds of sources, each tick only
+  // copies 10ms of audio per source.
+  static AudioPacer* global_audio_pacer = new AudioPacer(
+      GetGlobalTaskQueueFactory(),
+      std::clamp<int>(std::thread::hardware_concurrency() / 4, 1, 4));
+  return global_audio_pacer;
+}
+
+SimulcastEncodePool* GetGlobalSimulcastEncodePool() {
+  // Encoding is CPU bound, more workers than cores would only add switches.
+  static SimulcastEncodePool* global_simulcast_encode_pool =
+      new SimulcastEncodePool(
+          GetGlobalTaskQueueFactory(),
+          std::clamp<int>(std::thread::hardware_concurrency(), 2, 16));
+  return global_simulcast_encode_pool;
+}
+
 }  // namespace livekit_ffi
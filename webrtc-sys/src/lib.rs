@@ -19,6 +19,7 @@ pub mod audio_mixer;
 pub mod audio_resampler;
 pub mod audio_track;
 pub mod candidate;
+pub mod conference_mixer;
 pub mod data_channel;
 #[cfg(any(target_os = "macos", target_os = "windows", target_os = "linux"))]
 pub mod desktop_capturer;
@@ -35,6 +36,8 @@ pub mod rtp_parameters;
 pub mod rtp_receiver;
 pub mod rtp_sender;
 pub mod rtp_transceiver;
+pub mod stats;
+pub mod video_encoder_factory;
 pub mod video_frame;
 pub mod video_frame_buffer;
 pub mod video_track;
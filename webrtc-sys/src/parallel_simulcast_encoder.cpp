@@ -0,0 +1,481 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/parallel_simulcast_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "api/video/encoded_image.h"
+#include "api/video_codecs/video_codec.h"
+#include "livekit/global_task_queue.h"
+#include "media/engine/simulcast_encoder_adapter.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+
+namespace livekit_ffi {
+
+namespace {
+
+void record(SimulcastEncodeTiming& timing, int64_t elapsed_us) {
+  timing.count++;
+  timing.last_us = elapsed_us;
+  timing.max_us = std::max(timing.max_us, elapsed_us);
+  timing.total_us += elapsed_us;
+}
+
+}  // namespace
+
+SimulcastEncodePool::SimulcastEncodePool(
+    webrtc::TaskQueueFactory* task_queue_factory,
+    int num_workers) {
+  RTC_CHECK_GT(num_workers, 0);
+
+  for (int i = 0; i < num_workers; ++i) {
+    queues_.push_back(task_queue_factory->CreateTaskQueue(
+        "SimulcastEncode" + std::to_string(i),
+        webrtc::TaskQueueFactory::Priority::NORMAL));
+  }
+}
+
+void SimulcastEncodePool::Post(absl::AnyInvocable<void() &&> task) {
+  size_t index =
+      next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  queues_[index]->PostTask(std::move(task));
+}
+
+// State shared by the ParallelSimulcastEncoder and the encoders it gave to
+// its SimulcastEncoderAdapter.
+class SimulcastLayerGroup {
+ public:
+  // What a layer encoder produced while running on the pool, delivered later
+  // from the encoder thread.
+  struct Output {
+    int layer;
+    webrtc::EncodedImageCallback* callback;
+    // Unset when the frame was dropped.
+    std::optional<webrtc::EncodedImage> image;
+    std::optional<webrtc::CodecSpecificInfo> codec_specific_info;
+    webrtc::EncodedImageCallback::DropReason drop_reason;
+  };
+
+  explicit SimulcastLayerGroup(bool parallel) : parallel_(parallel) {}
+
+  bool parallel() const { return parallel_; }
+
+  void SetStreams(const webrtc::VideoCodec& codec) {
+    webrtc::MutexLock lock(&mutex_);
+    num_streams_ = codec.numberOfSimulcastStreams;
+    active_streams_.clear();
+    for (int i = 0; i < num_streams_; i++) {
+      if (codec.simulcastStream[i].active)
+        active_streams_.push_back(i);
+    }
+    next_stream_ = 0;
+  }
+
+  bool simulcast() const {
+    webrtc::MutexLock lock(&mutex_);
+    return num_streams_ > 1;
+  }
+
+  // SimulcastEncoderAdapter doesn't tell its encoders which stream they
+  // encode, but it initializes one per active stream in stream order after
+  // each SetStreams(). Returns -1 past the active streams.
+  int NextStream() {
+    webrtc::MutexLock lock(&mutex_);
+    if (next_stream_ >= active_streams_.size())
+      return -1;
+    return active_streams_[next_stream_++];
+  }
+
+  void RecordFrame(int64_t elapsed_us) {
+    webrtc::MutexLock lock(&mutex_);
+    record(timings_.frame, elapsed_us);
+  }
+
+  void RecordStream(int stream, int64_t elapsed_us) {
+    webrtc::MutexLock lock(&mutex_);
+    if (timings_.layers.size() <= static_cast<size_t>(stream))
+      timings_.layers.resize(stream + 1);
+    record(timings_.layers[stream], elapsed_us);
+  }
+
+  SimulcastEncodeTimings timings() const {
+    webrtc::MutexLock lock(&mutex_);
+    return timings_;
+  }
+
+  // |encode| must not outlive the current Encode() call, Join() waits for it.
+  void Post(absl::AnyInvocable<int32_t() &&> encode) {
+    {
+      std::lock_guard<std::mutex> lock(join_mutex_);
+      pending_++;
+    }
+
+    GetGlobalSimulcastEncodePool()->Post(
+        [this, encode = std::move(encode)]() mutable {
+          int32_t result = std::move(encode)();
+
+          std::lock_guard<std::mutex> lock(join_mutex_);
+          if (result < 0 && result_ == WEBRTC_VIDEO_CODEC_OK)
+            result_ = result;
+          if (--pending_ == 0)
+            joined_.notify_all();
+        });
+  }
+
+  // Waits for the layers posted since the last call, returns the first error
+  // one of them reported.
+  int32_t Join() {
+    std::unique_lock<std::mutex> lock(join_mutex_);
+    joined_.wait(lock, [this]() { return pending_ == 0; });
+    int32_t result = result_;
+    result_ = WEBRTC_VIDEO_CODEC_OK;
+    return result;
+  }
+
+  void AddOutput(Output output) {
+    webrtc::MutexLock lock(&mutex_);
+    outputs_.push_back(std::move(output));
+  }
+
+  // Delivers the outputs in layer order, like SimulcastEncoderAdapter does
+  // when it encodes its layers one after the other.
+  void Flush() {
+    std::vector<Output> outputs;
+    {
+      webrtc::MutexLock lock(&mutex_);
+      outputs.swap(outputs_);
+    }
+
+    std::stable_sort(
+        outputs.begin(), outputs.end(),
+        [](const Output& a, const Output& b) { return a.layer < b.layer; });
+
+    for (Output& output : outputs) {
+      if (!output.image) {
+        output.callback->OnDroppedFrame(output.drop_reason);
+        continue;
+      }
+      output.callback->OnEncodedImage(
+          *output.image, output.codec_specific_info
+                             ? &*output.codec_specific_info
+                             : nullptr);
+    }
+  }
+
+ private:
+  const bool parallel_;
+
+  mutable webrtc::Mutex mutex_;
+  int num_streams_ RTC_GUARDED_BY(mutex_) = 0;
+  std::vector<int> active_streams_ RTC_GUARDED_BY(mutex_);
+  size_t next_stream_ RTC_GUARDED_BY(mutex_) = 0;
+  SimulcastEncodeTimings timings_ RTC_GUARDED_BY(mutex_);
+  std::vector<Output> outputs_ RTC_GUARDED_BY(mutex_);
+
+  std::mutex join_mutex_;
+  std::condition_variable joined_;
+  int pending_ = 0;
+  int32_t result_ = WEBRTC_VIDEO_CODEC_OK;
+};
+
+namespace {
+
+// Groups of the live ParallelSimulcastEncoders, for GetSimulcastEncodeTimings.
+struct GroupRegistry {
+  webrtc::Mutex mutex;
+  std::vector<std::weak_ptr<SimulcastLayerGroup>> groups RTC_GUARDED_BY(mutex);
+};
+
+GroupRegistry& group_registry() {
+  static GroupRegistry* registry = new GroupRegistry();
+  return *registry;
+}
+
+void RegisterGroup(std::weak_ptr<SimulcastLayerGroup> group) {
+  GroupRegistry& registry = group_registry();
+  webrtc::MutexLock lock(&registry.mutex);
+  registry.groups.push_back(std::move(group));
+}
+
+// Encoder of one simulcast stream, as created by SimulcastEncoderAdapter.
+// Times its encodes and, in parallel mode, runs them on the pool and holds
+// back what they produce until the whole frame is encoded.
+class LayerEncoder : public webrtc::VideoEncoder,
+                     public webrtc::EncodedImageCallback {
+ public:
+  LayerEncoder(std::unique_ptr<webrtc::VideoEncoder> encoder,
+               std::shared_ptr<SimulcastLayerGroup> group)
+      : encoder_(std::move(encoder)), group_(std::move(group)) {}
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override {
+    encoder_->SetFecControllerOverride(fec_controller_override);
+  }
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const webrtc::VideoEncoder::Settings& settings) override {
+    // An encoder given every stream (e.g. libvpx VP8 in serial mode) encodes
+    // them all in one call, its time can't be split between them.
+    if (codec_settings)
+      layer_ = codec_settings->numberOfSimulcastStreams > 1
+                   ? -1
+                   : group_->NextStream();
+    return encoder_->InitEncode(codec_settings, settings);
+  }
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override {
+    callback_ = callback;
+    return encoder_->RegisterEncodeCompleteCallback(callback ? this : nullptr);
+  }
+
+  int32_t Release() override { return encoder_->Release(); }
+
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override {
+    if (!group_->parallel())
+      return TimedEncode(frame, frame_types);
+
+    std::optional<std::vector<webrtc::VideoFrameType>> types;
+    if (frame_types)
+      types = *frame_types;
+
+    group_->Post([this, frame, types = std::move(types)]() {
+      buffering_.store(true, std::memory_order_relaxed);
+      int32_t result = TimedEncode(frame, types ? &*types : nullptr);
+      buffering_.store(false, std::memory_order_relaxed);
+      return result;
+    });
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  void SetRates(const RateControlParameters& parameters) override {
+    encoder_->SetRates(parameters);
+  }
+
+  void OnPacketLossRateUpdate(float packet_loss_rate) override {
+    encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+  }
+
+  void OnRttUpdate(int64_t rtt_ms) override { encoder_->OnRttUpdate(rtt_ms); }
+
+  void OnLossNotification(const LossNotification& loss_notification) override {
+    encoder_->OnLossNotification(loss_notification);
+  }
+
+  EncoderInfo GetEncoderInfo() const override {
+    EncoderInfo info = encoder_->GetEncoderInfo();
+    // libvpx VP8 encodes every stream itself, one after the other. Have the
+    // adapter create one encoder per stream so they can run concurrently.
+    if (group_->parallel())
+      info.supports_simulcast = false;
+    return info;
+  }
+
+  Result OnEncodedImage(
+      const webrtc::EncodedImage& encoded_image,
+      const webrtc::CodecSpecificInfo* codec_specific_info) override {
+    if (!buffering_.load(std::memory_order_relaxed))
+      return callback_->OnEncodedImage(encoded_image, codec_specific_info);
+
+    // The encoder may reuse its buffer for the next frame.
+    webrtc::EncodedImage image = encoded_image;
+    image.SetEncodedData(webrtc::EncodedImageBuffer::Create(
+        encoded_image.data(), encoded_image.size()));
+
+    SimulcastLayerGroup::Output output{std::max(layer_, 0), callback_,
+                                       std::move(image)};
+    if (codec_specific_info)
+      output.codec_specific_info = *codec_specific_info;
+    group_->AddOutput(std::move(output));
+    return Result(Result::OK);
+  }
+
+  void OnDroppedFrame(DropReason reason) override {
+    if (!buffering_.load(std::memory_order_relaxed)) {
+      callback_->OnDroppedFrame(reason);
+      return;
+    }
+    group_->AddOutput({std::max(layer_, 0), callback_, std::nullopt,
+                       std::nullopt, reason});
+  }
+
+ private:
+  int32_t TimedEncode(const webrtc::VideoFrame& frame,
+                      const std::vector<webrtc::VideoFrameType>* frame_types) {
+    int64_t start_us = webrtc::TimeMicros();
+    int32_t result = encoder_->Encode(frame, frame_types);
+    if (layer_ >= 0 && group_->simulcast())
+      group_->RecordStream(layer_, webrtc::TimeMicros() - start_us);
+    return result;
+  }
+
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  std::shared_ptr<SimulcastLayerGroup> group_;
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+  // Simulcast stream encoded, -1 when it encodes all of them.
+  int layer_ = -1;
+  // Set while Encode() runs on the pool.
+  std::atomic<bool> buffering_{false};
+};
+
+}  // namespace
+
+class ParallelSimulcastEncoder::LayerFactory
+    : public webrtc::VideoEncoderFactory {
+ public:
+  LayerFactory(webrtc::VideoEncoderFactory* factory,
+               std::shared_ptr<SimulcastLayerGroup> group)
+      : factory_(factory), group_(std::move(group)) {}
+
+  std::vector<webrtc::SdpVideoFormat> GetSupportedFormats() const override {
+    return factory_->GetSupportedFormats();
+  }
+
+  CodecSupport QueryCodecSupport(
+      const webrtc::SdpVideoFormat& format,
+      std::optional<std::string> scalability_mode) const override {
+    return factory_->QueryCodecSupport(format, scalability_mode);
+  }
+
+  std::unique_ptr<webrtc::VideoEncoder> Create(
+      const webrtc::Environment& env,
+      const webrtc::SdpVideoFormat& format) override {
+    std::unique_ptr<webrtc::VideoEncoder> encoder =
+        factory_->Create(env, format);
+    if (!encoder)
+      return nullptr;
+    return std::make_unique<LayerEncoder>(std::move(encoder), group_);
+  }
+
+ private:
+  webrtc::VideoEncoderFactory* factory_;
+  std::shared_ptr<SimulcastLayerGroup> group_;
+};
+
+ParallelSimulcastEncoder::ParallelSimulcastEncoder(
+    const webrtc::Environment& env,
+    webrtc::VideoEncoderFactory* factory,
+    const webrtc::SdpVideoFormat& format,
+    bool parallel)
+    : group_(std::make_shared<SimulcastLayerGroup>(parallel)),
+      layer_factory_(std::make_unique<LayerFactory>(factory, group_)),
+      adapter_(std::make_unique<webrtc::SimulcastEncoderAdapter>(
+          env,
+          layer_factory_.get(),
+          nullptr,
+          format)) {
+  RegisterGroup(group_);
+}
+
+ParallelSimulcastEncoder::~ParallelSimulcastEncoder() = default;
+
+void ParallelSimulcastEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  adapter_->SetFecControllerOverride(fec_controller_override);
+}
+
+int32_t ParallelSimulcastEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  if (codec_settings)
+    group_->SetStreams(*codec_settings);
+  return adapter_->InitEncode(codec_settings, settings);
+}
+
+int32_t ParallelSimulcastEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  return adapter_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t ParallelSimulcastEncoder::Release() {
+  return adapter_->Release();
+}
+
+int32_t ParallelSimulcastEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  int64_t start_us = webrtc::TimeMicros();
+
+  // In parallel mode the adapter only posts the layer encodes.
+  int32_t result = adapter_->Encode(frame, frame_types);
+  if (group_->parallel()) {
+    int32_t layers_result = group_->Join();
+    group_->Flush();
+    if (result == WEBRTC_VIDEO_CODEC_OK)
+      result = layers_result;
+  }
+
+  if (group_->simulcast())
+    group_->RecordFrame(webrtc::TimeMicros() - start_us);
+  return result;
+}
+
+void ParallelSimulcastEncoder::SetRates(
+    const RateControlParameters& parameters) {
+  adapter_->SetRates(parameters);
+}
+
+void ParallelSimulcastEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  adapter_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void ParallelSimulcastEncoder::OnRttUpdate(int64_t rtt_ms) {
+  adapter_->OnRttUpdate(rtt_ms);
+}
+
+void ParallelSimulcastEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  adapter_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo ParallelSimulcastEncoder::GetEncoderInfo()
+    const {
+  return adapter_->GetEncoderInfo();
+}
+
+std::vector<SimulcastEncodeTimings> GetSimulcastEncodeTimings() {
+  GroupRegistry& registry = group_registry();
+  webrtc::MutexLock lock(&registry.mutex);
+
+  std::vector<SimulcastEncodeTimings> timings;
+  auto it = registry.groups.begin();
+  while (it != registry.groups.end()) {
+    std::shared_ptr<SimulcastLayerGroup> group = it->lock();
+    if (!group) {
+      it = registry.groups.erase(it);
+      continue;
+    }
+    if (group->simulcast())
+      timings.push_back(group->timings());
+    ++it;
+  }
+  return timings;
+}
+
+}  // namespace livekit_ffi
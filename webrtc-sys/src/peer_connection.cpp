@@ -23,6 +23,7 @@
 #include "api/peer_connection_interface.h"
 #include "api/scoped_refptr.h"
 #include "livekit/data_channel.h"
+#include "livekit/encoded_passthrough.h"
 #include "livekit/jsep.h"
 #include "livekit/media_stream.h"
 #include "livekit/rtc_error.h"
@@ -196,6 +197,7 @@ std::shared_ptr<RtpSender> PeerConnection::add_track(
     throw std::runtime_error(serialize_error(to_error(result.error())));
   }
 
+  AttachEncodedAudioSource(result.value().get());
   return std::make_shared<RtpSender>(rtc_runtime_, result.value(),
                                      peer_connection_);
 }
@@ -208,9 +210,11 @@ void PeerConnection::remove_track(std::shared_ptr<RtpSender> sender) const {
 
 void PeerConnection::get_stats(
     rust::Box<PeerContext> ctx,
-    rust::Fn<void(rust::Box<PeerContext>, rust::String)> on_stats) const {
+    bool delta,
+    rust::Fn<void(rust::Box<PeerContext>, rust::Vec<RtcStatsRecord>)> on_stats)
+    const {
   auto observer = webrtc::make_ref_counted<NativeRtcStatsCollector<PeerContext>>(
-      std::move(ctx), on_stats);
+      std::move(ctx), delta ? stats_delta_ : nullptr, on_stats);
   peer_connection_->GetStats(observer.get());
 }
 
@@ -222,6 +226,8 @@ std::shared_ptr<RtpTransceiver> PeerConnection::add_transceiver(
   if (!result.ok())
     throw std::runtime_error(serialize_error(to_error(result.error())));
 
+  AttachEncodedAudioSource(result.value()->sender().get());
+
   return std::make_shared<RtpTransceiver>(rtc_runtime_, result.value(),
                                           peer_connection_);
 }
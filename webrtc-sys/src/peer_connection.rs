@@ -105,6 +105,7 @@ pub mod ffi {
         include!("livekit/data_channel.h");
         include!("livekit/jsep.h");
         include!("livekit/webrtc.h");
+        include!("livekit/stats.h");
 
         type RtpSenderPtr = crate::helper::ffi::RtpSenderPtr;
         type RtpReceiverPtr = crate::helper::ffi::RtpReceiverPtr;
@@ -122,6 +123,7 @@ pub mod ffi {
         type MediaStreamTrack = crate::media_stream::ffi::MediaStreamTrack;
         type SessionDescription = crate::jsep::ffi::SessionDescription;
         type MediaType = crate::webrtc::ffi::MediaType;
+        type RtcStatsRecord = crate::stats::ffi::RtcStatsRecord;
     }
 
     unsafe extern "C++" {
@@ -166,7 +168,8 @@ pub mod ffi {
         fn get_stats(
             self: &PeerConnection,
             ctx: Box<PeerContext>,
-            on_stats: fn(ctx: Box<PeerContext>, json: String),
+            delta: bool,
+            on_stats: fn(ctx: Box<PeerContext>, stats: Vec<RtcStatsRecord>),
         );
         fn add_transceiver(
             self: &PeerConnection,
@@ -140,6 +140,12 @@ RtpCapabilities PeerConnectionFactory::rtp_receiver_capabilities(
       static_cast<webrtc::MediaType>(type)));
 }
 
+void PeerConnectionFactory::set_video_decoder_threading(
+    VideoDecoderThreading threading) const {
+  SetVideoDecoderThreads(static_cast<int>(threading.threads_per_decoder),
+                         static_cast<int>(threading.max_total_threads));
+}
+
 std::shared_ptr<PeerConnectionFactory> create_peer_connection_factory() {
   return std::make_shared<PeerConnectionFactory>(RtcRuntime::create());
 }
@@ -36,6 +36,13 @@ pub mod ffi {
         estimated_disconnected_time_ms: i64,
     }
 
+    /// Threads of the video decoders, 0 for no limit. See
+    /// SetVideoDecoderThreads in video_decoder_factory.h.
+    pub struct VideoDecoderThreading {
+        pub threads_per_decoder: u32,
+        pub max_total_threads: u32,
+    }
+
     extern "C++" {
         include!("livekit/rtp_parameters.h");
         include!("livekit/rtc_error.h");
@@ -116,6 +123,11 @@ pub mod ffi {
             self: &PeerConnectionFactory,
             kind: MediaType,
         ) -> RtpCapabilities;
+
+        fn set_video_decoder_threading(
+            self: &PeerConnectionFactory,
+            threading: VideoDecoderThreading,
+        );
     }
 
     extern "Rust" {
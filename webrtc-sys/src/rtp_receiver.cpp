@@ -20,11 +20,103 @@
 #include <memory>
 
 #include "absl/types/optional.h"
+#include "api/frame_transformer_interface.h"
 #include "api/peer_connection_interface.h"
 #include "api/scoped_refptr.h"
+#include "api/video/video_frame_metadata.h"
+#include "rtc_base/time_utils.h"
 
 namespace livekit_ffi {
 
+EncodedFrameTapTransformer::EncodedFrameTapTransformer(
+    rust::Box<EncodedFrameSinkWrapper> observer,
+    bool video,
+    bool decode)
+    : video_(video), decode_(decode), observer_(std::move(observer)) {}
+
+EncodedFrameTapTransformer::~EncodedFrameTapTransformer() {}
+
+void EncodedFrameTapTransformer::Detach() {
+  webrtc::MutexLock lock(&mutex_);
+  observer_.reset();
+}
+
+void EncodedFrameTapTransformer::Transform(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  const uint32_t ssrc = frame->GetSsrc();
+  bool forward = true;
+  webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (observer_) {
+      EncodedFrameInfo info{};
+      info.keyframe = true;  // Every audio frame can be decoded on its own.
+      info.rtp_timestamp = frame->GetTimestamp();
+      info.ssrc = ssrc;
+      info.payload_type = frame->GetPayloadType();
+      info.mime_type = frame->GetMimeType();
+      info.receive_time_us = webrtc::TimeMicros();
+      if (video_) {
+        auto* video_frame =
+            static_cast<webrtc::TransformableVideoFrameInterface*>(frame.get());
+        webrtc::VideoFrameMetadata metadata = video_frame->Metadata();
+        info.keyframe = video_frame->IsKeyFrame();
+        info.width = metadata.GetWidth();
+        info.height = metadata.GetHeight();
+      }
+
+      auto data = frame->GetData();
+      (*observer_)->on_encoded_frame(
+          info, rust::Slice<const uint8_t>(data.data(), data.size()));
+
+      if (!decode_) {
+        if (!video_)
+          forward = false;
+        else
+          frame->SetData(webrtc::ArrayView<const uint8_t>());
+      }
+    }
+
+    auto it = sink_callbacks_.find(ssrc);
+    callback = it != sink_callbacks_.end() ? it->second : callback_;
+  }
+
+  if (forward && callback)
+    callback->OnTransformedFrame(std::move(frame));
+}
+
+void EncodedFrameTapTransformer::RegisterTransformedFrameCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = std::move(callback);
+}
+
+void EncodedFrameTapTransformer::RegisterTransformedFrameSinkCallback(
+    webrtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+    uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_[ssrc] = std::move(callback);
+}
+
+void EncodedFrameTapTransformer::UnregisterTransformedFrameCallback() {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = nullptr;
+}
+
+void EncodedFrameTapTransformer::UnregisterTransformedFrameSinkCallback(
+    uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_.erase(ssrc);
+}
+
+EncodedFrameTap::EncodedFrameTap(
+    webrtc::scoped_refptr<EncodedFrameTapTransformer> transformer)
+    : transformer_(std::move(transformer)) {}
+
+EncodedFrameTap::~EncodedFrameTap() {
+  transformer_->Detach();
+}
+
 RtpReceiver::RtpReceiver(
     std::shared_ptr<RtcRuntime> rtc_runtime,
     webrtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
@@ -46,9 +138,11 @@ rust::Vec<rust::String> RtpReceiver::stream_ids() const {
 
 void RtpReceiver::get_stats(
     rust::Box<ReceiverContext> ctx,
-    rust::Fn<void(rust::Box<ReceiverContext>, rust::String)> on_stats) const {
-	auto observer = 
-      webrtc::make_ref_counted<NativeRtcStatsCollector<ReceiverContext>>(std::move(ctx), on_stats);
+    bool delta,
+    rust::Fn<void(rust::Box<ReceiverContext>, rust::Vec<RtcStatsRecord>)> on_stats)
+    const {
+  auto observer = webrtc::make_ref_counted<NativeRtcStatsCollector<ReceiverContext>>(
+      std::move(ctx), delta ? stats_delta_ : nullptr, on_stats);
   peer_connection_->GetStats(receiver_, observer);
 }
 
@@ -78,4 +172,15 @@ void RtpReceiver::set_jitter_buffer_minimum_delay(bool is_some,
       is_some ? absl::make_optional(delay_seconds) : absl::nullopt);
 }
 
+std::shared_ptr<EncodedFrameTap> RtpReceiver::add_encoded_frame_tap(
+    rust::Box<EncodedFrameSinkWrapper> observer,
+    bool decode) const {
+  bool video = receiver_->track()->kind() ==
+               webrtc::MediaStreamTrackInterface::kVideoKind;
+  auto transformer = webrtc::make_ref_counted<EncodedFrameTapTransformer>(
+      std::move(observer), video, decode);
+  receiver_->SetDepacketizerToDecoderFrameTransformer(transformer);
+  return std::make_shared<EncodedFrameTap>(transformer);
+}
+
 }  // namespace livekit_ffi
@@ -13,35 +13,55 @@
 // limitations under the License.
 
 use std::any::Any;
+use std::sync::Arc;
 
 use crate::impl_thread_safety;
 
 #[cxx::bridge(namespace = "livekit_ffi")]
 pub mod ffi {
+    /// Received encoded frame, before decoding.
+    #[derive(Debug)]
+    pub struct EncodedFrameInfo {
+        /// Always true for audio.
+        pub keyframe: bool,
+        pub rtp_timestamp: u32,
+        pub ssrc: u32,
+        pub payload_type: u8,
+        /// e.g. "video/VP8" or "audio/opus".
+        pub mime_type: String,
+        /// 0 for audio.
+        pub width: u32,
+        pub height: u32,
+        pub receive_time_us: i64,
+    }
 
     extern "C++" {
         include!("livekit/webrtc.h");
         include!("livekit/rtp_parameters.h");
         include!("livekit/helper.h");
         include!("livekit/media_stream.h");
+        include!("livekit/stats.h");
 
         type MediaType = crate::webrtc::ffi::MediaType;
         type RtpParameters = crate::rtp_parameters::ffi::RtpParameters;
         type MediaStreamPtr = crate::helper::ffi::MediaStreamPtr;
         type MediaStreamTrack = crate::media_stream::ffi::MediaStreamTrack;
         type MediaStream = crate::media_stream::ffi::MediaStream;
+        type RtcStatsRecord = crate::stats::ffi::RtcStatsRecord;
     }
 
     unsafe extern "C++" {
         include!("livekit/rtp_receiver.h");
 
         type RtpReceiver;
+        type EncodedFrameTap;
 
         fn track(self: &RtpReceiver) -> SharedPtr<MediaStreamTrack>;
         fn get_stats(
             self: &RtpReceiver,
             ctx: Box<ReceiverContext>,
-            on_stats: fn(ctx: Box<ReceiverContext>, json: String),
+            delta: bool,
+            on_stats: fn(ctx: Box<ReceiverContext>, stats: Vec<RtcStatsRecord>),
         );
         fn stream_ids(self: &RtpReceiver) -> Vec<String>;
         fn streams(self: &RtpReceiver) -> Vec<MediaStreamPtr>;
@@ -49,15 +69,43 @@ pub mod ffi {
         fn id(self: &RtpReceiver) -> String;
         fn get_parameters(self: &RtpReceiver) -> RtpParameters;
         fn set_jitter_buffer_minimum_delay(self: &RtpReceiver, is_some: bool, delay_seconds: f64);
+        fn add_encoded_frame_tap(
+            self: &RtpReceiver,
+            observer: Box<EncodedFrameSinkWrapper>,
+            decode: bool,
+        ) -> SharedPtr<EncodedFrameTap>;
 
         fn _shared_rtp_receiver() -> SharedPtr<RtpReceiver>;
     }
 
     extern "Rust" {
         type ReceiverContext;
+        type EncodedFrameSinkWrapper;
+
+        fn on_encoded_frame(self: &EncodedFrameSinkWrapper, info: &EncodedFrameInfo, data: &[u8]);
     }
 }
 
 pub struct ReceiverContext(pub Box<dyn Any + Send>);
 
 impl_thread_safety!(ffi::RtpReceiver, Send + Sync);
+impl_thread_safety!(ffi::EncodedFrameTap, Send + Sync);
+
+pub trait EncodedFrameSink: Send + Sync {
+    /// `data` is only borrowed for the duration of the call.
+    fn on_encoded_frame(&self, info: &ffi::EncodedFrameInfo, data: &[u8]);
+}
+
+pub struct EncodedFrameSinkWrapper {
+    observer: Arc<dyn EncodedFrameSink>,
+}
+
+impl EncodedFrameSinkWrapper {
+    pub fn new(observer: Arc<dyn EncodedFrameSink>) -> Self {
+        Self { observer }
+    }
+
+    fn on_encoded_frame(&self, info: &ffi::EncodedFrameInfo, data: &[u8]) {
+        self.observer.on_encoded_frame(info, data);
+    }
+}
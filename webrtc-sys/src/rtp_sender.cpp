@@ -46,9 +46,11 @@ uint32_t RtpSender::ssrc() const {
 
 void RtpSender::get_stats(
     rust::Box<SenderContext> ctx,
-    rust::Fn<void(rust::Box<SenderContext>, rust::String)> on_stats) const {
-  auto observer =
-      webrtc::make_ref_counted<NativeRtcStatsCollector<SenderContext>>(std::move(ctx), on_stats);
+    bool delta,
+    rust::Fn<void(rust::Box<SenderContext>, rust::Vec<RtcStatsRecord>)> on_stats)
+    const {
+  auto observer = webrtc::make_ref_counted<NativeRtcStatsCollector<SenderContext>>(
+      std::move(ctx), delta ? stats_delta_ : nullptr, on_stats);
   peer_connection_->GetStats(sender_, observer);
 }
 
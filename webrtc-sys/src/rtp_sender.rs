@@ -23,11 +23,13 @@ pub mod ffi {
         include!("livekit/webrtc.h");
         include!("livekit/rtp_parameters.h");
         include!("livekit/media_stream.h");
+        include!("livekit/stats.h");
 
         type MediaType = crate::webrtc::ffi::MediaType;
         type RtpEncodingParameters = crate::rtp_parameters::ffi::RtpEncodingParameters;
         type RtpParameters = crate::rtp_parameters::ffi::RtpParameters;
         type MediaStreamTrack = crate::media_stream::ffi::MediaStreamTrack;
+        type RtcStatsRecord = crate::stats::ffi::RtcStatsRecord;
     }
 
     unsafe extern "C++" {
@@ -40,7 +42,8 @@ pub mod ffi {
         fn get_stats(
             self: &RtpSender,
             ctx: Box<SenderContext>,
-            on_stats: fn(ctx: Box<SenderContext>, json: String),
+            delta: bool,
+            on_stats: fn(ctx: Box<SenderContext>, stats: Vec<RtcStatsRecord>),
         );
         fn ssrc(self: &RtpSender) -> u32;
         fn media_type(self: &RtpSender) -> MediaType;
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/simulcast_pyramid.h"
+
+#include <algorithm>
+
+#include "api/make_ref_counted.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "api/video_codecs/video_codec.h"
+#include "third_party/libyuv/include/libyuv/scale.h"
+
+namespace livekit_ffi {
+
+namespace {
+
+using Levels = std::vector<webrtc::scoped_refptr<webrtc::VideoFrameBuffer>>;
+
+webrtc::scoped_refptr<webrtc::VideoFrameBuffer> FindLevel(const Levels& levels,
+                                                          int width,
+                                                          int height) {
+  for (const auto& level : levels) {
+    if (level->width() == width && level->height() == height)
+      return level;
+  }
+  return nullptr;
+}
+
+bool IsFullFrame(const webrtc::VideoFrameBuffer& buffer,
+                 int offset_x,
+                 int offset_y,
+                 int crop_width,
+                 int crop_height) {
+  return offset_x == 0 && offset_y == 0 && crop_width == buffer.width() &&
+         crop_height == buffer.height();
+}
+
+class PyramidI420Buffer : public webrtc::I420BufferInterface {
+ public:
+  PyramidI420Buffer(webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source,
+                    Levels levels)
+      : source_(std::move(source)),
+        planes_(source_->GetI420()),
+        levels_(std::move(levels)) {}
+
+  int width() const override { return planes_->width(); }
+  int height() const override { return planes_->height(); }
+  const uint8_t* DataY() const override { return planes_->DataY(); }
+  const uint8_t* DataU() const override { return planes_->DataU(); }
+  const uint8_t* DataV() const override { return planes_->DataV(); }
+  int StrideY() const override { return planes_->StrideY(); }
+  int StrideU() const override { return planes_->StrideU(); }
+  int StrideV() const override { return planes_->StrideV(); }
+
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override {
+    if (IsFullFrame(*this, offset_x, offset_y, crop_width, crop_height)) {
+      if (auto level = FindLevel(levels_, scaled_width, scaled_height))
+        return level;
+    }
+    return source_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+
+ private:
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source_;
+  const webrtc::I420BufferInterface* planes_;
+  Levels levels_;
+};
+
+class PyramidNV12Buffer : public webrtc::NV12BufferInterface {
+ public:
+  PyramidNV12Buffer(webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source,
+                    Levels levels)
+      : source_(std::move(source)),
+        planes_(source_->GetNV12()),
+        levels_(std::move(levels)) {}
+
+  int width() const override { return planes_->width(); }
+  int height() const override { return planes_->height(); }
+  const uint8_t* DataY() const override { return planes_->DataY(); }
+  const uint8_t* DataUV() const override { return planes_->DataUV(); }
+  int StrideY() const override { return planes_->StrideY(); }
+  int StrideUV() const override { return planes_->StrideUV(); }
+
+  webrtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override {
+    return source_->ToI420();
+  }
+
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override {
+    if (IsFullFrame(*this, offset_x, offset_y, crop_width, crop_height)) {
+      if (auto level = FindLevel(levels_, scaled_width, scaled_height))
+        return level;
+    }
+    return source_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+
+ private:
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source_;
+  const webrtc::NV12BufferInterface* planes_;
+  Levels levels_;
+};
+
+}  // namespace
+
+FramePyramid::FramePyramid() = default;
+
+FramePyramid::~FramePyramid() = default;
+
+webrtc::scoped_refptr<webrtc::VideoFrameBuffer> FramePyramid::Build(
+    webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source,
+    std::vector<Size> sizes) {
+  const webrtc::VideoFrameBuffer::Type type = source->type();
+  if (type != webrtc::VideoFrameBuffer::Type::kI420 &&
+      type != webrtc::VideoFrameBuffer::Type::kNV12)
+    return source;
+
+  std::sort(sizes.begin(), sizes.end(), [](const Size& a, const Size& b) {
+    return a.width * a.height > b.width * b.height;
+  });
+
+  Levels levels;
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> previous = source;
+  for (const Size& size : sizes) {
+    if (size.width <= 0 || size.height <= 0 ||
+        size.width * size.height >= source->width() * source->height() ||
+        size.width > source->width() || size.height > source->height() ||
+        FindLevel(levels, size.width, size.height))
+      continue;
+
+    if (pools_.size() <= levels.size())
+      pools_.push_back(std::make_unique<webrtc::VideoFrameBufferPool>());
+    webrtc::VideoFrameBufferPool& pool = *pools_[levels.size()];
+
+    if (type == webrtc::VideoFrameBuffer::Type::kI420) {
+      webrtc::scoped_refptr<webrtc::I420Buffer> dst =
+          pool.CreateI420Buffer(size.width, size.height);
+      if (!dst)
+        break;
+
+      const webrtc::I420BufferInterface* src = previous->GetI420();
+      libyuv::I420Scale(src->DataY(), src->StrideY(), src->DataU(),
+                        src->StrideU(), src->DataV(), src->StrideV(),
+                        src->width(), src->height(), dst->MutableDataY(),
+                        dst->StrideY(), dst->MutableDataU(), dst->StrideU(),
+                        dst->MutableDataV(), dst->StrideV(), dst->width(),
+                        dst->height(), libyuv::kFilterBox);
+      levels.push_back(dst);
+    } else {
+      webrtc::scoped_refptr<webrtc::NV12Buffer> dst =
+          pool.CreateNV12Buffer(size.width, size.height);
+      if (!dst)
+        break;
+
+      const webrtc::NV12BufferInterface* src = previous->GetNV12();
+      libyuv::NV12Scale(src->DataY(), src->StrideY(), src->DataUV(),
+                        src->StrideUV(), src->width(), src->height(),
+                        dst->MutableDataY(), dst->StrideY(),
+                        dst->MutableDataUV(), dst->StrideUV(), dst->width(),
+                        dst->height(), libyuv::kFilterBox);
+      levels.push_back(dst);
+    }
+    previous = levels.back();
+  }
+
+  if (levels.empty())
+    return source;
+
+  if (type == webrtc::VideoFrameBuffer::Type::kI420)
+    return webrtc::make_ref_counted<PyramidI420Buffer>(std::move(source),
+                                                       std::move(levels));
+  return webrtc::make_ref_counted<PyramidNV12Buffer>(std::move(source),
+                                                     std::move(levels));
+}
+
+SimulcastPyramidEncoder::SimulcastPyramidEncoder(
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : encoder_(std::move(encoder)) {}
+
+void SimulcastPyramidEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int32_t SimulcastPyramidEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  layers_.clear();
+  if (codec_settings && codec_settings->numberOfSimulcastStreams > 1) {
+    for (int i = 0; i < codec_settings->numberOfSimulcastStreams; i++) {
+      const webrtc::SimulcastStream& stream = codec_settings->simulcastStream[i];
+      layers_.push_back({stream.width, stream.height, stream.active});
+    }
+  }
+  return encoder_->InitEncode(codec_settings, settings);
+}
+
+int32_t SimulcastPyramidEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t SimulcastPyramidEncoder::Release() {
+  layers_.clear();
+  return encoder_->Release();
+}
+
+int32_t SimulcastPyramidEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  std::vector<FramePyramid::Size> sizes;
+  for (const Layer& layer : layers_) {
+    if (layer.active &&
+        (layer.width != frame.width() || layer.height != frame.height()))
+      sizes.push_back({layer.width, layer.height});
+  }
+
+  if (sizes.empty())
+    return encoder_->Encode(frame, frame_types);
+
+  webrtc::VideoFrame scaled_frame = frame;
+  scaled_frame.set_video_frame_buffer(
+      pyramid_.Build(frame.video_frame_buffer(), std::move(sizes)));
+  return encoder_->Encode(scaled_frame, frame_types);
+}
+
+void SimulcastPyramidEncoder::SetRates(
+    const RateControlParameters& parameters) {
+  // Paused layers are not encoded, don't scale for them.
+  for (size_t i = 0; i < layers_.size(); i++)
+    layers_[i].active = parameters.bitrate.GetSpatialLayerSum(i) > 0;
+  encoder_->SetRates(parameters);
+}
+
+void SimulcastPyramidEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void SimulcastPyramidEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void SimulcastPyramidEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo SimulcastPyramidEncoder::GetEncoderInfo()
+    const {
+  return encoder_->GetEncoderInfo();
+}
+
+}  // namespace livekit_ffi
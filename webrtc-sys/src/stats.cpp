@@ -0,0 +1,207 @@
+/*
+ * Copyright 2025 LiveKit, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/stats.h"
+
+#include <cstring>
+#include <map>
+
+#include "api/stats/attribute.h"
+#include "api/stats/rtc_stats.h"
+
+namespace livekit_ffi {
+
+namespace {
+
+template <typename T, typename U>
+void push_all(rust::Vec<T>& dst, const std::vector<U>& src) {
+  dst.reserve(src.size());
+  for (const U& value : src)
+    dst.push_back(static_cast<T>(value));
+}
+
+template <typename T>
+void push_map(RtcStatsMember& member,
+              rust::Vec<T>& values,
+              const std::map<std::string, T>& map) {
+  member.string_values.reserve(map.size());
+  values.reserve(map.size());
+  for (const auto& [key, value] : map) {
+    member.string_values.push_back(key);
+    values.push_back(value);
+  }
+}
+
+RtcStatsMember to_rust_member(const webrtc::Attribute& attribute) {
+  RtcStatsMember member{};
+  member.name = attribute.name();
+
+  if (attribute.holds_alternative<bool>()) {
+    member.kind = RtcStatsMemberKind::Bool;
+    member.bool_value = attribute.get<bool>();
+  } else if (attribute.holds_alternative<int32_t>()) {
+    member.kind = RtcStatsMemberKind::Int;
+    member.int_value = attribute.get<int32_t>();
+  } else if (attribute.holds_alternative<int64_t>()) {
+    member.kind = RtcStatsMemberKind::Int;
+    member.int_value = attribute.get<int64_t>();
+  } else if (attribute.holds_alternative<uint32_t>()) {
+    member.kind = RtcStatsMemberKind::Uint;
+    member.uint_value = attribute.get<uint32_t>();
+  } else if (attribute.holds_alternative<uint64_t>()) {
+    member.kind = RtcStatsMemberKind::Uint;
+    member.uint_value = attribute.get<uint64_t>();
+  } else if (attribute.holds_alternative<double>()) {
+    member.kind = RtcStatsMemberKind::Double;
+    member.double_value = attribute.get<double>();
+  } else if (attribute.holds_alternative<std::string>()) {
+    member.kind = RtcStatsMemberKind::String;
+    member.string_value = attribute.get<std::string>();
+  } else if (attribute.holds_alternative<std::vector<bool>>()) {
+    member.kind = RtcStatsMemberKind::BoolSequence;
+    push_all(member.bool_values, attribute.get<std::vector<bool>>());
+  } else if (attribute.holds_alternative<std::vector<int32_t>>()) {
+    member.kind = RtcStatsMemberKind::IntSequence;
+    push_all(member.int_values, attribute.get<std::vector<int32_t>>());
+  } else if (attribute.holds_alternative<std::vector<int64_t>>()) {
+    member.kind = RtcStatsMemberKind::IntSequence;
+    push_all(member.int_values, attribute.get<std::vector<int64_t>>());
+  } else if (attribute.holds_alternative<std::vector<uint32_t>>()) {
+    member.kind = RtcStatsMemberKind::UintSequence;
+    push_all(member.uint_values, attribute.get<std::vector<uint32_t>>());
+  } else if (attribute.holds_alternative<std::vector<uint64_t>>()) {
+    member.kind = RtcStatsMemberKind::UintSequence;
+    push_all(member.uint_values, attribute.get<std::vector<uint64_t>>());
+  } else if (attribute.holds_alternative<std::vector<double>>()) {
+    member.kind = RtcStatsMemberKind::DoubleSequence;
+    push_all(member.double_values, attribute.get<std::vector<double>>());
+  } else if (attribute.holds_alternative<std::vector<std::string>>()) {
+    member.kind = RtcStatsMemberKind::StringSequence;
+    push_all(member.string_values, attribute.get<std::vector<std::string>>());
+  } else if (attribute.holds_alternative<std::map<std::string, uint64_t>>()) {
+    member.kind = RtcStatsMemberKind::UintMap;
+    push_map(member, member.uint_values,
+             attribute.get<std::map<std::string, uint64_t>>());
+  } else if (attribute.holds_alternative<std::map<std::string, double>>()) {
+    member.kind = RtcStatsMemberKind::DoubleMap;
+    push_map(member, member.double_values,
+             attribute.get<std::map<std::string, double>>());
+  }
+
+  return member;
+}
+
+// Scalar attributes are compared on their raw bits, avoids a string per
+// attribute per poll.
+bool scalar_bits(const webrtc::Attribute& attribute, uint64_t* bits) {
+  if (attribute.holds_alternative<bool>()) {
+    *bits = attribute.get<bool>();
+  } else if (attribute.holds_alternative<int32_t>()) {
+    *bits = static_cast<uint64_t>(int64_t{attribute.get<int32_t>()});
+  } else if (attribute.holds_alternative<int64_t>()) {
+    *bits = static_cast<uint64_t>(attribute.get<int64_t>());
+  } else if (attribute.holds_alternative<uint32_t>()) {
+    *bits = attribute.get<uint32_t>();
+  } else if (attribute.holds_alternative<uint64_t>()) {
+    *bits = attribute.get<uint64_t>();
+  } else if (attribute.holds_alternative<double>()) {
+    double value = attribute.get<double>();
+    memcpy(bits, &value, sizeof(value));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+RtcStatsRecord to_rust_record(const webrtc::RTCStats& stats) {
+  RtcStatsRecord record{};
+  record.id = stats.id();
+  record.stats_type = stats.type();
+  record.timestamp_us = stats.timestamp().us();
+  return record;
+}
+
+}  // namespace
+
+rust::Vec<RtcStatsRecord> to_rust_stats(const webrtc::RTCStatsReport& report) {
+  rust::Vec<RtcStatsRecord> records;
+  records.reserve(report.size());
+  for (const webrtc::RTCStats& stats : report) {
+    RtcStatsRecord record = to_rust_record(stats);
+    for (const webrtc::Attribute& attribute : stats.Attributes()) {
+      if (attribute.has_value())
+        record.members.push_back(to_rust_member(attribute));
+    }
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+rust::Vec<RtcStatsRecord> RtcStatsDelta::Diff(
+    const webrtc::RTCStatsReport& report) {
+  webrtc::MutexLock lock(&mutex_);
+
+  for (auto& [id, entry] : entries_)
+    entry.seen = false;
+
+  rust::Vec<RtcStatsRecord> records;
+  for (const webrtc::RTCStats& stats : report) {
+    Entry& entry = entries_[stats.id()];
+    entry.seen = true;
+
+    // Attributes() always lists every attribute of the type in the same
+    // order, so values can be matched by index.
+    std::vector<webrtc::Attribute> attributes = stats.Attributes();
+    if (entry.type != stats.type() ||
+        entry.values.size() != attributes.size()) {
+      entry.type = stats.type();
+      entry.values.assign(attributes.size(), Value());
+    }
+
+    RtcStatsRecord record = to_rust_record(stats);
+    for (size_t i = 0; i < attributes.size(); i++) {
+      const webrtc::Attribute& attribute = attributes[i];
+      if (!attribute.has_value())
+        continue;
+
+      Value& previous = entry.values[i];
+      Value current;
+      current.has_value = true;
+      if (!scalar_bits(attribute, &current.bits)) {
+        current.text = attribute.holds_alternative<std::string>()
+                           ? attribute.get<std::string>()
+                           : attribute.ToString();
+      }
+
+      if (previous.has_value && previous.bits == current.bits &&
+          previous.text == current.text)
+        continue;
+
+      previous = std::move(current);
+      record.members.push_back(to_rust_member(attribute));
+    }
+
+    if (!record.members.empty())
+      records.push_back(std::move(record));
+  }
+
+  // Forget the objects that are gone (closed transports, removed tracks...).
+  std::erase_if(entries_, [](const auto& item) { return !item.second.seen; });
+
+  return records;
+}
+
+}  // namespace livekit_ffi
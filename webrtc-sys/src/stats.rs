@@ -0,0 +1,73 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RTCStatsReport handed over as flat typed records, without going through JSON.
+
+#[cxx::bridge(namespace = "livekit_ffi")]
+pub mod ffi {
+    #[derive(Debug, Clone, Copy, PartialEq, Eq)]
+    #[repr(i32)]
+    pub enum RtcStatsMemberKind {
+        Bool,
+        Int,
+        Uint,
+        Double,
+        String,
+        BoolSequence,
+        IntSequence,
+        UintSequence,
+        DoubleSequence,
+        StringSequence,
+        /// Keys in `string_values`, values in `uint_values`.
+        UintMap,
+        /// Keys in `string_values`, values in `double_values`.
+        DoubleMap,
+    }
+
+    /// One attribute of an RTCStats object. Only the field(s) matching `kind`
+    /// are set, cxx has no tagged unions.
+    #[derive(Debug, Clone, Default)]
+    pub struct RtcStatsMember {
+        /// camelCase name, as in the spec and in RTCStatsReport::ToJson.
+        pub name: String,
+        pub kind: RtcStatsMemberKind,
+        pub bool_value: bool,
+        pub int_value: i64,
+        pub uint_value: u64,
+        pub double_value: f64,
+        pub string_value: String,
+        pub bool_values: Vec<bool>,
+        pub int_values: Vec<i64>,
+        pub uint_values: Vec<u64>,
+        pub double_values: Vec<f64>,
+        pub string_values: Vec<String>,
+    }
+
+    #[derive(Debug, Clone, Default)]
+    pub struct RtcStatsRecord {
+        pub id: String,
+        /// RTCStatsType, e.g. "outbound-rtp".
+        pub stats_type: String,
+        pub timestamp_us: i64,
+        /// Attributes with a value. In delta mode, only the ones that changed
+        /// since the previous report.
+        pub members: Vec<RtcStatsMember>,
+    }
+}
+
+impl Default for ffi::RtcStatsMemberKind {
+    fn default() -> Self {
+        Self::Bool
+    }
+}
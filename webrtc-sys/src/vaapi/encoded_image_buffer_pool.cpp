@@ -0,0 +1,60 @@
+#include "encoded_image_buffer_pool.h"
+
+#include <algorithm>
+
+#include "rtc_base/logging.h"
+
+namespace livekit_ffi {
+
+EncodedImageBufferPool::Buffer::Buffer(size_t capacity) {
+  Reset(0, capacity);
+}
+
+void EncodedImageBufferPool::Buffer::Reset(size_t size, size_t capacity) {
+  if (capacity > capacity_) {
+    data_.reset(new uint8_t[capacity]);
+    capacity_ = capacity;
+  }
+  size_ = size;
+}
+
+EncodedImageBufferPool::EncodedImageBufferPool(size_t max_buffers)
+    : max_buffers_(max_buffers) {}
+
+webrtc::scoped_refptr<webrtc::EncodedImageBufferInterface>
+EncodedImageBufferPool::Acquire(size_t size) {
+  high_water_mark_ = std::max(high_water_mark_, size);
+
+  for (auto& buffer : buffers_) {
+    // The pool holds the only reference: nobody downstream uses it anymore.
+    if (buffer->HasOneRef()) {
+      buffer->Reset(size, high_water_mark_);
+      return buffer;
+    }
+  }
+
+  if (buffers_.size() >= max_buffers_) {
+    // Logged once, it would otherwise repeat on every frame while the
+    // consumer holds on to the buffers.
+    if (exhausted_count_++ == 0) {
+      RTC_LOG(LS_WARNING) << "Encoded image buffer pool exhausted ("
+                          << max_buffers_
+                          << " buffers in use), allocating instead";
+    }
+    return webrtc::EncodedImageBuffer::Create(size);
+  }
+
+  auto buffer = webrtc::scoped_refptr<webrtc::RefCountedObject<Buffer>>(
+      new webrtc::RefCountedObject<Buffer>(high_water_mark_));
+  buffer->Reset(size, high_water_mark_);
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+void EncodedImageBufferPool::Release() {
+  buffers_.clear();
+  high_water_mark_ = 0;
+  exhausted_count_ = 0;
+}
+
+}  // namespace livekit_ffi
@@ -0,0 +1,69 @@
+#ifndef VAAPI_ENCODED_IMAGE_BUFFER_POOL_H_
+#define VAAPI_ENCODED_IMAGE_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
+#include "rtc_base/ref_counted_object.h"
+
+namespace livekit_ffi {
+
+// Recycles the buffers handed to EncodedImageCallback::OnEncodedImage.
+//
+// A buffer goes back to the pool once every EncodedImage referencing it has
+// been released. Buffers are grown to the largest frame seen so far, so
+// after a few frames the encoder stops allocating altogether.
+//
+// Acquire() must be called from a single thread (the encoder thread); the
+// returned buffers may be released from any thread.
+class EncodedImageBufferPool {
+ public:
+  explicit EncodedImageBufferPool(size_t max_buffers = 8);
+
+  // Returns a buffer of exactly |size| bytes. Its contents are undefined.
+  webrtc::scoped_refptr<webrtc::EncodedImageBufferInterface> Acquire(
+      size_t size);
+
+  // Drops the pooled buffers and resets the counters. Buffers still in use
+  // stay valid.
+  void Release();
+
+  size_t high_water_mark() const { return high_water_mark_; }
+
+  // Number of Acquire() calls that found every pooled buffer in use and
+  // allocated an unpooled one.
+  size_t exhausted_count() const { return exhausted_count_; }
+
+ private:
+  class Buffer : public webrtc::EncodedImageBufferInterface {
+   public:
+    explicit Buffer(size_t capacity);
+
+    const uint8_t* data() const override { return data_.get(); }
+    uint8_t* data() override { return data_.get(); }
+    size_t size() const override { return size_; }
+
+    size_t capacity() const { return capacity_; }
+    void Reset(size_t size, size_t capacity);
+
+   private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+  };
+
+  const size_t max_buffers_;
+  size_t high_water_mark_ = 0;
+  size_t exhausted_count_ = 0;
+  std::vector<webrtc::scoped_refptr<webrtc::RefCountedObject<Buffer>>>
+      buffers_;
+};
+
+}  // namespace livekit_ffi
+
+#endif  // VAAPI_ENCODED_IMAGE_BUFFER_POOL_H_
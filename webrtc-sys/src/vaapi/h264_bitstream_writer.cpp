@@ -0,0 +1,81 @@
+#include "h264_bitstream_writer.h"
+
+#include <assert.h>
+
+#include <bit>
+
+namespace livekit_ffi {
+
+H264BitstreamWriter::H264BitstreamWriter(size_t capacity_bytes)
+    : buffer_(capacity_bytes < 8 ? 8 : capacity_bytes) {}
+
+void H264BitstreamWriter::Reset() {
+  size_ = 0;
+  cache_ = 0;
+  cache_bits_ = 0;
+  bit_length_ = 0;
+}
+
+void H264BitstreamWriter::Reserve(size_t bytes) {
+  if (size_ + bytes > buffer_.size())
+    buffer_.resize((size_ + bytes) * 2);
+}
+
+void H264BitstreamWriter::StoreWord() {
+  Reserve(4);
+  cache_bits_ -= 32;
+  uint32_t word = static_cast<uint32_t>(cache_ >> cache_bits_);
+  buffer_[size_++] = static_cast<uint8_t>(word >> 24);
+  buffer_[size_++] = static_cast<uint8_t>(word >> 16);
+  buffer_[size_++] = static_cast<uint8_t>(word >> 8);
+  buffer_[size_++] = static_cast<uint8_t>(word);
+  cache_ &= (uint64_t{1} << cache_bits_) - 1;
+}
+
+void H264BitstreamWriter::PutUE(uint32_t value) {
+  // codeNum + 1 written on 2 * len - 1 bits, the leading zeros come for free.
+  uint64_t code = uint64_t{value} + 1;
+  int len = std::bit_width(code);
+  if (2 * len - 1 <= 32) {
+    PutBits(static_cast<uint32_t>(code), 2 * len - 1);
+  } else {
+    PutBits(0, len - 1);
+    PutBits(static_cast<uint32_t>(code >> 1), len - 1);
+    PutBits(static_cast<uint32_t>(code & 1), 1);
+  }
+}
+
+void H264BitstreamWriter::PutSE(int32_t value) {
+  uint32_t code = value <= 0 ? static_cast<uint32_t>(-int64_t{value}) * 2
+                             : static_cast<uint32_t>(value) * 2 - 1;
+  PutUE(code);
+}
+
+void H264BitstreamWriter::ByteAlign(int bit) {
+  assert(bit == 0 || bit == 1);
+  int pad = static_cast<int>((8 - (bit_length_ & 7)) & 7);
+  if (pad)
+    PutBits(bit ? (1u << pad) - 1 : 0, pad);
+}
+
+void H264BitstreamWriter::RbspTrailingBits() {
+  PutBits(1, 1);
+  ByteAlign(0);
+}
+
+void H264BitstreamWriter::Flush() {
+  Reserve(4);
+  int bits = cache_bits_;
+  uint64_t cache = cache_;
+  while (bits > 0) {
+    // Left-align the remaining bits in a byte, zero padded.
+    uint8_t byte = bits >= 8 ? static_cast<uint8_t>(cache >> (bits - 8))
+                             : static_cast<uint8_t>(cache << (8 - bits));
+    buffer_[size_++] = byte;
+    bits -= 8;
+  }
+  cache_ = 0;
+  cache_bits_ = 0;
+}
+
+}  // namespace livekit_ffi
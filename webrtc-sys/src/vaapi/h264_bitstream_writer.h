@@ -0,0 +1,65 @@
+#ifndef VAAPI_H264_BITSTREAM_WRITER_H_
+#define VAAPI_H264_BITSTREAM_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace livekit_ffi {
+
+// MSB-first bit writer for H.264 headers.
+//
+// Bits are gathered in a 64-bit cache and stored 32 bits at a time, the
+// output buffer is preallocated and kept across Reset() so steady-state
+// header generation does not allocate.
+class H264BitstreamWriter {
+ public:
+  explicit H264BitstreamWriter(size_t capacity_bytes = 256);
+
+  // Clears the content but keeps the allocated buffer.
+  void Reset();
+
+  // Writes the |bits| (0 to 32) least significant bits of |value|.
+  void PutBits(uint32_t value, int bits) {
+    if (bits == 0)
+      return;
+    cache_ = (cache_ << bits) | (value & (0xFFFFFFFFu >> (32 - bits)));
+    cache_bits_ += bits;
+    bit_length_ += bits;
+    if (cache_bits_ >= 32)
+      StoreWord();
+  }
+
+  // Exp-Golomb codes, ue(v) and se(v).
+  void PutUE(uint32_t value);
+  void PutSE(int32_t value);
+
+  // Pads to the next byte boundary with |bit| (0 or 1).
+  void ByteAlign(int bit);
+
+  // rbsp_stop_one_bit followed by zero alignment bits.
+  void RbspTrailingBits();
+
+  // Stores the bits still in the cache, zero padded to a whole byte. Must be
+  // called once, after the last Put*(), before reading data().
+  void Flush();
+
+  const uint8_t* data() const { return buffer_.data(); }
+  size_t bit_length() const { return bit_length_; }
+  size_t size_in_bytes() const { return (bit_length_ + 7) / 8; }
+
+ private:
+  void StoreWord();
+  void Reserve(size_t bytes);
+
+  std::vector<uint8_t> buffer_;
+  size_t size_ = 0;  // bytes stored in |buffer_|
+  uint64_t cache_ = 0;
+  int cache_bits_ = 0;
+  size_t bit_length_ = 0;
+};
+
+}  // namespace livekit_ffi
+
+#endif  // VAAPI_H264_BITSTREAM_WRITER_H_
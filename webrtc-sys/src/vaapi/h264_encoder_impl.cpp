@@ -6,6 +6,7 @@
 
 #include "absl/strings/match.h"
 #include "absl/types/optional.h"
+#include "api/video/nv12_buffer.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video_codecs/scalability_mode.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
@@ -21,8 +22,6 @@
 #include "third_party/libyuv/include/libyuv/convert.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
 
-#define VA_FOURCC_I420 0x30323449  // I420
-
 namespace webrtc {
 
 // Used by histograms. Values of entries should not be changed.
@@ -189,17 +188,20 @@ int32_t VAAPIH264EncoderWrapper::Encode(
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
 
-  webrtc::scoped_refptr<I420BufferInterface> frame_buffer =
-      input_frame.video_frame_buffer()->ToI420();
-  if (!frame_buffer) {
-    RTC_LOG(LS_ERROR) << "Failed to convert "
-                      << VideoFrameBufferTypeToString(
-                             input_frame.video_frame_buffer()->type())
-                      << " image to I420. Can't encode frame.";
-    return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
+  // NV12 and I420 are uploaded as-is, anything else goes through I420.
+  webrtc::scoped_refptr<VideoFrameBuffer> frame_buffer =
+      input_frame.video_frame_buffer();
+  if (frame_buffer->type() != VideoFrameBuffer::Type::kNV12 &&
+      frame_buffer->type() != VideoFrameBuffer::Type::kI420) {
+    frame_buffer = frame_buffer->ToI420();
+    if (!frame_buffer) {
+      RTC_LOG(LS_ERROR) << "Failed to convert "
+                        << VideoFrameBufferTypeToString(
+                               input_frame.video_frame_buffer()->type())
+                        << " image to I420. Can't encode frame.";
+      return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
+    }
   }
-  RTC_CHECK(frame_buffer->type() == VideoFrameBuffer::Type::kI420 ||
-            frame_buffer->type() == VideoFrameBuffer::Type::kI420A);
 
   bool is_keyframe_needed = false;
   if (configuration_.key_frame_request && configuration_.sending) {
@@ -228,17 +230,25 @@ int32_t VAAPIH264EncoderWrapper::Encode(
     }
   }
 
-  std::vector<uint8_t> output;
-  encoder_->Encode(VA_FOURCC_I420, frame_buffer->DataY(), frame_buffer->DataU(),
-                   frame_buffer->DataV(), send_key_frame, output);
+  webrtc::scoped_refptr<EncodedImageBufferInterface> output;
+  if (frame_buffer->type() == VideoFrameBuffer::Type::kNV12) {
+    const NV12BufferInterface* nv12 = frame_buffer->GetNV12();
+    encoder_->Encode(VA_FOURCC_NV12, nv12->DataY(), nv12->StrideY(),
+                     nv12->DataUV(), nv12->StrideUV(), nullptr, 0,
+                     send_key_frame, output);
+  } else {
+    const I420BufferInterface* i420 = frame_buffer->GetI420();
+    encoder_->Encode(VA_FOURCC_I420, i420->DataY(), i420->StrideY(),
+                     i420->DataU(), i420->StrideU(), i420->DataV(),
+                     i420->StrideV(), send_key_frame, output);
+  }
 
-  if (output.empty()) {
+  if (!output || output->size() == 0) {
     RTC_LOG(LS_ERROR) << "Failed to encode frame.";
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
 
-  encoded_image_.SetEncodedData(
-      EncodedImageBuffer::Create(output.data(), output.size()));
+  encoded_image_.SetEncodedData(output);
 
   h264_bitstream_parser_.ParseBitstream(encoded_image_);
 
@@ -268,7 +278,8 @@ VideoEncoder::EncoderInfo VAAPIH264EncoderWrapper::GetEncoderInfo() const {
   info.scaling_settings = VideoEncoder::ScalingSettings::kOff;
   info.is_hardware_accelerated = true;
   info.supports_simulcast = false;
-  info.preferred_pixel_formats = {VideoFrameBuffer::Type::kI420};
+  info.preferred_pixel_formats = {VideoFrameBuffer::Type::kNV12,
+                                   VideoFrameBuffer::Type::kI420};
   return info;
 }
 
@@ -0,0 +1,282 @@
+#include "h264_packed_headers.h"
+
+#include <assert.h>
+
+namespace livekit_ffi {
+
+namespace {
+
+constexpr int kNalRefIdcNone = 0;
+constexpr int kNalRefIdcLow = 1;
+constexpr int kNalRefIdcMedium = 2;
+constexpr int kNalRefIdcHigh = 3;
+
+constexpr int kNalNonIdr = 1;
+constexpr int kNalIdr = 5;
+constexpr int kNalSps = 7;
+constexpr int kNalPps = 8;
+
+constexpr int kSliceTypeP = 0;
+constexpr int kSliceTypeB = 1;
+constexpr int kSliceTypeI = 2;
+
+constexpr int kProfileIdcBaseline = 66;
+constexpr int kProfileIdcMain = 77;
+constexpr int kProfileIdcHigh = 100;
+
+void NalStart(H264BitstreamWriter& bs, int nal_ref_idc, int nal_unit_type) {
+  bs.PutBits(0x00000001, 32); /* start code prefix */
+  bs.PutBits(0, 1);           /* forbidden_zero_bit: 0 */
+  bs.PutBits(nal_ref_idc, 2);
+  bs.PutBits(nal_unit_type, 5);
+}
+
+void WriteSps(H264BitstreamWriter& bs,
+              VAProfile profile,
+              int constraint_set_flag,
+              const VAEncSequenceParameterBufferH264& seq) {
+  int profile_idc = kProfileIdcBaseline;
+  if (profile == VAProfileH264High)
+    profile_idc = kProfileIdcHigh;
+  else if (profile == VAProfileH264Main)
+    profile_idc = kProfileIdcMain;
+
+  bs.PutBits(profile_idc, 8);                  /* profile_idc */
+  bs.PutBits(!!(constraint_set_flag & 1), 1);  /* constraint_set0_flag */
+  bs.PutBits(!!(constraint_set_flag & 2), 1);  /* constraint_set1_flag */
+  bs.PutBits(!!(constraint_set_flag & 4), 1);  /* constraint_set2_flag */
+  bs.PutBits(!!(constraint_set_flag & 8), 1);  /* constraint_set3_flag */
+  bs.PutBits(0, 4);                            /* reserved_zero_4bits */
+  bs.PutBits(seq.level_idc, 8);                /* level_idc */
+  bs.PutUE(seq.seq_parameter_set_id);          /* seq_parameter_set_id */
+
+  if (profile_idc == kProfileIdcHigh) {
+    bs.PutUE(1);      /* chroma_format_idc = 1, 4:2:0 */
+    bs.PutUE(0);      /* bit_depth_luma_minus8 */
+    bs.PutUE(0);      /* bit_depth_chroma_minus8 */
+    bs.PutBits(0, 1); /* qpprime_y_zero_transform_bypass_flag */
+    bs.PutBits(0, 1); /* seq_scaling_matrix_present_flag */
+  }
+
+  bs.PutUE(seq.seq_fields.bits.log2_max_frame_num_minus4);
+  bs.PutUE(seq.seq_fields.bits.pic_order_cnt_type);
+  assert(seq.seq_fields.bits.pic_order_cnt_type == 0);
+  bs.PutUE(seq.seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4);
+
+  bs.PutUE(seq.max_num_ref_frames); /* num_ref_frames */
+  bs.PutBits(0, 1);                 /* gaps_in_frame_num_value_allowed_flag */
+
+  bs.PutUE(seq.picture_width_in_mbs - 1);  /* pic_width_in_mbs_minus1 */
+  bs.PutUE(seq.picture_height_in_mbs - 1); /* pic_height_in_map_units_minus1 */
+  bs.PutBits(seq.seq_fields.bits.frame_mbs_only_flag, 1);
+  assert(seq.seq_fields.bits.frame_mbs_only_flag);
+
+  bs.PutBits(seq.seq_fields.bits.direct_8x8_inference_flag, 1);
+  bs.PutBits(seq.frame_cropping_flag, 1);
+
+  if (seq.frame_cropping_flag) {
+    bs.PutUE(seq.frame_crop_left_offset);
+    bs.PutUE(seq.frame_crop_right_offset);
+    bs.PutUE(seq.frame_crop_top_offset);
+    bs.PutUE(seq.frame_crop_bottom_offset);
+  }
+
+  bs.PutBits(0, 1); /* vui_parameters_present_flag */
+
+  bs.RbspTrailingBits();
+}
+
+void WritePps(H264BitstreamWriter& bs,
+              const VAEncPictureParameterBufferH264& pic) {
+  bs.PutUE(pic.pic_parameter_set_id);
+  bs.PutUE(pic.seq_parameter_set_id);
+
+  bs.PutBits(pic.pic_fields.bits.entropy_coding_mode_flag, 1);
+  bs.PutBits(0, 1); /* pic_order_present_flag: 0 */
+  bs.PutUE(0);      /* num_slice_groups_minus1 */
+
+  bs.PutUE(pic.num_ref_idx_l0_active_minus1);
+  bs.PutUE(pic.num_ref_idx_l1_active_minus1);
+
+  bs.PutBits(pic.pic_fields.bits.weighted_pred_flag, 1);
+  bs.PutBits(pic.pic_fields.bits.weighted_bipred_idc, 2);
+
+  bs.PutSE(pic.pic_init_qp - 26); /* pic_init_qp_minus26 */
+  bs.PutSE(0);                    /* pic_init_qs_minus26 */
+  bs.PutSE(0);                    /* chroma_qp_index_offset */
+
+  bs.PutBits(pic.pic_fields.bits.deblocking_filter_control_present_flag, 1);
+  bs.PutBits(0, 1); /* constrained_intra_pred_flag */
+  bs.PutBits(0, 1); /* redundant_pic_cnt_present_flag */
+
+  /* more_rbsp_data */
+  bs.PutBits(pic.pic_fields.bits.transform_8x8_mode_flag, 1);
+  bs.PutBits(0, 1); /* pic_scaling_matrix_present_flag */
+  bs.PutSE(pic.second_chroma_qp_index_offset);
+
+  bs.RbspTrailingBits();
+}
+
+void WriteSliceHeader(H264BitstreamWriter& bs,
+                      const VAEncSequenceParameterBufferH264& seq,
+                      const VAEncPictureParameterBufferH264& pic,
+                      const VAEncSliceParameterBufferH264& slice) {
+  bs.PutUE(slice.macroblock_address); /* first_mb_in_slice */
+  bs.PutUE(slice.slice_type);
+  bs.PutUE(slice.pic_parameter_set_id);
+  bs.PutBits(pic.frame_num, seq.seq_fields.bits.log2_max_frame_num_minus4 + 4);
+
+  if (pic.pic_fields.bits.idr_pic_flag)
+    bs.PutUE(slice.idr_pic_id);
+
+  if (seq.seq_fields.bits.pic_order_cnt_type == 0) {
+    /* pic_order_present_flag == 0 */
+    bs.PutBits(pic.CurrPic.TopFieldOrderCnt,
+               seq.seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4 + 4);
+  }
+
+  /* redundant_pic_cnt_present_flag == 0 */
+  if (slice.slice_type == kSliceTypeP) {
+    bs.PutBits(slice.num_ref_idx_active_override_flag, 1);
+    if (slice.num_ref_idx_active_override_flag)
+      bs.PutUE(slice.num_ref_idx_l0_active_minus1);
+
+    bs.PutBits(0, 1); /* ref_pic_list_reordering_flag_l0: 0 */
+  } else if (slice.slice_type == kSliceTypeB) {
+    bs.PutBits(slice.direct_spatial_mv_pred_flag, 1);
+    bs.PutBits(slice.num_ref_idx_active_override_flag, 1);
+    if (slice.num_ref_idx_active_override_flag) {
+      bs.PutUE(slice.num_ref_idx_l0_active_minus1);
+      bs.PutUE(slice.num_ref_idx_l1_active_minus1);
+    }
+
+    bs.PutBits(0, 1); /* ref_pic_list_reordering_flag_l0: 0 */
+    bs.PutBits(0, 1); /* ref_pic_list_reordering_flag_l1: 0 */
+  }
+
+  /* dec_ref_pic_marking, nal_ref_idc != 0 */
+  if (pic.pic_fields.bits.reference_pic_flag) {
+    if (pic.pic_fields.bits.idr_pic_flag) {
+      bs.PutBits(0, 1); /* no_output_of_prior_pics_flag */
+      bs.PutBits(0, 1); /* long_term_reference_flag */
+    } else {
+      bs.PutBits(0, 1); /* adaptive_ref_pic_marking_mode_flag */
+    }
+  }
+
+  if (pic.pic_fields.bits.entropy_coding_mode_flag &&
+      slice.slice_type != kSliceTypeI)
+    bs.PutUE(slice.cabac_init_idc);
+
+  bs.PutSE(slice.slice_qp_delta);
+
+  if (pic.pic_fields.bits.deblocking_filter_control_present_flag) {
+    bs.PutUE(slice.disable_deblocking_filter_idc);
+    if (slice.disable_deblocking_filter_idc != 1) {
+      bs.PutSE(slice.slice_alpha_c0_offset_div2);
+      bs.PutSE(slice.slice_beta_offset_div2);
+    }
+  }
+
+  if (pic.pic_fields.bits.entropy_coding_mode_flag)
+    bs.ByteAlign(1);
+}
+
+}  // namespace
+
+H264PackedHeaders::H264PackedHeaders() : sps_(64), pps_(32), slice_(64) {}
+
+void H264PackedHeaders::Reset() {
+  has_sps_ = false;
+  has_pps_ = false;
+}
+
+const H264BitstreamWriter& H264PackedHeaders::Sps(
+    VAProfile profile,
+    int constraint_set_flag,
+    const VAEncSequenceParameterBufferH264& seq) {
+  SpsKey key = {
+      .profile = profile,
+      .constraint_set_flag = constraint_set_flag,
+      .level_idc = seq.level_idc,
+      .seq_parameter_set_id = seq.seq_parameter_set_id,
+      .log2_max_frame_num_minus4 =
+          seq.seq_fields.bits.log2_max_frame_num_minus4,
+      .pic_order_cnt_type = seq.seq_fields.bits.pic_order_cnt_type,
+      .log2_max_pic_order_cnt_lsb_minus4 =
+          seq.seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4,
+      .max_num_ref_frames = seq.max_num_ref_frames,
+      .picture_width_in_mbs = seq.picture_width_in_mbs,
+      .picture_height_in_mbs = seq.picture_height_in_mbs,
+      .frame_mbs_only_flag = seq.seq_fields.bits.frame_mbs_only_flag,
+      .direct_8x8_inference_flag =
+          seq.seq_fields.bits.direct_8x8_inference_flag,
+      .frame_cropping_flag = seq.frame_cropping_flag,
+      .frame_crop_left_offset = seq.frame_crop_left_offset,
+      .frame_crop_right_offset = seq.frame_crop_right_offset,
+      .frame_crop_top_offset = seq.frame_crop_top_offset,
+      .frame_crop_bottom_offset = seq.frame_crop_bottom_offset,
+  };
+  if (has_sps_ && key == sps_key_)
+    return sps_;
+
+  sps_.Reset();
+  NalStart(sps_, kNalRefIdcHigh, kNalSps);
+  WriteSps(sps_, profile, constraint_set_flag, seq);
+  sps_.Flush();
+  sps_key_ = key;
+  has_sps_ = true;
+  return sps_;
+}
+
+const H264BitstreamWriter& H264PackedHeaders::Pps(
+    const VAEncPictureParameterBufferH264& pic) {
+  PpsKey key = {
+      .pic_parameter_set_id = pic.pic_parameter_set_id,
+      .seq_parameter_set_id = pic.seq_parameter_set_id,
+      .entropy_coding_mode_flag = pic.pic_fields.bits.entropy_coding_mode_flag,
+      .num_ref_idx_l0_active_minus1 = pic.num_ref_idx_l0_active_minus1,
+      .num_ref_idx_l1_active_minus1 = pic.num_ref_idx_l1_active_minus1,
+      .weighted_pred_flag = pic.pic_fields.bits.weighted_pred_flag,
+      .weighted_bipred_idc = pic.pic_fields.bits.weighted_bipred_idc,
+      .pic_init_qp = pic.pic_init_qp,
+      .deblocking_filter_control_present_flag =
+          pic.pic_fields.bits.deblocking_filter_control_present_flag,
+      .transform_8x8_mode_flag = pic.pic_fields.bits.transform_8x8_mode_flag,
+      .second_chroma_qp_index_offset = pic.second_chroma_qp_index_offset,
+  };
+  if (has_pps_ && key == pps_key_)
+    return pps_;
+
+  pps_.Reset();
+  NalStart(pps_, kNalRefIdcHigh, kNalPps);
+  WritePps(pps_, pic);
+  pps_.Flush();
+  pps_key_ = key;
+  has_pps_ = true;
+  return pps_;
+}
+
+const H264BitstreamWriter& H264PackedHeaders::Slice(
+    const VAEncSequenceParameterBufferH264& seq,
+    const VAEncPictureParameterBufferH264& pic,
+    const VAEncSliceParameterBufferH264& slice) {
+  bool is_idr = pic.pic_fields.bits.idr_pic_flag;
+  bool is_ref = pic.pic_fields.bits.reference_pic_flag;
+
+  slice_.Reset();
+  if (slice.slice_type == kSliceTypeI) {
+    NalStart(slice_, kNalRefIdcHigh, is_idr ? kNalIdr : kNalNonIdr);
+  } else if (slice.slice_type == kSliceTypeP) {
+    NalStart(slice_, kNalRefIdcMedium, kNalNonIdr);
+  } else {
+    assert(slice.slice_type == kSliceTypeB);
+    NalStart(slice_, is_ref ? kNalRefIdcLow : kNalRefIdcNone, kNalNonIdr);
+  }
+
+  WriteSliceHeader(slice_, seq, pic, slice);
+  slice_.Flush();
+  return slice_;
+}
+
+}  // namespace livekit_ffi
@@ -0,0 +1,84 @@
+#ifndef VAAPI_H264_PACKED_HEADERS_H_
+#define VAAPI_H264_PACKED_HEADERS_H_
+
+#include <va/va.h>
+#include <va/va_enc_h264.h>
+
+#include "h264_bitstream_writer.h"
+
+namespace livekit_ffi {
+
+// Builds the packed SPS/PPS/slice header NAL units (start code included)
+// handed to the driver with VAEncPackedHeaderDataBufferType.
+//
+// SPS and PPS are cached and only rebuilt when one of the fields they encode
+// changes, slice headers are rebuilt on every call into a reused buffer.
+class H264PackedHeaders {
+ public:
+  H264PackedHeaders();
+
+  const H264BitstreamWriter& Sps(VAProfile profile,
+                                 int constraint_set_flag,
+                                 const VAEncSequenceParameterBufferH264& seq);
+
+  const H264BitstreamWriter& Pps(const VAEncPictureParameterBufferH264& pic);
+
+  const H264BitstreamWriter& Slice(
+      const VAEncSequenceParameterBufferH264& seq,
+      const VAEncPictureParameterBufferH264& pic,
+      const VAEncSliceParameterBufferH264& slice);
+
+  // Drops the cached SPS/PPS.
+  void Reset();
+
+ private:
+  struct SpsKey {
+    int profile;
+    int constraint_set_flag;
+    uint32_t level_idc;
+    uint32_t seq_parameter_set_id;
+    uint32_t log2_max_frame_num_minus4;
+    uint32_t pic_order_cnt_type;
+    uint32_t log2_max_pic_order_cnt_lsb_minus4;
+    uint32_t max_num_ref_frames;
+    uint32_t picture_width_in_mbs;
+    uint32_t picture_height_in_mbs;
+    uint32_t frame_mbs_only_flag;
+    uint32_t direct_8x8_inference_flag;
+    uint32_t frame_cropping_flag;
+    uint32_t frame_crop_left_offset;
+    uint32_t frame_crop_right_offset;
+    uint32_t frame_crop_top_offset;
+    uint32_t frame_crop_bottom_offset;
+
+    bool operator==(const SpsKey&) const = default;
+  };
+
+  struct PpsKey {
+    uint32_t pic_parameter_set_id;
+    uint32_t seq_parameter_set_id;
+    uint32_t entropy_coding_mode_flag;
+    uint32_t num_ref_idx_l0_active_minus1;
+    uint32_t num_ref_idx_l1_active_minus1;
+    uint32_t weighted_pred_flag;
+    uint32_t weighted_bipred_idc;
+    int pic_init_qp;
+    uint32_t deblocking_filter_control_present_flag;
+    uint32_t transform_8x8_mode_flag;
+    int second_chroma_qp_index_offset;
+
+    bool operator==(const PpsKey&) const = default;
+  };
+
+  H264BitstreamWriter sps_;
+  H264BitstreamWriter pps_;
+  H264BitstreamWriter slice_;
+  bool has_sps_ = false;
+  bool has_pps_ = false;
+  SpsKey sps_key_ = {};
+  PpsKey pps_key_ = {};
+};
+
+}  // namespace livekit_ffi
+
+#endif  // VAAPI_H264_PACKED_HEADERS_H_
@@ -7,35 +7,13 @@
 
 #include <map>
 
+#include "h264_packed_headers.h"
 #include "rtc_base/logging.h"
-
-#define NAL_REF_IDC_NONE 0
-#define NAL_REF_IDC_LOW 1
-#define NAL_REF_IDC_MEDIUM 2
-#define NAL_REF_IDC_HIGH 3
-
-#define NAL_NON_IDR 1
-#define NAL_IDR 5
-#define NAL_SPS 7
-#define NAL_PPS 8
-#define NAL_SEI 6
-
-#define SLICE_TYPE_P 0
-#define SLICE_TYPE_B 1
-#define SLICE_TYPE_I 2
-#define IS_P_SLICE(type) (SLICE_TYPE_P == (type))
-#define IS_B_SLICE(type) (SLICE_TYPE_B == (type))
-#define IS_I_SLICE(type) (SLICE_TYPE_I == (type))
+#include "vaapi_surface_upload.h"
 
 #define ENTROPY_MODE_CAVLC 0
 #define ENTROPY_MODE_CABAC 1
 
-#define PROFILE_IDC_BASELINE 66
-#define PROFILE_IDC_MAIN 77
-#define PROFILE_IDC_HIGH 100
-
-#define BITSTREAM_ALLOCATE_STEPPING 4096
-
 static const uint32_t MaxFrameNum = (2 << 16);
 static const uint32_t MaxPicOrderCntLsb = (2 << 8);
 static const uint32_t Log2MaxFrameNum = 16;
@@ -49,29 +27,33 @@ static const int rc_default_modes[] = {
     VA_RC_CBR, VA_RC_VCM, VA_RC_NONE,
 };
 
-VAImageFormat kImageFormatI420 = {
-    .fourcc = VA_FOURCC_I420,
+static_assert(livekit_ffi::kUploadFourccNV12 == VA_FOURCC_NV12, "NV12 fourcc");
+static_assert(livekit_ffi::kUploadFourccI420 == VA_FOURCC_I420, "I420 fourcc");
+static_assert(livekit_ffi::kUploadFourccYV12 == VA_FOURCC_YV12, "YV12 fourcc");
+
+VAImageFormat kImageFormatNV12 = {
+    .fourcc = VA_FOURCC_NV12,
     .byte_order = VA_LSB_FIRST,
     .bits_per_pixel = 12,
 };
 
 static int upload_surface_yuv(VADisplay va_dpy,
                               VASurfaceID surface_id,
-                              int src_fourcc,
+                              const livekit_ffi::UploadPlanes& src,
                               int src_width,
-                              int src_height,
-                              uint8_t* src_Y,
-                              uint8_t* src_U,
-                              uint8_t* src_V) {
+                              int src_height) {
   VAImage surface_image;
-  uint8_t *surface_p = NULL, *Y_start = NULL, *U_start = NULL;
-  int Y_pitch = 0, U_pitch = 0, row;
+  uint8_t* surface_p = NULL;
   VAStatus va_status;
 
+  // Prefer writing straight into the surface memory. Drivers that can't
+  // expose it get a staging image in the surface's native NV12 layout, which
+  // is then transferred with vaPutImage.
+  bool derived = true;
   va_status = vaDeriveImage(va_dpy, surface_id, &surface_image);
   if (va_status != VA_STATUS_SUCCESS) {
-    // If the driver does not support vaDeriveImage, create a new image.
-    va_status = vaCreateImage(va_dpy, &kImageFormatI420, src_width, src_height,
+    derived = false;
+    va_status = vaCreateImage(va_dpy, &kImageFormatNV12, src_width, src_height,
                               &surface_image);
     if (va_status != VA_STATUS_SUCCESS) {
       RTC_LOG(LS_ERROR) << "vaCreateImage failed with status " << va_status;
@@ -79,520 +61,42 @@ static int upload_surface_yuv(VADisplay va_dpy,
     }
   }
 
-  vaMapBuffer(va_dpy, surface_image.buf, (void**)&surface_p);
-  assert(VA_STATUS_SUCCESS == va_status);
-
-  Y_start = surface_p;
-  Y_pitch = surface_image.pitches[0];
-  switch (surface_image.format.fourcc) {
-    case VA_FOURCC_NV12:
-      U_start = (unsigned char*)surface_p + surface_image.offsets[1];
-      U_pitch = surface_image.pitches[1];
-      break;
-    case VA_FOURCC_I420:
-      U_start = (unsigned char*)surface_p + surface_image.offsets[1];
-      U_pitch = surface_image.pitches[1];
-      break;
-    case VA_FOURCC_YV12:
-      U_start = (unsigned char*)surface_p + surface_image.offsets[2];
-      U_pitch = surface_image.pitches[2];
-      break;
-    case VA_FOURCC_YUY2:
-      U_start = surface_p + 1;
-      U_pitch = surface_image.pitches[0];
-      break;
-    default:
-      assert(0);
-  }
-
-  /* copy Y plane */
-  for (row = 0; row < src_height; row++) {
-    uint8_t* Y_row = Y_start + row * Y_pitch;
-    memcpy(Y_row, src_Y + row * src_width, src_width);
-  }
-  for (row = 0; row < src_height / 2; row++) {
-    uint8_t* U_row = U_start + row * U_pitch;
-    uint8_t *u_ptr = NULL, *v_ptr = NULL;
-    int j;
-    if (src_fourcc == VA_FOURCC_NV12) {
-      memcpy(U_row, src_U + row * src_width, src_width);
-      break;
-    } else if (src_fourcc == VA_FOURCC_I420) {
-      u_ptr = src_U + row * (src_width / 2);
-      v_ptr = src_V + row * (src_width / 2);
-    } else if (src_fourcc == VA_FOURCC_YV12) {
-      v_ptr = src_U + row * (src_width / 2);
-      u_ptr = src_V + row * (src_width / 2);
-    }
-    if ((src_fourcc == VA_FOURCC_I420) || (src_fourcc == VA_FOURCC_YV12)) {
-      for (j = 0; j < src_width / 2; j++) {
-        U_row[2 * j] = u_ptr[j];
-        U_row[2 * j + 1] = v_ptr[j];
-      }
-    }
-  }
-  vaUnmapBuffer(va_dpy, surface_image.buf);
-  vaDestroyImage(va_dpy, surface_image.image_id);
-
-  return 0;
-}
-
-#define MIN(a, b) ((a) > (b) ? (b) : (a))
-#define MAX(a, b) ((a) > (b) ? (a) : (b))
-
-struct __bitstream {
-  uint32_t* buffer;
-  int bit_offset;
-  int max_size_in_dword;
-};
-typedef struct __bitstream bitstream;
-
-static uint32_t va_swap32(uint32_t val) {
-  unsigned char* pval = (unsigned char*)&val;
-
-  return ((pval[0] << 24) | (pval[1] << 16) | (pval[2] << 8) | (pval[3] << 0));
-}
-
-static void bitstream_start(bitstream* bs) {
-  bs->max_size_in_dword = BITSTREAM_ALLOCATE_STEPPING;
-  bs->buffer = (uint32_t*)calloc(bs->max_size_in_dword * sizeof(int), 1);
-  assert(bs->buffer);
-  bs->bit_offset = 0;
-}
-
-static void bitstream_end(bitstream* bs) {
-  int pos = (bs->bit_offset >> 5);
-  int bit_offset = (bs->bit_offset & 0x1f);
-  int bit_left = 32 - bit_offset;
-
-  if (bit_offset) {
-    bs->buffer[pos] = va_swap32((bs->buffer[pos] << bit_left));
-  }
-}
-
-static void bitstream_put_ui(bitstream* bs, uint32_t val, int size_in_bits) {
-  int pos = (bs->bit_offset >> 5);
-  int bit_offset = (bs->bit_offset & 0x1f);
-  int bit_left = 32 - bit_offset;
-
-  if (!size_in_bits)
-    return;
-
-  bs->bit_offset += size_in_bits;
-
-  if (bit_left > size_in_bits) {
-    bs->buffer[pos] = (bs->buffer[pos] << size_in_bits | val);
-  } else {
-    size_in_bits -= bit_left;
-    bs->buffer[pos] = (bs->buffer[pos] << bit_left) | (val >> size_in_bits);
-    bs->buffer[pos] = va_swap32(bs->buffer[pos]);
-
-    if (pos + 1 == bs->max_size_in_dword) {
-      bs->max_size_in_dword += BITSTREAM_ALLOCATE_STEPPING;
-      bs->buffer = bs->buffer = (uint32_t*)realloc(
-          bs->buffer, bs->max_size_in_dword * sizeof(uint32_t));
-      assert(bs->buffer);
-    }
-
-    bs->buffer[pos + 1] = val;
-  }
-}
-
-static void bitstream_put_ue(bitstream* bs, uint32_t val) {
-  int size_in_bits = 0;
-  int tmp_val = ++val;
-
-  while (tmp_val) {
-    tmp_val >>= 1;
-    size_in_bits++;
-  }
-
-  bitstream_put_ui(bs, 0, size_in_bits - 1);  // leading zero
-  bitstream_put_ui(bs, val, size_in_bits);
-}
-
-static void bitstream_put_se(bitstream* bs, int val) {
-  uint32_t new_val;
-
-  if (val <= 0)
-    new_val = -2 * val;
-  else
-    new_val = 2 * val - 1;
-
-  bitstream_put_ue(bs, new_val);
-}
-
-static void bitstream_byte_aligning(bitstream* bs, int bit) {
-  int bit_offset = (bs->bit_offset & 0x7);
-  int bit_left = 8 - bit_offset;
-  int new_val;
-
-  if (!bit_offset)
-    return;
-
-  assert(bit == 0 || bit == 1);
-
-  if (bit)
-    new_val = (1 << bit_left) - 1;
-  else
-    new_val = 0;
-
-  bitstream_put_ui(bs, new_val, bit_left);
-}
-
-static void rbsp_trailing_bits(bitstream* bs) {
-  bitstream_put_ui(bs, 1, 1);
-  bitstream_byte_aligning(bs, 0);
-}
-
-static void nal_start_code_prefix(bitstream* bs) {
-  bitstream_put_ui(bs, 0x00000001, 32);
-}
-
-static void nal_header(bitstream* bs, int nal_ref_idc, int nal_unit_type) {
-  bitstream_put_ui(bs, 0, 1); /* forbidden_zero_bit: 0 */
-  bitstream_put_ui(bs, nal_ref_idc, 2);
-  bitstream_put_ui(bs, nal_unit_type, 5);
-}
-
-static void sps_rbsp(VA264Context* context, bitstream* bs) {
-  int profile_idc = PROFILE_IDC_BASELINE;
-
-  if (context->config.h264_profile == VAProfileH264High)
-    profile_idc = PROFILE_IDC_HIGH;
-  else if (context->config.h264_profile == VAProfileH264Main)
-    profile_idc = PROFILE_IDC_MAIN;
-
-  bitstream_put_ui(bs, profile_idc, 8); /* profile_idc */
-  bitstream_put_ui(bs, !!(context->constraint_set_flag & 1),
-                   1); /* constraint_set0_flag */
-  bitstream_put_ui(bs, !!(context->constraint_set_flag & 2),
-                   1); /* constraint_set1_flag */
-  bitstream_put_ui(bs, !!(context->constraint_set_flag & 4),
-                   1); /* constraint_set2_flag */
-  bitstream_put_ui(bs, !!(context->constraint_set_flag & 8),
-                   1);        /* constraint_set3_flag */
-  bitstream_put_ui(bs, 0, 4); /* reserved_zero_4bits */
-  bitstream_put_ui(bs, context->seq_param.level_idc, 8); /* level_idc */
-  bitstream_put_ue(
-      bs, context->seq_param.seq_parameter_set_id); /* seq_parameter_set_id */
-
-  if (profile_idc == PROFILE_IDC_HIGH) {
-    bitstream_put_ue(bs, 1);    /* chroma_format_idc = 1, 4:2:0 */
-    bitstream_put_ue(bs, 0);    /* bit_depth_luma_minus8 */
-    bitstream_put_ue(bs, 0);    /* bit_depth_chroma_minus8 */
-    bitstream_put_ui(bs, 0, 1); /* qpprime_y_zero_transform_bypass_flag */
-    bitstream_put_ui(bs, 0, 1); /* seq_scaling_matrix_present_flag */
-  }
-
-  bitstream_put_ue(
-      bs, context->seq_param.seq_fields.bits
-              .log2_max_frame_num_minus4); /* log2_max_frame_num_minus4 */
-  bitstream_put_ue(bs, context->seq_param.seq_fields.bits
-                           .pic_order_cnt_type); /* pic_order_cnt_type */
-
-  if (context->seq_param.seq_fields.bits.pic_order_cnt_type == 0)
-    bitstream_put_ue(
-        bs,
-        context->seq_param.seq_fields.bits
-            .log2_max_pic_order_cnt_lsb_minus4); /* log2_max_pic_order_cnt_lsb_minus4
-                                                  */
-  else {
-    assert(0);
-  }
-
-  bitstream_put_ue(bs,
-                   context->seq_param.max_num_ref_frames); /* num_ref_frames */
-  bitstream_put_ui(bs, 0, 1); /* gaps_in_frame_num_value_allowed_flag */
-
-  bitstream_put_ue(bs, context->seq_param.picture_width_in_mbs -
-                           1); /* pic_width_in_mbs_minus1 */
-  bitstream_put_ue(bs, context->seq_param.picture_height_in_mbs -
-                           1); /* pic_height_in_map_units_minus1 */
-  bitstream_put_ui(bs, context->seq_param.seq_fields.bits.frame_mbs_only_flag,
-                   1); /* frame_mbs_only_flag */
-
-  if (!context->seq_param.seq_fields.bits.frame_mbs_only_flag) {
-    assert(0);
-  }
-
-  bitstream_put_ui(bs,
-                   context->seq_param.seq_fields.bits.direct_8x8_inference_flag,
-                   1); /* direct_8x8_inference_flag */
-  bitstream_put_ui(bs, context->seq_param.frame_cropping_flag,
-                   1); /* frame_cropping_flag */
-
-  if (context->seq_param.frame_cropping_flag) {
-    bitstream_put_ue(
-        bs,
-        context->seq_param.frame_crop_left_offset); /* frame_crop_left_offset */
-    bitstream_put_ue(
-        bs, context->seq_param
-                .frame_crop_right_offset); /* frame_crop_right_offset */
-    bitstream_put_ue(
-        bs,
-        context->seq_param.frame_crop_top_offset); /* frame_crop_top_offset */
-    bitstream_put_ue(
-        bs, context->seq_param
-                .frame_crop_bottom_offset); /* frame_crop_bottom_offset */
-  }
-
-  // if ( frame_bit_rate < 0 ) { //TODO EW: the vui header isn't correct
-  if (1) {
-    bitstream_put_ui(bs, 0, 1); /* vui_parameters_present_flag */
-  } else {
-    bitstream_put_ui(bs, 1, 1); /* vui_parameters_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* aspect_ratio_info_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* overscan_info_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* video_signal_type_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* chroma_loc_info_present_flag */
-    bitstream_put_ui(bs, 1, 1); /* timing_info_present_flag */
-    {
-      bitstream_put_ui(bs, 15, 32);
-      bitstream_put_ui(bs, 900, 32);
-      bitstream_put_ui(bs, 1, 1);
-    }
-    bitstream_put_ui(bs, 1, 1); /* nal_hrd_parameters_present_flag */
-    {
-      // hrd_parameters
-      bitstream_put_ue(bs, 0);    /* cpb_cnt_minus1 */
-      bitstream_put_ui(bs, 4, 4); /* bit_rate_scale */
-      bitstream_put_ui(bs, 6, 4); /* cpb_size_scale */
-
-      bitstream_put_ue(
-          bs, context->config.bitrate - 1); /* bit_rate_value_minus1[0] */
-      bitstream_put_ue(
-          bs, context->config.bitrate * 8 - 1); /* cpb_size_value_minus1[0] */
-      bitstream_put_ui(bs, 1, 1);               /* cbr_flag[0] */
-
-      bitstream_put_ui(bs, 23, 5); /* initial_cpb_removal_delay_length_minus1 */
-      bitstream_put_ui(bs, 23, 5); /* cpb_removal_delay_length_minus1 */
-      bitstream_put_ui(bs, 23, 5); /* dpb_output_delay_length_minus1 */
-      bitstream_put_ui(bs, 23, 5); /* time_offset_length  */
-    }
-    bitstream_put_ui(bs, 0, 1); /* vcl_hrd_parameters_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* low_delay_hrd_flag */
-
-    bitstream_put_ui(bs, 0, 1); /* pic_struct_present_flag */
-    bitstream_put_ui(bs, 0, 1); /* bitstream_restriction_flag */
-  }
-
-  rbsp_trailing_bits(bs); /* rbsp_trailing_bits */
-}
-
-static void pps_rbsp(VA264Context* context, bitstream* bs) {
-  bitstream_put_ue(
-      bs, context->pic_param.pic_parameter_set_id); /* pic_parameter_set_id */
-  bitstream_put_ue(
-      bs, context->pic_param.seq_parameter_set_id); /* seq_parameter_set_id */
-
-  bitstream_put_ui(bs,
-                   context->pic_param.pic_fields.bits.entropy_coding_mode_flag,
-                   1); /* entropy_coding_mode_flag */
-
-  bitstream_put_ui(bs, 0, 1); /* pic_order_present_flag: 0 */
-
-  bitstream_put_ue(bs, 0); /* num_slice_groups_minus1 */
-
-  bitstream_put_ue(
-      bs, context->pic_param
-              .num_ref_idx_l0_active_minus1); /* num_ref_idx_l0_active_minus1 */
-  bitstream_put_ue(
-      bs, context->pic_param
-              .num_ref_idx_l1_active_minus1); /* num_ref_idx_l1_active_minus1
-                                                 1 */
-
-  bitstream_put_ui(bs, context->pic_param.pic_fields.bits.weighted_pred_flag,
-                   1); /* weighted_pred_flag: 0 */
-  bitstream_put_ui(bs, context->pic_param.pic_fields.bits.weighted_bipred_idc,
-                   2); /* weighted_bipred_idc: 0 */
-
-  bitstream_put_se(
-      bs, context->pic_param.pic_init_qp - 26); /* pic_init_qp_minus26 */
-  bitstream_put_se(bs, 0);                      /* pic_init_qs_minus26 */
-  bitstream_put_se(bs, 0);                      /* chroma_qp_index_offset */
-
-  bitstream_put_ui(
-      bs,
-      context->pic_param.pic_fields.bits.deblocking_filter_control_present_flag,
-      1);                     /* deblocking_filter_control_present_flag */
-  bitstream_put_ui(bs, 0, 1); /* constrained_intra_pred_flag */
-  bitstream_put_ui(bs, 0, 1); /* redundant_pic_cnt_present_flag */
-
-  /* more_rbsp_data */
-  bitstream_put_ui(bs,
-                   context->pic_param.pic_fields.bits.transform_8x8_mode_flag,
-                   1);        /*transform_8x8_mode_flag */
-  bitstream_put_ui(bs, 0, 1); /* pic_scaling_matrix_present_flag */
-  bitstream_put_se(
-      bs, context->pic_param
-              .second_chroma_qp_index_offset); /*second_chroma_qp_index_offset
-                                                */
-
-  rbsp_trailing_bits(bs);
-}
-
-static void slice_header(VA264Context* context, bitstream* bs) {
-  int first_mb_in_slice = context->slice_param.macroblock_address;
-
-  bitstream_put_ue(bs, first_mb_in_slice); /* first_mb_in_slice: 0 */
-  bitstream_put_ue(bs, context->slice_param.slice_type); /* slice_type */
-  bitstream_put_ue(
-      bs,
-      context->slice_param.pic_parameter_set_id); /* pic_parameter_set_id: 0 */
-  bitstream_put_ui(
-      bs, context->pic_param.frame_num,
-      context->seq_param.seq_fields.bits.log2_max_frame_num_minus4 +
-          4); /* frame_num */
-
-  if (context->pic_param.pic_fields.bits.idr_pic_flag)
-    bitstream_put_ue(bs, context->slice_param.idr_pic_id); /* idr_pic_id: 0 */
-
-  if (context->seq_param.seq_fields.bits.pic_order_cnt_type == 0) {
-    bitstream_put_ui(
-        bs, context->pic_param.CurrPic.TopFieldOrderCnt,
-        context->seq_param.seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4 +
-            4);
-    /* pic_order_present_flag == 0 */
-  }
-
-  /* redundant_pic_cnt_present_flag == 0 */
-  /* slice type */
-  if (IS_P_SLICE(context->slice_param.slice_type)) {
-    bitstream_put_ui(bs, context->slice_param.num_ref_idx_active_override_flag,
-                     1); /* num_ref_idx_active_override_flag: */
-
-    if (context->slice_param.num_ref_idx_active_override_flag)
-      bitstream_put_ue(bs, context->slice_param.num_ref_idx_l0_active_minus1);
-
-    /* ref_pic_list_reordering */
-    bitstream_put_ui(bs, 0, 1); /* ref_pic_list_reordering_flag_l0: 0 */
-  } else if (IS_B_SLICE(context->slice_param.slice_type)) {
-    bitstream_put_ui(bs, context->slice_param.direct_spatial_mv_pred_flag,
-                     1); /* direct_spatial_mv_pred: 1 */
-
-    bitstream_put_ui(bs, context->slice_param.num_ref_idx_active_override_flag,
-                     1); /* num_ref_idx_active_override_flag: */
-
-    if (context->slice_param.num_ref_idx_active_override_flag) {
-      bitstream_put_ue(bs, context->slice_param.num_ref_idx_l0_active_minus1);
-      bitstream_put_ue(bs, context->slice_param.num_ref_idx_l1_active_minus1);
-    }
-
-    /* ref_pic_list_reordering */
-    bitstream_put_ui(bs, 0, 1); /* ref_pic_list_reordering_flag_l0: 0 */
-    bitstream_put_ui(bs, 0, 1); /* ref_pic_list_reordering_flag_l1: 0 */
+  va_status = vaMapBuffer(va_dpy, surface_image.buf, (void**)&surface_p);
+  if (va_status != VA_STATUS_SUCCESS) {
+    RTC_LOG(LS_ERROR) << "vaMapBuffer failed with status " << va_status;
+    vaDestroyImage(va_dpy, surface_image.image_id);
+    return -1;
   }
 
-  if ((context->pic_param.pic_fields.bits.weighted_pred_flag &&
-       IS_P_SLICE(context->slice_param.slice_type)) ||
-      ((context->pic_param.pic_fields.bits.weighted_bipred_idc == 1) &&
-       IS_B_SLICE(context->slice_param.slice_type))) {
+  livekit_ffi::UploadPlanes dst = {};
+  dst.fourcc = surface_image.format.fourcc;
+  for (uint32_t i = 0; i < surface_image.num_planes && i < 3; i++) {
+    dst.data[i] = surface_p + surface_image.offsets[i];
+    dst.stride[i] = surface_image.pitches[i];
   }
 
-  /* dec_ref_pic_marking */
-  if (context->pic_param.pic_fields.bits
-          .reference_pic_flag) { /* nal_ref_idc != 0 */
-    unsigned char no_output_of_prior_pics_flag = 0;
-    unsigned char long_term_reference_flag = 0;
-    unsigned char adaptive_ref_pic_marking_mode_flag = 0;
+  bool packed = livekit_ffi::PackYUV420(src, dst, src_width, src_height);
+  vaUnmapBuffer(va_dpy, surface_image.buf);
 
-    if (context->pic_param.pic_fields.bits.idr_pic_flag) {
-      bitstream_put_ui(bs, no_output_of_prior_pics_flag,
-                       1); /* no_output_of_prior_pics_flag: 0 */
-      bitstream_put_ui(bs, long_term_reference_flag,
-                       1); /* long_term_reference_flag: 0 */
-    } else {
-      bitstream_put_ui(bs, adaptive_ref_pic_marking_mode_flag,
-                       1); /* adaptive_ref_pic_marking_mode_flag: 0 */
-    }
+  if (!packed) {
+    RTC_LOG(LS_ERROR) << "Unsupported surface image format "
+                      << surface_image.format.fourcc;
+    vaDestroyImage(va_dpy, surface_image.image_id);
+    return -1;
   }
 
-  if (context->pic_param.pic_fields.bits.entropy_coding_mode_flag &&
-      !IS_I_SLICE(context->slice_param.slice_type))
-    bitstream_put_ue(
-        bs, context->slice_param.cabac_init_idc); /* cabac_init_idc: 0 */
-
-  bitstream_put_se(bs,
-                   context->slice_param.slice_qp_delta); /* slice_qp_delta: 0 */
-
-  /* ignore for SP/SI */
-
-  if (context->pic_param.pic_fields.bits
-          .deblocking_filter_control_present_flag) {
-    bitstream_put_ue(
-        bs,
-        context->slice_param
-            .disable_deblocking_filter_idc); /* disable_deblocking_filter_idc:
-                                                0 */
-
-    if (context->slice_param.disable_deblocking_filter_idc != 1) {
-      bitstream_put_se(
-          bs,
-          context->slice_param
-              .slice_alpha_c0_offset_div2); /* slice_alpha_c0_offset_div2: 2 */
-      bitstream_put_se(
-          bs, context->slice_param
-                  .slice_beta_offset_div2); /* slice_beta_offset_div2: 2 */
+  if (!derived) {
+    va_status = vaPutImage(va_dpy, surface_id, surface_image.image_id, 0, 0,
+                           src_width, src_height, 0, 0, src_width, src_height);
+    if (va_status != VA_STATUS_SUCCESS) {
+      RTC_LOG(LS_ERROR) << "vaPutImage failed with status " << va_status;
+      vaDestroyImage(va_dpy, surface_image.image_id);
+      return -1;
     }
   }
 
-  if (context->pic_param.pic_fields.bits.entropy_coding_mode_flag) {
-    bitstream_byte_aligning(bs, 1);
-  }
-}
-
-static int build_packed_pic_buffer(VA264Context* context,
-                                   unsigned char** header_buffer) {
-  bitstream bs;
-
-  bitstream_start(&bs);
-  nal_start_code_prefix(&bs);
-  nal_header(&bs, NAL_REF_IDC_HIGH, NAL_PPS);
-  pps_rbsp(context, &bs);
-  bitstream_end(&bs);
-
-  *header_buffer = (unsigned char*)bs.buffer;
-  return bs.bit_offset;
-}
-
-static int build_packed_seq_buffer(VA264Context* context,
-                                   unsigned char** header_buffer) {
-  bitstream bs;
-
-  bitstream_start(&bs);
-  nal_start_code_prefix(&bs);
-  nal_header(&bs, NAL_REF_IDC_HIGH, NAL_SPS);
-  sps_rbsp(context, &bs);
-  bitstream_end(&bs);
-
-  *header_buffer = (unsigned char*)bs.buffer;
-  return bs.bit_offset;
-}
-
-static int build_packed_slice_buffer(VA264Context* context,
-                                     unsigned char** header_buffer) {
-  bitstream bs;
-  int is_idr = !!context->pic_param.pic_fields.bits.idr_pic_flag;
-  int is_ref = !!context->pic_param.pic_fields.bits.reference_pic_flag;
-
-  bitstream_start(&bs);
-  nal_start_code_prefix(&bs);
-
-  if (IS_I_SLICE(context->slice_param.slice_type)) {
-    nal_header(&bs, NAL_REF_IDC_HIGH, is_idr ? NAL_IDR : NAL_NON_IDR);
-  } else if (IS_P_SLICE(context->slice_param.slice_type)) {
-    nal_header(&bs, NAL_REF_IDC_MEDIUM, NAL_NON_IDR);
-  } else {
-    assert(IS_B_SLICE(context->slice_param.slice_type));
-    nal_header(&bs, is_ref ? NAL_REF_IDC_LOW : NAL_REF_IDC_NONE, NAL_NON_IDR);
-  }
-
-  slice_header(context, &bs);
-  bitstream_end(&bs);
-
-  *header_buffer = (unsigned char*)bs.buffer;
-  return bs.bit_offset;
+  vaDestroyImage(va_dpy, surface_image.image_id);
+  return 0;
 }
 
 /*
@@ -1432,69 +936,21 @@ static int render_picture(VA264Context* context) {
   return 0;
 }
 
-static int render_packedsequence(VA264Context* context) {
-  VAEncPackedHeaderParameterBuffer packedheader_param_buffer;
-  VABufferID packedseq_para_bufid, packedseq_data_bufid, render_id[2];
-  uint32_t length_in_bits;
-  unsigned char* packedseq_buffer = NULL;
-  VAStatus va_status;
-
-  length_in_bits = build_packed_seq_buffer(context, &packedseq_buffer);
-
-  packedheader_param_buffer.type = VAEncPackedHeaderSequence;
-
-  packedheader_param_buffer.bit_length = length_in_bits; /*length_in_bits*/
-  packedheader_param_buffer.has_emulation_bytes = 0;
-  va_status = vaCreateBuffer(context->va_dpy, context->context_id,
-                             VAEncPackedHeaderParameterBufferType,
-                             sizeof(packedheader_param_buffer), 1,
-                             &packedheader_param_buffer, &packedseq_para_bufid);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
-    return -1;
-  }
-
-  va_status = vaCreateBuffer(
-      context->va_dpy, context->context_id, VAEncPackedHeaderDataBufferType,
-      (length_in_bits + 7) / 8, 1, packedseq_buffer, &packedseq_data_bufid);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
-    return -1;
-  }
-
-  render_id[0] = packedseq_para_bufid;
-  render_id[1] = packedseq_data_bufid;
-  va_status =
-      vaRenderPicture(context->va_dpy, context->context_id, render_id, 2);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaRenderPicture failed va_status = " << va_status;
-    return -1;
-  }
-
-  free(packedseq_buffer);
-
-  return 0;
-}
-
-static int render_packedpicture(VA264Context* context) {
+static int render_packed_header(VA264Context* context,
+                                VAEncPackedHeaderType type,
+                                const livekit_ffi::H264BitstreamWriter& bs) {
   VAEncPackedHeaderParameterBuffer packedheader_param_buffer;
-  VABufferID packedpic_para_bufid, packedpic_data_bufid, render_id[2];
-  uint32_t length_in_bits;
-  unsigned char* packedpic_buffer = NULL;
+  VABufferID packed_para_bufid, packed_data_bufid, render_id[2];
   VAStatus va_status;
 
-  length_in_bits = build_packed_pic_buffer(context, &packedpic_buffer);
-  packedheader_param_buffer.type = VAEncPackedHeaderPicture;
-  packedheader_param_buffer.bit_length = length_in_bits;
+  packedheader_param_buffer.type = type;
+  packedheader_param_buffer.bit_length = bs.bit_length();
   packedheader_param_buffer.has_emulation_bytes = 0;
 
   va_status = vaCreateBuffer(context->va_dpy, context->context_id,
                              VAEncPackedHeaderParameterBufferType,
                              sizeof(packedheader_param_buffer), 1,
-                             &packedheader_param_buffer, &packedpic_para_bufid);
+                             &packedheader_param_buffer, &packed_para_bufid);
 
   if (va_status != VA_STATUS_SUCCESS) {
     RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
@@ -1503,14 +959,16 @@ static int render_packedpicture(VA264Context* context) {
 
   va_status = vaCreateBuffer(
       context->va_dpy, context->context_id, VAEncPackedHeaderDataBufferType,
-      (length_in_bits + 7) / 8, 1, packedpic_buffer, &packedpic_data_bufid);
+      bs.size_in_bytes(), 1, const_cast<uint8_t*>(bs.data()),
+      &packed_data_bufid);
 
   if (va_status != VA_STATUS_SUCCESS) {
     RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
     return -1;
   }
-  render_id[0] = packedpic_para_bufid;
-  render_id[1] = packedpic_data_bufid;
+
+  render_id[0] = packed_para_bufid;
+  render_id[1] = packed_data_bufid;
   va_status =
       vaRenderPicture(context->va_dpy, context->context_id, render_id, 2);
 
@@ -1518,54 +976,12 @@ static int render_packedpicture(VA264Context* context) {
     RTC_LOG(LS_ERROR) << "vaRenderPicture failed va_status = " << va_status;
     return -1;
   }
-  free(packedpic_buffer);
 
   return 0;
 }
 
-static void render_packedslice(VA264Context* context) {
-  VAEncPackedHeaderParameterBuffer packedheader_param_buffer;
-  VABufferID packedslice_para_bufid, packedslice_data_bufid, render_id[2];
-  uint32_t length_in_bits;
-  unsigned char* packedslice_buffer = NULL;
-  VAStatus va_status;
-
-  length_in_bits = build_packed_slice_buffer(context, &packedslice_buffer);
-  packedheader_param_buffer.type = VAEncPackedHeaderSlice;
-  packedheader_param_buffer.bit_length = length_in_bits;
-  packedheader_param_buffer.has_emulation_bytes = 0;
-
-  va_status = vaCreateBuffer(
-      context->va_dpy, context->context_id,
-      VAEncPackedHeaderParameterBufferType, sizeof(packedheader_param_buffer),
-      1, &packedheader_param_buffer, &packedslice_para_bufid);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
-    return;
-  }
-
-  va_status = vaCreateBuffer(
-      context->va_dpy, context->context_id, VAEncPackedHeaderDataBufferType,
-      (length_in_bits + 7) / 8, 1, packedslice_buffer, &packedslice_data_bufid);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaCreateBuffer failed va_status = " << va_status;
-    return;
-  }
-  render_id[0] = packedslice_para_bufid;
-  render_id[1] = packedslice_data_bufid;
-  va_status =
-      vaRenderPicture(context->va_dpy, context->context_id, render_id, 2);
-
-  if (va_status != VA_STATUS_SUCCESS) {
-    RTC_LOG(LS_ERROR) << "vaRenderPicture failed va_status = " << va_status;
-    return;
-  }
-  free(packedslice_buffer);
-}
-
-static int render_slice(VA264Context* context) {
+static int render_slice(VA264Context* context,
+                        livekit_ffi::H264PackedHeaders* headers) {
   VABufferID slice_param_buf;
   VAStatus va_status;
   int i;
@@ -1624,7 +1040,10 @@ static int render_slice(VA264Context* context) {
   if (context->h264_packedheader &&
       context->config_attrib[context->enc_packed_header_idx].value &
           VA_ENC_PACKED_HEADER_SLICE)
-    render_packedslice(context);
+    render_packed_header(
+        context, VAEncPackedHeaderSlice,
+        headers->Slice(context->seq_param, context->pic_param,
+                       context->slice_param));
 
   va_status = vaCreateBuffer(
       context->va_dpy, context->context_id, VAEncSliceParameterBufferType,
@@ -1662,11 +1081,6 @@ void VaapiH264EncoderWrapper::Destroy() {
     vaDestroySurfaces(context_->va_dpy, &context_->ref_surface[0], SURFACE_NUM);
   }
 
-  if (context_->encoded_buffer) {
-    free(context_->encoded_buffer);
-    context_->encoded_buffer = nullptr;
-  }
-
   for (int i = 0; i < SURFACE_NUM; i++) {
     vaDestroyBuffer(context_->va_dpy, context_->coded_buf[i]);
   }
@@ -1682,6 +1096,12 @@ void VaapiH264EncoderWrapper::Destroy() {
   context_->va_dpy = nullptr;
   context_->context_id = VA_INVALID_ID;
   memset((void*)context_.get(), 0, sizeof(VA264Context));
+  if (output_pool_.exhausted_count() > 0) {
+    RTC_LOG(LS_INFO) << output_pool_.exhausted_count()
+                     << " frames were encoded outside the buffer pool";
+  }
+  output_pool_.Release();
+  headers_.Reset();
   initialized_ = false;
 }
 
@@ -1744,27 +1164,17 @@ bool VaapiH264EncoderWrapper::Initialize(int width,
                      << context_->frame_height_mbaligned << " with crop";
   }
 
-  // the buffer to receive the encoded frames from encodeImage
-  context_->encoded_buffer = (uint8_t*)malloc(
-      context_->frame_width_mbaligned * context_->frame_height_mbaligned * 3);
-
   if (!va_display_->isOpen()) {
     if (!va_display_->Open()) {
-      free(context_->encoded_buffer);
-      context_->encoded_buffer = nullptr;
       return false;
     }
   }
 
   if (init_va(context_.get(), va_display_->display()) != VA_STATUS_SUCCESS) {
-    free(context_->encoded_buffer);
-    context_->encoded_buffer = nullptr;
     return false;
   }
 
   if (setup_encode(context_.get()) != VA_STATUS_SUCCESS) {
-    free(context_->encoded_buffer);
-    context_->encoded_buffer = nullptr;
     return false;
   }
 
@@ -1779,22 +1189,34 @@ bool VaapiH264EncoderWrapper::Initialize(int width,
 
 bool VaapiH264EncoderWrapper::Encode(int fourcc,
                                      const uint8_t* y,
+                                     int stride_y,
                                      const uint8_t* u,
+                                     int stride_u,
                                      const uint8_t* v,
+                                     int stride_v,
                                      bool forceIDR,
-                                     std::vector<uint8_t>& encoded) {
+                                     webrtc::scoped_refptr<
+                                         webrtc::EncodedImageBufferInterface>&
+                                         encoded) {
   if (forceIDR) {
     // reset the sequence to start with a new IDR regardless of layout
     context_->current_frame_num = context_->current_frame_display =
         context_->current_frame_encoding = 0;
   }
 
-  uint8_t* output = context_->encoded_buffer;
   VASurfaceID surface =
       context_->src_surface[context_->current_frame_encoding % SURFACE_NUM];
-  int retv = upload_surface_yuv(
-      context_->va_dpy, surface, fourcc, context_->config.frame_width,
-      context_->config.frame_height, (uint8_t*)y, (uint8_t*)u, (uint8_t*)v);
+  UploadPlanes src = {};
+  src.fourcc = fourcc;
+  src.data[0] = const_cast<uint8_t*>(y);
+  src.stride[0] = stride_y;
+  src.data[1] = const_cast<uint8_t*>(u);
+  src.stride[1] = stride_u;
+  src.data[2] = const_cast<uint8_t*>(v);
+  src.stride[2] = stride_v;
+  int retv = upload_surface_yuv(context_->va_dpy, surface, src,
+                                context_->config.frame_width,
+                                context_->config.frame_height);
 
   if (retv != 0) {
     RTC_LOG(LS_ERROR) << "Failed to upload surface";
@@ -1826,13 +1248,17 @@ bool VaapiH264EncoderWrapper::Encode(int fourcc,
     render_sequence(context_.get());
     render_picture(context_.get());
     if (context_->h264_packedheader) {
-      render_packedsequence(context_.get());
-      render_packedpicture(context_.get());
+      render_packed_header(
+          context_.get(), VAEncPackedHeaderSequence,
+          headers_.Sps(context_->config.h264_profile,
+                       context_->constraint_set_flag, context_->seq_param));
+      render_packed_header(context_.get(), VAEncPackedHeaderPicture,
+                           headers_.Pps(context_->pic_param));
     }
   } else {
     render_picture(context_.get());
   }
-  render_slice(context_.get());
+  render_slice(context_.get(), &headers_);
 
   va_status = vaEndPicture(context_->va_dpy, context_->context_id);
 
@@ -1859,9 +1285,19 @@ bool VaapiH264EncoderWrapper::Encode(int fourcc,
     RTC_LOG(LS_ERROR) << "vaMapBuffer failed va_status = " << va_status;
     return false;
   }
+  // Size the output first so the segments can be copied straight into a
+  // pooled buffer that is handed to the callback as-is.
+  for (VACodedBufferSegment* segment = buf_list; segment != NULL;
+       segment = (VACodedBufferSegment*)segment->next) {
+    coded_size += segment->size;
+  }
+
+  encoded = output_pool_.Acquire(coded_size);
+  uint8_t* output = encoded->data();
+  size_t offset = 0;
   while (buf_list != NULL) {
-    memcpy(&output[coded_size], buf_list->buf, buf_list->size);
-    coded_size += buf_list->size;
+    memcpy(&output[offset], buf_list->buf, buf_list->size);
+    offset += buf_list->size;
     buf_list = (VACodedBufferSegment*)buf_list->next;
   }
 
@@ -1873,7 +1309,6 @@ bool VaapiH264EncoderWrapper::Encode(int fourcc,
 
   context_->current_frame_encoding++;
 
-  encoded = std::vector<uint8_t>(output, output + coded_size);
   return true;
 }
 
@@ -9,6 +9,11 @@
 #include <memory>
 #include <vector>
 
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
+#include "encoded_image_buffer_pool.h"
+#include "h264_packed_headers.h"
+
 #if defined(WIN32)
 #include "vaapi_display_win32.h"
 using VaapiDisplay = livekit_ffi::VaapiDisplayWin32;
@@ -72,7 +77,6 @@ typedef struct {
   uint64_t current_frame_display;
   uint64_t current_idr_display;
 
-  uint8_t* encoded_buffer;
   VA264Config config;
 } VA264Context;
 
@@ -94,13 +98,19 @@ class VaapiH264EncoderWrapper {
                   VAProfile profile,
                   int rc_mode);
 
-  // Encode a frame and return the encoded data.
+  // Encode a frame and return the encoded data. |fourcc| is VA_FOURCC_NV12
+  // (|u| is the interleaved UV plane, |v| is unused) or VA_FOURCC_I420.
+  // |output| comes from an internal pool and is recycled once released.
   bool Encode(int fourcc,
               const uint8_t* y,
+              int stride_y,
               const uint8_t* u,
+              int stride_u,
               const uint8_t* v,
+              int stride_v,
               bool forceIDR,
-              std::vector<uint8_t>& output);
+              webrtc::scoped_refptr<webrtc::EncodedImageBufferInterface>&
+                  output);
 
   void UpdateRates(int frame_rate, int bitrate) {
     if (context_) {
@@ -113,12 +123,18 @@ class VaapiH264EncoderWrapper {
     return initialized_;
   }
 
+  // Frames encoded into an unpooled buffer because the consumer still held
+  // every pooled one.
+  size_t unpooled_outputs() const { return output_pool_.exhausted_count(); }
+
   // Release resources.
   void Destroy();
 
  private:
   std::unique_ptr<VA264Context> context_;
   std::unique_ptr<VaapiDisplay> va_display_;
+  EncodedImageBufferPool output_pool_;
+  H264PackedHeaders headers_;
   bool initialized_ = false;
 };
 
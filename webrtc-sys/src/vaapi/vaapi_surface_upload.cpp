@@ -0,0 +1,123 @@
+#include "vaapi_surface_upload.h"
+
+#include <string.h>
+
+namespace livekit_ffi {
+
+namespace {
+
+// Chroma planes of a 4:2:0 picture, either interleaved (uv) or planar (u, v).
+struct ChromaPlanes {
+  bool interleaved;
+  uint8_t* uv;
+  int stride_uv;
+  uint8_t* u;
+  int stride_u;
+  uint8_t* v;
+  int stride_v;
+};
+
+bool GetChromaPlanes(const UploadPlanes& planes, ChromaPlanes* chroma) {
+  memset(chroma, 0, sizeof(*chroma));
+  switch (planes.fourcc) {
+    case kUploadFourccNV12:
+      chroma->interleaved = true;
+      chroma->uv = planes.data[1];
+      chroma->stride_uv = planes.stride[1];
+      return true;
+    case kUploadFourccI420:
+      chroma->u = planes.data[1];
+      chroma->stride_u = planes.stride[1];
+      chroma->v = planes.data[2];
+      chroma->stride_v = planes.stride[2];
+      return true;
+    case kUploadFourccYV12:
+      chroma->v = planes.data[1];
+      chroma->stride_v = planes.stride[1];
+      chroma->u = planes.data[2];
+      chroma->stride_u = planes.stride[2];
+      return true;
+    default:
+      return false;
+  }
+}
+
+void InterleaveUV(const ChromaPlanes& src,
+                  const ChromaPlanes& dst,
+                  int chroma_width,
+                  int chroma_height) {
+  for (int row = 0; row < chroma_height; row++) {
+    const uint8_t* u = src.u + row * src.stride_u;
+    const uint8_t* v = src.v + row * src.stride_v;
+    uint8_t* uv = dst.uv + row * dst.stride_uv;
+    for (int i = 0; i < chroma_width; i++) {
+      uv[2 * i] = u[i];
+      uv[2 * i + 1] = v[i];
+    }
+  }
+}
+
+void DeinterleaveUV(const ChromaPlanes& src,
+                    const ChromaPlanes& dst,
+                    int chroma_width,
+                    int chroma_height) {
+  for (int row = 0; row < chroma_height; row++) {
+    const uint8_t* uv = src.uv + row * src.stride_uv;
+    uint8_t* u = dst.u + row * dst.stride_u;
+    uint8_t* v = dst.v + row * dst.stride_v;
+    for (int i = 0; i < chroma_width; i++) {
+      u[i] = uv[2 * i];
+      v[i] = uv[2 * i + 1];
+    }
+  }
+}
+
+}  // namespace
+
+void CopyPlane(const uint8_t* src,
+               int src_stride,
+               uint8_t* dst,
+               int dst_stride,
+               int width_bytes,
+               int height) {
+  if (src_stride == width_bytes && dst_stride == width_bytes) {
+    memcpy(dst, src, static_cast<size_t>(width_bytes) * height);
+    return;
+  }
+
+  for (int row = 0; row < height; row++) {
+    memcpy(dst + row * dst_stride, src + row * src_stride, width_bytes);
+  }
+}
+
+bool PackYUV420(const UploadPlanes& src,
+                const UploadPlanes& dst,
+                int width,
+                int height) {
+  ChromaPlanes src_chroma, dst_chroma;
+  if (!GetChromaPlanes(src, &src_chroma) || !GetChromaPlanes(dst, &dst_chroma))
+    return false;
+
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+
+  CopyPlane(src.data[0], src.stride[0], dst.data[0], dst.stride[0], width,
+            height);
+
+  if (src_chroma.interleaved && dst_chroma.interleaved) {
+    CopyPlane(src_chroma.uv, src_chroma.stride_uv, dst_chroma.uv,
+              dst_chroma.stride_uv, chroma_width * 2, chroma_height);
+  } else if (!src_chroma.interleaved && !dst_chroma.interleaved) {
+    CopyPlane(src_chroma.u, src_chroma.stride_u, dst_chroma.u,
+              dst_chroma.stride_u, chroma_width, chroma_height);
+    CopyPlane(src_chroma.v, src_chroma.stride_v, dst_chroma.v,
+              dst_chroma.stride_v, chroma_width, chroma_height);
+  } else if (dst_chroma.interleaved) {
+    InterleaveUV(src_chroma, dst_chroma, chroma_width, chroma_height);
+  } else {
+    DeinterleaveUV(src_chroma, dst_chroma, chroma_width, chroma_height);
+  }
+  return true;
+}
+
+}  // namespace livekit_ffi
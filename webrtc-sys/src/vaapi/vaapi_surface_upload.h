@@ -0,0 +1,43 @@
+#ifndef VAAPI_SURFACE_UPLOAD_H_
+#define VAAPI_SURFACE_UPLOAD_H_
+
+#include <stdint.h>
+
+namespace livekit_ffi {
+
+// FOURCC codes of the layouts handled below. They match the VA_FOURCC_*
+// values from va.h but are spelled out so these routines (and their tests)
+// do not depend on libva.
+constexpr uint32_t kUploadFourccNV12 = 0x3231564E;  // 'N','V','1','2'
+constexpr uint32_t kUploadFourccI420 = 0x30323449;  // 'I','4','2','0'
+constexpr uint32_t kUploadFourccYV12 = 0x32315659;  // 'Y','V','1','2'
+
+// A source or destination picture. For NV12, plane 1 holds the interleaved
+// UV samples and plane 2 is unused. For YV12 plane 1 is V and plane 2 is U.
+struct UploadPlanes {
+  uint32_t fourcc;
+  uint8_t* data[3];
+  int stride[3];
+};
+
+// Copies |height| rows of |width_bytes| bytes. Falls back to a single memcpy
+// when both sides are tightly packed.
+void CopyPlane(const uint8_t* src,
+               int src_stride,
+               uint8_t* dst,
+               int dst_stride,
+               int width_bytes,
+               int height);
+
+// Writes a |width|x|height| 4:2:0 picture from |src| into |dst|, converting
+// between NV12, I420 and YV12 as needed. Luma is always a straight planar
+// copy; chroma is copied as-is when the layouts match and (de)interleaved
+// otherwise. Returns false for unsupported layouts.
+bool PackYUV420(const UploadPlanes& src,
+                const UploadPlanes& dst,
+                int width,
+                int height);
+
+}  // namespace livekit_ffi
+
+#endif  // VAAPI_SURFACE_UPLOAD_H_
@@ -17,6 +17,10 @@
 #include "livekit/video_decoder_factory.h"
 
 #include <modules/video_coding/codecs/av1/av1_svc_config.h>
+
+#include <algorithm>
+#include <mutex>
+
 #include "api/environment/environment.h"
 #include "api/video_codecs/av1_profile.h"
 #include "api/video_codecs/sdp_video_format.h"
@@ -25,6 +29,7 @@
 #include "modules/video_coding/codecs/h264/include/h264.h"
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/codecs/vp9/include/vp9.h"
+#include "modules/video_coding/include/video_error_codes.h"
 #include "rtc_base/logging.h"
 
 #if defined(RTC_DAV1D_IN_INTERNAL_DECODER_FACTORY)
@@ -41,18 +46,130 @@
 
 namespace livekit_ffi {
 
+namespace {
+
+std::mutex threads_mutex;
+int threads_per_decoder = 0;
+int max_total_threads = 0;
+int threads_in_use = 0;
+
+// Returns the number of threads a decoder offered |cores| threads by the
+// receive stream gets under the current limits.
+int AcquireDecoderThreads(int cores) {
+  std::lock_guard<std::mutex> lock(threads_mutex);
+  int threads = std::max(cores, 1);
+  if (threads_per_decoder > 0)
+    threads = std::min(threads, threads_per_decoder);
+  // A decoder always gets a thread, even past the budget.
+  if (max_total_threads > 0)
+    threads = std::clamp(max_total_threads - threads_in_use, 1, threads);
+  threads_in_use += threads;
+  return threads;
+}
+
+void ReleaseDecoderThreads(int threads) {
+  std::lock_guard<std::mutex> lock(threads_mutex);
+  threads_in_use -= threads;
+}
+
+// Wraps every decoder.
+//
+// Empty frames are returned as decoded without producing any picture, see
+// IsSkippedVideoFrame.
+//
+// The number of cores the decoder is configured with is limited by the
+// threading set with SetVideoDecoderThreads. libvpx (VP9) and dav1d (AV1)
+// split tiles and rows over that many threads, the VP8 and H264 decoders
+// ignore it.
+class ManagedVideoDecoder : public webrtc::VideoDecoder {
+ public:
+  explicit ManagedVideoDecoder(std::unique_ptr<webrtc::VideoDecoder> decoder)
+      : decoder_(std::move(decoder)) {}
+
+  ~ManagedVideoDecoder() override { ReleaseThreads(); }
+
+  bool Configure(const Settings& settings) override {
+    ReleaseThreads();
+    threads_ = AcquireDecoderThreads(settings.number_of_cores());
+
+    Settings limited = settings;
+    limited.set_number_of_cores(threads_);
+    if (decoder_->Configure(limited))
+      return true;
+    ReleaseThreads();
+    return false;
+  }
+
+  int32_t Decode(const webrtc::EncodedImage& input_image,
+                 int64_t render_time_ms) override {
+    if (IsSkippedVideoFrame(input_image))
+      return WEBRTC_VIDEO_CODEC_OK;
+    return decoder_->Decode(input_image, render_time_ms);
+  }
+
+  int32_t Decode(const webrtc::EncodedImage& input_image,
+                 bool missing_frames,
+                 int64_t render_time_ms) override {
+    if (IsSkippedVideoFrame(input_image))
+      return WEBRTC_VIDEO_CODEC_OK;
+    return decoder_->Decode(input_image, missing_frames, render_time_ms);
+  }
+
+  int32_t RegisterDecodeCompleteCallback(
+      webrtc::DecodedImageCallback* callback) override {
+    return decoder_->RegisterDecodeCompleteCallback(callback);
+  }
+
+  int32_t Release() override {
+    ReleaseThreads();
+    return decoder_->Release();
+  }
+
+  DecoderInfo GetDecoderInfo() const override {
+    return decoder_->GetDecoderInfo();
+  }
+
+ private:
+  void ReleaseThreads() {
+    ReleaseDecoderThreads(threads_);
+    threads_ = 0;
+  }
+
+  std::unique_ptr<webrtc::VideoDecoder> decoder_;
+  int threads_ = 0;
+};
+
+}  // namespace
+
+bool IsSkippedVideoFrame(const webrtc::EncodedImage& image) {
+  return image.size() == 0;
+}
+
+void SetVideoDecoderThreads(int per_decoder, int max_total) {
+  std::lock_guard<std::mutex> lock(threads_mutex);
+  threads_per_decoder = std::max(per_decoder, 0);
+  max_total_threads = std::max(max_total, 0);
+}
+
+int VideoDecoderThreadsInUse() {
+  std::lock_guard<std::mutex> lock(threads_mutex);
+  return threads_in_use;
+}
+
 VideoDecoderFactory::VideoDecoderFactory() {
 #ifdef __APPLE__
-  factories_.push_back(livekit_ffi::CreateObjCVideoDecoderFactory());
+  implementations_.push_back(
+      {"videotoolbox", livekit_ffi::CreateObjCVideoDecoderFactory()});
 #endif
 
 #ifdef WEBRTC_ANDROID
-  factories_.push_back(CreateAndroidVideoDecoderFactory());
+  implementations_.push_back({"mediacodec", CreateAndroidVideoDecoderFactory()});
 #endif
 
 #if defined(USE_NVIDIA_VIDEO_CODEC)
   if (webrtc::NvidiaVideoDecoderFactory::IsSupported()) {
-    factories_.push_back(std::make_unique<webrtc::NvidiaVideoDecoderFactory>());
+    implementations_.push_back(
+        {"nvidia", std::make_unique<webrtc::NvidiaVideoDecoderFactory>()});
   }
 #endif
 }
@@ -61,8 +178,8 @@ std::vector<webrtc::SdpVideoFormat> VideoDecoderFactory::GetSupportedFormats()
     const {
   std::vector<webrtc::SdpVideoFormat> formats;
 
-  for (const auto& factory : factories_) {
-    auto supported_formats = factory->GetSupportedFormats();
+  for (const auto& implementation : implementations_) {
+    auto supported_formats = implementation.factory->GetSupportedFormats();
     formats.insert(formats.end(), supported_formats.begin(),
                    supported_formats.end());
   }
@@ -97,15 +214,68 @@ VideoDecoderFactory::CodecSupport VideoDecoderFactory::QueryCodecSupport(
   return codec_support;
 }
 
+std::vector<std::string> VideoDecoderFactory::GetImplementations(
+    const webrtc::SdpVideoFormat& format) const {
+  std::vector<std::string> implementations;
+  for (const auto& implementation : implementations_) {
+    if (format.IsCodecInList(implementation.factory->GetSupportedFormats()))
+      implementations.push_back(implementation.name);
+  }
+  if (IsSoftwareCodec(format))
+    implementations.push_back("software");
+  return implementations;
+}
+
 std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Create(
     const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) {
-  for (const auto& factory : factories_) {
-    for (const auto& supported_format : factory->GetSupportedFormats()) {
-      if (supported_format.IsSameCodec(format))
-        return factory->Create(env, format);
-    }
+  for (const auto& implementation : implementations_) {
+    if (format.IsCodecInList(implementation.factory->GetSupportedFormats()))
+      return Wrap(implementation.factory->Create(env, format));
   }
 
+  std::unique_ptr<webrtc::VideoDecoder> decoder = CreateSoftware(env, format);
+  if (!decoder)
+    RTC_LOG(LS_ERROR) << "No VideoDecoder found for " << format.name;
+  return Wrap(std::move(decoder));
+}
+
+std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Create(
+    const webrtc::Environment& env,
+    const webrtc::SdpVideoFormat& format,
+    const std::string& name) {
+  if (name == "software")
+    return Wrap(CreateSoftware(env, format));
+
+  for (const auto& implementation : implementations_) {
+    if (implementation.name == name &&
+        format.IsCodecInList(implementation.factory->GetSupportedFormats()))
+      return Wrap(implementation.factory->Create(env, format));
+  }
+  return nullptr;
+}
+
+std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Wrap(
+    std::unique_ptr<webrtc::VideoDecoder> decoder) {
+  if (!decoder)
+    return nullptr;
+  return std::make_unique<ManagedVideoDecoder>(std::move(decoder));
+}
+
+bool VideoDecoderFactory::IsSoftwareCodec(
+    const webrtc::SdpVideoFormat& format) {
+  if (absl::EqualsIgnoreCase(format.name, cricket::kVp8CodecName) ||
+      absl::EqualsIgnoreCase(format.name, cricket::kVp9CodecName) ||
+      absl::EqualsIgnoreCase(format.name, cricket::kH264CodecName))
+    return true;
+#if defined(RTC_DAV1D_IN_INTERNAL_DECODER_FACTORY)
+  if (absl::EqualsIgnoreCase(format.name, cricket::kAv1CodecName))
+    return true;
+#endif
+  return false;
+}
+
+std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::CreateSoftware(
+    const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) {
   if (absl::EqualsIgnoreCase(format.name, cricket::kVp8CodecName))
     return webrtc::CreateVp8Decoder(env);
   if (absl::EqualsIgnoreCase(format.name, cricket::kVp9CodecName))
@@ -113,15 +283,12 @@ std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Create(
   if (absl::EqualsIgnoreCase(format.name, cricket::kH264CodecName))
     return webrtc::H264Decoder::Create();
 
-
 #if defined(RTC_DAV1D_IN_INTERNAL_DECODER_FACTORY)
   if (absl::EqualsIgnoreCase(format.name, cricket::kAv1CodecName)) {
     return webrtc::CreateDav1dDecoder();
   }
 #endif
 
-
-  RTC_LOG(LS_ERROR) << "No VideoDecoder found for " << format.name;
   return nullptr;
 }
 
@@ -16,14 +16,26 @@
 
 #include "livekit/video_encoder_factory.h"
 
+#include <atomic>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
 #include "api/environment/environment_factory.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory_template.h"
+#include "livekit/encoded_passthrough.h"
+#include "livekit/fallback_video_encoder.h"
 #include "livekit/objc_video_factory.h"
+#include "livekit/parallel_simulcast_encoder.h"
+#include "livekit/simulcast_pyramid.h"
 #include "media/base/media_constants.h"
-#include "media/engine/simulcast_encoder_adapter.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
 #if defined(RTC_USE_LIBAOM_AV1_ENCODER)
 #include "api/video_codecs/video_encoder_factory_template_libaom_av1_adapter.h"
 #endif
@@ -47,6 +59,38 @@
 
 namespace livekit_ffi {
 
+namespace {
+
+std::atomic<bool> parallel_simulcast_encode{false};
+
+// How InternalFactory picks among the implementations supporting a codec.
+struct VideoEncoderSelection {
+  bool prefer_hardware = true;
+  // (codec name, implementation name), tried before any other implementation.
+  std::vector<std::pair<std::string, std::string>> pinned;
+  FallbackVideoEncoder::Options fallback;
+};
+
+webrtc::Mutex selection_mutex;
+VideoEncoderSelection encoder_selection RTC_GUARDED_BY(selection_mutex);
+
+VideoEncoderSelection video_encoder_selection() {
+  webrtc::MutexLock lock(&selection_mutex);
+  return encoder_selection;
+}
+
+EncodeTimingStats to_rust_timing(const SimulcastEncodeTiming& timing) {
+  EncodeTimingStats rust_timing{};
+  rust_timing.count = timing.count;
+  rust_timing.last_us = timing.last_us;
+  rust_timing.max_us = timing.max_us;
+  rust_timing.avg_us =
+      timing.count ? static_cast<double>(timing.total_us) / timing.count : 0.0;
+  return rust_timing;
+}
+
+}  // namespace
+
 using Factory = webrtc::VideoEncoderFactoryTemplate<
     webrtc::LibvpxVp8EncoderTemplateAdapter,
 #if defined(WEBRTC_USE_H264)
@@ -59,73 +103,146 @@ using Factory = webrtc::VideoEncoderFactoryTemplate<
 
 VideoEncoderFactory::InternalFactory::InternalFactory() {
 #ifdef __APPLE__
-  factories_.push_back(livekit_ffi::CreateObjCVideoEncoderFactory());
+  AddImplementation("videotoolbox", true,
+                    livekit_ffi::CreateObjCVideoEncoderFactory());
 #endif
 
 #ifdef WEBRTC_ANDROID
-  factories_.push_back(CreateAndroidVideoEncoderFactory());
+  AddImplementation("mediacodec", true, CreateAndroidVideoEncoderFactory());
 #endif
 
 #if defined(USE_NVIDIA_VIDEO_CODEC)
   if (webrtc::NvidiaVideoEncoderFactory::IsSupported()) {
-    factories_.push_back(std::make_unique<webrtc::NvidiaVideoEncoderFactory>());
-  } else {
+    AddImplementation("nvidia", true,
+                      std::make_unique<webrtc::NvidiaVideoEncoderFactory>());
+  }
 #endif
 
 #if defined(USE_VAAPI_VIDEO_CODEC)
-    if (webrtc::VAAPIVideoEncoderFactory::IsSupported()) {
-      factories_.push_back(std::make_unique<webrtc::VAAPIVideoEncoderFactory>());
-    }
+  if (webrtc::VAAPIVideoEncoderFactory::IsSupported()) {
+    AddImplementation("vaapi", true,
+                      std::make_unique<webrtc::VAAPIVideoEncoderFactory>());
+  }
 #endif
 
-#if defined(USE_NVIDIA_VIDEO_CODEC)
+  AddImplementation("software", false, std::make_unique<Factory>());
+
+  for (bool hardware : {false, true}) {
+    for (const Implementation& implementation : implementations_) {
+      if (implementation.hardware == hardware)
+        formats_.insert(formats_.end(), implementation.formats.begin(),
+                        implementation.formats.end());
+    }
   }
-#endif
+}
+
+void VideoEncoderFactory::InternalFactory::AddImplementation(
+    std::string name,
+    bool hardware,
+    std::unique_ptr<webrtc::VideoEncoderFactory> factory) {
+  if (!factory)
+    return;
+
+  std::vector<webrtc::SdpVideoFormat> formats = factory->GetSupportedFormats();
+  implementations_.push_back(
+      {std::move(name), hardware, std::move(factory), std::move(formats)});
+}
+
+std::optional<webrtc::SdpVideoFormat>
+VideoEncoderFactory::InternalFactory::Match(
+    const Implementation& implementation,
+    const webrtc::SdpVideoFormat& format) const {
+  if (!implementation.hardware)
+    return webrtc::FuzzyMatchSdpVideoFormat(implementation.formats, format);
+
+  for (const auto& supported_format : implementation.formats) {
+    if (supported_format.IsSameCodec(format))
+      return format;
+  }
+  return std::nullopt;
 }
 
 std::vector<webrtc::SdpVideoFormat>
 VideoEncoderFactory::InternalFactory::GetSupportedFormats() const {
-  std::vector<webrtc::SdpVideoFormat> formats = Factory().GetSupportedFormats();
+  return formats_;
+}
 
-  for (const auto& factory : factories_) {
-    auto supported_formats = factory->GetSupportedFormats();
-    formats.insert(formats.end(), supported_formats.begin(),
-                   supported_formats.end());
-  }
-  return formats;
+bool VideoEncoderFactory::InternalFactory::IsSupported(
+    const webrtc::SdpVideoFormat& format) const {
+  return format.IsCodecInList(formats_);
 }
 
 VideoEncoderFactory::CodecSupport
 VideoEncoderFactory::InternalFactory::QueryCodecSupport(
     const webrtc::SdpVideoFormat& format,
     std::optional<std::string> scalability_mode) const {
-  auto original_format =
-      webrtc::FuzzyMatchSdpVideoFormat(Factory().GetSupportedFormats(), format);
-  return original_format
-             ? Factory().QueryCodecSupport(*original_format, scalability_mode)
-             : webrtc::VideoEncoderFactory::CodecSupport{.is_supported = false};
+  for (const Implementation& implementation : implementations_) {
+    if (implementation.hardware)
+      continue;
+
+    auto original_format = Match(implementation, format);
+    if (original_format)
+      return implementation.factory->QueryCodecSupport(*original_format,
+                                                       scalability_mode);
+  }
+  return webrtc::VideoEncoderFactory::CodecSupport{.is_supported = false};
 }
 
 std::unique_ptr<webrtc::VideoEncoder>
 VideoEncoderFactory::InternalFactory::Create(
     const webrtc::Environment& env,
     const webrtc::SdpVideoFormat& format) {
-  for (const auto& factory : factories_) {
-    for (const auto& supported_format : factory->GetSupportedFormats()) {
-      if (supported_format.IsSameCodec(format))
-        return factory->Create(env, format);
+  VideoEncoderSelection selection = video_encoder_selection();
+
+  std::vector<FallbackVideoEncoder::Candidate> candidates;
+  auto add_candidate = [&](const Implementation& implementation) {
+    for (const auto& candidate : candidates) {
+      if (candidate.name == implementation.name)
+        return;
+    }
+
+    std::optional<webrtc::SdpVideoFormat> matched_format =
+        Match(implementation, format);
+    if (!matched_format)
+      return;
+
+    webrtc::VideoEncoderFactory* factory = implementation.factory.get();
+    candidates.push_back({implementation.name, implementation.hardware,
+                          [factory, env, format = *matched_format]() {
+                            return factory->Create(env, format);
+                          }});
+  };
+
+  for (const auto& [codec, name] : selection.pinned) {
+    if (!absl::EqualsIgnoreCase(codec, format.name))
+      continue;
+    for (const Implementation& implementation : implementations_) {
+      if (implementation.name == name)
+        add_candidate(implementation);
     }
   }
 
-  auto original_format =
-      webrtc::FuzzyMatchSdpVideoFormat(Factory().GetSupportedFormats(), format);
+  const bool prefer_hardware = selection.prefer_hardware;
+  for (bool hardware : {prefer_hardware, !prefer_hardware}) {
+    for (const Implementation& implementation : implementations_) {
+      if (implementation.hardware == hardware)
+        add_candidate(implementation);
+    }
+  }
 
-  if (original_format) {
-    return Factory().Create(env, *original_format);
+  if (candidates.empty()) {
+    RTC_LOG(LS_ERROR) << "No VideoEncoder found for " << format.name;
+    return nullptr;
   }
 
-  RTC_LOG(LS_ERROR) << "No VideoEncoder found for " << format.name;
-  return nullptr;
+  RTC_LOG(LS_INFO) << "Using the " << candidates.front().name << " encoder for "
+                   << format.name;
+
+  const FallbackVideoEncoder::Options& fallback = selection.fallback;
+  if (candidates.size() == 1 ||
+      (!fallback.on_init_failure && !fallback.on_encode_failure))
+    return candidates.front().create();
+  return FallbackVideoEncoder::Create(std::move(candidates), fallback);
 }
 
 VideoEncoderFactory::VideoEncoderFactory() {
@@ -147,12 +264,52 @@ std::unique_ptr<webrtc::VideoEncoder> VideoEncoderFactory::Create(
     const webrtc::Environment& env,
     const webrtc::SdpVideoFormat& format) {
   std::unique_ptr<webrtc::VideoEncoder> encoder;
-  if (format.IsCodecInList(internal_factory_->GetSupportedFormats())) {
-    encoder = std::make_unique<webrtc::SimulcastEncoderAdapter>(
-        env, internal_factory_.get(), nullptr, format);
+  if (internal_factory_->IsSupported(format)) {
+    // SimulcastEncoderAdapter scales every layer from the input frame, the
+    // pyramid gives it the layers prescaled from one another instead.
+    encoder = std::make_unique<PassthroughVideoEncoder>(
+        std::make_unique<SimulcastPyramidEncoder>(
+            std::make_unique<ParallelSimulcastEncoder>(
+                env, internal_factory_.get(), format,
+                parallel_simulcast_encode.load(std::memory_order_relaxed))));
   }
 
   return encoder;
 }
 
+void set_parallel_simulcast_encode(bool enabled) {
+  parallel_simulcast_encode.store(enabled, std::memory_order_relaxed);
+}
+
+void set_video_encoder_policy(VideoEncoderPolicy policy) {
+  VideoEncoderSelection new_selection;
+  new_selection.prefer_hardware =
+      policy.preference == VideoEncoderPreference::Hardware;
+  for (const VideoEncoderPin& pin : policy.pins)
+    new_selection.pinned.emplace_back(std::string(pin.codec),
+                                      std::string(pin.implementation));
+  new_selection.fallback.on_init_failure = policy.fallback_on_init_failure;
+  new_selection.fallback.on_encode_failure = policy.fallback_on_encode_failure;
+  new_selection.fallback.max_encode_time_ms = policy.max_encode_time_ms;
+
+  webrtc::MutexLock lock(&selection_mutex);
+  encoder_selection = std::move(new_selection);
+}
+
+uint64_t video_encoder_fallbacks() {
+  return FallbackVideoEncoder::total_fallbacks();
+}
+
+rust::Vec<SimulcastEncodeStats> simulcast_encode_stats() {
+  rust::Vec<SimulcastEncodeStats> rust_stats;
+  for (const SimulcastEncodeTimings& timings : GetSimulcastEncodeTimings()) {
+    SimulcastEncodeStats encoder_stats{};
+    encoder_stats.frame = to_rust_timing(timings.frame);
+    for (const SimulcastEncodeTiming& layer : timings.layers)
+      encoder_stats.layers.push_back(to_rust_timing(layer));
+    rust_stats.push_back(std::move(encoder_stats));
+  }
+  return rust_stats;
+}
+
 }  // namespace livekit_ffi
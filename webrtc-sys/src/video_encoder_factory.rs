@@ -0,0 +1,77 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#[cxx::bridge(namespace = "livekit_ffi")]
+pub mod ffi {
+    #[derive(Debug, Default, Clone, Copy)]
+    pub struct EncodeTimingStats {
+        pub count: u64,
+        /// Wall-clock time of the last encode, in microseconds.
+        pub last_us: i64,
+        pub max_us: i64,
+        pub avg_us: f64,
+    }
+
+    /// Encode times of one simulcast encoder.
+    #[derive(Debug, Default, Clone)]
+    pub struct SimulcastEncodeStats {
+        /// From the input frame to all of its layers being encoded.
+        pub frame: EncodeTimingStats,
+        /// Indexed by simulcast stream, lowest resolution first.
+        pub layers: Vec<EncodeTimingStats>,
+    }
+
+    #[derive(Debug, Clone, Copy, PartialEq, Eq)]
+    #[repr(i32)]
+    pub enum VideoEncoderPreference {
+        Hardware,
+        Software,
+    }
+
+    /// Use `implementation` for `codec` whenever it supports it.
+    #[derive(Debug, Clone)]
+    pub struct VideoEncoderPin {
+        pub codec: String,
+        /// "software", "nvidia", "vaapi", "videotoolbox" or "mediacodec".
+        pub implementation: String,
+    }
+
+    #[derive(Debug, Clone)]
+    pub struct VideoEncoderPolicy {
+        pub preference: VideoEncoderPreference,
+        pub pins: Vec<VideoEncoderPin>,
+        /// Try the next implementation when one fails to initialize.
+        pub fallback_on_init_failure: bool,
+        /// Replace a hardware encoder by a software one when an encode fails,
+        /// or when it can't keep up if max_encode_time_ms is set.
+        pub fallback_on_encode_failure: bool,
+        /// Longest acceptable encode time before falling back, 0 to only
+        /// fall back on encode errors.
+        pub max_encode_time_ms: i32,
+    }
+
+    unsafe extern "C++" {
+        include!("livekit/video_encoder_factory.h");
+
+        /// Only applies to the encoders created afterwards.
+        fn set_parallel_simulcast_encode(enabled: bool);
+        /// One entry per live simulcast encoder, i.e. per published
+        /// simulcast track.
+        fn simulcast_encode_stats() -> Vec<SimulcastEncodeStats>;
+
+        /// Only applies to the encoders created afterwards.
+        fn set_video_encoder_policy(policy: VideoEncoderPolicy);
+        fn video_encoder_fallbacks() -> u64;
+    }
+}
@@ -48,12 +48,15 @@ VideoTrack::~VideoTrack() {
 
 void VideoTrack::add_sink(const std::shared_ptr<NativeVideoSink>& sink) const {
   webrtc::MutexLock lock(&mutex_);
-  track()->AddOrUpdateSink(sink.get(),
-                           webrtc::VideoSinkWants());  // TODO(theomonnom): Expose
-                                                    // VideoSinkWants to Rust?
+  track()->AddOrUpdateSink(sink.get(), webrtc::VideoSinkWants());
   sinks_.push_back(sink);
 }
 
+void VideoTrack::set_sink_wants(const std::shared_ptr<NativeVideoSink>& sink,
+                                const VideoSinkWants& wants) const {
+  sink->set_wants(wants);
+}
+
 void VideoTrack::remove_sink(
     const std::shared_ptr<NativeVideoSink>& sink) const {
   webrtc::MutexLock lock(&mutex_);
@@ -82,7 +85,42 @@ NativeVideoSink::NativeVideoSink(rust::Box<VideoSinkWrapper> observer)
     : observer_(std::move(observer)) {}
 
 void NativeVideoSink::OnFrame(const webrtc::VideoFrame& frame) {
-  observer_->on_frame(std::make_unique<VideoFrame>(frame));
+  // Encoded frames of passthrough sources are meant for the encoder only,
+  // there are no pixels to render or convert.
+  if (EncodedVideoFrameBuffer::From(frame.video_frame_buffer().get()))
+    return;
+
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> adapted;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (adapt_) {
+      int crop_width, crop_height, out_width, out_height;
+      // Remote frames carry their render time, use the arrival time so the
+      // framerate limit works the same for every track.
+      if (!adapter_.AdaptFrameResolution(
+              frame.width(), frame.height(), webrtc::TimeNanos(), &crop_width,
+              &crop_height, &out_width, &out_height)) {
+        return;  // Dropped to honor max_framerate_fps
+      }
+
+      if (out_width != frame.width() || out_height != frame.height()) {
+        adapted = frame.video_frame_buffer()->CropAndScale(
+            (frame.width() - crop_width) / 2,
+            (frame.height() - crop_height) / 2, crop_width, crop_height,
+            out_width, out_height);
+      }
+    }
+  }
+
+  // The wrapper only lives for the duration of the callback, Rust must take
+  // its own reference to the buffer if it wants to keep the frame around.
+  // Copying a webrtc::VideoFrame only bumps the buffer refcount.
+  webrtc::VideoFrame delivered(frame);
+  if (adapted)
+    delivered.set_video_frame_buffer(adapted);
+
+  VideoFrame borrowed(delivered);
+  observer_->on_frame(borrowed);
 }
 
 void NativeVideoSink::OnDiscardedFrame() {
@@ -99,6 +137,23 @@ void NativeVideoSink::OnConstraintsChanged(
   observer_->on_constraints_changed(cst);
 }
 
+void NativeVideoSink::set_wants(const VideoSinkWants& wants) {
+  webrtc::VideoSinkWants rtc_wants;
+  if (wants.max_pixel_count > 0)
+    rtc_wants.max_pixel_count = wants.max_pixel_count;
+  if (wants.target_pixel_count > 0)
+    rtc_wants.target_pixel_count = wants.target_pixel_count;
+  if (wants.max_framerate_fps > 0)
+    rtc_wants.max_framerate_fps = wants.max_framerate_fps;
+  if (wants.resolution_alignment > 0)
+    rtc_wants.resolution_alignment = wants.resolution_alignment;
+
+  webrtc::MutexLock lock(&mutex_);
+  adapter_.OnSinkWants(rtc_wants);
+  adapt_ = wants.max_pixel_count > 0 || wants.target_pixel_count > 0 ||
+           wants.max_framerate_fps > 0 || wants.resolution_alignment > 1;
+}
+
 std::shared_ptr<NativeVideoSink> new_native_video_sink(
     rust::Box<VideoSinkWrapper> observer) {
   return std::make_shared<NativeVideoSink>(std::move(observer));
@@ -175,7 +230,29 @@ bool VideoTrackSource::InternalSource::on_captured_frame(
   return true;
 }
 
-VideoTrackSource::VideoTrackSource(const VideoResolution& resolution) {
+bool VideoTrackSource::InternalSource::on_captured_encoded_frame(
+    webrtc::scoped_refptr<EncodedVideoFrameBuffer> buffer,
+    int64_t timestamp_us) {
+  webrtc::MutexLock lock(&mutex_);
+
+  int64_t aligned_timestamp_us = timestamp_aligner_.TranslateTimestamp(
+      timestamp_us, webrtc::TimeMicros());
+
+  if (resolution_.height == 0 || resolution_.width == 0) {
+    resolution_ = VideoResolution{static_cast<uint32_t>(buffer->width()),
+                                  static_cast<uint32_t>(buffer->height())};
+  }
+
+  OnFrame(webrtc::VideoFrame::Builder()
+              .set_video_frame_buffer(buffer)
+              .set_timestamp_us(aligned_timestamp_us)
+              .build());
+
+  return true;
+}
+
+VideoTrackSource::VideoTrackSource(const VideoResolution& resolution)
+    : keyframe_request_(std::make_shared<std::atomic<bool>>(false)) {
   source_ = webrtc::make_ref_counted<InternalSource>(resolution);
 }
 
@@ -189,6 +266,35 @@ bool VideoTrackSource::on_captured_frame(
   return source_->on_captured_frame(rtc_frame);
 }
 
+bool VideoTrackSource::on_captured_encoded_frame(
+    const EncodedVideoFrameInfo& info,
+    rust::Slice<const uint8_t> data) const {
+  webrtc::VideoCodecType codec;
+  switch (info.codec) {
+    case EncodedVideoCodec::H264:
+      codec = webrtc::kVideoCodecH264;
+      break;
+    case EncodedVideoCodec::VP8:
+      codec = webrtc::kVideoCodecVP8;
+      break;
+    default:
+      return false;
+  }
+
+  if (data.empty() || info.width == 0 || info.height == 0)
+    return false;
+
+  auto buffer = webrtc::make_ref_counted<EncodedVideoFrameBuffer>(
+      codec, webrtc::EncodedImageBuffer::Create(data.data(), data.size()),
+      info.keyframe, info.width, info.height, encoded_sequence_++,
+      keyframe_request_);
+  return source_->on_captured_encoded_frame(buffer, info.timestamp_us);
+}
+
+bool VideoTrackSource::take_keyframe_request() const {
+  return keyframe_request_->exchange(false, std::memory_order_relaxed);
+}
+
 webrtc::scoped_refptr<VideoTrackSource::InternalSource> VideoTrackSource::get()
     const {
   return source_;
@@ -14,8 +14,6 @@
 
 use std::sync::Arc;
 
-use cxx::UniquePtr;
-
 use crate::{impl_thread_safety, video_frame::ffi::VideoFrame};
 
 #[cxx::bridge(namespace = "livekit_ffi")]
@@ -36,12 +34,40 @@ pub mod ffi {
         pub max_fps: f64,
     }
 
+    /// Constraints a sink puts on the frames it receives, 0 means no limit.
+    #[derive(Debug, Default, Clone, Copy)]
+    pub struct VideoSinkWants {
+        pub max_pixel_count: i32,
+        pub target_pixel_count: i32,
+        pub max_framerate_fps: i32,
+        pub resolution_alignment: i32,
+    }
+
     #[derive(Debug)]
     pub struct VideoResolution {
         pub width: u32,
         pub height: u32,
     }
 
+    /// Codecs an encoded source can publish without re-encoding.
+    #[derive(Debug)]
+    #[repr(i32)]
+    pub enum EncodedVideoCodec {
+        /// Annex B byte stream, SPS/PPS in front of every keyframe.
+        H264,
+        VP8,
+    }
+
+    #[derive(Debug)]
+    pub struct EncodedVideoFrameInfo {
+        pub codec: EncodedVideoCodec,
+        pub keyframe: bool,
+        pub width: u32,
+        pub height: u32,
+        /// Capture time, the RTP timestamp is derived from it.
+        pub timestamp_us: i64,
+    }
+
     extern "C++" {
         include!("livekit/video_frame.h");
         include!("livekit/media_stream_track.h");
@@ -59,6 +85,11 @@ pub mod ffi {
 
         fn add_sink(self: &VideoTrack, sink: &SharedPtr<NativeVideoSink>);
         fn remove_sink(self: &VideoTrack, sink: &SharedPtr<NativeVideoSink>);
+        fn set_sink_wants(
+            self: &VideoTrack,
+            sink: &SharedPtr<NativeVideoSink>,
+            wants: &VideoSinkWants,
+        );
         fn set_should_receive(self: &VideoTrack, should_receive: bool);
         fn should_receive(self: &VideoTrack) -> bool;
         fn content_hint(self: &VideoTrack) -> ContentHint;
@@ -67,6 +98,12 @@ pub mod ffi {
 
         fn video_resolution(self: &VideoTrackSource) -> VideoResolution;
         fn on_captured_frame(self: &VideoTrackSource, frame: &UniquePtr<VideoFrame>) -> bool;
+        fn on_captured_encoded_frame(
+            self: &VideoTrackSource,
+            info: &EncodedVideoFrameInfo,
+            data: &[u8],
+        ) -> bool;
+        fn take_keyframe_request(self: &VideoTrackSource) -> bool;
         fn new_video_track_source(resolution: &VideoResolution) -> SharedPtr<VideoTrackSource>;
         fn video_to_media(track: SharedPtr<VideoTrack>) -> SharedPtr<MediaStreamTrack>;
         unsafe fn media_to_video(track: SharedPtr<MediaStreamTrack>) -> SharedPtr<VideoTrack>;
@@ -76,7 +113,7 @@ pub mod ffi {
     extern "Rust" {
         type VideoSinkWrapper;
 
-        fn on_frame(self: &VideoSinkWrapper, frame: UniquePtr<VideoFrame>);
+        fn on_frame(self: &VideoSinkWrapper, frame: &VideoFrame);
         fn on_discarded_frame(self: &VideoSinkWrapper);
         fn on_constraints_changed(
             self: &VideoSinkWrapper,
@@ -90,7 +127,10 @@ impl_thread_safety!(ffi::NativeVideoSink, Send + Sync);
 impl_thread_safety!(ffi::VideoTrackSource, Send + Sync);
 
 pub trait VideoSink: Send {
-    fn on_frame(&self, frame: UniquePtr<VideoFrame>);
+    /// The frame is only borrowed for the duration of the call, nothing is
+    /// allocated to deliver it. Use `video_frame_buffer()` to keep a reference
+    /// to the underlying buffer.
+    fn on_frame(&self, frame: &VideoFrame);
     fn on_discarded_frame(&self);
     fn on_constraints_changed(&self, constraints: ffi::VideoTrackSourceConstraints);
 }
@@ -104,7 +144,7 @@ impl VideoSinkWrapper {
         Self { observer }
     }
 
-    fn on_frame(&self, frame: UniquePtr<VideoFrame>) {
+    fn on_frame(&self, frame: &VideoFrame) {
         self.observer.on_frame(frame);
     }
 
@@ -116,3 +156,211 @@ impl VideoSinkWrapper {
         self.observer.on_constraints_changed(constraints);
     }
 }
+
+#[cfg(all(test, target_os = "linux", target_env = "gnu"))]
+mod tests {
+    use std::cell::Cell;
+    use std::ffi::c_void;
+    use std::sync::atomic::{AtomicU32, AtomicUsize, Ordering};
+    use std::sync::Arc;
+
+    use super::*;
+    use crate::{
+        peer_connection_factory::ffi as pcf, video_frame::ffi as vf, video_frame_buffer::ffi as vfb,
+    };
+
+    // Interpose the libc allocator so that both Rust allocations and C++
+    // operator new (which ends up in malloc) are counted. libwebrtc is
+    // statically linked, its calls resolve to the definitions below.
+    extern "C" {
+        fn __libc_malloc(size: usize) -> *mut c_void;
+        fn __libc_calloc(n: usize, size: usize) -> *mut c_void;
+        fn __libc_realloc(ptr: *mut c_void, size: usize) -> *mut c_void;
+        fn __libc_memalign(align: usize, size: usize) -> *mut c_void;
+    }
+
+    thread_local! {
+        static ALLOCATIONS: Cell<usize> = const { Cell::new(0) };
+    }
+
+    fn count() {
+        let _ = ALLOCATIONS.try_with(|n| n.set(n.get() + 1));
+    }
+
+    #[no_mangle]
+    unsafe extern "C" fn malloc(size: usize) -> *mut c_void {
+        count();
+        __libc_malloc(size)
+    }
+
+    #[no_mangle]
+    unsafe extern "C" fn calloc(n: usize, size: usize) -> *mut c_void {
+        count();
+        __libc_calloc(n, size)
+    }
+
+    #[no_mangle]
+    unsafe extern "C" fn realloc(ptr: *mut c_void, size: usize) -> *mut c_void {
+        count();
+        __libc_realloc(ptr, size)
+    }
+
+    #[no_mangle]
+    unsafe extern "C" fn aligned_alloc(align: usize, size: usize) -> *mut c_void {
+        count();
+        __libc_memalign(align, size)
+    }
+
+    #[no_mangle]
+    unsafe extern "C" fn posix_memalign(out: *mut *mut c_void, align: usize, size: usize) -> i32 {
+        count();
+        let ptr = __libc_memalign(align, size);
+        if ptr.is_null() {
+            return 12; // ENOMEM
+        }
+        *out = ptr;
+        0
+    }
+
+    fn allocations() -> usize {
+        ALLOCATIONS.with(|n| n.get())
+    }
+
+    #[derive(Default)]
+    struct BorrowingSink {
+        frames: AtomicUsize,
+    }
+
+    impl VideoSink for BorrowingSink {
+        fn on_frame(&self, frame: &VideoFrame) {
+            assert_eq!(frame.width(), 64);
+            self.frames.fetch_add(1, Ordering::Relaxed);
+        }
+
+        fn on_discarded_frame(&self) {}
+
+        fn on_constraints_changed(&self, _constraints: ffi::VideoTrackSourceConstraints) {}
+    }
+
+    #[derive(Default)]
+    struct SizeSink {
+        width: AtomicU32,
+        height: AtomicU32,
+    }
+
+    impl VideoSink for SizeSink {
+        fn on_frame(&self, frame: &VideoFrame) {
+            self.width.store(frame.width(), Ordering::Relaxed);
+            self.height.store(frame.height(), Ordering::Relaxed);
+        }
+
+        fn on_discarded_frame(&self) {}
+
+        fn on_constraints_changed(&self, _constraints: ffi::VideoTrackSourceConstraints) {}
+    }
+
+    fn i420_frame(width: i32, height: i32) -> cxx::UniquePtr<vf::VideoFrame> {
+        let i420 = vfb::new_i420_buffer(width, height, width, width / 2, width / 2);
+        let mut builder = vf::new_video_frame_builder();
+        unsafe {
+            let buffer = vfb::yuv_to_vfb(vfb::yuv8_to_yuv(vfb::i420_to_yuv8(&*i420)));
+            builder.pin_mut().set_video_frame_buffer(&*buffer);
+        }
+        builder.pin_mut().set_timestamp_us(1);
+        builder.pin_mut().build()
+    }
+
+    #[test]
+    fn sink_wants_only_adapt_their_sink() {
+        let factory = pcf::create_peer_connection_factory();
+        let source = ffi::new_video_track_source(&ffi::VideoResolution { width: 64, height: 64 });
+        let track = factory.create_video_track("test".to_owned(), source.clone());
+
+        let small = Arc::new(SizeSink::default());
+        let small_sink = ffi::new_native_video_sink(Box::new(VideoSinkWrapper::new(small.clone())));
+        let full = Arc::new(SizeSink::default());
+        let full_sink = ffi::new_native_video_sink(Box::new(VideoSinkWrapper::new(full.clone())));
+        track.set_sink_wants(
+            &small_sink,
+            &ffi::VideoSinkWants {
+                max_pixel_count: 32 * 32,
+                target_pixel_count: 0,
+                max_framerate_fps: 0,
+                resolution_alignment: 0,
+            },
+        );
+        track.add_sink(&small_sink);
+        track.add_sink(&full_sink);
+
+        let frame = i420_frame(64, 64);
+        for _ in 0..10 {
+            source.on_captured_frame(&frame);
+        }
+
+        let small_pixels =
+            small.width.load(Ordering::Relaxed) * small.height.load(Ordering::Relaxed);
+        assert!(small_pixels > 0 && small_pixels <= 32 * 32, "got {} pixels", small_pixels);
+        assert_eq!(full.width.load(Ordering::Relaxed), 64, "the other sink was downscaled");
+        assert_eq!(full.height.load(Ordering::Relaxed), 64);
+
+        track.remove_sink(&small_sink);
+        track.remove_sink(&full_sink);
+    }
+
+    #[test]
+    fn encoded_frames_skip_local_sinks() {
+        let factory = pcf::create_peer_connection_factory();
+        let source = ffi::new_video_track_source(&ffi::VideoResolution { width: 64, height: 64 });
+        let track = factory.create_video_track("test".to_owned(), source.clone());
+
+        let sink = Arc::new(SizeSink::default());
+        let native_sink = ffi::new_native_video_sink(Box::new(VideoSinkWrapper::new(sink.clone())));
+        track.add_sink(&native_sink);
+
+        let info = ffi::EncodedVideoFrameInfo {
+            codec: ffi::EncodedVideoCodec::VP8,
+            keyframe: true,
+            width: 64,
+            height: 64,
+            timestamp_us: 1,
+        };
+        assert!(source.on_captured_encoded_frame(&info, &[0x10, 0x00, 0x00, 0x9d, 0x01, 0x2a]));
+        assert_eq!(sink.width.load(Ordering::Relaxed), 0, "an encoded frame reached the sink");
+
+        // Raw frames of the same track still go through.
+        source.on_captured_frame(&i420_frame(64, 64));
+        assert_eq!(sink.width.load(Ordering::Relaxed), 64);
+
+        track.remove_sink(&native_sink);
+    }
+
+    #[test]
+    fn on_frame_does_not_allocate() {
+        let factory = pcf::create_peer_connection_factory();
+        let source = ffi::new_video_track_source(&ffi::VideoResolution { width: 64, height: 64 });
+        let track = factory.create_video_track("test".to_owned(), source.clone());
+
+        let sink = Arc::new(BorrowingSink::default());
+        let native_sink = ffi::new_native_video_sink(Box::new(VideoSinkWrapper::new(sink.clone())));
+        track.add_sink(&native_sink);
+
+        let frame = i420_frame(64, 64);
+
+        // Warm up, the first frames may initialize lazy state in the source.
+        for _ in 0..10 {
+            source.on_captured_frame(&frame);
+        }
+
+        let delivered = sink.frames.load(Ordering::Relaxed);
+        let before = allocations();
+        for _ in 0..100 {
+            source.on_captured_frame(&frame);
+        }
+        let after = allocations();
+
+        assert!(sink.frames.load(Ordering::Relaxed) > delivered, "no frame was delivered");
+        assert_eq!(after - before, 0, "frame delivery allocated");
+
+        track.remove_sink(&native_sink);
+    }
+}
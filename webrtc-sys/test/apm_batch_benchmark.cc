@@ -0,0 +1,171 @@
+// Offline noise suppression and gain control through AudioProcessingModule:
+// one call per 10 ms block, the way the Rust wrapper used to feed it, versus
+// one process_stream_batch call for the whole buffer, with int16 and float
+// samples. Runs one module per thread on 1 and on every core, and reports
+// the real-time factor per core (audio duration / processing time).
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "livekit/apm.h"
+
+namespace {
+
+constexpr int kSeconds = 60;
+
+struct Format {
+  int sample_rate;
+  int num_channels;
+};
+
+const Format kFormats[] = {{16000, 1}, {48000, 1}, {48000, 2}};
+
+enum class Mode { kPerBlock, kBatch, kBatchFloat };
+
+const char* ModeName(Mode mode) {
+  switch (mode) {
+    case Mode::kPerBlock:
+      return "per 10ms";
+    case Mode::kBatch:
+      return "batch";
+    case Mode::kBatchFloat:
+      return "batch f32";
+  }
+  return "";
+}
+
+// Voiced bursts over background noise, so the suppressor and the gain
+// controller have something to do.
+std::vector<float> CreateAudio(const Format& format, uint32_t seed) {
+  const size_t frames = static_cast<size_t>(format.sample_rate) * kSeconds;
+  std::vector<float> audio(frames * format.num_channels);
+  for (size_t i = 0; i < frames; i++) {
+    double t = static_cast<double>(i) / format.sample_rate;
+    double envelope = std::fmod(t, 1.5) < 1.0 ? 0.3 : 0.0;
+    double voice = 0;
+    for (int harmonic = 1; harmonic <= 8; harmonic++)
+      voice += std::sin(2 * M_PI * 140 * harmonic * t) / harmonic;
+    for (int ch = 0; ch < format.num_channels; ch++) {
+      seed = seed * 1664525u + 1013904223u;
+      double noise = (static_cast<int32_t>(seed) / 2147483648.0) * 0.02;
+      audio[i * format.num_channels + ch] =
+          static_cast<float>(envelope * voice / 3 + noise);
+    }
+  }
+  return audio;
+}
+
+std::vector<int16_t> ToInt16(const std::vector<float>& audio) {
+  std::vector<int16_t> samples(audio.size());
+  for (size_t i = 0; i < audio.size(); i++)
+    samples[i] = static_cast<int16_t>(audio[i] * 32767);
+  return samples;
+}
+
+struct Input {
+  std::vector<float> audio;
+  // Empty without echo canceller.
+  std::vector<float> reverse;
+};
+
+// Processes a copy of |input|, returns false on error.
+bool Process(const Format& format, Mode mode, const Input& input) {
+  const bool echo_canceller = !input.reverse.empty();
+  std::unique_ptr<livekit_ffi::AudioProcessingModule> apm =
+      livekit_ffi::create_apm(echo_canceller, /*gain_controller_enabled=*/true,
+                              /*high_pass_filter_enabled=*/true,
+                              /*noise_suppression_enabled=*/true);
+
+  std::vector<float> audio = input.audio;
+  std::vector<float> reverse = input.reverse;
+  if (mode == Mode::kBatchFloat) {
+    return apm->process_stream_batch_f32(
+               audio.data(), audio.size(), audio.data(), reverse.data(),
+               reverse.size(), reverse.data(), format.sample_rate,
+               format.num_channels) == 0;
+  }
+
+  std::vector<int16_t> samples = ToInt16(audio);
+  std::vector<int16_t> reverse_samples = ToInt16(reverse);
+  if (mode == Mode::kBatch) {
+    return apm->process_stream_batch(
+               samples.data(), samples.size(), samples.data(),
+               reverse_samples.data(), reverse_samples.size(),
+               reverse_samples.data(), format.sample_rate,
+               format.num_channels) == 0;
+  }
+
+  const size_t block = format.sample_rate / 100 * format.num_channels;
+  for (size_t offset = 0; offset < samples.size(); offset += block) {
+    if (echo_canceller &&
+        apm->process_reverse_stream(reverse_samples.data() + offset, block,
+                                    reverse_samples.data() + offset, block,
+                                    format.sample_rate,
+                                    format.num_channels) != 0)
+      return false;
+    if (apm->process_stream(samples.data() + offset, block,
+                            samples.data() + offset, block,
+                            format.sample_rate, format.num_channels) != 0)
+      return false;
+  }
+  return true;
+}
+
+// Returns the real-time factor per core of |threads| concurrent jobs, 0 on
+// error.
+double Run(const Format& format, Mode mode, const Input& input, int threads) {
+  std::vector<std::thread> jobs;
+  std::vector<char> ok(threads);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threads; i++)
+    jobs.emplace_back([&, i]() { ok[i] = Process(format, mode, input); });
+  for (std::thread& job : jobs)
+    job.join();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  for (char job_ok : ok) {
+    if (!job_ok)
+      return 0;
+  }
+  return kSeconds / std::chrono::duration<double>(elapsed).count();
+}
+
+}  // namespace
+
+int main() {
+  const int cores =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  printf("%ds of audio per job, NS + AGC + HPF, %d cores\n", kSeconds,
+         cores);
+  printf("%6s %3s %4s %10s %12s %12s\n", "rate", "ch", "aec", "mode",
+         "1 thread", "all cores");
+  for (const Format& format : kFormats) {
+    for (bool echo_canceller : {false, true}) {
+      Input input;
+      input.audio = CreateAudio(format, 1);
+      if (echo_canceller)
+        input.reverse = CreateAudio(format, 2);
+
+      // Warm up.
+      Run(format, Mode::kBatch, input, 1);
+
+      for (Mode mode : {Mode::kPerBlock, Mode::kBatch, Mode::kBatchFloat}) {
+        double single = Run(format, mode, input, 1);
+        double all = cores == 1 ? single : Run(format, mode, input, cores);
+        printf("%6d %3d %4s %10s %11.1fx %11.1fx\n", format.sample_rate,
+               format.num_channels, echo_canceller ? "on" : "off",
+               ModeName(mode), single, all);
+      }
+    }
+  }
+
+  return 0;
+}
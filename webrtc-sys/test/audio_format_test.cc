@@ -0,0 +1,94 @@
+// Checks the int16/float and planar/interleaved conversions of the float
+// audio path against each other.
+
+#include <cstdint>
+#include <vector>
+
+#include "livekit/audio_format.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr size_t kFrames = 480;
+constexpr size_t kChannels = 2;
+
+std::vector<int16_t> CreateSamples() {
+  std::vector<int16_t> samples(kFrames * kChannels);
+  uint32_t seed = 1;
+  for (int16_t& sample : samples) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = static_cast<int16_t>(seed >> 16);
+  }
+  samples[0] = INT16_MIN;
+  samples[1] = INT16_MAX;
+  return samples;
+}
+
+void TestInterleavedRoundTrip() {
+  std::vector<int16_t> samples = CreateSamples();
+  std::vector<float> floats(samples.size());
+  livekit_ffi::S16ToFloat(samples.data(), kFrames, kChannels, false,
+                          floats.data());
+  for (float sample : floats)
+    EXPECT(sample >= -1.f && sample <= 1.f);
+
+  std::vector<int16_t> back(samples.size());
+  livekit_ffi::FloatToS16Interleaved(floats.data(), kFrames, kChannels, 0,
+                                     back.data());
+  EXPECT(back == samples);
+}
+
+void TestPlanarRoundTrip() {
+  std::vector<int16_t> samples = CreateSamples();
+  std::vector<float> planar(samples.size());
+  livekit_ffi::S16ToFloat(samples.data(), kFrames, kChannels, true,
+                          planar.data());
+  EXPECT(planar[0] == -1.f);
+  EXPECT(planar[kFrames] > 0.99f);
+
+  std::vector<int16_t> back(samples.size());
+  livekit_ffi::FloatToS16Interleaved(planar.data(), kFrames, kChannels,
+                                     kFrames, back.data());
+  EXPECT(back == samples);
+}
+
+void TestPlanarStride() {
+  // The second half of a planar buffer twice as long, as a source sends it
+  // in chunks.
+  std::vector<float> planar(kFrames * 2 * kChannels);
+  for (size_t i = 0; i < planar.size(); i++)
+    planar[i] = static_cast<float>(i);
+
+  std::vector<float> interleaved(kFrames * kChannels);
+  livekit_ffi::InterleaveFloat(planar.data() + kFrames, kFrames, kChannels,
+                               kFrames * 2, interleaved.data());
+  EXPECT(interleaved[0] == kFrames);
+  EXPECT(interleaved[1] == kFrames * 3);
+  EXPECT(interleaved[kFrames * kChannels - 1] == kFrames * 4 - 1);
+
+  std::vector<float> deinterleaved(kFrames * kChannels);
+  livekit_ffi::DeinterleaveFloat(interleaved.data(), kFrames, kChannels,
+                                 deinterleaved.data());
+  EXPECT(deinterleaved[0] == kFrames);
+  EXPECT(deinterleaved[kFrames] == kFrames * 3);
+}
+
+void TestClipping() {
+  const float floats[] = {-2.f, 2.f, 0.5f};
+  int16_t samples[3];
+  livekit_ffi::FloatToS16Interleaved(floats, 3, 1, 0, samples);
+  EXPECT(samples[0] == INT16_MIN);
+  EXPECT(samples[1] == INT16_MAX);
+  EXPECT(samples[2] == 16384);
+}
+
+}  // namespace
+
+int main() {
+  TestInterleavedRoundTrip();
+  TestPlanarRoundTrip();
+  TestPlanarStride();
+  TestClipping();
+
+  return livekit_test::TestResult("audio_format_test");
+}
@@ -0,0 +1,135 @@
+// Checks the 10 ms chunking, the carry over between calls and the per-format
+// state cache of AudioResampler.
+
+#include <cstdint>
+#include <vector>
+
+#include "livekit/audio_resampler.h"
+#include "test_util.h"
+
+using livekit_ffi::AudioResampler;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kChunkFrames = kSampleRate / 100;
+
+struct Format {
+  int dest_sample_rate;
+  size_t dest_num_channels;
+
+  // Output samples of one 10 ms chunk.
+  size_t chunk() const { return dest_sample_rate / 100 * dest_num_channels; }
+};
+
+// Resamples |frames| of 48 kHz stereo to |format|, returns the number of
+// output samples.
+size_t Resample(AudioResampler& resampler, size_t frames, Format format) {
+  std::vector<int16_t> src(frames * kChannels);
+  for (size_t i = 0; i < src.size(); i++)
+    src[i] = static_cast<int16_t>(i * 37);
+  size_t bytes = resampler.remix_and_resample(
+      src.data(), frames, kChannels, kSampleRate, format.dest_num_channels,
+      format.dest_sample_rate);
+  EXPECT(bytes == 0 || resampler.data() != nullptr);
+  return bytes / sizeof(int16_t);
+}
+
+size_t ResampleF32(AudioResampler& resampler,
+                   size_t frames,
+                   Format format,
+                   bool planar) {
+  std::vector<float> src(frames * kChannels, 0.25f);
+  size_t bytes = resampler.remix_and_resample_f32(
+      src.data(), frames, kChannels, kSampleRate, planar,
+      format.dest_num_channels, format.dest_sample_rate);
+  EXPECT(bytes == 0 || resampler.data_f32() != nullptr);
+  return bytes / sizeof(float);
+}
+
+void TestCarryOver() {
+  AudioResampler resampler;
+  const Format format{16000, 1};
+
+  // 333 frames are short of 10 ms, nothing comes out yet.
+  EXPECT(Resample(resampler, 333, format) == 0);
+  // 666 frames carried, one chunk out and 186 carried.
+  EXPECT(Resample(resampler, 333, format) == format.chunk());
+
+  size_t total_in = 666;
+  size_t total_out = format.chunk();
+  for (int i = 0; i < 100; i++) {
+    total_in += 333;
+    total_out += Resample(resampler, 333, format);
+    EXPECT(total_out == total_in / kChunkFrames * format.chunk());
+  }
+}
+
+void TestSeveralChunks() {
+  AudioResampler resampler;
+  const Format format{24000, 2};
+
+  // Exactly 10 ms.
+  EXPECT(Resample(resampler, kChunkFrames, format) == format.chunk());
+  // Three chunks in one call, 60 frames carried.
+  EXPECT(Resample(resampler, 3 * kChunkFrames + 60, format) ==
+         3 * format.chunk());
+  // The carry completes the first chunk of the next call.
+  EXPECT(Resample(resampler, 2 * kChunkFrames - 60, format) ==
+         2 * format.chunk());
+  EXPECT(Resample(resampler, 0, format) == 0);
+}
+
+void TestFormatCache() {
+  AudioResampler resampler;
+  const Format formats[AudioResampler::kMaxCachedFormats + 1] = {
+      {16000, 1}, {16000, 2}, {8000, 1}, {8000, 2},  {24000, 1},
+      {32000, 1}, {32000, 2}, {44100, 1}, {44100, 2},
+  };
+
+  // Leaves 333 frames carried in each format, the last one drops the
+  // state of the first.
+  for (const Format& format : formats)
+    EXPECT(Resample(resampler, 333, format) == 0);
+
+  // The second format kept its carry and completes a chunk...
+  EXPECT(Resample(resampler, kChunkFrames - 333, formats[1]) ==
+         formats[1].chunk());
+  // ...the first one starts over. Coming back drops the third format, now
+  // the least recently used.
+  EXPECT(Resample(resampler, kChunkFrames - 333, formats[0]) == 0);
+  EXPECT(Resample(resampler, kChunkFrames - 333, formats[2]) == 0);
+  // The most recent ones are still there.
+  EXPECT(Resample(resampler, kChunkFrames - 333, formats[8]) ==
+         formats[8].chunk());
+}
+
+void TestFloat() {
+  AudioResampler resampler;
+  const Format format{16000, 2};
+
+  // Same chunking as int16, with its own carry.
+  EXPECT(ResampleF32(resampler, 333, format, false) == 0);
+  EXPECT(Resample(resampler, 333, format) == 0);
+  size_t total_in = 333;
+  size_t total_out = 0;
+  for (int i = 0; i < 50; i++) {
+    total_in += 333;
+    total_out += ResampleF32(resampler, 333, format, i % 2 == 0);
+    EXPECT(total_out == total_in / kChunkFrames * format.chunk());
+  }
+  EXPECT(ResampleF32(resampler, 3 * kChunkFrames, format, true) ==
+         3 * format.chunk());
+}
+
+}  // namespace
+
+int main() {
+  TestCarryOver();
+  TestSeveralChunks();
+  TestFormatCache();
+  TestFloat();
+
+  return livekit_test::TestResult("audio_resampler_test");
+}
@@ -0,0 +1,123 @@
+// Checks that AudioSinkFanout resamples once per format and callback,
+// however many sinks share the format, and delivers to every sink.
+
+#include <cstdint>
+#include <vector>
+
+#include "livekit/audio_sink_fanout.h"
+#include "test_util.h"
+
+using livekit_ffi::AudioSinkFanout;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kChannels = 2;
+constexpr size_t kFrames = kSampleRate / 100;
+
+class FakeSink : public AudioSinkFanout::Sink {
+ public:
+  FakeSink(int sample_rate, int num_channels)
+      : sample_rate_(sample_rate), num_channels_(num_channels) {}
+
+  int sample_rate() const override { return sample_rate_; }
+  int num_channels() const override { return num_channels_; }
+
+  void deliver(const int16_t* data,
+               int sample_rate,
+               size_t number_of_channels,
+               size_t number_of_frames) override {
+    calls++;
+    format_ok = format_ok && sample_rate == sample_rate_ &&
+                number_of_channels == static_cast<size_t>(num_channels_) &&
+                number_of_frames ==
+                    static_cast<size_t>(sample_rate_ / 100);
+    last = data;
+  }
+
+  int calls = 0;
+  bool format_ok = true;
+  const int16_t* last = nullptr;
+
+ private:
+  const int sample_rate_;
+  const int num_channels_;
+};
+
+void Push(AudioSinkFanout& fanout, int callbacks) {
+  std::vector<int16_t> audio(kFrames * kChannels);
+  for (size_t i = 0; i < audio.size(); i++)
+    audio[i] = static_cast<int16_t>(i * 37);
+  for (int i = 0; i < callbacks; i++)
+    fanout.OnData(audio.data(), 16, kSampleRate, kChannels, kFrames);
+}
+
+void TestSharedFormat() {
+  // Recorder, transcriber, VAD, mixer and UI, all at 16 kHz mono.
+  AudioSinkFanout fanout;
+  std::vector<FakeSink> sinks(5, FakeSink(16000, 1));
+  for (FakeSink& sink : sinks)
+    fanout.AddSink(&sink);
+
+  Push(fanout, 10);
+  EXPECT(fanout.resamples() == 10);
+  for (FakeSink& sink : sinks) {
+    EXPECT(sink.calls == 10);
+    EXPECT(sink.format_ok);
+    EXPECT(sink.last == sinks[0].last);
+  }
+}
+
+void TestOneResamplePerFormat() {
+  AudioSinkFanout fanout;
+  FakeSink mono16(16000, 1), other_mono16(16000, 1);
+  FakeSink stereo24(24000, 2);
+  FakeSink mono48(48000, 1);
+  FakeSink native(kSampleRate, kChannels), other_native(kSampleRate, kChannels);
+  for (FakeSink* sink :
+       {&mono16, &other_mono16, &stereo24, &mono48, &native, &other_native})
+    fanout.AddSink(sink);
+
+  Push(fanout, 4);
+  // The sinks at the track format need no resampling.
+  EXPECT(fanout.resamples() == 3 * 4);
+  for (FakeSink* sink :
+       {&mono16, &other_mono16, &stereo24, &mono48, &native, &other_native}) {
+    EXPECT(sink->calls == 4);
+    EXPECT(sink->format_ok);
+  }
+}
+
+void TestRemoveSink() {
+  AudioSinkFanout fanout;
+  FakeSink first(16000, 1), second(16000, 1), third(24000, 1);
+  fanout.AddSink(&first);
+  fanout.AddSink(&second);
+  fanout.AddSink(&third);
+
+  Push(fanout, 1);
+  EXPECT(fanout.resamples() == 2);
+
+  fanout.RemoveSink(&first);
+  Push(fanout, 1);
+  EXPECT(fanout.resamples() == 4);
+  EXPECT(first.calls == 1);
+  EXPECT(second.calls == 2);
+
+  // Removing the last sink of a format drops its resampling.
+  fanout.RemoveSink(&second);
+  Push(fanout, 1);
+  EXPECT(fanout.resamples() == 5);
+  EXPECT(second.calls == 2);
+  EXPECT(third.calls == 3);
+}
+
+}  // namespace
+
+int main() {
+  TestSharedFormat();
+  TestOneResamplePerFormat();
+  TestRemoveSink();
+
+  return livekit_test::TestResult("audio_sink_fanout_test");
+}
@@ -10,8 +10,10 @@
 
 #include "benchmark.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <vector>
 #if defined(_WIN32)
@@ -19,18 +21,162 @@
 #endif
 
 #include "api/video/i420_buffer.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "common_video/h264/h264_common.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "fileutils.h"
+#include "livekit/video_decoder_factory.h"
+#include "media/base/media_constants.h"
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/event.h"
 #include "video_source.h"
 
-#define SSIM_CALC 0  // by default, don't compute SSIM
-
 using namespace webrtc;
 
 #define EXPECT_EQ (a, b)
 
+namespace {
+
+// Constrained baseline, what the benchmarked encoders produce.
+webrtc::SdpVideoFormat H264Format() {
+  return webrtc::SdpVideoFormat(
+      cricket::kH264CodecName,
+      {{cricket::kH264FmtpProfileLevelId, "42e01f"},
+       {cricket::kH264FmtpLevelAsymmetryAllowed, "1"},
+       {cricket::kH264FmtpPacketizationMode, "1"}});
+}
+
+double Percentile(std::vector<double> values, double percentile) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t index = static_cast<size_t>(percentile / 100 * values.size());
+  return values[std::min(index, values.size() - 1)];
+}
+
+// Splits an Annex B stream into access units. One starts at an AUD, SPS,
+// PPS or SEI following a slice, or at a slice with first_mb_in_slice 0.
+std::vector<webrtc::EncodedImage> SplitAnnexB(
+    const std::vector<uint8_t>& stream,
+    int width,
+    int height,
+    int frameRate) {
+  std::vector<webrtc::EncodedImage> frames;
+  size_t frameStart = 0;
+  bool hasSlice = false;
+  bool keyframe = false;
+
+  auto addFrame = [&](size_t frameEnd) {
+    if (!hasSlice) {
+      return;
+    }
+    webrtc::EncodedImage image;
+    image.SetEncodedData(webrtc::EncodedImageBuffer::Create(
+        stream.data() + frameStart, frameEnd - frameStart));
+    image.SetRtpTimestamp(
+        static_cast<uint32_t>(frames.size() * 90000 / frameRate));
+    image._encodedWidth = width;
+    image._encodedHeight = height;
+    image._frameType = keyframe ? VideoFrameType::kVideoFrameKey
+                                : VideoFrameType::kVideoFrameDelta;
+    frames.push_back(std::move(image));
+  };
+
+  for (const H264::NaluIndex& nalu :
+       H264::FindNaluIndices(MakeArrayView(stream.data(), stream.size()))) {
+    if (nalu.payload_size == 0) {
+      continue;
+    }
+    const uint8_t* payload = stream.data() + nalu.payload_start_offset;
+    H264::NaluType type = H264::ParseNaluType(payload[0]);
+    bool slice = type == H264::NaluType::kSlice || type == H264::NaluType::kIdr;
+    bool startsFrame;
+    if (slice) {
+      // first_mb_in_slice is ue(v), a leading 1 bit codes 0.
+      startsFrame = nalu.payload_size > 1 && (payload[1] & 0x80);
+    } else {
+      startsFrame = type == H264::NaluType::kAud ||
+                    type == H264::NaluType::kSps ||
+                    type == H264::NaluType::kPps ||
+                    type == H264::NaluType::kSei;
+    }
+
+    if (startsFrame && hasSlice) {
+      addFrame(nalu.start_offset);
+      frameStart = nalu.start_offset;
+      hasSlice = false;
+      keyframe = false;
+    }
+    hasSlice |= slice;
+    keyframe |= type == H264::NaluType::kIdr;
+  }
+  addFrame(stream.size());
+  return frames;
+}
+
+bool ReadFile(const std::string& fileName, std::vector<uint8_t>& data) {
+  std::ifstream file(fileName, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  data.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  return true;
+}
+
+std::string JsonString(const std::string& value) {
+  std::string escaped = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+}  // namespace
+
+void WriteResultsJson(const std::vector<RunResult>& results,
+                      std::ostream& out) {
+  out << "[";
+  for (size_t i = 0; i < results.size(); i++) {
+    const RunResult& r = results[i];
+    out << (i ? ",\n " : "\n ") << "{\"codec\": " << JsonString(r.codec)
+        << ", \"input\": " << JsonString(r.input)
+        << ", \"width\": " << r.width << ", \"height\": " << r.height
+        << ", \"frame_rate\": " << r.frameRate
+        << ", \"target_bitrate_kbps\": " << r.targetBitRate
+        << ", \"iterations\": " << r.iterations
+        << ", \"frames\": " << r.frames << ", \"fps\": " << r.fps
+        << ", \"latency_p50_ms\": " << r.latencyP50
+        << ", \"latency_p95_ms\": " << r.latencyP95
+        << ", \"latency_p99_ms\": " << r.latencyP99
+        << ", \"cpu_usage\": " << r.cpuUsage
+        << ", \"actual_bitrate_kbps\": " << r.actualBitRate
+        << ", \"bitrate_error_pct\": " << r.bitRateError
+        << ", \"psnr\": " << r.psnr << ", \"ssim\": " << r.ssim << "}";
+  }
+  out << "\n]\n";
+}
+
+void WriteResultsCsv(const std::vector<RunResult>& results,
+                     std::ostream& out) {
+  out << "codec,input,width,height,frame_rate,target_bitrate_kbps,"
+         "iterations,frames,fps,latency_p50_ms,latency_p95_ms,"
+         "latency_p99_ms,cpu_usage,actual_bitrate_kbps,bitrate_error_pct,"
+         "psnr,ssim\n";
+  for (const RunResult& r : results) {
+    out << r.codec << "," << r.input << "," << r.width << "," << r.height
+        << "," << r.frameRate << "," << r.targetBitRate << ","
+        << r.iterations << "," << r.frames << "," << r.fps << ","
+        << r.latencyP50 << "," << r.latencyP95 << "," << r.latencyP99 << ","
+        << r.cpuUsage << "," << r.actualBitRate << "," << r.bitRateError
+        << "," << r.psnr << "," << r.ssim << "\n";
+  }
+}
+
 FrameQueueTuple::~FrameQueueTuple() {
   if (_codecSpecificInfo != NULL) {
     delete _codecSpecificInfo;
@@ -69,6 +215,8 @@ webrtc::EncodedImageCallback::Result
 VideoEncodeCompleteCallback::OnEncodedImage(
     const webrtc::EncodedImage& encodedImage,
     const webrtc::CodecSpecificInfo* codecSpecificInfo) {
+  // The work below isn't part of the encode time.
+  _test._encodeCompleteTime = _test.tGetTime();
   _test.UpdateEncodedBytes(encodedImage.GetEncodedData()->size());
   _encodedBytes += encodedImage.GetEncodedData()->size();
 
@@ -81,10 +229,46 @@ VideoEncodeCompleteCallback::OnEncodedImage(
     }
   }
 
+  if (_test._qualityDecoder) {
+    _test._qualityDecoder->Decode(encodedImage, /*render_time_ms=*/0);
+  }
+
   return webrtc::EncodedImageCallback::Result(
       webrtc::EncodedImageCallback::Result::OK);
 }
 
+int32_t VideoDecodeCompleteCallback::Decoded(
+    webrtc::VideoFrame& decodedImage) {
+  {
+    // Asynchronous decoders call back from their own thread.
+    webrtc::MutexLock lock(&_test._decodeLock);
+    _decodedFrames++;
+    _test._decodeCompleteTime = _test.tGetTime();
+    auto it = _test._decodeTimes.find(decodedImage.rtp_timestamp());
+    if (it != _test._decodeTimes.end()) {
+      _test._decodeLatencies.push_back(
+          (_test._decodeCompleteTime - it->second) * 1000);
+      _test._decodeTimes.erase(it);
+    }
+    if (_test._decodePending > 0 && --_test._decodePending == 0) {
+      _test._decodeDone.Set();
+    }
+  }
+
+  webrtc::scoped_refptr<webrtc::I420BufferInterface> source =
+      _test._sourceFrame;
+  if (source && decodedImage.rtp_timestamp() == _test._sourceTimestamp &&
+      decodedImage.width() == source->width() &&
+      decodedImage.height() == source->height()) {
+    webrtc::scoped_refptr<webrtc::I420BufferInterface> decoded =
+        decodedImage.video_frame_buffer()->ToI420();
+    _test._psnrSum += webrtc::I420PSNR(*source, *decoded);
+    _test._ssimSum += webrtc::I420SSIM(*source, *decoded);
+    _test._qualityFrames++;
+  }
+  return 0;
+}
+
 Benchmark::Benchmark()
     : _resultsFileName(webrtc::test::OutputPath() + "benchmark.txt"),
       _codecName("Default"),
@@ -109,69 +293,45 @@ Benchmark::Benchmark(std::string name,
       _env(webrtc::CreateEnvironment()) {}
 
 void Benchmark::Perform() {
-  std::vector<const VideoSource*> sources;
-  std::vector<const VideoSource*>::iterator it;
-
-  // Configuration --------------------------
-  sources.push_back(new const VideoSource(
-      webrtc::test::ProjectRootPath() + "resources/FourPeople_1280x720_30.yuv",
-      kWHD));
-  //sources.push_back(
-  //    new const VideoSource(webrtc::test::ProjectRootPath() +
-  //                              "resources/Big_Buck_Bunny_1920x1080_30.yuv",
-  //                          kWFullHD));
-
-  const VideoSize size[] = {kWHD};
-  const int frameRate[] = {30};
-  // Specifies the framerates for which to perform a speed test.
-  const bool speedTestMask[] = {true};
-  const int bitRate[] = {500, 1000, 2000, 3000, 4000};
-  // Determines the number of iterations to perform to arrive at the speed
-  // result.
-  enum { kSpeedTestIterations = 8 };
-  // ----------------------------------------
-
-  const int nFrameRates = sizeof(frameRate) / sizeof(*frameRate);
-  assert(sizeof(speedTestMask) / sizeof(*speedTestMask) == nFrameRates);
-  const int nBitrates = sizeof(bitRate) / sizeof(*bitRate);
-  int testIterations = 1;
-
-  double fps[nBitrates];
-  uint32_t cpuUsage[nBitrates];
-  double totalEncodeTime[nBitrates];
-  double totalDecodeTime[nBitrates];
+  const BenchmarkConfig& config = _config;
+  const size_t nBitrates = config.bitRates.size();
+
+  std::vector<double> fps(nBitrates);
+  std::vector<uint32_t> cpuUsage(nBitrates);
+  std::vector<double> totalEncodeTime(nBitrates);
 
   _results.open(_resultsFileName.c_str(), std::fstream::out);
   _results << GetMagicStr() << std::endl;
   _results << _codecName << std::endl;
 
-  for (it = sources.begin(); it < sources.end(); it++) {
-    int i = 0;
-    for (int j = 0; j < nFrameRates; j++) {
-      _target = *it;
-      _inname = (*it)->GetFileName();
-      std::cout << (*it)->GetName() << ", "
-                << VideoSource::GetSizeString(size[i]) << ", " << frameRate[j]
-                << " fps" << ", " << _name << std::endl;
-      _results << (*it)->GetName() << "," << VideoSource::GetSizeString(size[i])
-               << "," << frameRate[j] << " fps" << ", " << _name << std::endl
+  for (const BenchmarkConfig::Size& size : config.sizes) {
+    for (int frameRate : config.frameRates) {
+      const VideoSource source = CreateSource(frameRate);
+      _target = &source;
+      _inname = source.GetFileName();
+      _width = size.width;
+      _height = size.height;
+      std::cout << source.GetName() << ", " << _width << "x" << _height
+                << ", " << frameRate << " fps" << ", " << _name << std::endl;
+      _results << source.GetName() << "," << _width << "x" << _height << ","
+               << frameRate << " fps" << ", " << _name << std::endl
                << "Bitrate [kbps]";
-      
-      if (speedTestMask[j]) {
-        testIterations = kSpeedTestIterations;
-      } else {
-        testIterations = 1;
-      }
 
-      for (int k = 0; k < nBitrates; k++) {
-        _bitRate = (bitRate[k]);
+      for (size_t k = 0; k < nBitrates; k++) {
+        _bitRate = config.bitRates[k];
         double avgFps = 0.0;
         uint32_t currCpuUsage = 0;
+        double actualBitRate = 0.0;
+        int frames = 0;
+        std::vector<double> latencies;
+        double psnrSum = 0.0;
+        double ssimSum = 0.0;
+        int qualityFrames = 0;
         totalEncodeTime[k] = 0;
 
         std::cout << "TargetBitrate [kbps]:" << " " << _bitRate << std::endl;
 
-        for (int l = 0; l < testIterations; l++) {
+        for (int l = 0; l < config.iterations; l++) {
           PerformNormalTest();
           uint32_t cpuUsage = _cpu->CpuUsage();
           if (cpuUsage > 0) {
@@ -181,7 +341,7 @@ void Benchmark::Perform() {
             str += std::to_string(coreCount);
             str += ", usage " + std::to_string(cpuUsage) + "%" +
                    ", Test Iteration: " + std::to_string(l + 1) + "/" +
-                   std::to_string(testIterations);
+                   std::to_string(config.iterations);
             std::cout << str << std::flush;
             for (int i = 0; i < str.length(); ++i) {
               std::cout << "\b";
@@ -190,14 +350,51 @@ void Benchmark::Perform() {
           _appendNext = false;
           avgFps += _framecnt / (_totalEncodeTime);
           totalEncodeTime[k] += _totalEncodeTime;
+          actualBitRate += ActualBitRate(_framecnt) / 1000.0;
+          frames += _framecnt;
+          latencies.insert(latencies.end(), _encodeLatencies.begin(),
+                           _encodeLatencies.end());
+          psnrSum += _psnrSum;
+          ssimSum += _ssimSum;
+          qualityFrames += _qualityFrames;
         }
-        avgFps /= testIterations;
-        totalEncodeTime[k] /= testIterations;
-        currCpuUsage /= testIterations;
+        avgFps /= config.iterations;
+        totalEncodeTime[k] /= config.iterations;
+        currCpuUsage /= config.iterations;
+        actualBitRate /= config.iterations;
+
+        RunResult result;
+        result.codec = _name;
+        result.input = source.GetFileName();
+        result.width = _width;
+        result.height = _height;
+        result.frameRate = frameRate;
+        result.targetBitRate = _bitRate;
+        result.iterations = config.iterations;
+        result.frames = frames / config.iterations;
+        result.fps = avgFps;
+        result.latencyP50 = Percentile(latencies, 50);
+        result.latencyP95 = Percentile(latencies, 95);
+        result.latencyP99 = Percentile(latencies, 99);
+        result.cpuUsage = currCpuUsage;
+        result.actualBitRate = actualBitRate;
+        result.bitRateError =
+            100.0 * (actualBitRate - _bitRate) / _bitRate;
+        if (qualityFrames > 0) {
+          result.psnr = psnrSum / qualityFrames;
+          result.ssim = ssimSum / qualityFrames;
+        }
+        _runResults.push_back(result);
 
-        double actualBitRate = ActualBitRate(_framecnt) / 1000.0;
         std::cout << "ActualBitRate [kbps]:" << " " << actualBitRate
-                  << std::endl;
+                  << " (" << result.bitRateError << "%)"
+                  << ", Latency p50/p95/p99 [ms]: " << result.latencyP50
+                  << "/" << result.latencyP95 << "/" << result.latencyP99;
+        if (qualityFrames > 0) {
+          std::cout << ", PSNR [dB]: " << result.psnr
+                    << ", SSIM: " << result.ssim;
+        }
+        std::cout << std::endl;
         _results << "," << actualBitRate;
         fps[k] = avgFps;
         cpuUsage[k] = currCpuUsage;
@@ -205,39 +402,192 @@ void Benchmark::Perform() {
 
       std::cout << std::endl << "CpuUsage [%]:";
       _results << std::endl << "CpuUsage [%]";
-      for (int k = 0; k < nBitrates; k++) {
+      for (size_t k = 0; k < nBitrates; k++) {
         std::cout << " " << cpuUsage[k] << "%";
         _results << "," << cpuUsage[k] << "%";
       }
       std::cout << std::endl << "Encode Time[ms]:";
       _results << std::endl << "Encode Time[ms]";
-      for (int k = 0; k < nBitrates; k++) {
+      for (size_t k = 0; k < nBitrates; k++) {
         std::cout << " " << totalEncodeTime[k];
         _results << "," << totalEncodeTime[k];
       }
 
-      if (speedTestMask[j]) {
-        std::cout << std::endl << "Speed [fps]:";
-        _results << std::endl << "Speed [fps]";
-        for (int k = 0; k < nBitrates; k++) {
-          std::cout << " " << static_cast<int>(fps[k] + 0.5);
-          _results << "," << static_cast<int>(fps[k] + 0.5);
-        }
+      std::cout << std::endl << "Speed [fps]:";
+      _results << std::endl << "Speed [fps]";
+      for (size_t k = 0; k < nBitrates; k++) {
+        std::cout << " " << static_cast<int>(fps[k] + 0.5);
+        _results << "," << static_cast<int>(fps[k] + 0.5);
       }
       std::cout << std::endl << std::endl;
       _results << std::endl << std::endl;
     }
-    i++;
-    delete *it;
   }
+  _target = NULL;
   _results.close();
 }
 
+VideoSource Benchmark::CreateSource(int frameRate) const {
+  if (_config.synthetic) {
+    return VideoSource(_config.syntheticOptions, _config.inputWidth,
+                       _config.inputHeight, frameRate, _config.syntheticFrames);
+  }
+  return VideoSource(_config.inputFile, _config.inputWidth,
+                     _config.inputHeight, frameRate);
+}
+
+void Benchmark::PerformDecode() {
+  const VideoSource source = CreateSource(_config.frameRates[0]);
+  _target = &source;
+  _inname = source.GetFileName();
+  _width = source.GetWidth();
+  _height = source.GetHeight();
+  _bitRate = 2000;
+
+  std::cout << source.GetName() << ", " << _name << ", "
+            << "TargetBitrate [kbps]: " << _bitRate << std::endl;
+  // Writes the stream to _codecName.
+  PerformNormalTest();
+  _appendNext = false;
+  _target = NULL;
+
+  std::vector<uint8_t> stream;
+  if (!ReadFile(_codecName, stream)) {
+    fprintf(stderr, "Cannot read encoded file %s\n", _codecName.c_str());
+    return;
+  }
+  DecodeWithAllDecoders(SplitAnnexB(stream, source.GetWidth(),
+                                    source.GetHeight(),
+                                    source.GetFrameRate()),
+                        source.GetWidth(), source.GetHeight());
+}
+
+void Benchmark::PerformDecode(const std::string& annexbFile) {
+  std::vector<uint8_t> stream;
+  if (!ReadFile(annexbFile, stream)) {
+    fprintf(stderr, "Cannot read file %s\n", annexbFile.c_str());
+    return;
+  }
+
+  // The decoders take the size from the SPS, this is only a hint.
+  const int width = 1920;
+  const int height = 1080;
+  std::cout << annexbFile << std::endl;
+  DecodeWithAllDecoders(SplitAnnexB(stream, width, height, 30), width,
+                        height);
+}
+
+void Benchmark::DecodeWithAllDecoders(
+    const std::vector<webrtc::EncodedImage>& frames,
+    int width,
+    int height) {
+  if (frames.empty()) {
+    fprintf(stderr, "No frame to decode\n");
+    return;
+  }
+
+  livekit_ffi::VideoDecoderFactory factory;
+  const webrtc::SdpVideoFormat format = H264Format();
+
+  _results.open(_resultsFileName.c_str(),
+                std::fstream::out | std::fstream::app);
+  _results << "Decode," << frames.size() << " frames" << std::endl
+           << "Decoder,Speed [fps],Latency p50 [ms],Latency p95 [ms],"
+           << "Latency p99 [ms],CpuUsage [%]" << std::endl;
+  std::cout << "Decode, " << frames.size() << " frames" << std::endl;
+
+  for (const std::string& implementation :
+       factory.GetImplementations(format)) {
+    std::unique_ptr<webrtc::VideoDecoder> decoder =
+        factory.Create(_env, format, implementation);
+    webrtc::VideoDecoder::Settings settings;
+    settings.set_codec_type(webrtc::kVideoCodecH264);
+    settings.set_max_render_resolution({width, height});
+    settings.set_number_of_cores(_cpu->GetNumCores());
+    if (!decoder || !decoder->Configure(settings)) {
+      std::cout << implementation << ": cannot create the decoder"
+                << std::endl;
+      continue;
+    }
+
+    VideoDecodeCompleteCallback decCallback(*this);
+    _decoder = decoder.get();
+    _decoder->RegisterDecodeCompleteCallback(&decCallback);
+
+    // Starts the CPU measurement.
+    _cpu->CpuUsage();
+    int ret = PerformDecodeTest(frames);
+    int32_t cpuUsage = _cpu->CpuUsage();
+
+    _decoder->Release();
+    _decoder = nullptr;
+    if (ret < 0) {
+      std::cout << implementation << ": decode error " << ret << std::endl;
+      continue;
+    }
+
+    double fps = _totalDecodeTime > 0
+                     ? decCallback.DecodedFrames() / _totalDecodeTime
+                     : 0;
+    double p50 = Percentile(_decodeLatencies, 50);
+    double p95 = Percentile(_decodeLatencies, 95);
+    double p99 = Percentile(_decodeLatencies, 99);
+    std::cout << implementation << ": decoded "
+              << decCallback.DecodedFrames() << "/" << frames.size()
+              << ", Speed [fps]: " << static_cast<int>(fps + 0.5)
+              << ", Latency p50/p95/p99 [ms]: " << p50 << "/" << p95 << "/"
+              << p99 << ", CpuUsage [%]: " << cpuUsage << std::endl;
+    _results << implementation << "," << static_cast<int>(fps + 0.5) << ","
+             << p50 << "," << p95 << "," << p99 << "," << cpuUsage
+             << std::endl;
+  }
+
+  std::cout << std::endl;
+  _results << std::endl;
+  _results.close();
+}
+
+int Benchmark::PerformDecodeTest(
+    const std::vector<webrtc::EncodedImage>& frames) {
+  {
+    webrtc::MutexLock lock(&_decodeLock);
+    _totalDecodeTime = 0;
+    _decodeCompleteTime = 0;
+    _decodeTimes.clear();
+    _decodeLatencies.clear();
+    _decodePending = frames.size();
+  }
+  _decodeDone.Reset();
+
+  double first = tGetTime();
+  for (const webrtc::EncodedImage& frame : frames) {
+    {
+      webrtc::MutexLock lock(&_decodeLock);
+      _decodeTimes[frame.RtpTimestamp()] = tGetTime();
+    }
+    int ret = _decoder->Decode(frame, /*render_time_ms=*/0);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+
+  // Decode() returning only means the frame was queued for asynchronous and
+  // hardware decoders, wait for the last Decoded() callback. Frames a
+  // decoder drops never call back, hence the timeout.
+  _decodeDone.Wait(webrtc::TimeDelta::Seconds(5));
+
+  webrtc::MutexLock lock(&_decodeLock);
+  _decodePending = 0;
+  if (_decodeCompleteTime > first) {
+    _totalDecodeTime = _decodeCompleteTime - first;
+  }
+  return 0;
+}
+
 void Benchmark::PerformNormalTest() {
   _encoder = GetNewEncoder(_env);
   _lengthSourceFrame = _target->GetFrameLength();
-  CodecSettings(_target->GetWidth(), _target->GetHeight(),
-                _target->GetFrameRate(), _bitRate);
+  CodecSettings(_width, _height, _target->GetFrameRate(), _bitRate);
   Setup();
   std::unique_ptr<webrtc::Event> waitEvent = std::make_unique<webrtc::Event>();
   //_inputVideoBuffer.VerifyAndAllocate(_lengthSourceFrame);
@@ -250,6 +600,23 @@ void Benchmark::PerformNormalTest() {
 
   _encoder->RegisterEncodeCompleteCallback(&encCallback);
 
+  VideoDecodeCompleteCallback qualityCallback(*this);
+  _psnrSum = _ssimSum = 0;
+  _qualityFrames = 0;
+  if (_config.quality) {
+    livekit_ffi::VideoDecoderFactory factory;
+    _qualityDecoder = factory.Create(_env, H264Format(), "software");
+    webrtc::VideoDecoder::Settings settings;
+    settings.set_codec_type(webrtc::kVideoCodecH264);
+    settings.set_max_render_resolution({_width, _height});
+    if (_qualityDecoder && _qualityDecoder->Configure(settings)) {
+      _qualityDecoder->RegisterDecodeCompleteCallback(&qualityCallback);
+    } else {
+      fprintf(stderr, "Cannot create the decoder, quality not measured\n");
+      _qualityDecoder = nullptr;
+    }
+  }
+
   _totalEncodeTime = _totalDecodeTime = 0;
   _totalEncodePipeTime = _totalDecodePipeTime = 0;
   bool complete = false;
@@ -257,8 +624,12 @@ void Benchmark::PerformNormalTest() {
   _encFrameCnt = 0;
   _sumEncBytes = 0;
   _lengthEncFrame = 0;
+  _encodeLatencies.clear();
   while (!complete) {
     complete = Encode();
+    if (complete) {
+      break;
+    }
     _framecnt++;
     _encFrameCnt++;
     /*
@@ -289,15 +660,28 @@ void Benchmark::PerformNormalTest() {
 }
 
 void Benchmark::Teardown() {
-  // Use _sourceFile as a check to prevent multiple Teardown() calls.
-  if (_sourceFile == NULL) {
+  if (!_setup) {
     return;
   }
+  _setup = false;
 
   _encoder->Release();
 
-  fclose(_sourceFile);
-  _sourceFile = NULL;
+  if (_qualityDecoder) {
+    _qualityDecoder->Release();
+    _qualityDecoder = nullptr;
+  }
+  _sourceFrame = nullptr;
+
+  if (_sourceFile != NULL) {
+    fclose(_sourceFile);
+    _sourceFile = NULL;
+  }
+
+  if (_encodedFile != NULL) {
+    fclose(_encodedFile);
+    _encodedFile = NULL;
+  }
 
   delete[] _sourceBuffer;
   _sourceBuffer = NULL;
@@ -315,7 +699,7 @@ void Benchmark::CodecSpecific_InitBitrate() {
   } else {
     VideoBitrateAllocation allocation =
         init_allocator.Allocate(VideoBitrateAllocationParameters(
-            DataRate::BitsPerSec(_bitRate), _inst.maxFramerate));
+            DataRate::KilobitsPerSec(_bitRate), _inst.maxFramerate));
     _encoder->SetRates(webrtc::VideoEncoder::RateControlParameters(
         allocation, _inst.maxFramerate));
   }
@@ -326,18 +710,29 @@ bool Benchmark::Encode() {
   if (_sourceBuffer == NULL) {
     _sourceBuffer = new unsigned char[_lengthSourceFrame];
   }
-  auto size = fread(_sourceBuffer, 1, _lengthSourceFrame, _sourceFile);
-  if (size <= 0) {
+  if (_target->IsSynthetic()) {
+    if (_encFrameCnt >= _target->GetFrameCount()) {
+      return true;
+    }
+    _target->GenerateFrame(_encFrameCnt, _sourceBuffer);
+  } else if (fread(_sourceBuffer, 1, _lengthSourceFrame, _sourceFile) <= 0) {
     return true;
   }
   // TODO: build video frame from buffer ptr.
-  webrtc::scoped_refptr<webrtc::I420Buffer> buffer(
-      webrtc::I420Buffer::Create(_inst.width, _inst.height));
+  webrtc::scoped_refptr<webrtc::I420Buffer> buffer(webrtc::I420Buffer::Create(
+      _target->GetWidth(), _target->GetHeight()));
 
   buffer->InitializeData();
 
   memcpy(buffer->MutableDataY(), _sourceBuffer, _lengthSourceFrame);
 
+  if (_inst.width != buffer->width() || _inst.height != buffer->height()) {
+    webrtc::scoped_refptr<webrtc::I420Buffer> scaled =
+        webrtc::I420Buffer::Create(_inst.width, _inst.height);
+    scaled->ScaleFrom(*buffer);
+    buffer = scaled;
+  }
+
   webrtc::VideoFrame inputVideoBuffer =
       webrtc::VideoFrame::Builder()
           .set_video_frame_buffer(buffer)
@@ -345,7 +740,7 @@ bool Benchmark::Encode() {
               (unsigned int)(_encFrameCnt * 9e4 / _inst.maxFramerate))
           .build();
 
-  if (feof(_sourceFile) != 0) {
+  if (_sourceFile != NULL && feof(_sourceFile) != 0) {
     return true;
   }
   _encodeCompleteTime = 0;
@@ -386,14 +781,24 @@ bool Benchmark::Encode() {
     _hasReceivedSLI = false;  // don't trigger both at once
   }
 
+  if (_qualityDecoder) {
+    _sourceFrame = buffer;
+    _sourceTimestamp = inputVideoBuffer.rtp_timestamp();
+  }
+
   int ret = _encoder->Encode(inputVideoBuffer, &frame_types);
 
+  double encodeTime;
   if (_encodeCompleteTime > 0) {
-    _totalEncodeTime +=
+    encodeTime =
         _encodeCompleteTime - _encodeTimes[inputVideoBuffer.rtp_timestamp()];
   } else {
-    _totalEncodeTime += tGetTime() - _encodeTimes[inputVideoBuffer.rtp_timestamp()];
+    encodeTime = tGetTime() - _encodeTimes[inputVideoBuffer.rtp_timestamp()];
   }
+  _totalEncodeTime += encodeTime;
+  _encodeLatencies.push_back(encodeTime * 1000);
+  _encodeTimes.erase(inputVideoBuffer.rtp_timestamp());
+  _sourceFrame = nullptr;
   assert(ret >= 0);
   return false;
 }
@@ -406,10 +811,10 @@ webrtc::CodecSpecificInfo* Benchmark::CopyCodecSpecificInfo(
 }
 
 void Benchmark::Setup() {
-  // Use _sourceFile as a check to prevent multiple Setup() calls.
-  if (_sourceFile != NULL) {
+  if (_setup) {
     return;
   }
+  _setup = true;
 
   std::stringstream ss;
   std::string strTestNo;
@@ -427,7 +832,8 @@ void Benchmark::Setup() {
         webrtc::test::OutputPath() + "encoded_normaltest" + strTestNo + ".yuv";
   }
 
-  if ((_sourceFile = fopen(_inname.c_str(), "rb")) == NULL) {
+  if (!_target->IsSynthetic() &&
+      (_sourceFile = fopen(_inname.c_str(), "rb")) == NULL) {
     printf("Cannot read file %s.\n", _inname.c_str());
     exit(1);
   }
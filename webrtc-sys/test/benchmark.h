@@ -14,20 +14,85 @@
 #include <cstdlib>
 #include <fstream>
 #include <list>
+#include <memory>
+#include <ostream>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "cpu/cpu_linux.h"
 #include "api/environment/environment_factory.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_decoder.h"
 #include "modules/include/module_common_types.h"
 #include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/event.h"
 #include "rtc_base/synchronization/mutex.h"
 #include "system_wrappers/include/clock.h"
+#include "video_source.h"
 
 
-class VideoSource;
 class Benchmark;
 
+// Run matrix of Benchmark::Perform, every combination of size, frame rate
+// and bit rate is run |iterations| times. See test_main.cc for the command
+// line.
+struct BenchmarkConfig {
+  struct Size {
+    int width;
+    int height;
+  };
+
+  // Raw I420 frames of inputWidth x inputHeight.
+  std::string inputFile;
+  int inputWidth = 1280;
+  int inputHeight = 720;
+  // Generate syntheticFrames frames of inputWidth x inputHeight instead of
+  // reading inputFile.
+  bool synthetic = false;
+  SyntheticVideoGenerator::Options syntheticOptions;
+  int syntheticFrames = 300;
+  // Encode in screen sharing mode.
+  bool screenshare = false;
+  // The input is scaled to each size.
+  std::vector<Size> sizes{{1280, 720}};
+  std::vector<int> frameRates{30};
+  // In kbps.
+  std::vector<int> bitRates{500, 1000, 2000, 3000, 4000};
+  int iterations = 8;
+  // Decode every encoded frame to compute PSNR and SSIM against the input.
+  bool quality = true;
+};
+
+// One cell of the run matrix. Speed, CPU, bit rate and quality are averaged
+// over the iterations, latency percentiles are over all the encoded frames.
+struct RunResult {
+  std::string codec;
+  std::string input;
+  int width = 0;
+  int height = 0;
+  int frameRate = 0;
+  int targetBitRate = 0;  // kbps
+  int iterations = 0;
+  int frames = 0;
+  double fps = 0;
+  double latencyP50 = 0;  // ms
+  double latencyP95 = 0;
+  double latencyP99 = 0;
+  uint32_t cpuUsage = 0;  // %
+  double actualBitRate = 0;  // kbps
+  double bitRateError = 0;  // % of the target
+  // 0 when quality isn't measured.
+  double psnr = 0;  // dB
+  double ssim = 0;
+};
+
+void WriteResultsJson(const std::vector<RunResult>& results,
+                      std::ostream& out);
+void WriteResultsCsv(const std::vector<RunResult>& results,
+                     std::ostream& out);
+
 // feedback signal to encoder
 struct fbSignal {
   fbSignal(int d, uint8_t pid) : delay(d), id(pid) {};
@@ -84,13 +149,36 @@ class VideoEncodeCompleteCallback : public webrtc::EncodedImageCallback {
   uint32_t _encodedBytes;
 };
 
+class VideoDecodeCompleteCallback : public webrtc::DecodedImageCallback {
+ public:
+  explicit VideoDecodeCompleteCallback(Benchmark& test)
+      : _test(test), _decodedFrames(0) {}
+
+  int32_t Decoded(webrtc::VideoFrame& decodedImage) override;
+
+  int DecodedFrames() const { return _decodedFrames; }
+
+ private:
+  Benchmark& _test;
+  int _decodedFrames;
+};
+
 class Benchmark {
  public:
   friend class VideoEncodeCompleteCallback;
+  friend class VideoDecodeCompleteCallback;
 
  public:
   Benchmark();
+  void SetConfig(const BenchmarkConfig& config) { _config = config; }
+  // Results of the runs of Perform, one per cell of the run matrix.
+  const std::vector<RunResult>& GetResults() const { return _runResults; }
   virtual void Perform();
+  // Encodes the first source with this benchmark's encoder, then decodes the
+  // stream with every H264 decoder of livekit_ffi::VideoDecoderFactory.
+  virtual void PerformDecode();
+  // Decodes an Annex B H264 file with every decoder.
+  virtual void PerformDecode(const std::string& annexbFile);
   virtual bool IsSupported() = 0;
 
  protected:
@@ -105,7 +193,8 @@ class Benchmark {
   static const char* GetMagicStr() { return "#!benchmark1.0"; }
 
   double ActualBitRate(int nFrames) {
-    return 8.0 * _sumEncBytes / (nFrames / _inst.maxFramerate);
+    return 8.0 * _sumEncBytes / (static_cast<double>(nFrames) /
+                                 _inst.maxFramerate);
   }
 
   webrtc::CodecSpecificInfo* CopyCodecSpecificInfo(
@@ -113,6 +202,20 @@ class Benchmark {
 
   bool Encode();
 
+  // Decodes |frames| with every decoder and reports fps, per-frame latency
+  // percentiles and CPU usage.
+  void DecodeWithAllDecoders(const std::vector<webrtc::EncodedImage>& frames,
+                             int width,
+                             int height);
+
+  // Feeds |frames| to _decoder and waits for their Decoded() callbacks,
+  // returns the first decode error if any. _totalDecodeTime is the wall time
+  // from the first Decode() to the last Decoded().
+  int PerformDecodeTest(const std::vector<webrtc::EncodedImage>& frames);
+
+  // The input file of the config, or its synthetic video.
+  VideoSource CreateSource(int frameRate) const;
+
   void Setup();
 
   void Teardown();
@@ -142,15 +245,17 @@ class Benchmark {
     _inst.simulcastStream[0].maxFramerate = frameRate;
     _inst.simulcastStream[0].active = true;
     _inst.SetScalabilityMode(webrtc::ScalabilityMode::kL1T1);
-    _inst.mode = webrtc::VideoCodecMode::kRealtimeVideo;
+    _inst.mode = _config.screenshare
+                     ? webrtc::VideoCodecMode::kScreensharing
+                     : webrtc::VideoCodecMode::kRealtimeVideo;
     _inst.qpMax = 56;
     _inst.SetFrameDropEnabled(true);
   }
 
   double tGetTime() {
     // return time in sec
-    return ((double)(webrtc::Clock::GetRealTimeClock()->TimeInMilliseconds()) /
-            1000);
+    return ((double)(webrtc::Clock::GetRealTimeClock()->TimeInMicroseconds()) /
+            1e6);
   }
 
   virtual webrtc::CodecSpecificInfo* CreateEncoderSpecificInfo() const {
@@ -159,7 +264,12 @@ class Benchmark {
 
   void UpdateEncodedBytes(int encodedBytes) { _sumEncBytes += encodedBytes; }
 
+  BenchmarkConfig _config;
+  std::vector<RunResult> _runResults;
   const VideoSource* _target;
+  // Encoded size of the current run, the input is scaled to it.
+  int _width = 0;
+  int _height = 0;
   std::string _resultsFileName;
   std::ofstream _results;
   std::string _name;
@@ -168,7 +278,7 @@ class Benchmark {
   std::string _inname;
   std::string _outname;
   webrtc::VideoEncoder* _encoder;
-  //webrtc::VideoDecoder* _decoder;
+  webrtc::VideoDecoder* _decoder = nullptr;
   uint32_t _bitRate;
   bool _appendNext = false;
   int _framecnt;
@@ -191,11 +301,32 @@ class Benchmark {
 
   FILE* _sourceFile = nullptr;
   FILE* _decodedFile = nullptr;
+  // Between Setup() and Teardown(), synthetic sources have no _sourceFile.
+  bool _setup = false;
 
   bool _hasReceivedPLI = false;
   bool _waitForKey = false;
   std::map<uint32_t, double> _encodeTimes;
+  // Guards the decode bookkeeping below and _decodeCompleteTime.
+  webrtc::Mutex _decodeLock;
+  // Set once the last pending frame of a decode test has been decoded.
+  webrtc::Event _decodeDone;
+  size_t _decodePending = 0;
   std::map<uint32_t, double> _decodeTimes;
+  // Per-frame decode latency of the last decode test, from Decode() to the
+  // matching Decoded() callback, in ms.
+  std::vector<double> _decodeLatencies;
+  // Per-frame encode latency of the last run, in ms.
+  std::vector<double> _encodeLatencies;
+
+  // Quality of the last run. The frame being encoded is kept until the
+  // quality decoder outputs it, the encoders deliver synchronously.
+  std::unique_ptr<webrtc::VideoDecoder> _qualityDecoder;
+  webrtc::scoped_refptr<webrtc::I420BufferInterface> _sourceFrame;
+  uint32_t _sourceTimestamp = 0;
+  double _psnrSum = 0;
+  double _ssimSum = 0;
+  int _qualityFrames = 0;
 
   bool _missingFrames = false;
   std::list<fbSignal> _signalSLI;
@@ -0,0 +1,136 @@
+// Cost of mixing one 10 ms tick of a room against its participant count,
+// 48 kHz mono with 4 participants talking and the others silent:
+//  - webrtc: AudioMixerImpl (what AudioMixer wraps) pulling every source,
+//    without the Rust callback.
+//  - top3: ConferenceMixer fed by push_frame(), levels computed from the
+//    samples, silent participants skipped by their voice activity.
+//  - top3 mix-minus: the same with a mix-minus for each speaker.
+//  - all: ConferenceMixer with everyone talking and mixed, the cost of the
+//    float accumulation itself.
+
+#include <stdio.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio/audio_mixer.h"
+#include "livekit/conference_mixer.h"
+#include "modules/audio_mixer/audio_mixer_impl.h"
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kSamples = kSampleRate / 100;
+constexpr int kTicks = 1000;
+constexpr int kTalkers = 4;
+constexpr size_t kSpeakers = 3;
+
+const int kParticipantCounts[] = {10, 25, 50, 100, 200};
+
+std::vector<int16_t> CreateFrame(int participant, bool talking) {
+  std::vector<int16_t> frame(kSamples);
+  const double amplitude = talking ? 2000 + participant * 100 : 0;
+  const double frequency = 120 + participant * 7;
+  uint32_t seed = participant * 2654435761u;
+  for (size_t i = 0; i < kSamples; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    double noise = static_cast<int32_t>(seed) / 2147483648.0 * 20;
+    double voice = std::sin(2 * M_PI * frequency * i / kSampleRate);
+    frame[i] = static_cast<int16_t>(amplitude * voice + noise);
+  }
+  return frame;
+}
+
+class Source : public webrtc::AudioMixer::Source {
+ public:
+  Source(int ssrc, std::vector<int16_t> frame, bool talking)
+      : ssrc_(ssrc), frame_(std::move(frame)), talking_(talking) {}
+
+  AudioFrameInfo GetAudioFrameWithInfo(
+      int sample_rate_hz,
+      webrtc::AudioFrame* audio_frame) override {
+    audio_frame->UpdateFrame(
+        0, frame_.data(), kSamples, kSampleRate,
+        webrtc::AudioFrame::SpeechType::kNormalSpeech,
+        talking_ ? webrtc::AudioFrame::VADActivity::kVadActive
+                 : webrtc::AudioFrame::VADActivity::kVadPassive,
+        1);
+    return AudioFrameInfo::kNormal;
+  }
+
+  int Ssrc() const override { return ssrc_; }
+  int PreferredSampleRate() const override { return kSampleRate; }
+
+ private:
+  const int ssrc_;
+  const std::vector<int16_t> frame_;
+  const bool talking_;
+};
+
+template <typename Tick>
+double MicrosecondsPerTick(Tick tick) {
+  // Warm up.
+  for (int i = 0; i < 10; i++)
+    tick();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kTicks; i++)
+    tick();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / kTicks;
+}
+
+double RunWebrtc(int participants) {
+  webrtc::scoped_refptr<webrtc::AudioMixerImpl> mixer =
+      webrtc::AudioMixerImpl::Create();
+  std::vector<std::unique_ptr<Source>> sources;
+  for (int i = 0; i < participants; i++) {
+    sources.push_back(std::make_unique<Source>(
+        i, CreateFrame(i, i < kTalkers), i < kTalkers));
+    mixer->AddSource(sources.back().get());
+  }
+
+  webrtc::AudioFrame frame;
+  double result = MicrosecondsPerTick([&]() { mixer->Mix(1, &frame); });
+  for (auto& source : sources)
+    mixer->RemoveSource(source.get());
+  return result;
+}
+
+double RunConference(int participants, bool mix_minus, bool everyone) {
+  livekit_ffi::ConferenceMixer mixer(kSampleRate, 1,
+                                     everyone ? participants : kSpeakers);
+  std::vector<std::vector<int16_t>> frames;
+  for (int i = 0; i < participants; i++) {
+    mixer.add_participant(i);
+    frames.push_back(CreateFrame(i, everyone || i < kTalkers));
+  }
+
+  return MicrosecondsPerTick([&]() {
+    for (int i = 0; i < participants; i++) {
+      mixer.push_frame(i, frames[i].data(), kSamples,
+                       everyone || i < kTalkers,
+                       livekit_ffi::ConferenceMixer::kUnknownLevel);
+    }
+    mixer.mix(mix_minus);
+  });
+}
+
+}  // namespace
+
+int main() {
+  printf("48 kHz mono, %d talking, us per 10 ms tick\n", kTalkers);
+  printf("%12s %10s %10s %16s %10s\n", "participants", "webrtc", "top3",
+         "top3 mix-minus", "all");
+  for (int participants : kParticipantCounts) {
+    printf("%12d %10.1f %10.1f %16.1f %10.1f\n", participants,
+           RunWebrtc(participants), RunConference(participants, false, false),
+           RunConference(participants, true, false),
+           RunConference(participants, false, true));
+  }
+  return 0;
+}
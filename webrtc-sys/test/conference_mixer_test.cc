@@ -0,0 +1,171 @@
+// Checks the speaker selection, the mix and the mix-minus outputs of
+// ConferenceMixer.
+
+#include <cstdint>
+#include <vector>
+
+#include "livekit/conference_mixer.h"
+#include "test_util.h"
+
+using livekit_ffi::ConferenceMixer;
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kSamples = kSampleRate / 100;
+
+std::vector<int16_t> Frame(int16_t value, size_t samples = kSamples) {
+  return std::vector<int16_t>(samples, value);
+}
+
+bool Push(ConferenceMixer& mixer,
+          uint32_t id,
+          const std::vector<int16_t>& frame,
+          bool voice_activity = true,
+          int audio_level = ConferenceMixer::kUnknownLevel) {
+  return mixer.push_frame(id, frame.data(), frame.size(), voice_activity,
+                          audio_level);
+}
+
+void TestMix() {
+  ConferenceMixer mixer(kSampleRate, 1, 3);
+  for (uint32_t id = 1; id <= 3; id++)
+    mixer.add_participant(id);
+  EXPECT(Push(mixer, 1, Frame(100)));
+  EXPECT(Push(mixer, 2, Frame(-300)));
+  EXPECT(Push(mixer, 3, Frame(1000)));
+
+  EXPECT(mixer.mix(true) == kSamples);
+  EXPECT(mixer.data()[0] == 800 && mixer.data()[kSamples - 1] == 800);
+  EXPECT((*mixer.speakers() == std::vector<uint32_t>{3, 2, 1}));
+  EXPECT(mixer.mix_minus(1)[0] == 700);
+  EXPECT(mixer.mix_minus(2)[kSamples - 1] == 1100);
+  EXPECT(mixer.mix_minus(3)[0] == -200);
+
+  // Frames are mixed once.
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 0);
+  EXPECT(mixer.speakers()->empty());
+  EXPECT(mixer.mix_minus(1) == nullptr);
+}
+
+void TestTopSpeakers() {
+  ConferenceMixer mixer(kSampleRate, 1, 2);
+  for (uint32_t id = 1; id <= 50; id++) {
+    mixer.add_participant(id);
+    if (id != 7 && id != 42)
+      EXPECT(Push(mixer, id, Frame(10)));
+  }
+  // Louder by their reported level, whatever their samples.
+  EXPECT(Push(mixer, 7, Frame(1), true, 20));
+  EXPECT(Push(mixer, 42, Frame(2), true, 10));
+
+  mixer.mix(true);
+  EXPECT((*mixer.speakers() == std::vector<uint32_t>{42, 7}));
+  EXPECT(mixer.data()[0] == 3);
+  EXPECT(mixer.mix_minus(42)[0] == 1);
+  // Participants left out hear the full mix.
+  EXPECT(mixer.mix_minus(1) == mixer.data());
+  EXPECT(mixer.mix_minus(51) == nullptr);
+}
+
+void TestSilenceSkipped() {
+  ConferenceMixer mixer(kSampleRate, 1, 3);
+  for (uint32_t id = 1; id <= 4; id++)
+    mixer.add_participant(id);
+  EXPECT(Push(mixer, 1, Frame(500), /*voice_activity=*/false));
+  EXPECT(Push(mixer, 2, Frame(500), true, ConferenceMixer::kSilentLevel));
+  EXPECT(Push(mixer, 3, Frame(0)));
+  EXPECT(Push(mixer, 4, Frame(20)));
+
+  mixer.mix(false);
+  EXPECT((*mixer.speakers() == std::vector<uint32_t>{4}));
+  EXPECT(mixer.data()[0] == 20);
+}
+
+void TestSaturation() {
+  // 1323 samples, the vector loops leave a tail.
+  constexpr size_t kOddSamples = 441 * 3;
+  ConferenceMixer mixer(44100, 3, 3);
+  for (uint32_t id = 1; id <= 3; id++) {
+    mixer.add_participant(id);
+    EXPECT(Push(mixer, id, Frame(-20000, kOddSamples)));
+  }
+  EXPECT(!Push(mixer, 1, Frame(1)));
+
+  EXPECT(mixer.mix(true) == kOddSamples);
+  for (size_t i = 0; i < kOddSamples; i++)
+    EXPECT(mixer.data()[i] == INT16_MIN);
+  // From the unsaturated sum.
+  EXPECT(mixer.mix_minus(2)[kOddSamples - 1] == INT16_MIN);
+}
+
+void TestQueuedFrames() {
+  ConferenceMixer mixer(kSampleRate, 1, 3);
+  mixer.add_participant(1);
+  mixer.add_participant(2);
+
+  // Two pushes between mixes, none is lost.
+  EXPECT(Push(mixer, 1, Frame(100)));
+  EXPECT(Push(mixer, 1, Frame(200)));
+  EXPECT(Push(mixer, 2, Frame(1000)));
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 1100);
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 200);
+  EXPECT((*mixer.speakers() == std::vector<uint32_t>{1}));
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 0);
+
+  // A silent frame still takes its turn.
+  EXPECT(Push(mixer, 1, Frame(100)));
+  EXPECT(Push(mixer, 1, Frame(100), /*voice_activity=*/false));
+  EXPECT(Push(mixer, 1, Frame(300)));
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 100);
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 0);
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 300);
+
+  // Past kMaxQueuedFrames, the oldest frames are dropped.
+  for (int16_t value = 1; value <= 6; value++)
+    EXPECT(Push(mixer, 2, Frame(value)));
+  for (int16_t value = 3; value <= 6; value++) {
+    mixer.mix(false);
+    EXPECT(mixer.data()[0] == value);
+  }
+  mixer.mix(false);
+  EXPECT(mixer.data()[0] == 0);
+}
+
+void TestRemoveParticipant() {
+  ConferenceMixer mixer(kSampleRate, 1, 3);
+  for (uint32_t id = 1; id <= 3; id++)
+    mixer.add_participant(id);
+  mixer.remove_participant(1);
+  EXPECT(!Push(mixer, 1, Frame(100)));
+  EXPECT(Push(mixer, 2, Frame(200)));
+  EXPECT(Push(mixer, 3, Frame(300)));
+
+  mixer.mix(true);
+  EXPECT(mixer.data()[0] == 500);
+  EXPECT(mixer.mix_minus(3)[0] == 200);
+
+  mixer.remove_participant(3);
+  EXPECT((*mixer.speakers() == std::vector<uint32_t>{2}));
+  EXPECT(mixer.mix_minus(2)[0] == 300);
+}
+
+}  // namespace
+
+int main() {
+  TestMix();
+  TestTopSpeakers();
+  TestSilenceSkipped();
+  TestSaturation();
+  TestQueuedFrames();
+  TestRemoveParticipant();
+
+  return livekit_test::TestResult("conference_mixer_test");
+}
@@ -0,0 +1,228 @@
+// Decode speed of the VP9 and AV1 decoders created by VideoDecoderFactory
+// for a range of thread budgets (SetVideoDecoderThreads). A synthetic 1080p
+// clip is encoded once per codec, with enough tiles for every budget, then
+// decoded as fast as possible.
+
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "api/environment/environment_factory.h"
+#include "api/video/encoded_image.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_bitrate_allocation.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_decoder.h"
+#include "api/video_codecs/video_encoder.h"
+#include "livekit/video_decoder_factory.h"
+#include "media/base/media_constants.h"
+#include "modules/video_coding/codecs/av1/libaom_av1_encoder.h"
+#include "modules/video_coding/codecs/vp9/include/vp9.h"
+#include "modules/video_coding/include/video_error_codes.h"
+
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr int kFrames = 150;
+constexpr int kFrameRate = 30;
+constexpr int kBitrateKbps = 4000;
+// The encoders pick their tile count from the number of cores.
+constexpr int kEncoderCores = 8;
+
+const int kThreadBudgets[] = {1, 2, 4, 8};
+
+struct Codec {
+  const char* name;
+  webrtc::VideoCodecType type;
+};
+
+const Codec kCodecs[] = {
+    {cricket::kVp9CodecName, webrtc::kVideoCodecVP9},
+    {cricket::kAv1CodecName, webrtc::kVideoCodecAV1},
+};
+
+class EncodedCollector : public webrtc::EncodedImageCallback {
+ public:
+  Result OnEncodedImage(
+      const webrtc::EncodedImage& encoded_image,
+      const webrtc::CodecSpecificInfo* codec_specific_info) override {
+    webrtc::EncodedImage image = encoded_image;
+    image.SetEncodedData(webrtc::EncodedImageBuffer::Create(
+        encoded_image.data(), encoded_image.size()));
+    images.push_back(std::move(image));
+    return Result(Result::OK);
+  }
+
+  std::vector<webrtc::EncodedImage> images;
+};
+
+class DecodedCounter : public webrtc::DecodedImageCallback {
+ public:
+  int32_t Decoded(webrtc::VideoFrame& decoded_image) override {
+    frames++;
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int frames = 0;
+};
+
+// Moving pattern with some noise, so every frame costs something to decode.
+webrtc::VideoFrame CreateFrame(int index) {
+  webrtc::scoped_refptr<webrtc::I420Buffer> buffer =
+      webrtc::I420Buffer::Create(kWidth, kHeight);
+  uint32_t seed = index * 2654435761u;
+  for (int y = 0; y < kHeight; y++) {
+    uint8_t* row = buffer->MutableDataY() + y * buffer->StrideY();
+    for (int x = 0; x < kWidth; x++) {
+      seed = seed * 1664525u + 1013904223u;
+      row[x] = ((x + index * 4) * 7 + y * 3 + (seed >> 28)) & 0xFF;
+    }
+  }
+  for (int y = 0; y < buffer->ChromaHeight(); y++) {
+    for (int x = 0; x < buffer->ChromaWidth(); x++) {
+      buffer->MutableDataU()[y * buffer->StrideU() + x] =
+          (x + y + index) & 0xFF;
+      buffer->MutableDataV()[y * buffer->StrideV() + x] =
+          (x * 5 - y) & 0xFF;
+    }
+  }
+
+  return webrtc::VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_rtp_timestamp(index * 90000 / kFrameRate)
+      .build();
+}
+
+std::unique_ptr<webrtc::VideoEncoder> CreateEncoder(
+    const webrtc::Environment& env,
+    webrtc::VideoCodecType type) {
+  if (type == webrtc::kVideoCodecVP9)
+    return webrtc::CreateVp9Encoder(env);
+  return webrtc::CreateLibaomAv1Encoder(env);
+}
+
+std::vector<webrtc::EncodedImage> Encode(const webrtc::Environment& env,
+                                         const Codec& codec) {
+  EncodedCollector collector;
+  std::unique_ptr<webrtc::VideoEncoder> encoder =
+      CreateEncoder(env, codec.type);
+  if (!encoder)
+    return {};
+
+  webrtc::VideoCodec settings;
+  settings.codecType = codec.type;
+  settings.width = kWidth;
+  settings.height = kHeight;
+  settings.maxFramerate = kFrameRate;
+  settings.startBitrate = kBitrateKbps;
+  settings.maxBitrate = kBitrateKbps;
+  settings.qpMax = 56;
+  settings.mode = webrtc::VideoCodecMode::kRealtimeVideo;
+  settings.SetScalabilityMode(webrtc::ScalabilityMode::kL1T1);
+  if (codec.type == webrtc::kVideoCodecVP9) {
+    *settings.VP9() = webrtc::VideoEncoder::GetDefaultVp9Settings();
+    settings.VP9()->numberOfSpatialLayers = 1;
+    settings.VP9()->numberOfTemporalLayers = 1;
+  }
+
+  webrtc::VideoEncoder::Settings encoder_settings(
+      webrtc::VideoEncoder::Capabilities(false), kEncoderCores, 1200);
+  if (encoder->InitEncode(&settings, encoder_settings) !=
+      WEBRTC_VIDEO_CODEC_OK)
+    return {};
+  encoder->RegisterEncodeCompleteCallback(&collector);
+
+  webrtc::VideoBitrateAllocation allocation;
+  allocation.SetBitrate(0, 0, kBitrateKbps * 1000);
+  encoder->SetRates(
+      webrtc::VideoEncoder::RateControlParameters(allocation, kFrameRate));
+
+  for (int i = 0; i < kFrames; i++) {
+    std::vector<webrtc::VideoFrameType> types{
+        i == 0 ? webrtc::VideoFrameType::kVideoFrameKey
+               : webrtc::VideoFrameType::kVideoFrameDelta};
+    encoder->Encode(CreateFrame(i), &types);
+  }
+  encoder->Release();
+  return std::move(collector.images);
+}
+
+struct Result {
+  int threads = 0;
+  double fps = 0;
+};
+
+Result Decode(const webrtc::Environment& env,
+              livekit_ffi::VideoDecoderFactory& factory,
+              const Codec& codec,
+              const std::vector<webrtc::EncodedImage>& images,
+              int budget) {
+  livekit_ffi::SetVideoDecoderThreads(budget, 0);
+  std::unique_ptr<webrtc::VideoDecoder> decoder =
+      factory.Create(env, webrtc::SdpVideoFormat(codec.name));
+  if (!decoder)
+    return {};
+
+  // What the receive stream offers, before the budget applies.
+  webrtc::VideoDecoder::Settings settings;
+  settings.set_codec_type(codec.type);
+  settings.set_max_render_resolution({kWidth, kHeight});
+  settings.set_number_of_cores(std::thread::hardware_concurrency());
+  if (!decoder->Configure(settings))
+    return {};
+
+  DecodedCounter counter;
+  decoder->RegisterDecodeCompleteCallback(&counter);
+
+  Result result;
+  result.threads = livekit_ffi::VideoDecoderThreadsInUse();
+  auto start = std::chrono::steady_clock::now();
+  for (const webrtc::EncodedImage& image : images)
+    decoder->Decode(image, /*render_time_ms=*/0);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  decoder->Release();
+
+  result.fps =
+      counter.frames / std::chrono::duration<double>(elapsed).count();
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  webrtc::Environment env = webrtc::CreateEnvironment();
+  livekit_ffi::VideoDecoderFactory factory;
+
+  printf("%dx%d, %d frames at %d kbps, %u cores\n", kWidth, kHeight, kFrames,
+         kBitrateKbps, std::thread::hardware_concurrency());
+  printf("%6s %8s %8s %10s %9s\n", "codec", "budget", "threads", "decode fps",
+         "speedup");
+  for (const Codec& codec : kCodecs) {
+    std::vector<webrtc::EncodedImage> images = Encode(env, codec);
+    if (images.empty()) {
+      printf("%6s: failed to encode\n", codec.name);
+      continue;
+    }
+
+    // Warm up.
+    Decode(env, factory, codec, images, 1);
+
+    double single_thread_fps = 0;
+    for (int budget : kThreadBudgets) {
+      Result result = Decode(env, factory, codec, images, budget);
+      if (budget == 1)
+        single_thread_fps = result.fps;
+      printf("%6s %8d %8d %10.1f %8.2fx\n", codec.name, budget,
+             result.threads, result.fps,
+             single_thread_fps > 0 ? result.fps / single_thread_fps : 0);
+    }
+  }
+
+  livekit_ffi::SetVideoDecoderThreads(0, 0);
+  return 0;
+}
@@ -0,0 +1,249 @@
+// Checks the hardware to software switch of FallbackVideoEncoder with fake
+// encoders injecting init failures, encode failures and slow encodes, so it
+// runs on machines without any hardware encoder.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "api/video/encoded_image.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "livekit/fallback_video_encoder.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "test_util.h"
+
+using livekit_ffi::FallbackVideoEncoder;
+
+namespace {
+
+struct Faults {
+  bool fail_init = false;
+  // Encodes past this number of frames fail, -1 to never fail.
+  int fail_after_frames = -1;
+  int encode_delay_ms = 0;
+};
+
+// What a FakeEncoder went through, outlives the encoder.
+struct Record {
+  int inits = 0;
+  int init_width = 0;
+  int frames = 0;
+  int encoded = 0;
+  bool first_frame_key = false;
+  bool rates_set = false;
+};
+
+class FakeEncoder : public webrtc::VideoEncoder {
+ public:
+  FakeEncoder(Faults faults, std::shared_ptr<Record> record)
+      : faults_(faults), record_(std::move(record)) {}
+
+  int32_t InitEncode(const webrtc::VideoCodec* codec_settings,
+                     const Settings& settings) override {
+    record_->inits++;
+    record_->init_width = codec_settings->width;
+    return faults_.fail_init ? WEBRTC_VIDEO_CODEC_ERROR
+                             : WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override {
+    callback_ = callback;
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int32_t Release() override { return WEBRTC_VIDEO_CODEC_OK; }
+
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override {
+    bool key = frame_types && !frame_types->empty() &&
+               (*frame_types)[0] == webrtc::VideoFrameType::kVideoFrameKey;
+    if (record_->frames++ == 0)
+      record_->first_frame_key = key;
+
+    if (faults_.fail_after_frames >= 0 &&
+        record_->frames > faults_.fail_after_frames)
+      return WEBRTC_VIDEO_CODEC_ERROR;
+
+    if (faults_.encode_delay_ms > 0)
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(faults_.encode_delay_ms));
+
+    webrtc::EncodedImage image;
+    image.SetEncodedData(webrtc::EncodedImageBuffer::Create(16));
+    image._frameType = key ? webrtc::VideoFrameType::kVideoFrameKey
+                           : webrtc::VideoFrameType::kVideoFrameDelta;
+    callback_->OnEncodedImage(image, nullptr);
+    record_->encoded++;
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  void SetRates(const RateControlParameters& parameters) override {
+    record_->rates_set = true;
+  }
+
+ private:
+  const Faults faults_;
+  std::shared_ptr<Record> record_;
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+};
+
+class Sink : public webrtc::EncodedImageCallback {
+ public:
+  Result OnEncodedImage(
+      const webrtc::EncodedImage& encoded_image,
+      const webrtc::CodecSpecificInfo* codec_specific_info) override {
+    images++;
+    return Result(Result::OK);
+  }
+
+  int images = 0;
+};
+
+struct Setup {
+  std::shared_ptr<Record> hardware = std::make_shared<Record>();
+  std::shared_ptr<Record> software = std::make_shared<Record>();
+  std::unique_ptr<FallbackVideoEncoder> encoder;
+  Sink sink;
+};
+
+std::unique_ptr<Setup> CreateSetup(Faults hardware_faults,
+                                   Faults software_faults,
+                                   FallbackVideoEncoder::Options options) {
+  auto setup = std::make_unique<Setup>();
+  std::shared_ptr<Record> hardware = setup->hardware;
+  std::shared_ptr<Record> software = setup->software;
+
+  std::vector<FallbackVideoEncoder::Candidate> candidates;
+  candidates.push_back({"fake-hw", true, [hardware_faults, hardware]() {
+                          return std::make_unique<FakeEncoder>(hardware_faults,
+                                                               hardware);
+                        }});
+  candidates.push_back({"fake-sw", false, [software_faults, software]() {
+                          return std::make_unique<FakeEncoder>(software_faults,
+                                                               software);
+                        }});
+  setup->encoder = FallbackVideoEncoder::Create(std::move(candidates), options);
+  setup->encoder->RegisterEncodeCompleteCallback(&setup->sink);
+
+  webrtc::VideoCodec codec;
+  codec.width = 320;
+  codec.height = 180;
+  codec.maxFramerate = 30;
+  webrtc::VideoEncoder::Settings settings(
+      webrtc::VideoEncoder::Capabilities(false), 1, 1200);
+  EXPECT(setup->encoder->InitEncode(&codec, settings) ==
+         WEBRTC_VIDEO_CODEC_OK);
+  setup->encoder->SetRates(webrtc::VideoEncoder::RateControlParameters());
+  return setup;
+}
+
+int32_t EncodeFrames(FallbackVideoEncoder* encoder, int count) {
+  webrtc::VideoFrame frame = webrtc::VideoFrame::Builder()
+                                 .set_video_frame_buffer(
+                                     webrtc::I420Buffer::Create(320, 180))
+                                 .build();
+  std::vector<webrtc::VideoFrameType> types{
+      webrtc::VideoFrameType::kVideoFrameDelta};
+
+  for (int i = 0; i < count; i++) {
+    int32_t result = encoder->Encode(frame, &types);
+    if (result != WEBRTC_VIDEO_CODEC_OK)
+      return result;
+  }
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
+void TestInitFailure() {
+  auto setup = CreateSetup({.fail_init = true}, {}, {});
+  EXPECT(setup->hardware->inits == 1);
+  EXPECT(setup->software->inits == 1);
+  EXPECT(setup->software->init_width == 320);
+  EXPECT(EncodeFrames(setup->encoder.get(), 5) == WEBRTC_VIDEO_CODEC_OK);
+  EXPECT(setup->software->encoded == 5);
+  // Init fallbacks are not counted, nothing was sent by the hardware encoder.
+  EXPECT(setup->encoder->fallbacks() == 0);
+}
+
+void TestEncodeFailure() {
+  uint64_t total = FallbackVideoEncoder::total_fallbacks();
+  auto setup = CreateSetup({.fail_after_frames = 5}, {}, {});
+
+  EXPECT(EncodeFrames(setup->encoder.get(), 10) == WEBRTC_VIDEO_CODEC_OK);
+  EXPECT(setup->hardware->encoded == 5);
+  // The failed frame is encoded again by the software encoder, as a keyframe.
+  EXPECT(setup->software->encoded == 5);
+  EXPECT(setup->software->first_frame_key);
+  EXPECT(setup->software->init_width == 320);
+  EXPECT(setup->software->rates_set);
+  EXPECT(setup->sink.images == 10);
+  EXPECT(setup->encoder->fallbacks() == 1);
+  EXPECT(FallbackVideoEncoder::total_fallbacks() == total + 1);
+}
+
+void TestSlowEncoder() {
+  auto setup = CreateSetup({.encode_delay_ms = 3}, {},
+                           {.max_encode_time_ms = 1});
+
+  const int frames = FallbackVideoEncoder::kSlowFramesBeforeFallback + 5;
+  EXPECT(EncodeFrames(setup->encoder.get(), frames) == WEBRTC_VIDEO_CODEC_OK);
+  EXPECT(setup->hardware->encoded ==
+         FallbackVideoEncoder::kSlowFramesBeforeFallback);
+  EXPECT(setup->software->encoded == 5);
+  EXPECT(setup->software->first_frame_key);
+  EXPECT(setup->encoder->fallbacks() == 1);
+}
+
+void TestSlowEncoderIgnoredByDefault() {
+  // 40ms is over the 33ms frame interval, but latency fallback is opt-in.
+  auto setup = CreateSetup({.encode_delay_ms = 40}, {}, {});
+
+  const int frames = FallbackVideoEncoder::kSlowFramesBeforeFallback + 5;
+  EXPECT(EncodeFrames(setup->encoder.get(), frames) == WEBRTC_VIDEO_CODEC_OK);
+  EXPECT(setup->hardware->encoded == frames);
+  EXPECT(setup->software->inits == 0);
+  EXPECT(setup->encoder->fallbacks() == 0);
+}
+
+void TestFailedFallbackIsNotCounted() {
+  uint64_t total = FallbackVideoEncoder::total_fallbacks();
+  auto setup = CreateSetup({.fail_after_frames = 2}, {.fail_init = true}, {});
+
+  EXPECT(EncodeFrames(setup->encoder.get(), 5) == WEBRTC_VIDEO_CODEC_ERROR);
+  EXPECT(setup->software->inits == 1);
+  EXPECT(setup->encoder->fallbacks() == 0);
+  EXPECT(FallbackVideoEncoder::total_fallbacks() == total);
+}
+
+void TestFallbackDisabled() {
+  auto setup =
+      CreateSetup({.fail_after_frames = 2}, {}, {.on_encode_failure = false});
+  EXPECT(EncodeFrames(setup->encoder.get(), 5) == WEBRTC_VIDEO_CODEC_ERROR);
+  EXPECT(setup->software->inits == 0);
+  EXPECT(setup->encoder->fallbacks() == 0);
+}
+
+void TestSoftwareFailureIsReported() {
+  // Once on software there is nothing left to fall back to.
+  auto setup = CreateSetup({.fail_after_frames = 1}, {.fail_after_frames = 1},
+                           {});
+  EXPECT(EncodeFrames(setup->encoder.get(), 5) == WEBRTC_VIDEO_CODEC_ERROR);
+  EXPECT(setup->encoder->fallbacks() == 1);
+}
+
+}  // namespace
+
+int main() {
+  TestInitFailure();
+  TestEncodeFailure();
+  TestSlowEncoder();
+  TestSlowEncoderIgnoredByDefault();
+  TestFailedFallbackIsNotCounted();
+  TestFallbackDisabled();
+  TestSoftwareFailureIsReported();
+
+  return livekit_test::TestResult("fallback_video_encoder_test");
+}
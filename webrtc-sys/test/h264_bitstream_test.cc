@@ -0,0 +1,249 @@
+// Golden-output checks for the packed H.264 headers generated for VAAPI.
+// Only the libva headers are needed, no driver or GPU.
+//
+// The expected bytes were produced by the previous per-field bitstream code
+// in vaapi_h264_encoder_wrapper.cpp, so any difference is a regression.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "test_util.h"
+#include "vaapi/h264_bitstream_writer.h"
+#include "vaapi/h264_packed_headers.h"
+
+using livekit_ffi::H264BitstreamWriter;
+using livekit_ffi::H264PackedHeaders;
+
+namespace {
+
+struct Golden {
+  size_t bits;
+  std::vector<uint8_t> bytes;
+};
+
+bool Matches(const H264BitstreamWriter& bs, const Golden& golden) {
+  return bs.bit_length() == golden.bits &&
+         bs.size_in_bytes() == golden.bytes.size() &&
+         memcmp(bs.data(), golden.bytes.data(), golden.bytes.size()) == 0;
+}
+
+struct Scenario {
+  const char* name;
+  VAProfile profile;
+  int constraint_set_flag;
+  int width_in_mbs;
+  int height_in_mbs;
+  int crop_bottom;
+  int entropy_coding_mode;
+  int transform_8x8_mode;
+  int slice_type;
+  int idr;
+  int reference;
+  int frame_num;
+  int poc;
+  int macroblock_address;
+  int idr_pic_id;
+  int slice_qp_delta;
+  int disable_deblocking_filter_idc;
+  int alpha_c0_offset_div2;
+  int beta_offset_div2;
+  int num_ref_idx_active_override;
+  Golden sps;
+  Golden pps;
+  Golden slice;
+};
+
+const Scenario kScenarios[] = {
+    {"1080p high IDR", VAProfileH264High, 1 << 3, 120, 68, 4, 1, 1,
+     2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     {128, {0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x10, 0x29, 0xac, 0x1b, 0x2b,
+            0x01, 0xe0, 0x08, 0x9f, 0x95}},
+     {64, {0x00, 0x00, 0x00, 0x01, 0x68, 0xee, 0x3c, 0xb0}},
+     {80, {0x00, 0x00, 0x00, 0x01, 0x65, 0xb8, 0x00, 0x04, 0x00, 0xff}}},
+    {"1080p high P, second slice", VAProfileH264High, 1 << 3, 120, 68, 4, 1,
+     1, 0, 0, 1, 5, 10, 2040, 0, -3, 0, 0, 0, 0,
+     {128, {0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x10, 0x29, 0xac, 0x1b, 0x2b,
+            0x01, 0xe0, 0x08, 0x9f, 0x95}},
+     {64, {0x00, 0x00, 0x00, 0x01, 0x68, 0xee, 0x3c, 0xb0}},
+     {104, {0x00, 0x00, 0x00, 0x01, 0x41, 0x00, 0x3f, 0xce, 0x00, 0x0a, 0x14,
+            0x27, 0xff}}},
+    {"720p main B", VAProfileH264Main, 1 << 1, 80, 45, 0, 1, 0,
+     1, 0, 0, 7, 13, 0, 0, 2, 0, -2, 3, 1,
+     {112, {0x00, 0x00, 0x00, 0x01, 0x67, 0x4d, 0x40, 0x29, 0x8d, 0x95, 0x80,
+            0xa0, 0x0b, 0x72}},
+     {64, {0x00, 0x00, 0x00, 0x01, 0x68, 0xee, 0x3c, 0x30}},
+     {96, {0x00, 0x00, 0x00, 0x01, 0x01, 0xa8, 0x00, 0x38, 0x6f, 0x92, 0x4a,
+           0x6f}}},
+    {"360p baseline IDR", VAProfileH264ConstrainedBaseline, 3, 40, 23, 4, 0, 0,
+     2, 1, 1, 0, 0, 0, 3, 0, 1, 0, 0, 0,
+     {120, {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x29, 0x8d, 0x95, 0x81,
+            0x40, 0x5f, 0xf2, 0xa0}},
+     {64, {0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x30}},
+     {80, {0x00, 0x00, 0x00, 0x01, 0x65, 0xb8, 0x00, 0x01, 0x00, 0x0a}}},
+    {"360p baseline P, wrapped counters", VAProfileH264ConstrainedBaseline, 3,
+     40, 23, 4, 0, 0, 0, 0, 1, 65535, 255, 459, 0, 12, 0, 1, -1, 1,
+     {120, {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x29, 0x8d, 0x95, 0x81,
+            0x40, 0x5f, 0xf2, 0xa0}},
+     {64, {0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x30}},
+     {103, {0x00, 0x00, 0x00, 0x01, 0x41, 0x00, 0xe6, 0x7f, 0xff, 0xff, 0xf8,
+            0x18, 0xa6}}},
+};
+
+void Fill(const Scenario& s,
+          VAEncSequenceParameterBufferH264* seq,
+          VAEncPictureParameterBufferH264* pic,
+          VAEncSliceParameterBufferH264* slice) {
+  memset(seq, 0, sizeof(*seq));
+  memset(pic, 0, sizeof(*pic));
+  memset(slice, 0, sizeof(*slice));
+
+  // Same values as render_sequence() in vaapi_h264_encoder_wrapper.cpp.
+  seq->level_idc = 41;
+  seq->picture_width_in_mbs = s.width_in_mbs;
+  seq->picture_height_in_mbs = s.height_in_mbs;
+  seq->max_num_ref_frames = 2;
+  seq->bits_per_second = 2000000;
+  seq->time_scale = 900;
+  seq->num_units_in_tick = 15;
+  seq->seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4 = 4;
+  seq->seq_fields.bits.log2_max_frame_num_minus4 = 12;
+  seq->seq_fields.bits.frame_mbs_only_flag = 1;
+  seq->seq_fields.bits.chroma_format_idc = 1;
+  seq->seq_fields.bits.direct_8x8_inference_flag = 1;
+  if (s.crop_bottom) {
+    seq->frame_cropping_flag = 1;
+    seq->frame_crop_bottom_offset = s.crop_bottom;
+  }
+
+  pic->pic_init_qp = 26;
+  pic->frame_num = s.frame_num;
+  pic->CurrPic.TopFieldOrderCnt = s.poc;
+  pic->pic_fields.bits.entropy_coding_mode_flag = s.entropy_coding_mode;
+  pic->pic_fields.bits.deblocking_filter_control_present_flag = 1;
+  pic->pic_fields.bits.transform_8x8_mode_flag = s.transform_8x8_mode;
+  pic->pic_fields.bits.idr_pic_flag = s.idr;
+  pic->pic_fields.bits.reference_pic_flag = s.reference;
+
+  slice->slice_type = s.slice_type;
+  slice->macroblock_address = s.macroblock_address;
+  slice->idr_pic_id = s.idr_pic_id;
+  slice->slice_qp_delta = s.slice_qp_delta;
+  slice->disable_deblocking_filter_idc = s.disable_deblocking_filter_idc;
+  slice->slice_alpha_c0_offset_div2 = s.alpha_c0_offset_div2;
+  slice->slice_beta_offset_div2 = s.beta_offset_div2;
+  slice->num_ref_idx_active_override_flag = s.num_ref_idx_active_override;
+  slice->direct_spatial_mv_pred_flag = 1;
+}
+
+void TestGolden() {
+  for (const Scenario& s : kScenarios) {
+    VAEncSequenceParameterBufferH264 seq;
+    VAEncPictureParameterBufferH264 pic;
+    VAEncSliceParameterBufferH264 slice;
+    Fill(s, &seq, &pic, &slice);
+
+    H264PackedHeaders headers;
+    bool sps = Matches(headers.Sps(s.profile, s.constraint_set_flag, seq),
+                       s.sps);
+    bool pps = Matches(headers.Pps(pic), s.pps);
+    bool slc = Matches(headers.Slice(seq, pic, slice), s.slice);
+    if (!sps || !pps || !slc)
+      fprintf(stderr, "scenario \"%s\" mismatch\n", s.name);
+    EXPECT(sps);
+    EXPECT(pps);
+    EXPECT(slc);
+  }
+}
+
+void TestCaching() {
+  const Scenario& s = kScenarios[1];
+  VAEncSequenceParameterBufferH264 seq;
+  VAEncPictureParameterBufferH264 pic;
+  VAEncSliceParameterBufferH264 slice;
+  Fill(s, &seq, &pic, &slice);
+
+  H264PackedHeaders headers;
+  headers.Sps(s.profile, s.constraint_set_flag, seq);
+  headers.Pps(pic);
+
+  // Fields that are not part of the SPS/PPS must not invalidate them.
+  seq.bits_per_second = 500000;
+  pic.frame_num = 9;
+  pic.CurrPic.TopFieldOrderCnt = 18;
+  EXPECT(Matches(headers.Sps(s.profile, s.constraint_set_flag, seq), s.sps));
+  EXPECT(Matches(headers.Pps(pic), s.pps));
+
+  // A new resolution does.
+  seq.picture_width_in_mbs = 80;
+  seq.picture_height_in_mbs = 45;
+  seq.frame_cropping_flag = 0;
+  seq.frame_crop_bottom_offset = 0;
+  const H264BitstreamWriter& sps =
+      headers.Sps(s.profile, s.constraint_set_flag, seq);
+  EXPECT(!Matches(sps, s.sps));
+
+  H264PackedHeaders fresh;
+  const H264BitstreamWriter& expected =
+      fresh.Sps(s.profile, s.constraint_set_flag, seq);
+  EXPECT(sps.bit_length() == expected.bit_length());
+  EXPECT(memcmp(sps.data(), expected.data(), sps.size_in_bytes()) == 0);
+}
+
+void TestWriter() {
+  H264BitstreamWriter bs(8);
+
+  // ue(v): 0 -> 1, 1 -> 010, 2 -> 011, 3 -> 00100
+  bs.PutUE(0);
+  bs.PutUE(1);
+  bs.PutUE(2);
+  bs.PutUE(3);
+  bs.Flush();
+  EXPECT(bs.bit_length() == 12);
+  EXPECT(bs.data()[0] == 0xA6 && bs.data()[1] == 0x40);
+
+  // se(v): 1 -> 010, -1 -> 011, 0 -> 1
+  bs.Reset();
+  bs.PutSE(1);
+  bs.PutSE(-1);
+  bs.PutSE(0);
+  bs.Flush();
+  EXPECT(bs.bit_length() == 7);
+  EXPECT(bs.data()[0] == 0x4E);
+
+  // The largest codeNum needs 65 bits (32 zeros, a one, 32 zeros), it must
+  // not overflow the cache.
+  bs.Reset();
+  bs.PutBits(1, 1);
+  bs.PutUE(0xFFFFFFFF);
+  bs.Flush();
+  EXPECT(bs.bit_length() == 66);
+  EXPECT(bs.data()[0] == 0x80 && bs.data()[3] == 0x00);
+  EXPECT(bs.data()[4] == 0x40);
+  EXPECT(bs.data()[5] == 0x00 && bs.data()[8] == 0x00);
+
+  // Growing past the initial capacity keeps the content.
+  bs.Reset();
+  for (int i = 0; i < 100; i++)
+    bs.PutBits(0xA5, 8);
+  bs.PutBits(1, 1);
+  bs.ByteAlign(1);
+  bs.Flush();
+  EXPECT(bs.size_in_bytes() == 101);
+  bool content = true;
+  for (int i = 0; i < 100; i++)
+    content &= bs.data()[i] == 0xA5;
+  EXPECT(content);
+  EXPECT(bs.data()[100] == 0xFF);
+}
+
+}  // namespace
+
+int main() {
+  TestWriter();
+  TestGolden();
+  TestCaching();
+
+  return livekit_test::TestResult("h264 packed headers");
+}
@@ -0,0 +1,107 @@
+// Micro-benchmark of the packed H.264 header generation done per frame by
+// the VAAPI encoder: a 1080p60 stream, one IDR every 5 seconds and a varying
+// number of slices per frame.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "vaapi/h264_packed_headers.h"
+
+using livekit_ffi::H264PackedHeaders;
+
+namespace {
+
+constexpr int kWidthInMbs = 1920 / 16;
+constexpr int kHeightInMbs = 1088 / 16;
+constexpr int kFrameRate = 60;
+constexpr int kIdrPeriod = kFrameRate * 5;
+constexpr int kFrames = kFrameRate * 60;
+
+size_t sink = 0;
+
+void Setup(VAEncSequenceParameterBufferH264* seq,
+           VAEncPictureParameterBufferH264* pic,
+           VAEncSliceParameterBufferH264* slice) {
+  memset(seq, 0, sizeof(*seq));
+  memset(pic, 0, sizeof(*pic));
+  memset(slice, 0, sizeof(*slice));
+
+  seq->level_idc = 41;
+  seq->picture_width_in_mbs = kWidthInMbs;
+  seq->picture_height_in_mbs = kHeightInMbs;
+  seq->max_num_ref_frames = 2;
+  seq->seq_fields.bits.log2_max_pic_order_cnt_lsb_minus4 = 4;
+  seq->seq_fields.bits.log2_max_frame_num_minus4 = 12;
+  seq->seq_fields.bits.frame_mbs_only_flag = 1;
+  seq->seq_fields.bits.chroma_format_idc = 1;
+  seq->seq_fields.bits.direct_8x8_inference_flag = 1;
+  seq->frame_cropping_flag = 1;
+  seq->frame_crop_bottom_offset = 4;
+
+  pic->pic_init_qp = 26;
+  pic->pic_fields.bits.entropy_coding_mode_flag = 1;
+  pic->pic_fields.bits.deblocking_filter_control_present_flag = 1;
+  pic->pic_fields.bits.transform_8x8_mode_flag = 1;
+}
+
+// Returns the average time spent generating headers per frame, in ns.
+double Run(int slices, bool cache_parameter_sets) {
+  VAEncSequenceParameterBufferH264 seq;
+  VAEncPictureParameterBufferH264 pic;
+  VAEncSliceParameterBufferH264 slice;
+  Setup(&seq, &pic, &slice);
+
+  const int mbs = kWidthInMbs * kHeightInMbs;
+  H264PackedHeaders headers;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    bool idr = frame % kIdrPeriod == 0;
+    pic.frame_num = frame % kIdrPeriod;
+    pic.CurrPic.TopFieldOrderCnt = (2 * (frame % kIdrPeriod)) % 256;
+    pic.pic_fields.bits.idr_pic_flag = idr;
+    pic.pic_fields.bits.reference_pic_flag = 1;
+    slice.slice_type = idr ? 2 : 0;
+    if (idr)
+      slice.idr_pic_id = (frame / kIdrPeriod) & 0xFFFF;
+
+    if (!cache_parameter_sets)
+      headers.Reset();
+    if (idr || !cache_parameter_sets) {
+      sink += headers.Sps(VAProfileH264High, 1 << 3, seq).bit_length();
+      sink += headers.Pps(pic).bit_length();
+    }
+
+    for (int i = 0; i < slices; i++) {
+      slice.macroblock_address = i * mbs / slices;
+      slice.num_macroblocks = (i + 1) * mbs / slices - slice.macroblock_address;
+      sink += headers.Slice(seq, pic, slice).bit_length();
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  return std::chrono::duration<double, std::nano>(elapsed).count() / kFrames;
+}
+
+}  // namespace
+
+int main() {
+  const int kSlices[] = {1, 2, 4, 8, 16};
+
+  // Warm up.
+  Run(4, true);
+
+  printf("1080p%d, IDR every %d frames, %d frames per run\n", kFrameRate,
+         kIdrPeriod, kFrames);
+  printf("%8s %22s %22s\n", "slices", "cached SPS/PPS ns/frame",
+         "SPS/PPS every frame");
+  for (int slices : kSlices) {
+    double cached = Run(slices, true);
+    double uncached = Run(slices, false);
+    printf("%8d %22.1f %22.1f\n", slices, cached, uncached);
+  }
+
+  return sink == 0;
+}
@@ -0,0 +1,99 @@
+// Cost of producing the simulcast layers of one published track per frame:
+// scaling every layer from the input, as SimulcastEncoderAdapter does on its
+// own, versus building them with FramePyramid.
+//
+// The layer sizes are the ones compute_video_encodings (livekit/src/room/
+// options.rs) picks for a 720p and a 1080p camera track.
+
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "livekit/simulcast_pyramid.h"
+
+using livekit_ffi::FramePyramid;
+
+namespace {
+
+constexpr int kFrames = 600;
+constexpr int kFrameRate = 30;
+
+struct Track {
+  const char* name;
+  int width;
+  int height;
+  std::vector<FramePyramid::Size> layers;
+};
+
+const Track kTracks[] = {
+    {"720p", 1280, 720, {{640, 360}, {320, 180}}},
+    {"1080p", 1920, 1080, {{640, 360}, {320, 180}}},
+};
+
+size_t sink = 0;
+
+webrtc::scoped_refptr<webrtc::VideoFrameBuffer> CreateSource(const Track& track,
+                                                             bool nv12) {
+  webrtc::scoped_refptr<webrtc::I420Buffer> i420 =
+      webrtc::I420Buffer::Create(track.width, track.height);
+  for (int y = 0; y < track.height; y++) {
+    for (int x = 0; x < track.width; x++)
+      i420->MutableDataY()[y * i420->StrideY() + x] = (x * 7 + y * 3) & 0xFF;
+  }
+  for (int y = 0; y < i420->ChromaHeight(); y++) {
+    for (int x = 0; x < i420->ChromaWidth(); x++) {
+      i420->MutableDataU()[y * i420->StrideU() + x] = (x + y) & 0xFF;
+      i420->MutableDataV()[y * i420->StrideV() + x] = (x * 5) & 0xFF;
+    }
+  }
+
+  if (!nv12)
+    return i420;
+  return webrtc::NV12Buffer::Copy(*i420);
+}
+
+// Returns the average time spent scaling per frame, in ns.
+double Run(const Track& track, bool nv12, bool pyramid) {
+  webrtc::scoped_refptr<webrtc::VideoFrameBuffer> source =
+      CreateSource(track, nv12);
+  FramePyramid frame_pyramid;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    webrtc::scoped_refptr<webrtc::VideoFrameBuffer> input =
+        pyramid ? frame_pyramid.Build(source, track.layers) : source;
+
+    // What SimulcastEncoderAdapter does for each layer smaller than the input.
+    for (const FramePyramid::Size& layer : track.layers)
+      sink += input->Scale(layer.width, layer.height)->width();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  return std::chrono::duration<double, std::nano>(elapsed).count() / kFrames;
+}
+
+}  // namespace
+
+int main() {
+  // Warm up.
+  Run(kTracks[0], false, true);
+
+  printf("%d frames per run, CPU is for one track at %d fps\n", kFrames,
+         kFrameRate);
+  printf("%8s %6s %16s %16s %14s\n", "track", "format", "per-layer ns/fr",
+         "pyramid ns/fr", "CPU saved %");
+  for (const Track& track : kTracks) {
+    for (bool nv12 : {false, true}) {
+      double independent = Run(track, nv12, false);
+      double pyramid = Run(track, nv12, true);
+      double saved = (independent - pyramid) * kFrameRate / 1e9 * 100;
+      printf("%8s %6s %16.0f %16.0f %14.3f\n", track.name,
+             nv12 ? "NV12" : "I420", independent, pyramid, saved);
+    }
+  }
+
+  return sink == 0;
+}
@@ -1,20 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
 #include "benchmark_nvidia.h"
 #include "benchmark_openh264.h"
 #include "benchmark_vaapi.h"
-#include "stdio.h"
+#include "fileutils.h"
+
+namespace {
+
+const char kUsage[] =
+    "Usage: h264_benchmark [options]\n"
+    "  --input=FILE          raw I420 input, default "
+    "resources/FourPeople_1280x720_30.yuv\n"
+    "  --input-size=WxH      size of the input, default 1280x720\n"
+    "  --synthetic=PATTERN   generate the input instead, gradient, text or "
+    "screen\n"
+    "  --motion=N            synthetic motion in pixels per frame, default 4\n"
+    "  --detail=N            synthetic detail from 0 to 100, default 50\n"
+    "  --noise=N             synthetic luma noise amplitude, default 0\n"
+    "  --frames=N            synthetic frame count, default 300\n"
+    "  --screenshare         encode in screen sharing mode, implied by "
+    "--synthetic=screen\n"
+    "  --sizes=WxH,...       encoded sizes, default the input size\n"
+    "  --fps=N,...           frame rates, default 30\n"
+    "  --bitrates=KBPS,...   default 500,1000,2000,3000,4000\n"
+    "  --iterations=N        runs per configuration, default 8\n"
+    "  --codecs=NAME,...     openh264, nvidia, vaapi, default "
+    "nvidia,openh264\n"
+    "  --no-quality          don't compute PSNR and SSIM\n"
+    "  --json=FILE           write the results as JSON\n"
+    "  --csv=FILE            write the results as CSV\n"
+    "  --decode [FILE]       decode benchmark, on the output of every "
+    "encoder or on an Annex B file\n";
+
+std::vector<std::string> Split(const std::string& value) {
+  std::vector<std::string> items;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+bool ParseSize(const std::string& value, BenchmarkConfig::Size& size) {
+  return sscanf(value.c_str(), "%dx%d", &size.width, &size.height) == 2 &&
+         size.width > 0 && size.height > 0;
+}
+
+bool ParseInts(const std::string& value, std::vector<int>& ints) {
+  ints.clear();
+  for (const std::string& item : Split(value)) {
+    int n = atoi(item.c_str());
+    if (n <= 0) {
+      return false;
+    }
+    ints.push_back(n);
+  }
+  return !ints.empty();
+}
+
+// Returns the value of --|name|=value, or nullptr.
+const char* Option(const std::string& arg, const char* name) {
+  std::string prefix = std::string("--") + name + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) {
+    return nullptr;
+  }
+  return arg.c_str() + prefix.size();
+}
+
+Benchmark* CreateBenchmark(const std::string& codec) {
+  if (codec == "openh264") {
+    return new OpenH264Benchmark();
+  }
+  if (codec == "nvidia") {
+    return new NvidiaBenchmark();
+  }
+  if (codec == "vaapi") {
+    return new VaapiBenchmark();
+  }
+  return nullptr;
+}
+
+}  // namespace
 
 int main(int argc, char** argv) {
+  BenchmarkConfig config;
+  config.inputFile = webrtc::test::ProjectRootPath() +
+                     "resources/FourPeople_1280x720_30.yuv";
+  std::vector<std::string> codecs{"nvidia", "openh264"};
+  bool inputSet = false;
+  bool sizesSet = false;
+  bool decode = false;
+  std::string annexbFile;
+  std::string jsonFile;
+  std::string csvFile;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    const char* value;
+    bool ok = true;
+    if ((value = Option(arg, "input"))) {
+      config.inputFile = value;
+      inputSet = true;
+    } else if ((value = Option(arg, "input-size"))) {
+      BenchmarkConfig::Size size;
+      ok = ParseSize(value, size);
+      config.inputWidth = size.width;
+      config.inputHeight = size.height;
+    } else if ((value = Option(arg, "sizes"))) {
+      config.sizes.clear();
+      for (const std::string& item : Split(value)) {
+        BenchmarkConfig::Size size;
+        ok = ok && ParseSize(item, size);
+        config.sizes.push_back(size);
+      }
+      ok = ok && !config.sizes.empty();
+      sizesSet = true;
+    } else if ((value = Option(arg, "fps"))) {
+      ok = ParseInts(value, config.frameRates);
+    } else if ((value = Option(arg, "bitrates"))) {
+      ok = ParseInts(value, config.bitRates);
+    } else if ((value = Option(arg, "iterations"))) {
+      config.iterations = atoi(value);
+      ok = config.iterations > 0;
+    } else if ((value = Option(arg, "synthetic"))) {
+      config.synthetic = true;
+      ok = SyntheticVideoGenerator::ParsePattern(
+          value, config.syntheticOptions.pattern);
+      if (config.syntheticOptions.pattern ==
+          SyntheticVideoGenerator::kScreenShare) {
+        config.screenshare = true;
+      }
+    } else if ((value = Option(arg, "motion"))) {
+      config.syntheticOptions.motion = atoi(value);
+      ok = config.syntheticOptions.motion >= 0;
+    } else if ((value = Option(arg, "detail"))) {
+      config.syntheticOptions.detail = atoi(value);
+      ok = config.syntheticOptions.detail >= 0 &&
+           config.syntheticOptions.detail <= 100;
+    } else if ((value = Option(arg, "noise"))) {
+      config.syntheticOptions.noise = atoi(value);
+      ok = config.syntheticOptions.noise >= 0;
+    } else if ((value = Option(arg, "frames"))) {
+      config.syntheticFrames = atoi(value);
+      ok = config.syntheticFrames > 0;
+    } else if (arg == "--screenshare") {
+      config.screenshare = true;
+    } else if ((value = Option(arg, "codecs"))) {
+      codecs = Split(value);
+    } else if ((value = Option(arg, "json"))) {
+      jsonFile = value;
+    } else if ((value = Option(arg, "csv"))) {
+      csvFile = value;
+    } else if (arg == "--no-quality") {
+      config.quality = false;
+    } else if (arg == "--decode") {
+      decode = true;
+      if (i + 1 < argc && argv[i + 1][0] != '-') {
+        annexbFile = argv[++i];
+      }
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      fprintf(stderr, "Invalid argument %s\n%s", arg.c_str(), kUsage);
+      return 1;
+    }
+  }
+  if (!config.synthetic && !inputSet) {
+    FILE* file = fopen(config.inputFile.c_str(), "rb");
+    if (file) {
+      fclose(file);
+    } else {
+      printf("%s not found, using a synthetic gradient\n",
+             config.inputFile.c_str());
+      config.synthetic = true;
+    }
+  }
+  if (!sizesSet) {
+    config.sizes = {{config.inputWidth, config.inputHeight}};
+  }
 
   std::vector<Benchmark*> benchmarks;
-  benchmarks.push_back(new NvidiaBenchmark());
-  //benchmarks.push_back(new VaapiBenchmark());
-  benchmarks.push_back(new OpenH264Benchmark());
+  for (const std::string& codec : codecs) {
+    Benchmark* benchmark = CreateBenchmark(codec);
+    if (!benchmark) {
+      fprintf(stderr, "Unknown codec %s\n%s", codec.c_str(), kUsage);
+      return 1;
+    }
+    benchmark->SetConfig(config);
+    benchmarks.push_back(benchmark);
+  }
 
+  std::vector<RunResult> results;
   for (auto benchmark : benchmarks) {
-    if (benchmark->IsSupported()) {
+    if (!benchmark->IsSupported()) {
+      continue;
+    }
+    if (!decode) {
       benchmark->Perform();
+      results.insert(results.end(), benchmark->GetResults().begin(),
+                     benchmark->GetResults().end());
+    } else if (annexbFile.empty()) {
+      benchmark->PerformDecode();
+    } else {
+      // The encoder doesn't matter.
+      benchmark->PerformDecode(annexbFile);
+      break;
     }
   }
 
+  if (!jsonFile.empty()) {
+    std::ofstream out(jsonFile);
+    WriteResultsJson(results, out);
+  }
+  if (!csvFile.empty()) {
+    std::ofstream out(csvFile);
+    WriteResultsCsv(results, out);
+  }
+
   return 0;
 }
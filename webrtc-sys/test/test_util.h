@@ -0,0 +1,31 @@
+// Minimal check harness shared by the standalone tests: EXPECT() records a
+// failure and carries on, main() returns TestResult() to report them.
+
+#pragma once
+
+#include <stdio.h>
+
+namespace livekit_test {
+
+inline int failures = 0;
+
+// Prints the number of failed checks, or that all of |name| passed. Returns
+// the exit code of the test.
+inline int TestResult(const char* name) {
+  if (failures) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("%s: all checks passed\n", name);
+  return 0;
+}
+
+}  // namespace livekit_test
+
+#define EXPECT(cond)                                                    \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: FAILED %s\n", __FILE__, __LINE__, #cond); \
+      livekit_test::failures++;                                         \
+    }                                                                   \
+  } while (0)
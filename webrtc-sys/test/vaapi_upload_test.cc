@@ -0,0 +1,139 @@
+// Software-only checks for the VAAPI surface upload packing. These do not
+// touch libva, so they run on machines without a VAAPI capable GPU.
+
+#include <string.h>
+
+#include <vector>
+
+#include "test_util.h"
+#include "vaapi/vaapi_surface_upload.h"
+
+using livekit_ffi::kUploadFourccI420;
+using livekit_ffi::kUploadFourccNV12;
+using livekit_ffi::kUploadFourccYV12;
+using livekit_ffi::PackYUV420;
+using livekit_ffi::UploadPlanes;
+
+namespace {
+
+// Planar or semi-planar 4:2:0 picture with padded strides.
+struct Picture {
+  Picture(uint32_t fourcc, int width, int height, int padding)
+      : width(width), height(height) {
+    const int chroma_width = (width + 1) / 2;
+    const int chroma_height = (height + 1) / 2;
+    planes.fourcc = fourcc;
+    planes.stride[0] = width + padding;
+    if (fourcc == kUploadFourccNV12) {
+      planes.stride[1] = chroma_width * 2 + padding;
+      planes.stride[2] = 0;
+    } else {
+      planes.stride[1] = chroma_width + padding;
+      planes.stride[2] = chroma_width + padding;
+    }
+    for (int i = 0; i < 3; i++) {
+      int rows = i == 0 ? height : chroma_height;
+      storage[i].assign(planes.stride[i] * rows, 0xEE);
+      planes.data[i] = storage[i].empty() ? nullptr : storage[i].data();
+    }
+  }
+
+  // Sample accessors, independent of the layout.
+  uint8_t& Y(int x, int y) { return planes.data[0][y * planes.stride[0] + x]; }
+  uint8_t& U(int x, int y) {
+    switch (planes.fourcc) {
+      case kUploadFourccNV12:
+        return planes.data[1][y * planes.stride[1] + 2 * x];
+      case kUploadFourccYV12:
+        return planes.data[2][y * planes.stride[2] + x];
+      default:
+        return planes.data[1][y * planes.stride[1] + x];
+    }
+  }
+  uint8_t& V(int x, int y) {
+    switch (planes.fourcc) {
+      case kUploadFourccNV12:
+        return planes.data[1][y * planes.stride[1] + 2 * x + 1];
+      case kUploadFourccYV12:
+        return planes.data[1][y * planes.stride[1] + x];
+      default:
+        return planes.data[2][y * planes.stride[2] + x];
+    }
+  }
+
+  void Fill() {
+    for (int y = 0; y < height; y++)
+      for (int x = 0; x < width; x++)
+        Y(x, y) = static_cast<uint8_t>(x * 7 + y * 13);
+    for (int y = 0; y < (height + 1) / 2; y++) {
+      for (int x = 0; x < (width + 1) / 2; x++) {
+        U(x, y) = static_cast<uint8_t>(x * 3 + y * 5 + 1);
+        V(x, y) = static_cast<uint8_t>(x * 11 + y * 2 + 2);
+      }
+    }
+  }
+
+  int width;
+  int height;
+  UploadPlanes planes = {};
+  std::vector<uint8_t> storage[3];
+};
+
+bool SamePixels(Picture& a, Picture& b) {
+  for (int y = 0; y < a.height; y++)
+    for (int x = 0; x < a.width; x++)
+      if (a.Y(x, y) != b.Y(x, y))
+        return false;
+  for (int y = 0; y < (a.height + 1) / 2; y++)
+    for (int x = 0; x < (a.width + 1) / 2; x++)
+      if (a.U(x, y) != b.U(x, y) || a.V(x, y) != b.V(x, y))
+        return false;
+  return true;
+}
+
+// The padding bytes of |dst| past the visible width must stay untouched.
+bool PaddingUntouched(Picture& dst) {
+  for (int y = 0; y < dst.height; y++)
+    for (int x = dst.width; x < dst.planes.stride[0]; x++)
+      if (dst.planes.data[0][y * dst.planes.stride[0] + x] != 0xEE)
+        return false;
+  return true;
+}
+
+void TestPack(uint32_t src_fourcc,
+              uint32_t dst_fourcc,
+              int width,
+              int height,
+              int src_padding,
+              int dst_padding) {
+  Picture src(src_fourcc, width, height, src_padding);
+  Picture dst(dst_fourcc, width, height, dst_padding);
+  src.Fill();
+
+  EXPECT(PackYUV420(src.planes, dst.planes, width, height));
+  EXPECT(SamePixels(src, dst));
+  EXPECT(PaddingUntouched(dst));
+}
+
+}  // namespace
+
+int main() {
+  const uint32_t formats[] = {kUploadFourccNV12, kUploadFourccI420,
+                              kUploadFourccYV12};
+  const int sizes[][2] = {{64, 48}, {17, 9}, {1, 1}, {1280, 720}};
+  const int paddings[][2] = {{0, 0}, {0, 32}, {8, 0}, {3, 64}};
+
+  for (uint32_t src : formats)
+    for (uint32_t dst : formats)
+      for (auto& size : sizes)
+        for (auto& padding : paddings)
+          TestPack(src, dst, size[0], size[1], padding[0], padding[1]);
+
+  // Unknown layouts are rejected.
+  Picture src(kUploadFourccI420, 16, 16, 0);
+  Picture dst(kUploadFourccNV12, 16, 16, 0);
+  dst.planes.fourcc = 0x32595559;  // YUY2
+  EXPECT(!PackYUV420(src.planes, dst.planes, 16, 16));
+
+  return livekit_test::TestResult("vaapi upload packing");
+}
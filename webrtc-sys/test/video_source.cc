@@ -11,6 +11,9 @@
 #include "video_source.h"
 
 #include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "fileutils.h"
 
@@ -62,6 +65,32 @@ _frameRate(frameRate)
     assert(frameRate > 0);
 }
 
+VideoSource::VideoSource(const SyntheticVideoGenerator::Options& options,
+    int width, int height, int frameRate /*= 30*/, int frameCount /*= 300*/)
+:
+_fileName(std::string("synthetic-") +
+          SyntheticVideoGenerator::GetPatternName(options.pattern)),
+_width(width),
+_height(height),
+_type(webrtc::VideoType::kI420),
+_frameRate(frameRate),
+_synthetic(true),
+_options(options),
+_frameCount(frameCount)
+{
+    assert(width > 0);
+    assert(height > 0);
+    assert(frameRate > 0);
+    assert(frameCount > 0);
+}
+
+void
+VideoSource::GenerateFrame(int index, uint8_t* frame) const
+{
+    assert(_synthetic);
+    SyntheticVideoGenerator(_width, _height, _options).Generate(index, frame);
+}
+
 VideoSize
 VideoSource::GetSize() const
 {
@@ -393,6 +422,327 @@ VideoSource::GetWidthHeight( VideoSize size, int & width, int& height)
     }
 }
 
+namespace {
+
+const int kGlyphWidth = 5;
+const int kGlyphHeight = 7;
+const uint8_t kInk = 30;
+const uint8_t kPaper = 235;
+
+uint32_t Hash(uint32_t a, uint32_t b, uint32_t c = 0, uint32_t d = 0)
+{
+    uint32_t h = a * 0x9E3779B1u ^ b * 0x85EBCA77u ^ c * 0xC2B2AE3Du ^
+                 d * 0x27D4EB2Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return h;
+}
+
+uint8_t Clamp(int value)
+{
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+// Position in a triangle wave of |period|, from 0 to |period|.
+int Triangle(int position, int period)
+{
+    int t = position % (2 * period);
+    return t < period ? t : 2 * period - t;
+}
+
+}  // namespace
+
+SyntheticVideoGenerator::SyntheticVideoGenerator(int width, int height,
+    const Options& options)
+:
+_width(width),
+_height(height),
+_options(options),
+_scale(1 + (100 - std::min(std::max(options.detail, 0), 100)) / 34)
+{
+}
+
+bool
+SyntheticVideoGenerator::ParsePattern(const std::string& name,
+    Pattern& pattern)
+{
+    for (Pattern candidate : {kGradient, kScrollingText, kScreenShare})
+    {
+        if (name == GetPatternName(candidate))
+        {
+            pattern = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char*
+SyntheticVideoGenerator::GetPatternName(Pattern pattern)
+{
+    switch (pattern)
+    {
+        case kGradient:
+            return "gradient";
+        case kScrollingText:
+            return "text";
+        case kScreenShare:
+            return "screen";
+    }
+    return "unknown";
+}
+
+void
+SyntheticVideoGenerator::Generate(int index, uint8_t* frame) const
+{
+    const int chromaSize = ((_width + 1) / 2) * ((_height + 1) / 2);
+    uint8_t* y = frame;
+    uint8_t* u = y + _width * _height;
+    uint8_t* v = u + chromaSize;
+
+    switch (_options.pattern)
+    {
+        case kGradient:
+            GenerateGradient(index, y, u, v);
+            break;
+        case kScrollingText:
+            GenerateText(index, y, u, v);
+            break;
+        case kScreenShare:
+            GenerateScreenShare(index, y, u, v);
+            break;
+    }
+
+    if (_options.noise > 0)
+    {
+        AddNoise(index, y);
+    }
+}
+
+void
+SyntheticVideoGenerator::GenerateGradient(int index, uint8_t* y, uint8_t* u,
+    uint8_t* v) const
+{
+    const int detail = std::min(std::max(_options.detail, 0), 100);
+    // More detail, shorter ramps and a stronger, finer texture.
+    const int period = 32 + (100 - detail) * 4;
+    const int cell = 2 + (100 - detail) / 16;
+    const int amplitude = detail / 4;
+    const int shift = _options.motion * index;
+
+    for (int py = 0; py < _height; py++)
+    {
+        uint8_t* row = y + py * _width;
+        for (int px = 0; px < _width; px++)
+        {
+            int ramp = Triangle(px + shift + py / 2, period);
+            int texture =
+                (((px + shift) / cell) ^ (py / cell)) & 1 ? amplitude
+                                                          : -amplitude;
+            row[px] = Clamp(16 + ramp * 219 / period + texture);
+        }
+    }
+
+    const int chromaWidth = (_width + 1) / 2;
+    const int chromaHeight = (_height + 1) / 2;
+    for (int cy = 0; cy < chromaHeight; cy++)
+    {
+        for (int cx = 0; cx < chromaWidth; cx++)
+        {
+            int offset = cy * chromaWidth + cx;
+            u[offset] = Clamp(88 + Triangle(cx * 2 + shift, period) * 80 /
+                                       period);
+            v[offset] = Clamp(88 + Triangle(cy * 2 + shift / 2, period) * 80 /
+                                       period);
+        }
+    }
+}
+
+void
+SyntheticVideoGenerator::GenerateText(int index, uint8_t* y, uint8_t* u,
+    uint8_t* v) const
+{
+    const int chromaSize = ((_width + 1) / 2) * ((_height + 1) / 2);
+    memset(y, kPaper, _width * _height);
+    memset(u, 128, chromaSize);
+    memset(v, 128, chromaSize);
+
+    const int margin = (kGlyphWidth + 1) * _scale;
+    Rect page = {margin, 0, std::max(_width - 2 * margin, 0), _height};
+    DrawText(y, page, _options.seed, _options.motion * index);
+}
+
+void
+SyntheticVideoGenerator::GenerateScreenShare(int index, uint8_t* y,
+    uint8_t* u, uint8_t* v) const
+{
+    const int chromaWidth = (_width + 1) / 2;
+    const int chromaHeight = (_height + 1) / 2;
+    const int cellWidth = (kGlyphWidth + 1) * _scale;
+    const int cellHeight = (kGlyphHeight + 3) * _scale;
+    const int detail = std::min(std::max(_options.detail, 0), 100);
+    const int windows = 1 + detail / 25;
+
+    // Desktop.
+    Fill(y, _width, {0, 0, _width, _height}, 70);
+    Fill(u, chromaWidth, {0, 0, chromaWidth, chromaHeight}, 150);
+    Fill(v, chromaWidth, {0, 0, chromaWidth, chromaHeight}, 110);
+
+    for (int k = 0; k < windows; k++)
+    {
+        uint32_t h = Hash(_options.seed, k, 1);
+        Rect window;
+        window.width = _width / 3 + h % (_width / 3 + 1);
+        window.height = _height / 3 + (h >> 8) % (_height / 3 + 1);
+        window.x = (h >> 16) % (_width - window.width + 1);
+        window.y = Hash(_options.seed, k, 2) % (_height - window.height + 1);
+
+        const int titleHeight = std::min(cellHeight, window.height);
+        Rect title = {window.x, window.y, window.width, titleHeight};
+        Rect body = {window.x, window.y + titleHeight, window.width,
+                     window.height - titleHeight};
+        Fill(y, _width, title, 110);
+        Fill(y, _width, body, kPaper);
+        Rect chroma = {window.x / 2, window.y / 2, window.width / 2,
+                       window.height / 2};
+        Fill(u, chromaWidth, chroma, 128);
+        Fill(v, chromaWidth, chroma, 128);
+
+        const int inset = 2 * _scale;
+        Rect text = {body.x + inset, body.y + inset,
+                     std::max(body.width - 2 * inset, 0),
+                     std::max(body.height - 2 * inset, 0)};
+        if (k < windows - 1 || _options.motion <= 0)
+        {
+            DrawText(y, text, Hash(_options.seed, k), 0);
+            continue;
+        }
+
+        // The window on top gets text typed on its last line.
+        const int columns = text.width / cellWidth;
+        const int typingLine = text.height / cellHeight - 1;
+        const int typed = index * _options.motion / 8 % (columns + 1);
+        DrawText(y, text, Hash(_options.seed, k), 0, typingLine, typed);
+    }
+
+    // Clock, ticking every second.
+    Rect clock = {_width - 7 * cellWidth, 0, 6 * cellWidth, cellHeight};
+    if (clock.x >= 0 && clock.height <= _height)
+    {
+        const int tick = _options.motion > 0 ? index / 30 : 0;
+        Fill(y, _width, clock, 40);
+        Rect digits = {clock.x + cellWidth / 2, _scale, clock.width,
+                       clock.height - _scale};
+        for (int py = 0; py < digits.height; py++)
+        {
+            int gy = py / _scale;
+            if (gy >= kGlyphHeight)
+            {
+                continue;
+            }
+            uint8_t* out = y + (digits.y + py) * _width + digits.x;
+            for (int c = 0; c < 5; c++)
+            {
+                uint32_t glyph = Hash(_options.seed, tick, c, 3);
+                uint32_t bits = glyph >> (gy * kGlyphWidth % 28) & 0x1F;
+                for (int gx = 0; gx < kGlyphWidth; gx++)
+                {
+                    if (bits >> gx & 1)
+                    {
+                        memset(out + c * cellWidth + gx * _scale, kPaper,
+                               _scale);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+SyntheticVideoGenerator::AddNoise(int index, uint8_t* y) const
+{
+    const uint32_t range = 2 * _options.noise + 1;
+    const int size = _width * _height;
+    for (int p = 0; p < size; p++)
+    {
+        int noise = static_cast<int>(Hash(p, index, _options.seed, 4) % range) -
+                    _options.noise;
+        y[p] = Clamp(y[p] + noise);
+    }
+}
+
+void
+SyntheticVideoGenerator::Fill(uint8_t* plane, int stride, const Rect& rect,
+    uint8_t value)
+{
+    if (rect.width <= 0)
+    {
+        return;
+    }
+    for (int py = rect.y; py < rect.y + rect.height; py++)
+    {
+        memset(plane + py * stride + rect.x, value, rect.width);
+    }
+}
+
+void
+SyntheticVideoGenerator::DrawText(uint8_t* y, const Rect& rect, uint32_t key,
+    int scroll, int typingLine /*= -1*/, int typed /*= 0*/) const
+{
+    const int cellWidth = (kGlyphWidth + 1) * _scale;
+    const int cellHeight = (kGlyphHeight + 3) * _scale;
+    const int columns = rect.width / cellWidth;
+    if (columns == 0)
+    {
+        return;
+    }
+
+    for (int py = 0; py < rect.height; py++)
+    {
+        const int row = py + scroll;
+        const int line = row / cellHeight;
+        const int gy = (row % cellHeight) / _scale;
+        if (gy >= kGlyphHeight)
+        {
+            continue;
+        }
+
+        // Lines of varying length and indentation, some of them empty.
+        const uint32_t lineHash = Hash(key, line);
+        const int indent = (lineHash >> 16) % 4 * 2;
+        int length = lineHash % 8 == 0 ? 0 : 4 + (lineHash >> 3) % columns;
+        if (line == typingLine)
+        {
+            length = indent + typed;
+        }
+        length = std::min(length, columns);
+
+        uint8_t* out = y + (rect.y + py) * _width + rect.x;
+        for (int col = indent; col < length; col++)
+        {
+            uint32_t glyph = Hash(key, line, col);
+            // Space between words.
+            if (glyph % 6 == 0)
+            {
+                continue;
+            }
+            // Sparser than random bits, closer to actual glyphs.
+            glyph &= Hash(glyph, key);
+            uint32_t bits = glyph >> (gy * kGlyphWidth % 28) & 0x1F;
+            for (int gx = 0; gx < kGlyphWidth; gx++)
+            {
+                if (bits >> gx & 1)
+                {
+                    memset(out + col * cellWidth + gx * _scale, kInk, _scale);
+                }
+            }
+        }
+    }
+}
+
 FrameDropper::FrameDropper()
 :
 _dropsBetweenRenders(0),
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_FRAMEWORK_VIDEO_SOURCE_H_
 #define WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_FRAMEWORK_VIDEO_SOURCE_H_
 
+#include <stdint.h>
+
 #include <string>
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 
@@ -48,6 +50,70 @@ enum VideoSize
         kNumberOfVideoSizes
     };
 
+// Deterministic I420 content for benchmarks without YUV files: the same
+// options always give the same frames, at any resolution.
+class SyntheticVideoGenerator
+{
+public:
+    enum Pattern
+    {
+        kGradient,      // moving diagonal gradient over a checker texture
+        kScrollingText, // page of text scrolling up
+        kScreenShare    // static windows, text being typed and a clock
+    };
+
+    struct Options
+    {
+        Pattern pattern = kGradient;
+        // Pixels per frame the gradient and the text move by. For screen
+        // share, speed of the typing, 0 for a fully static screen.
+        int motion = 4;
+        // 0 to 100: texture contrast, font size and number of windows.
+        int detail = 50;
+        // Amplitude of the noise added to luma, 0 for none.
+        int noise = 0;
+        uint32_t seed = 1;
+    };
+
+    SyntheticVideoGenerator(int width, int height, const Options& options);
+
+    // Writes frame |index| to |frame|, contiguous I420 planes.
+    void Generate(int index, uint8_t* frame) const;
+
+    // "gradient", "text" or "screen".
+    static bool ParsePattern(const std::string& name, Pattern& pattern);
+    static const char* GetPatternName(Pattern pattern);
+
+private:
+    struct Rect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    void GenerateGradient(int index, uint8_t* y, uint8_t* u, uint8_t* v) const;
+    void GenerateText(int index, uint8_t* y, uint8_t* u, uint8_t* v) const;
+    void GenerateScreenShare(int index, uint8_t* y, uint8_t* u,
+                             uint8_t* v) const;
+    void AddNoise(int index, uint8_t* y) const;
+
+    static void Fill(uint8_t* plane, int stride, const Rect& rect,
+                     uint8_t value);
+    // Draws lines of pseudo-glyphs keyed by |key| over |rect|, scrolled up
+    // by |scroll| pixels. Only the first |typed| characters of line
+    // |typingLine| are drawn.
+    void DrawText(uint8_t* y, const Rect& rect, uint32_t key, int scroll,
+                  int typingLine = -1, int typed = 0) const;
+
+    const int _width;
+    const int _height;
+    const Options _options;
+    // Glyph pixel size.
+    const int _scale;
+};
+
 class VideoSource
 {
 public:
@@ -56,12 +122,21 @@ public:
         webrtc::VideoType type = webrtc::VideoType::kI420);
     VideoSource(std::string fileName, int width, int height, int frameRate = 30,
                 webrtc::VideoType type = webrtc::VideoType::kI420);
+    // |frameCount| frames generated by a SyntheticVideoGenerator instead of
+    // read from a file.
+    VideoSource(const SyntheticVideoGenerator::Options& options, int width,
+                int height, int frameRate = 30, int frameCount = 300);
 
     std::string GetFileName() const { return _fileName; }
     int GetWidth() const { return _width; }
     int GetHeight() const { return _height; }
     webrtc::VideoType GetType() const { return _type; }
     int GetFrameRate() const { return _frameRate; }
+    bool IsSynthetic() const { return _synthetic; }
+    int GetFrameCount() const { return _frameCount; }
+
+    // Writes synthetic frame |index| to |frame|, GetFrameLength() bytes.
+    void GenerateFrame(int index, uint8_t* frame) const;
 
     // Returns the file path without a trailing slash.
     std::string GetFilePath() const;
@@ -89,6 +164,9 @@ private:
     int _height;
     webrtc::VideoType _type;
     int _frameRate;
+    bool _synthetic = false;
+    SyntheticVideoGenerator::Options _options;
+    int _frameCount = 0;
 };
 
 class FrameDropper